@@ -0,0 +1,74 @@
+/*
+ * Ultrawide layout plugin for VaultWM
+ * Three columns: the first client in a wide centre column, the rest
+ * alternating between the left and right stacks
+ */
+
+#include <stddef.h>
+#include "layout-plugin.h"
+
+#define CENTER_RATIO 0.5
+
+static void place(const VaultLayoutBatch *b, uint32_t i, int32_t x, int32_t y, int32_t w, int32_t h) {
+    // Respect minimum size hints; the stack may overflow rather than squash a client
+    if (b->min_width[i] > 0 && w < b->min_width[i]) w = b->min_width[i];
+    if (b->min_height[i] > 0 && h < b->min_height[i]) h = b->min_height[i];
+    b->out_x[i] = x;
+    b->out_y[i] = y;
+    b->out_width[i] = w;
+    b->out_height[i] = h;
+}
+
+static int ultrawide_arrange(const VaultLayoutRect *area, int32_t gap, const VaultLayoutBatch *b, void *state) {
+    uint32_t i, tiled = 0, left = 0, right = 0, nleft, nright, k = 0;
+    int32_t center_w, side_w, row;
+    (void)state;
+    
+    for (i = 0; i < b->count; i++) {
+        tiled += b->floating[i] ? 0 : 1;
+    }
+    if (tiled == 0) {
+        return 0;
+    }
+    
+    // Fewer than three clients: plain columns
+    center_w = (tiled < 3) ? area->width / (int32_t)tiled : (int32_t)(area->width * CENTER_RATIO);
+    side_w = (area->width - center_w) / 2;
+    nleft = tiled / 2;          // Odd positions 1, 3, 5, ...
+    nright = (tiled - 1) / 2;
+    
+    for (i = 0; i < b->count; i++) {
+        if (b->floating[i]) continue;
+        
+        if (tiled < 3) {
+            place(b, i, area->x + (int32_t)k * center_w + gap, area->y + gap,
+                  center_w - 2 * gap, area->height - 2 * gap);
+        } else if (k == 0) {
+            place(b, i, area->x + side_w + gap, area->y + gap, center_w - 2 * gap, area->height - 2 * gap);
+        } else if (k % 2 == 1) {
+            row = area->height / (int32_t)nleft;
+            place(b, i, area->x + gap, area->y + (int32_t)left * row + gap, side_w - 2 * gap, row - 2 * gap);
+            left++;
+        } else {
+            row = area->height / (int32_t)nright;
+            place(b, i, area->x + side_w + center_w + gap, area->y + (int32_t)right * row + gap,
+                  side_w - 2 * gap, row - 2 * gap);
+            right++;
+        }
+        k++;
+    }
+    return 0;
+}
+
+static const VaultLayoutPlugin ultrawide = {
+    VAULTWM_LAYOUT_ABI_VERSION,
+    VAULTWM_LAYOUT_REENTRANT,
+    "ultrawide",
+    ultrawide_arrange,
+    NULL,
+    NULL
+};
+
+const VaultLayoutPlugin *vaultwm_layout_plugin(uint32_t host_abi_version) {
+    return (host_abi_version == VAULTWM_LAYOUT_ABI_VERSION) ? &ultrawide : NULL;
+}
@@ -1,11 +1,12 @@
 #!/bin/bash
 #
 # VaultOS Theme Management Daemon
-# Monitors and manages theme changes
+# Applies VaultWM theme changes to GTK applications. Event-driven: waits on
+# the WM's IPC event stream instead of polling for a request file.
+# Change theme with: vaultwmctl theme <pipboy|vaulttec|none>
 #
 
 CONFIG_DIR="$HOME/.config/vaultos"
-THEME_CONFIG="$CONFIG_DIR/theme.conf"
 PID_FILE="/tmp/vaultos-theme-daemon.pid"
 
 # Create config directory if it doesn't exist
@@ -17,30 +18,29 @@ echo $$ > "$PID_FILE"
 # Cleanup on exit
 trap "rm -f $PID_FILE; exit" INT TERM EXIT
 
-# Main loop
-while true; do
-    # Check for theme change requests
-    if [ -f "$CONFIG_DIR/theme_change" ]; then
-        NEW_THEME=$(cat "$CONFIG_DIR/theme_change")
-        rm -f "$CONFIG_DIR/theme_change"
-        
-        # Apply theme change
-        case "$NEW_THEME" in
-            pipboy|Pip-Boy)
-                gsettings set org.gnome.desktop.interface gtk-theme "VaultOS" 2>/dev/null
-                echo "Pip-Boy theme applied"
-                ;;
-            vaulttec|Vault-Tec)
-                # Apply Vault-Tec theme variant
-                gsettings set org.gnome.desktop.interface gtk-theme "VaultOS" 2>/dev/null
-                echo "Vault-Tec theme applied"
-                ;;
-        esac
-        
-        # Notify completion
-        echo "$NEW_THEME" > "$CONFIG_DIR/current_theme"
-    fi
+apply_theme() {
+    case "$1" in
+        pipboy|Pip-Boy|none)
+            gsettings set org.gnome.desktop.interface gtk-theme "VaultOS" 2>/dev/null
+            echo "Pip-Boy theme applied"
+            ;;
+        vaulttec|Vault-Tec)
+            # Apply Vault-Tec theme variant
+            gsettings set org.gnome.desktop.interface gtk-theme "VaultOS" 2>/dev/null
+            echo "Vault-Tec theme applied"
+            ;;
+    esac
     
-    sleep 1
-done
+    # Record for tools that read the current theme
+    echo "$1" > "$CONFIG_DIR/current_theme"
+}
+
+# Catch up with the theme the WM already uses
+CURRENT=$(vaultwmctl theme 2>/dev/null) || exit 1
+apply_theme "$CURRENT"
 
+# Blocks until the WM announces a change; exits (and systemd restarts us) when the WM goes away
+vaultwmctl -S theme | while read -r class theme; do
+    [ "$class" = "theme" ] && apply_theme "$theme"
+done
+exit 1
@@ -0,0 +1,272 @@
+/*
+ * VaultWM Animation Implementation
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/timerfd.h>
+#include "animation.h"
+
+uint64_t animation_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void set_timer(Animator *anim, uint64_t period_ns) {
+    struct itimerspec its;
+    
+    if (anim->timer_fd < 0) {
+        return;
+    }
+    memset(&its, 0, sizeof(its));
+    its.it_interval.tv_sec = (time_t)(period_ns / 1000000000ull);
+    its.it_interval.tv_nsec = (long)(period_ns % 1000000000ull);
+    its.it_value = its.it_interval;
+    timerfd_settime(anim->timer_fd, 0, &its, NULL);
+}
+
+int animation_init(Animator *anim, int refresh_mhz, int duration_ms, int max_windows,
+                   AnimationCommit commit, void *data) {
+    memset(anim, 0, sizeof(Animator));
+    if (refresh_mhz <= 0) {
+        refresh_mhz = ANIMATION_DEFAULT_REFRESH_MHZ;
+    }
+    anim->frame_ns = 1000000000000ull / (uint64_t)refresh_mhz;
+    anim->budget_ns = anim->frame_ns * ANIMATION_BUDGET_PERCENT / 100;
+    anim->duration_ns = (uint64_t)(duration_ms > 0 ? duration_ms : 0) * 1000000ull;
+    anim->max_windows = max_windows;
+    anim->commit = commit;
+    anim->commit_data = data;
+    
+    // Armed only while something moves, so an idle WM never wakes for it
+    anim->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    anim->enabled = (anim->timer_fd >= 0 && anim->duration_ns > 0 && commit != NULL);
+    return anim->timer_fd >= 0;
+}
+
+void animation_cleanup(Animator *anim) {
+    if (anim->timer_fd >= 0) {
+        close(anim->timer_fd);
+        anim->timer_fd = -1;
+    }
+    anim->num_tracks = 0;
+}
+
+void animation_set_enabled(Animator *anim, int enabled) {
+    if (!enabled) {
+        animation_finish(anim);
+    }
+    anim->enabled = enabled && anim->timer_fd >= 0 && anim->duration_ns > 0 && anim->commit;
+}
+
+int animation_get_fd(Animator *anim) {
+    return anim->timer_fd;
+}
+
+int animation_active(const Animator *anim) {
+    return anim->num_tracks > 0;
+}
+
+static int find_track(const Animator *anim, Window win) {
+    int i;
+    
+    for (i = 0; i < anim->num_tracks; i++) {
+        if (anim->tracks[i].to.win == win) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void remove_track(Animator *anim, int idx) {
+    anim->tracks[idx] = anim->tracks[--anim->num_tracks];
+    if (anim->num_tracks == 0) {
+        set_timer(anim, 0);
+    }
+}
+
+int animation_transition(Animator *anim, const LayoutClient *target, LayoutClient *applied,
+                         int num_clients, uint64_t now_ns, int loaded) {
+    int i, t, moving = 0;
+    
+    // Windows in motion are on screen at their last frame, not at the old target
+    for (i = 0; i < num_clients; i++) {
+        t = find_track(anim, applied[i].win);
+        if (t >= 0) {
+            applied[i] = anim->tracks[t].shown;
+        }
+        if (target[i].win != None && layout_rect_changed(&target[i], &applied[i])) {
+            moving++;
+        }
+    }
+    
+    if (moving == 0 && anim->num_tracks == 0) {
+        return 0;
+    }
+    
+    if (!anim->enabled || loaded || anim->overloaded || moving > anim->max_windows ||
+        moving > ANIMATION_MAX_TRACKS) {
+        if (anim->enabled && moving > 0) {
+            anim->skipped++;
+            anim->overloaded = 0;
+        }
+        
+        // These windows are committed below; anything else still moving jumps to its end
+        for (i = 0; i < num_clients; i++) {
+            t = find_track(anim, applied[i].win);
+            if (t >= 0) {
+                remove_track(anim, t);
+            }
+        }
+        animation_finish(anim);
+        if (anim->commit) {
+            anim->commit(anim->commit_data, target, applied, num_clients);
+        }
+        return 0;
+    }
+    
+    for (i = 0; i < num_clients; i++) {
+        t = find_track(anim, applied[i].win);
+        
+        // Retargeting to where a window is already headed keeps its timing
+        if (t >= 0 && !layout_rect_changed(&anim->tracks[t].to, &target[i])) {
+            applied[i] = target[i];
+            continue;
+        }
+        if (target[i].win == None || !layout_rect_changed(&target[i], &applied[i])) {
+            if (t >= 0) {
+                remove_track(anim, t);
+            }
+            continue;
+        }
+        
+        if (t < 0) {
+            t = anim->num_tracks++;
+        }
+        anim->tracks[t].from = applied[i];
+        anim->tracks[t].shown = applied[i];
+        anim->tracks[t].to = target[i];
+        anim->tracks[t].start_ns = now_ns;
+        applied[i] = target[i];
+    }
+    
+    if (anim->num_tracks > 0) {
+        struct itimerspec its;
+        if (anim->timer_fd >= 0 && timerfd_gettime(anim->timer_fd, &its) == 0 &&
+            its.it_interval.tv_sec == 0 && its.it_interval.tv_nsec == 0) {
+            set_timer(anim, anim->frame_ns);
+        }
+    }
+    return anim->num_tracks;
+}
+
+static int lerp(int a, int b, double e) {
+    double v = a + (b - a) * e;
+    return (int)(v < 0 ? v - 0.5 : v + 0.5);
+}
+
+int animation_frame(Animator *anim, uint64_t now_ns, uint64_t ticks) {
+    LayoutClient frame[ANIMATION_MAX_TRACKS], shown[ANIMATION_MAX_TRACKS];
+    uint64_t started;
+    int i, n;
+    
+    if (anim->num_tracks == 0) {
+        set_timer(anim, 0);
+        return 0;
+    }
+    if (ticks > 1) {
+        anim->dropped += (unsigned long)(ticks - 1);
+    }
+    
+    // After an overrun, give the server a refresh to catch up instead of queueing stale frames
+    if (anim->skip_next) {
+        anim->skip_next = 0;
+        anim->dropped++;
+        return anim->num_tracks;
+    }
+    
+    // Progress follows the clock, so late frames land where they should be by now
+    n = anim->num_tracks;
+    for (i = 0; i < n; i++) {
+        AnimationTrack *tr = &anim->tracks[i];
+        double p = (now_ns > tr->start_ns) ? (double)(now_ns - tr->start_ns) / (double)anim->duration_ns : 0.0;
+        double e;
+        
+        if (p > 1.0) p = 1.0;
+        e = 1.0 - (1.0 - p) * (1.0 - p) * (1.0 - p);  // Ease out: fast start, gentle landing
+        
+        frame[i] = tr->to;
+        frame[i].x = lerp(tr->from.x, tr->to.x, e);
+        frame[i].y = lerp(tr->from.y, tr->to.y, e);
+        frame[i].width = lerp(tr->from.width, tr->to.width, e);
+        frame[i].height = lerp(tr->from.height, tr->to.height, e);
+        shown[i] = tr->shown;
+    }
+    
+    started = animation_now_ns();
+    anim->commit(anim->commit_data, frame, shown, n);
+    anim->frames++;
+    
+    if (animation_now_ns() - started > anim->budget_ns) {
+        anim->skip_next = 1;
+        if (++anim->overruns >= ANIMATION_MAX_OVERRUNS) {
+            anim->overloaded = 1;
+        }
+    } else {
+        anim->overruns = 0;
+    }
+    
+    // Tracks can only be removed after the commit, which indexes them by position
+    for (i = n - 1; i >= 0; i--) {
+        anim->tracks[i].shown = shown[i];
+        if (now_ns >= anim->tracks[i].start_ns + anim->duration_ns) {
+            remove_track(anim, i);
+        }
+    }
+    
+    if (anim->overloaded) {
+        animation_finish(anim);
+    }
+    return anim->num_tracks;
+}
+
+void animation_finish(Animator *anim) {
+    LayoutClient frame[ANIMATION_MAX_TRACKS], shown[ANIMATION_MAX_TRACKS];
+    int i;
+    
+    if (anim->num_tracks == 0) {
+        return;
+    }
+    for (i = 0; i < anim->num_tracks; i++) {
+        frame[i] = anim->tracks[i].to;
+        shown[i] = anim->tracks[i].shown;
+    }
+    if (anim->commit) {
+        anim->commit(anim->commit_data, frame, shown, anim->num_tracks);
+    }
+    anim->num_tracks = 0;
+    anim->skip_next = 0;
+    anim->overruns = 0;
+    set_timer(anim, 0);
+}
+
+void animation_forget(Animator *anim, Window win) {
+    int t = find_track(anim, win);
+    
+    if (t >= 0) {
+        remove_track(anim, t);
+    }
+}
+
+int animation_dispatch(Animator *anim, int budget) {
+    uint64_t ticks = 0;
+    (void)budget;
+    
+    if (read(anim->timer_fd, &ticks, sizeof(ticks)) != sizeof(ticks) || ticks == 0) {
+        return 0;
+    }
+    animation_frame(anim, animation_now_ns(), ticks);
+    return 1;
+}
@@ -0,0 +1,88 @@
+/*
+ * VaultWM Animation
+ * Slides windows from their old to their new layout geometry, one frame
+ * per display refresh, and falls back to an instant jump when the WM is
+ * busy or too many windows would move
+ */
+
+#ifndef VAULTWM_ANIMATION_H
+#define VAULTWM_ANIMATION_H
+
+#include <stdint.h>
+#include "../layouts/layout-engine.h"
+
+#define ANIMATION_MAX_TRACKS 256
+#define ANIMATION_DEFAULT_REFRESH_MHZ 60000  // Used when XRandR reports no rate
+#define ANIMATION_BUDGET_PERCENT 50          // Share of a frame period a frame may take
+#define ANIMATION_MAX_OVERRUNS 3             // Over-budget frames in a row before giving up
+
+/* Push geometry to the server: reconfigure windows whose target differs from
+ * shown, update shown, return the number reconfigured (layout_commit signature) */
+typedef int (*AnimationCommit)(void *data, const LayoutClient *target, LayoutClient *shown, int num_clients);
+
+typedef struct {
+    LayoutClient from;
+    LayoutClient to;
+    LayoutClient shown;           // Last rectangle sent to the server
+    uint64_t start_ns;
+} AnimationTrack;
+
+typedef struct {
+    AnimationTrack tracks[ANIMATION_MAX_TRACKS];
+    int num_tracks;
+    int enabled;
+    int max_windows;              // Transitions moving more windows than this jump
+    uint64_t duration_ns;
+    uint64_t frame_ns;            // One display refresh
+    uint64_t budget_ns;           // Time a frame may spend committing
+    int overruns;                 // Consecutive frames over budget
+    int skip_next;                // Last frame overran; let one refresh pass
+    int overloaded;               // Snap the next transition, then retry
+    int timer_fd;
+    AnimationCommit commit;
+    void *commit_data;
+    unsigned long frames;         // Frames committed
+    unsigned long dropped;        // Refreshes passed without a frame
+    unsigned long skipped;        // Transitions applied without animating
+} Animator;
+
+/* Set up the animator and its frame timer. refresh_mhz is the display refresh
+ * rate in millihertz (0 = default); returns 1 on success */
+int animation_init(Animator *anim, int refresh_mhz, int duration_ms, int max_windows,
+                   AnimationCommit commit, void *data);
+
+/* Close the frame timer */
+void animation_cleanup(Animator *anim);
+
+/* Enable or disable animation; disabling finishes running transitions */
+void animation_set_enabled(Animator *anim, int enabled);
+
+/* Timer descriptor that becomes readable once per frame while animating */
+int animation_get_fd(Animator *anim);
+
+/* Non-zero while windows are in motion */
+int animation_active(const Animator *anim);
+
+/* CLOCK_MONOTONIC in nanoseconds */
+uint64_t animation_now_ns(void);
+
+/* Move clients from applied to target. Animates when enabled, not loaded and
+ * few enough windows change; otherwise commits target at once. On return
+ * applied holds target. Returns the number of windows now animating. */
+int animation_transition(Animator *anim, const LayoutClient *target, LayoutClient *applied,
+                         int num_clients, uint64_t now_ns, int loaded);
+
+/* Commit the frame for now_ns. ticks is the number of refreshes since the last
+ * call; all but one are counted as dropped. Returns windows still in motion. */
+int animation_frame(Animator *anim, uint64_t now_ns, uint64_t ticks);
+
+/* Jump every running transition to its end */
+void animation_finish(Animator *anim);
+
+/* Stop tracking a window that is gone */
+void animation_forget(Animator *anim, Window win);
+
+/* Event loop source: read the frame timer and commit one frame */
+int animation_dispatch(Animator *anim, int budget);
+
+#endif /* VAULTWM_ANIMATION_H */
@@ -11,6 +11,7 @@
 #define COLOR_BLACK 0x000000
 #define COLOR_DARK_GREEN 0x003300
 #define COLOR_AMBER 0xFFBF00
+#define COLOR_ALERT_RED 0xFF0000
 
 /* Dimensions */
 #define STATUS_BAR_HEIGHT 30
@@ -28,9 +29,29 @@
 #define STATUS_UPDATE_INTERVAL 1
 
 /* Window management */
-#define MAX_WORKSPACES 9
+#define DEFAULT_WORKSPACES 9  // Always present (Mod4+1-9)
+#define WORKSPACE_LIMIT 1024  // Higher workspaces are created on first use
 #define WINDOW_GAP 5
 #define RESIZE_STEP 10
+#define MOVE_STEP 20  // Pixels Mod4+Shift+direction moves a floating window
+#define SNAP_THRESHOLD 12  // Dragged windows snap to edges this close, 0 disables
+
+/* Event loop scheduling: items each source may handle per loop iteration */
+#define X_EVENT_BUDGET 64
+#define IPC_COMMAND_BUDGET 32
+#define METRICS_SCRAPE_BUDGET 4
+#define JOB_COMPLETION_BUDGET 16
+
+/* Worker threads for file and /proc reads; 0 = one per CPU, up to 4 */
+#define JOB_WORKERS 2
+
+/* Layout animation: slide time, and the most windows that slide at once */
+#define ANIMATION_DURATION_MS 150
+#define ANIMATION_MAX_WINDOWS 12
+
+/* Plugin time budget per call, and the slow calls that disable a plugin */
+#define PLUGIN_BUDGET_MS 5
+#define PLUGIN_MAX_OVERRUNS 20
 
 /* Application launcher */
 #define LAUNCHER_CMD "dmenu_run"
@@ -0,0 +1,76 @@
+/*
+ * VaultWM Configuration Key Table Generator
+ * Build-time tool: searches a seed under which config_key_hash() maps
+ * every key in config-keys.def to its own slot, and prints the table as
+ * config-keys-table.h. Usage: config-keygen > config-keys-table.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config-keys.h"
+
+#define KEYGEN_MAX_SEEDS 1000000
+
+#define CONFIG_SCHEMA_KEY(name, kind, field) name,
+static const char *schema[] = {
+#include "config-keys.def"
+};
+#undef CONFIG_SCHEMA_KEY
+
+#define SCHEMA_SIZE ((int)(sizeof(schema) / sizeof(schema[0])))
+
+/* Fill slots for seed; returns 0 on the first collision */
+static int try_seed(uint32_t seed, int bits, short *slots) {
+    int size = 1 << bits, i;
+    
+    for (i = 0; i < size; i++) slots[i] = -1;
+    for (i = 0; i < SCHEMA_SIZE; i++) {
+        uint32_t slot = config_key_hash(schema[i], strlen(schema[i]), seed) & (uint32_t)(size - 1);
+        if (slots[slot] >= 0) return 0;
+        slots[slot] = (short)i;
+    }
+    return 1;
+}
+
+int main(void) {
+    short *slots;
+    uint32_t seed;
+    int bits = 1, i, j;
+    
+    // Start at a load factor of at most one half and grow until a seed works
+    while ((1 << bits) < 2 * SCHEMA_SIZE) bits++;
+    for (;; bits++) {
+        slots = malloc(sizeof(short) << bits);
+        if (!slots) return 1;
+        for (seed = 1; seed <= KEYGEN_MAX_SEEDS; seed++) {
+            if (try_seed(seed, bits, slots)) break;
+        }
+        if (seed <= KEYGEN_MAX_SEEDS) break;
+        free(slots);
+        if (bits >= 14) {
+            fprintf(stderr, "config-keygen: no perfect hash found (duplicate key?)\n");
+            return 1;
+        }
+    }
+    
+    printf("/*\n * VaultWM Configuration Key Table\n"
+           " * Generated by config-keygen from config-keys.def; do not edit\n */\n\n");
+    printf("#ifndef VAULTWM_CONFIG_KEYS_TABLE_H\n#define VAULTWM_CONFIG_KEYS_TABLE_H\n\n");
+    printf("#define CONFIG_KEY_SCHEMA_SIZE %d\n", SCHEMA_SIZE);
+    printf("#define CONFIG_KEY_HASH_SEED %uu\n", (unsigned)seed);
+    printf("#define CONFIG_KEY_HASH_BITS %d\n\n", bits);
+    printf("/* config_key_hash() slot -> schema index, -1 = no key */\n");
+    printf("static const short config_key_slots[1 << CONFIG_KEY_HASH_BITS] = {\n");
+    for (i = 0; i < (1 << bits); i += 16) {
+        printf("   ");
+        for (j = i; j < i + 16 && j < (1 << bits); j++) {
+            printf(" %d,", slots[j]);
+        }
+        printf("\n");
+    }
+    printf("};\n\n#endif /* VAULTWM_CONFIG_KEYS_TABLE_H */\n");
+    
+    free(slots);
+    return 0;
+}
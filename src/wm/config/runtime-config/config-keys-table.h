@@ -0,0 +1,25 @@
+/*
+ * VaultWM Configuration Key Table
+ * Generated by config-keygen from config-keys.def; do not edit
+ */
+
+#ifndef VAULTWM_CONFIG_KEYS_TABLE_H
+#define VAULTWM_CONFIG_KEYS_TABLE_H
+
+#define CONFIG_KEY_SCHEMA_SIZE 40
+#define CONFIG_KEY_HASH_SEED 115u
+#define CONFIG_KEY_HASH_BITS 7
+
+/* config_key_hash() slot -> schema index, -1 = no key */
+static const short config_key_slots[1 << CONFIG_KEY_HASH_BITS] = {
+    -1, 20, 1, -1, -1, -1, -1, 24, -1, -1, 12, -1, 33, 8, -1, -1,
+    17, 6, -1, -1, 5, -1, -1, 26, -1, -1, -1, 23, 31, -1, 39, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, 14, -1, -1, -1, -1, -1, 38, 9,
+    -1, 16, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 25, -1, -1, 34,
+    -1, 27, -1, -1, -1, 18, -1, -1, -1, -1, -1, -1, 15, -1, -1, 19,
+    -1, -1, -1, 10, 0, -1, -1, 22, 11, -1, -1, 37, 7, -1, -1, 21,
+    -1, -1, -1, 28, -1, -1, -1, -1, -1, -1, 29, -1, -1, -1, -1, -1,
+    -1, 3, 2, 4, -1, -1, 35, -1, 32, -1, -1, -1, 36, -1, 13, 30,
+};
+
+#endif /* VAULTWM_CONFIG_KEYS_TABLE_H */
@@ -0,0 +1,35 @@
+/*
+ * VaultWM Configuration Keys
+ * Value kinds of the key schema in config-keys.def and the seeded hash
+ * its perfect-hash table is built with
+ */
+
+#ifndef VAULTWM_CONFIG_KEYS_H
+#define VAULTWM_CONFIG_KEYS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    CONFIG_VALUE_UINT,      // Integer >= 0
+    CONFIG_VALUE_POSITIVE,  // Integer > 0
+    CONFIG_VALUE_COLOR,     // 0xRRGGBB, #RRGGBB or RRGGBB
+    CONFIG_VALUE_STRING,    // Copied, truncated to the field; may be empty
+    CONFIG_VALUE_KEYSYM     // X keysym name, not empty
+} ConfigValueKind;
+
+/* FNV-1a over the key with a seed folded in, then mixed so the low bits spread */
+static inline uint32_t config_key_hash(const char *key, size_t len, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        h ^= (unsigned char)key[i];
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    return h;
+}
+
+#endif /* VAULTWM_CONFIG_KEYS_H */
@@ -7,31 +7,159 @@
 #include <string.h>
 #include <unistd.h>
 #include <pwd.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../config.h"
 #include "config-parser.h"
+#include "config-keys.h"
+#include "config-keys-table.h"
+
+/* Defaults of the ConfigKey bindings */
+static const char *key_defaults[CONFIG_KEY_COUNT] = {
+    "Return", "d", "q", "t", "f", "r", "m"
+};
+
+/* Where each schema key's value lives; indexed like config-keys-table.h */
+typedef struct {
+    const char *name;
+    unsigned char name_len;
+    unsigned char kind;                // ConfigValueKind
+    unsigned short offset;             // Into VaultWMConfig
+    unsigned short size;
+} ConfigKeyEntry;
+
+#define CONFIG_SCHEMA_KEY(name, kind, field) \
+    { name, sizeof(name) - 1, kind, offsetof(VaultWMConfig, field), sizeof(((VaultWMConfig *)0)->field) },
+static const ConfigKeyEntry schema[] = {
+#include "config-keys.def"
+};
+#undef CONFIG_SCHEMA_KEY
+
+_Static_assert(sizeof(schema) / sizeof(schema[0]) == CONFIG_KEY_SCHEMA_SIZE,
+               "config-keys-table.h is out of date with config-keys.def; run make");
+
+/* One hash, one table load and one compare per key */
+static const ConfigKeyEntry* find_key(const char *key, size_t len) {
+    uint32_t slot = config_key_hash(key, len, CONFIG_KEY_HASH_SEED) & ((1u << CONFIG_KEY_HASH_BITS) - 1);
+    int index = config_key_slots[slot];
+    
+    if (index < 0 || schema[index].name_len != len || memcmp(schema[index].name, key, len) != 0) {
+        return NULL;
+    }
+    return &schema[index];
+}
+
+/* Decimal integer spanning all of [s, s + len) */
+static int parse_int(const char *s, size_t len, int *out) {
+    long v = 0;
+    size_t i = 0;
+    int negative = 0;
+    
+    if (len > 0 && (s[0] == '-' || s[0] == '+')) {
+        negative = (s[0] == '-');
+        i++;
+    }
+    if (i == len) return 0;
+    for (; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9') return 0;
+        v = v * 10 + (s[i] - '0');
+        if (v > 1000000) return 0;
+    }
+    *out = negative ? (int)-v : (int)v;
+    return 1;
+}
+
+/* "#RRGGBB", "0xRRGGBB" or bare hex, at most six digits */
+static int parse_color(const char *s, size_t len, unsigned long *out) {
+    unsigned long v = 0;
+    size_t i = 0;
+    
+    if (len > 0 && s[0] == '#') i = 1;
+    else if (len > 1 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) i = 2;
+    if (i == len || len - i > 6) return 0;
+    for (; i < len; i++) {
+        int c = s[i];
+        if (c >= '0' && c <= '9') v = v * 16 + (unsigned long)(c - '0');
+        else if (c >= 'a' && c <= 'f') v = v * 16 + (unsigned long)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v = v * 16 + (unsigned long)(c - 'A' + 10);
+        else return 0;
+    }
+    *out = v;
+    return 1;
+}
+
+/* Store a value for entry; returns NULL or what is wrong with it */
+static const char* set_value(const ConfigKeyEntry *entry, const char *value, size_t len,
+                             VaultWMConfig *config) {
+    char *field = (char *)config + entry->offset;
+    int n;
+    
+    switch (entry->kind) {
+        case CONFIG_VALUE_UINT:
+        case CONFIG_VALUE_POSITIVE:
+            if (!parse_int(value, len, &n)) return "expected a number";
+            if (n < (entry->kind == CONFIG_VALUE_POSITIVE ? 1 : 0)) {
+                return entry->kind == CONFIG_VALUE_POSITIVE ? "must be greater than 0" : "must not be negative";
+            }
+            *(int *)field = n;
+            return NULL;
+        case CONFIG_VALUE_COLOR:
+            if (!parse_color(value, len, (unsigned long *)field)) return "expected a colour like #00FF41";
+            return NULL;
+        case CONFIG_VALUE_KEYSYM:
+            if (len == 0) return "expected a key name";
+            /* fall through */
+        case CONFIG_VALUE_STRING:
+            if (len >= entry->size) len = entry->size - 1;  // Truncate long values
+            memcpy(field, value, len);
+            field[len] = '\0';
+            return NULL;
+    }
+    return "bad schema entry";
+}
+
+static void add_error(ConfigErrors *errors, int line, int column, const char *message) {
+    if (!errors) return;
+    if (errors->count < CONFIG_MAX_ERRORS) {
+        errors->errors[errors->count].line = line;
+        errors->errors[errors->count].column = column;
+        errors->errors[errors->count].message = message;
+    }
+    errors->count++;
+}
 
 void get_default_config(VaultWMConfig *config) {
-    config->border_width = 2;
-    config->border_color_focused = 0x00FF41;
-    config->border_color_unfocused = 0x003300;
-    config->border_color_urgent = 0xFF0000;
-    config->gap_size = 5;
-    config->status_bar_height = 30;
-    config->status_bar_update_interval = 1;
+    config->border_width = BORDER_WIDTH;
+    config->border_color_focused = COLOR_PIPBOY_GREEN;
+    config->border_color_unfocused = COLOR_DARK_GREEN;
+    config->border_color_urgent = COLOR_ALERT_RED;
+    config->gap_size = WINDOW_GAP;
+    config->status_bar_height = STATUS_BAR_HEIGHT;
+    config->status_bar_update_interval = STATUS_UPDATE_INTERVAL;
+    config->snap_threshold = SNAP_THRESHOLD;
+    config->move_step = MOVE_STEP;
+    config->plugin_budget_ms = PLUGIN_BUDGET_MS;
+    config->plugin_max_overruns = PLUGIN_MAX_OVERRUNS;
     
     // Use strncpy with explicit null termination for safety
-    strncpy(config->terminal_cmd, "alacritty", sizeof(config->terminal_cmd) - 1);
+    strncpy(config->terminal_cmd, TERMINAL_CMD, sizeof(config->terminal_cmd) - 1);
     config->terminal_cmd[sizeof(config->terminal_cmd) - 1] = '\0';
     
-    strncpy(config->terminal_fallback, "xterm", sizeof(config->terminal_fallback) - 1);
+    strncpy(config->terminal_fallback, TERMINAL_FALLBACK, sizeof(config->terminal_fallback) - 1);
     config->terminal_fallback[sizeof(config->terminal_fallback) - 1] = '\0';
     
-    strncpy(config->launcher_cmd, "dmenu_run", sizeof(config->launcher_cmd) - 1);
+    strncpy(config->launcher_cmd, LAUNCHER_CMD, sizeof(config->launcher_cmd) - 1);
     config->launcher_cmd[sizeof(config->launcher_cmd) - 1] = '\0';
     
-    strncpy(config->launcher_fallback, "rofi -show drun", sizeof(config->launcher_fallback) - 1);
+    strncpy(config->launcher_fallback, LAUNCHER_FALLBACK, sizeof(config->launcher_fallback) - 1);
     config->launcher_fallback[sizeof(config->launcher_fallback) - 1] = '\0';
     
-    config->default_layout = 0;  // tiling
+    config->theme[0] = '\0';
+    
+    strncpy(config->default_layout, "tiling", sizeof(config->default_layout) - 1);
+    config->default_layout[sizeof(config->default_layout) - 1] = '\0';
     
     // Default workspace names
     int i;
@@ -41,103 +169,74 @@ void get_default_config(VaultWMConfig *config) {
         strncpy(config->workspace_names[i], ws_name, sizeof(config->workspace_names[i]) - 1);
         config->workspace_names[i][sizeof(config->workspace_names[i]) - 1] = '\0';
     }
-}
-
-int parse_config_line(const char *line, VaultWMConfig *config) {
-    char key[CONFIG_KEY_MAX];
-    char value[CONFIG_VALUE_MAX];
-    char line_copy[CONFIG_LINE_MAX];
-    int i, j;
     
-    // Skip empty lines and comments
-    if (line[0] == '\0' || line[0] == '#' || line[0] == '\n') {
-        return 0;
+    for (i = 0; i < CONFIG_KEY_COUNT; i++) {
+        strncpy(config->keys[i], key_defaults[i], sizeof(config->keys[i]) - 1);
+        config->keys[i][sizeof(config->keys[i]) - 1] = '\0';
     }
+}
+
+int config_parse_buffer(const char *buf, size_t len, VaultWMConfig *config, ConfigErrors *errors) {
+    const char *p = buf, *end = buf + len;
+    int line = 0, set = 0;
     
-    strncpy(line_copy, line, CONFIG_LINE_MAX - 1);
-    line_copy[CONFIG_LINE_MAX - 1] = '\0';
-    
-    // Remove trailing whitespace and newline
-    for (i = strlen(line_copy) - 1; i >= 0 && (line_copy[i] == ' ' || line_copy[i] == '\t' || line_copy[i] == '\n' || line_copy[i] == '\r'); i--) {
-        line_copy[i] = '\0';
-    }
-    
-    // Find = sign
-    char *eq = strchr(line_copy, '=');
-    if (!eq) return 0;
-    
-    // Extract key (left side of =)
-    for (i = 0; line_copy[i] != '=' && i < CONFIG_KEY_MAX - 1; i++) {
-        key[i] = line_copy[i];
-    }
-    key[i] = '\0';
-    
-    // Remove trailing whitespace from key
-    for (i = strlen(key) - 1; i >= 0 && (key[i] == ' ' || key[i] == '\t'); i--) {
-        key[i] = '\0';
-    }
-    
-    // Extract value (right side of =)
-    for (i = 0, j = (int)(eq - line_copy) + 1; line_copy[j] != '\0' && i < CONFIG_VALUE_MAX - 1; i++, j++) {
-        value[i] = line_copy[j];
-    }
-    value[i] = '\0';
-    
-    // Remove leading whitespace from value
-    for (i = 0; value[i] == ' ' || value[i] == '\t'; i++);
-    if (i > 0) {
-        memmove(value, value + i, strlen(value) - i + 1);
-    }
-    
-    // Parse configuration values
-    if (strcmp(key, "border_width") == 0) {
-        config->border_width = atoi(value);
-    } else if (strcmp(key, "border_color_focused") == 0) {
-        config->border_color_focused = strtoul(value, NULL, 16);
-    } else if (strcmp(key, "border_color_unfocused") == 0) {
-        config->border_color_unfocused = strtoul(value, NULL, 16);
-    } else if (strcmp(key, "border_color_urgent") == 0) {
-        config->border_color_urgent = strtoul(value, NULL, 16);
-    } else if (strcmp(key, "gap_size") == 0) {
-        config->gap_size = atoi(value);
-    } else if (strcmp(key, "status_bar_height") == 0) {
-        config->status_bar_height = atoi(value);
-    } else if (strcmp(key, "status_bar_update_interval") == 0) {
-        config->status_bar_update_interval = atoi(value);
-    } else if (strcmp(key, "terminal_cmd") == 0) {
-        strncpy(config->terminal_cmd, value, sizeof(config->terminal_cmd) - 1);
-        config->terminal_cmd[sizeof(config->terminal_cmd) - 1] = '\0';
-    } else if (strcmp(key, "terminal_fallback") == 0) {
-        strncpy(config->terminal_fallback, value, sizeof(config->terminal_fallback) - 1);
-        config->terminal_fallback[sizeof(config->terminal_fallback) - 1] = '\0';
-    } else if (strcmp(key, "launcher_cmd") == 0) {
-        strncpy(config->launcher_cmd, value, sizeof(config->launcher_cmd) - 1);
-        config->launcher_cmd[sizeof(config->launcher_cmd) - 1] = '\0';
-    } else if (strcmp(key, "launcher_fallback") == 0) {
-        strncpy(config->launcher_fallback, value, sizeof(config->launcher_fallback) - 1);
-        config->launcher_fallback[sizeof(config->launcher_fallback) - 1] = '\0';
-    } else if (strcmp(key, "default_layout") == 0) {
-        if (strcmp(value, "tiling") == 0) config->default_layout = 0;
-        else if (strcmp(value, "floating") == 0) config->default_layout = 1;
-        else if (strcmp(value, "monocle") == 0) config->default_layout = 2;
-        else if (strcmp(value, "grid") == 0) config->default_layout = 3;
-        else if (strcmp(value, "fibonacci") == 0) config->default_layout = 4;
-    } else if (strncmp(key, "workspace_", 10) == 0) {
-        int ws_num = atoi(key + 10);
-        if (ws_num >= 1 && ws_num <= 9) {
-            strncpy(config->workspace_names[ws_num - 1], value, sizeof(config->workspace_names[0]) - 1);
-            config->workspace_names[ws_num - 1][sizeof(config->workspace_names[0]) - 1] = '\0';
+    // One pass over the buffer; keys and values are (pointer, length) spans into it
+    while (p < end) {
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        const char *next = eol ? eol + 1 : end;
+        const char *s = p, *e = eol ? eol : end;
+        line++;
+        
+        while (s < e && (*s == ' ' || *s == '\t')) s++;
+        while (e > s && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\r')) e--;
+        if (s == e || *s == '#') {
+            p = next;
+            continue;
+        }
+        
+        const char *eq = memchr(s, '=', (size_t)(e - s));
+        if (!eq) {
+            add_error(errors, line, (int)(s - p) + 1, "expected key=value");
+            p = next;
+            continue;
+        }
+        
+        const char *key_end = eq;
+        while (key_end > s && (key_end[-1] == ' ' || key_end[-1] == '\t')) key_end--;
+        const char *value = eq + 1;
+        while (value < e && (*value == ' ' || *value == '\t')) value++;
+        const char *value_end = e;
+        if (value_end - value >= 2 && *value == '"' && value_end[-1] == '"') {
+            value++;
+            value_end--;
         }
+        
+        const ConfigKeyEntry *entry = find_key(s, (size_t)(key_end - s));
+        if (!entry) {
+            add_error(errors, line, (int)(s - p) + 1, key_end == s ? "missing key" : "unknown key");
+        } else {
+            const char *message = set_value(entry, value, (size_t)(value_end - value), config);
+            if (message) {
+                add_error(errors, line, (int)(value - p) + 1, message);
+            } else {
+                set++;
+            }
+        }
+        p = next;
     }
     
-    return 1;
+    return set;
 }
 
-int load_config(const char *config_path, VaultWMConfig *config) {
-    FILE *file;
-    char line[CONFIG_LINE_MAX];
+int parse_config_line(const char *line, VaultWMConfig *config) {
+    return config_parse_buffer(line, strlen(line), config, NULL) > 0;
+}
+
+int config_load(const char *config_path, VaultWMConfig *config, ConfigErrors *errors) {
     char expanded_path[512];
     struct stat st;
+    void *map;
+    int fd;
     
     if (!config_path || !config) {
         return 0;
@@ -145,6 +244,7 @@ int load_config(const char *config_path, VaultWMConfig *config) {
     
     // Get default config first
     get_default_config(config);
+    if (errors) errors->count = 0;
     
     // Expand ~ to home directory
     if (config_path[0] == '~') {
@@ -161,44 +261,77 @@ int load_config(const char *config_path, VaultWMConfig *config) {
         return 0;  // Reject paths with ..
     }
     
-    // Check if file exists and is readable
-    if (stat(config_path, &st) != 0) {
+    fd = open(config_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
         return 0;  // File doesn't exist, use defaults
     }
     
-    // Verify it's a regular file
-    if (!S_ISREG(st.st_mode)) {
-        return 0;  // Not a regular file
+    // Verify it's a regular file of sane size
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > CONFIG_FILE_MAX_SIZE) {
+        close(fd);
+        return 0;
     }
-    
-    // Check file size (prevent reading huge files)
-    if (st.st_size > CONFIG_FILE_MAX_SIZE) {
-        return 0;  // File too large
+    if (st.st_size == 0) {
+        close(fd);
+        return 1;  // Empty file: all defaults
     }
     
-    file = fopen(config_path, "r");
-    if (!file) {
-        return 0;  // Cannot open file, use defaults
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return 0;
     }
     
-    // Read file line by line with bounds checking
-    while (fgets(line, sizeof(line), file)) {
-        // Check for buffer overflow (line too long)
-        if (strlen(line) >= CONFIG_LINE_MAX - 1 && line[CONFIG_LINE_MAX - 2] != '\n') {
-            // Line too long, skip it
-            int c;
-            while ((c = fgetc(file)) != EOF && c != '\n');
-            continue;
-        }
-        parse_config_line(line, config);
-    }
+    config_parse_buffer(map, (size_t)st.st_size, config, errors);
+    munmap(map, (size_t)st.st_size);
+    return 1;
+}
+
+int load_config(const char *config_path, VaultWMConfig *config) {
+    return config_load(config_path, config, NULL);
+}
+
+unsigned int config_diff(const VaultWMConfig *old_config, const VaultWMConfig *new_config) {
+    unsigned int changed = 0;
     
-    if (ferror(file)) {
-        fclose(file);
-        return 0;  // Error reading file
+    if (old_config->border_color_focused != new_config->border_color_focused ||
+        old_config->border_color_unfocused != new_config->border_color_unfocused ||
+        old_config->border_color_urgent != new_config->border_color_urgent) {
+        changed |= CONFIG_CHANGED_COLORS;
+    }
+    if (strcmp(old_config->theme, new_config->theme) != 0) {
+        changed |= CONFIG_CHANGED_THEME;
+    }
+    if (old_config->border_width != new_config->border_width) {
+        changed |= CONFIG_CHANGED_BORDER;
+    }
+    if (old_config->gap_size != new_config->gap_size) {
+        changed |= CONFIG_CHANGED_GAPS;
+    }
+    if (old_config->status_bar_height != new_config->status_bar_height) {
+        changed |= CONFIG_CHANGED_BAR;
+    }
+    if (memcmp(old_config->keys, new_config->keys, sizeof(old_config->keys)) != 0) {
+        changed |= CONFIG_CHANGED_KEYS;
+    }
+    if (old_config->status_bar_update_interval != new_config->status_bar_update_interval ||
+        memcmp(old_config->workspace_names, new_config->workspace_names,
+               sizeof(old_config->workspace_names)) != 0) {
+        changed |= CONFIG_CHANGED_STATUS;
+    }
+    if (old_config->snap_threshold != new_config->snap_threshold ||
+        old_config->move_step != new_config->move_step ||
+        strcmp(old_config->terminal_cmd, new_config->terminal_cmd) != 0 ||
+        strcmp(old_config->terminal_fallback, new_config->terminal_fallback) != 0 ||
+        strcmp(old_config->launcher_cmd, new_config->launcher_cmd) != 0 ||
+        strcmp(old_config->launcher_fallback, new_config->launcher_fallback) != 0 ||
+        strcmp(old_config->default_layout, new_config->default_layout) != 0) {
+        changed |= CONFIG_CHANGED_BEHAVIOUR;
+    }
+    if (old_config->plugin_budget_ms != new_config->plugin_budget_ms ||
+        old_config->plugin_max_overruns != new_config->plugin_max_overruns) {
+        changed |= CONFIG_CHANGED_PLUGINS;
     }
     
-    fclose(file);
-    return 1;
+    return changed;
 }
-
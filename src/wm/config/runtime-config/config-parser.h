@@ -1,40 +1,94 @@
 /*
  * VaultWM Configuration Parser
- * Runtime configuration file parsing
+ * Runtime configuration file parsing; the one config model, with the
+ * compile-time values in config.h as its defaults. Files are mapped and
+ * tokenised in place, keys dispatched through a generated perfect hash.
  */
 
 #ifndef VAULTWM_CONFIG_PARSER_H
 #define VAULTWM_CONFIG_PARSER_H
 
-#define CONFIG_FILE_MAX_SIZE 8192
-#define CONFIG_LINE_MAX 256
-#define CONFIG_KEY_MAX 64
-#define CONFIG_VALUE_MAX 128
+#include <stddef.h>
+
+#define CONFIG_FILE_MAX_SIZE (16 * 1024 * 1024)  // Mapped, so only a sanity limit
+#define CONFIG_KEYSYM_MAX 32
+#define CONFIG_MAX_ERRORS 16                     // Diagnostics kept per load
+
+/* Rebindable Mod4 keys, by X keysym name */
+typedef enum {
+    CONFIG_KEY_TERMINAL,
+    CONFIG_KEY_LAUNCHER,
+    CONFIG_KEY_CLOSE,
+    CONFIG_KEY_TOGGLE_LAYOUT,
+    CONFIG_KEY_TOGGLE_FLOAT,
+    CONFIG_KEY_RESIZE,
+    CONFIG_KEY_MOVE,
+    CONFIG_KEY_COUNT
+} ConfigKey;
+
+/* What a reload changed, i.e. which subsystems have to react */
+#define CONFIG_CHANGED_COLORS     (1 << 0)  // Recolour borders
+#define CONFIG_CHANGED_BORDER     (1 << 1)  // Reset border widths
+#define CONFIG_CHANGED_GAPS       (1 << 2)  // Relayout
+#define CONFIG_CHANGED_BAR        (1 << 3)  // Resize the bar, relayout
+#define CONFIG_CHANGED_KEYS       (1 << 4)  // Regrab
+#define CONFIG_CHANGED_STATUS     (1 << 5)  // Redraw the bar
+#define CONFIG_CHANGED_BEHAVIOUR  (1 << 6)  // Read where used: commands, snapping, defaults
+#define CONFIG_CHANGED_THEME      (1 << 7)  // Load another palette
+#define CONFIG_CHANGED_PLUGINS    (1 << 8)  // New plugin time budget
 
 typedef struct {
     int border_width;
     unsigned long border_color_focused;
     unsigned long border_color_unfocused;
     unsigned long border_color_urgent;
+    char theme[32];  // VaultOS theme whose palette overrides the colours above, "" = none
     int gap_size;
     int status_bar_height;
     int status_bar_update_interval;
+    int snap_threshold;
+    int move_step;
     char terminal_cmd[64];
     char terminal_fallback[64];
     char launcher_cmd[64];
     char launcher_fallback[64];
-    int default_layout;  // 0=tiling, 1=floating, 2=monocle, 3=grid, 4=fibonacci
+    char default_layout[32];  // Layout name, built-in or plugin
+    int plugin_budget_ms;     // Per call, 0 = unlimited
+    int plugin_max_overruns;  // Overruns before a plugin is disabled, 0 = never
     char workspace_names[9][32];
+    char keys[CONFIG_KEY_COUNT][CONFIG_KEYSYM_MAX];
 } VaultWMConfig;
 
-/* Load configuration from file */
+/* A line the loader skipped, with the 1-based position of the offending token */
+typedef struct {
+    int line;
+    int column;
+    const char *message;  // Static string
+} ConfigError;
+
+typedef struct {
+    ConfigError errors[CONFIG_MAX_ERRORS];
+    int count;            // All errors seen; only the first CONFIG_MAX_ERRORS are kept
+} ConfigErrors;
+
+/* Load configuration from file; missing keys keep their defaults. Returns 1 if the
+ * file was read; bad lines are skipped and, if errors is not NULL, reported there */
+int config_load(const char *config_path, VaultWMConfig *config, ConfigErrors *errors);
+
+/* config_load() without diagnostics */
 int load_config(const char *config_path, VaultWMConfig *config);
 
+/* Parse a buffer of config lines over config (no defaults applied); returns the
+ * number of values set */
+int config_parse_buffer(const char *buf, size_t len, VaultWMConfig *config, ConfigErrors *errors);
+
 /* Get default configuration */
 void get_default_config(VaultWMConfig *config);
 
-/* Parse a single config line */
+/* Parse a single config line; returns 1 if it set a value */
 int parse_config_line(const char *line, VaultWMConfig *config);
 
-#endif /* VAULTWM_CONFIG_PARSER_H */
+/* CONFIG_CHANGED_* bits for everything that differs between two configurations */
+unsigned int config_diff(const VaultWMConfig *old_config, const VaultWMConfig *new_config);
 
+#endif /* VAULTWM_CONFIG_PARSER_H */
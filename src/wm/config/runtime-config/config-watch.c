@@ -0,0 +1,67 @@
+/*
+ * VaultWM Configuration Watcher Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "config-watch.h"
+
+/* Whole-file events only: a save is a close after writing or a rename over the file */
+#define CONFIG_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)
+
+static int watch_fd = -1;
+
+int config_watch_init(const char *dir) {
+    if (!dir || watch_fd >= 0) return 0;
+    
+    // Watch the directory, not the files: editors replace files and a config may appear later
+    mkdir(dir, 0755);
+    
+    watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_fd < 0) return 0;
+    
+    if (inotify_add_watch(watch_fd, dir, CONFIG_WATCH_MASK) < 0) {
+        close(watch_fd);
+        watch_fd = -1;
+        return 0;
+    }
+    return 1;
+}
+
+int config_watch_get_fd(void) {
+    return watch_fd;
+}
+
+unsigned int config_watch_read(void) {
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    unsigned int changed = 0;
+    ssize_t len;
+    
+    if (watch_fd < 0) return 0;
+    
+    while ((len = read(watch_fd, buf, sizeof(buf))) > 0) {
+        char *p = buf;
+        while (p < buf + len) {
+            struct inotify_event *ev = (struct inotify_event *)p;
+            if (ev->len > 0) {
+                if (strcmp(ev->name, "config") == 0) changed |= CONFIG_WATCH_CONFIG;
+                else if (strcmp(ev->name, "rules") == 0) changed |= CONFIG_WATCH_RULES;
+            }
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+    
+    return changed;
+}
+
+void config_watch_cleanup(void) {
+    if (watch_fd >= 0) {
+        close(watch_fd);
+        watch_fd = -1;
+    }
+}
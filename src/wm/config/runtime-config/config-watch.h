@@ -0,0 +1,26 @@
+/*
+ * VaultWM Configuration Watcher
+ * inotify on the config directory, so saved edits are picked up without
+ * a reload command or restart
+ */
+
+#ifndef VAULTWM_CONFIG_WATCH_H
+#define VAULTWM_CONFIG_WATCH_H
+
+#define CONFIG_WATCH_CONFIG (1 << 0)  // <dir>/config written, replaced or removed
+#define CONFIG_WATCH_RULES  (1 << 1)  // <dir>/rules likewise
+
+/* Watch dir (created if missing); returns 1 on success */
+int config_watch_init(const char *dir);
+
+/* inotify descriptor for the event loop, -1 if not watching */
+int config_watch_get_fd(void);
+
+/* Drain pending events; returns the CONFIG_WATCH_* bits of the files that changed.
+ * An editor's save usually produces several events, they come back as one bit. */
+unsigned int config_watch_read(void);
+
+/* Stop watching */
+void config_watch_cleanup(void);
+
+#endif /* VAULTWM_CONFIG_WATCH_H */
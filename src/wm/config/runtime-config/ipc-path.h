@@ -0,0 +1,37 @@
+/*
+ * VaultWM IPC Socket Path
+ * Where the socket lives, shared by the WM (ipc.c) and the client library
+ * (libvaultwm-ipc) so the two cannot disagree
+ */
+
+#ifndef VAULTWM_IPC_PATH_H
+#define VAULTWM_IPC_PATH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "ipc.h"
+
+/* $VAULTWM_IPC_SOCKET, else $XDG_RUNTIME_DIR/vaultwm-ipc.sock, else a per-user
+ * name in /tmp. Returns 0 if it does not fit path */
+static inline int ipc_resolve_socket_path(char *path, size_t path_size) {
+    const char *env = getenv(IPC_SOCKET_ENV);
+    const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+    int n;
+    
+    if (!path || path_size == 0) {
+        return 0;
+    }
+    
+    if (env && env[0] != '\0') {
+        n = snprintf(path, path_size, "%s", env);
+    } else if (runtime_dir && runtime_dir[0] == '/') {
+        n = snprintf(path, path_size, "%s/%s", runtime_dir, IPC_SOCKET_NAME);
+    } else {
+        n = snprintf(path, path_size, "/tmp/vaultwm-ipc-%u.sock", (unsigned int)getuid());
+    }
+    
+    return (n > 0 && (size_t)n < path_size) ? 1 : 0;
+}
+
+#endif /* VAULTWM_IPC_PATH_H */
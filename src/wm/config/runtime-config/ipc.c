@@ -2,6 +2,7 @@
  * VaultWM IPC Implementation
  */
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,24 +11,65 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <ctype.h>
+#include <stdarg.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
 #include "ipc.h"
+#include "ipc-path.h"
+
+#define IPC_INPUT_MAX 4096
+
+/* Persistent socket client */
+typedef struct {
+    int fd;
+    char in[IPC_INPUT_MAX];    // Pipelined requests not yet executed
+    size_t in_len;
+    int discarding;            // Dropping the rest of an over-long line
+    int backlog;               // Complete requests left over after a budgeted turn
+    int eof;                   // Client shut down its write side
+    char *out;                 // Replies and events not yet written
+    size_t out_len;
+    size_t out_cap;
+    int want_write;            // EPOLLOUT armed while output is pending
+    unsigned int subscriptions;
+    int dead;                  // Write failed mid-service; closed once the service returns
+} IPCConnection;
 
 static int ipc_fifo_fd = -1;
 static int ipc_initialized = 0;
 static ipc_command_handler_t command_handler = NULL;
 
+static int ipc_epoll_fd = -1;
+static int ipc_listen_fd = -1;
+static char ipc_socket_file[IPC_SOCKET_PATH_MAX];
+static IPCConnection connections[IPC_MAX_CONNECTIONS];
+static IPCConnection *servicing = NULL;  // Connection whose requests are executing
+
 // Command whitelist - only these commands are allowed
 static const char *allowed_commands[] = {
     IPC_CMD_QUIT,
     IPC_CMD_RELOAD,
+    IPC_CMD_RESTART,
+    IPC_CMD_THEME,
     IPC_CMD_WORKSPACE,
     IPC_CMD_MOVE_TO_WORKSPACE,
     IPC_CMD_FOCUS_NEXT,
     IPC_CMD_FOCUS_PREV,
+    IPC_CMD_FOCUS,
+    IPC_CMD_MOVE,
+    IPC_CMD_TAG,
+    IPC_CMD_VIEW,
+    IPC_CMD_TOGGLE_VIEW,
     IPC_CMD_CLOSE_WINDOW,
     IPC_CMD_TOGGLE_FLOAT,
     IPC_CMD_TOGGLE_LAYOUT,
+    IPC_CMD_RESIZE_SPLIT,
+    IPC_CMD_SET_LAYOUT,
+    IPC_CMD_ANIMATIONS,
+    IPC_CMD_PLUGINS,
     IPC_CMD_GET_STATUS,
+    IPC_CMD_SUBSCRIBE,
     NULL
 };
 
@@ -62,13 +104,80 @@ static int validate_command(const char *cmd, size_t len) {
     return 1;
 }
 
+/* Resolve the socket path shared by the WM and its clients */
+int ipc_socket_path(char *path, size_t path_size) {
+    return ipc_resolve_socket_path(path, path_size);
+}
+
+// Register fd with the IPC epoll set; data.ptr identifies the endpoint
+static int epoll_watch(int fd, void *tag, unsigned int events, int op) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = tag;
+    return epoll_ctl(ipc_epoll_fd, op, fd, &ev) == 0;
+}
+
+static int ipc_socket_init(void) {
+    struct sockaddr_un addr;
+    
+    if (!ipc_socket_path(ipc_socket_file, sizeof(ipc_socket_file))) {
+        fprintf(stderr, "VaultWM: IPC socket path too long\n");
+        return 0;
+    }
+    
+    ipc_listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (ipc_listen_fd < 0) {
+        fprintf(stderr, "VaultWM: Failed to create IPC socket: %s\n", strerror(errno));
+        return 0;
+    }
+    
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", ipc_socket_file);
+    
+    unlink(ipc_socket_file);
+    if (bind(ipc_listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        chmod(ipc_socket_file, 0600) < 0 ||
+        listen(ipc_listen_fd, IPC_MAX_CONNECTIONS) < 0) {
+        fprintf(stderr, "VaultWM: Failed to bind IPC socket %s: %s\n", ipc_socket_file, strerror(errno));
+        close(ipc_listen_fd);
+        ipc_listen_fd = -1;
+        unlink(ipc_socket_file);
+        return 0;
+    }
+    
+    if (!epoll_watch(ipc_listen_fd, &ipc_listen_fd, EPOLLIN, EPOLL_CTL_ADD)) {
+        close(ipc_listen_fd);
+        ipc_listen_fd = -1;
+        unlink(ipc_socket_file);
+        return 0;
+    }
+    
+    return 1;
+}
+
 int ipc_init(void) {
+    int i;
+    
+    for (i = 0; i < IPC_MAX_CONNECTIONS; i++) {
+        connections[i].fd = -1;
+    }
+    
+    ipc_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (ipc_epoll_fd < 0) {
+        fprintf(stderr, "VaultWM: Failed to create IPC poll set: %s\n", strerror(errno));
+        return 0;
+    }
+    
     // Remove existing FIFO if it exists
     unlink(IPC_FIFO_PATH);
     
     // Create FIFO with secure permissions (0600 = owner read/write only)
     if (mkfifo(IPC_FIFO_PATH, 0600) < 0 && errno != EEXIST) {
         fprintf(stderr, "VaultWM: Failed to create IPC FIFO: %s\n", IPC_FIFO_PATH);
+        close(ipc_epoll_fd);
+        ipc_epoll_fd = -1;
         return 0;
     }
     
@@ -76,37 +185,130 @@ int ipc_init(void) {
     if (chmod(IPC_FIFO_PATH, 0600) < 0) {
         fprintf(stderr, "VaultWM: Failed to set IPC FIFO permissions: %s\n", strerror(errno));
         unlink(IPC_FIFO_PATH);
+        close(ipc_epoll_fd);
+        ipc_epoll_fd = -1;
         return 0;
     }
     
-    // Open FIFO in non-blocking mode
-    ipc_fifo_fd = open(IPC_FIFO_PATH, O_RDONLY | O_NONBLOCK);
+    // Open FIFO read/write so it never reports EOF/HUP between writers
+    ipc_fifo_fd = open(IPC_FIFO_PATH, O_RDWR | O_NONBLOCK | O_CLOEXEC);
     if (ipc_fifo_fd < 0) {
         fprintf(stderr, "VaultWM: Failed to open IPC FIFO: %s\n", strerror(errno));
         unlink(IPC_FIFO_PATH);
+        close(ipc_epoll_fd);
+        ipc_epoll_fd = -1;
         return 0;
     }
+    epoll_watch(ipc_fifo_fd, &ipc_fifo_fd, EPOLLIN, EPOLL_CTL_ADD);
+    
+    // The socket is additive: scripts using the FIFO keep working without it
+    if (!ipc_socket_init()) {
+        fprintf(stderr, "VaultWM: IPC socket unavailable, FIFO only\n");
+    }
     
     ipc_initialized = 1;
     return 1;
 }
 
+static void connection_close(IPCConnection *conn) {
+    if (conn->fd >= 0) {
+        epoll_ctl(ipc_epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+        close(conn->fd);
+    }
+    free(conn->out);
+    memset(conn, 0, sizeof(*conn));
+    conn->fd = -1;
+}
+
 void ipc_cleanup(void) {
+    int i;
+    
+    for (i = 0; i < IPC_MAX_CONNECTIONS; i++) {
+        if (connections[i].fd >= 0) {
+            connection_close(&connections[i]);
+        }
+    }
+    if (ipc_listen_fd >= 0) {
+        close(ipc_listen_fd);
+        ipc_listen_fd = -1;
+        unlink(ipc_socket_file);
+    }
     if (ipc_fifo_fd >= 0) {
         close(ipc_fifo_fd);
         ipc_fifo_fd = -1;
     }
+    if (ipc_epoll_fd >= 0) {
+        close(ipc_epoll_fd);
+        ipc_epoll_fd = -1;
+    }
     unlink(IPC_FIFO_PATH);
     ipc_initialized = 0;
 }
 
+int ipc_get_fd(void) {
+    return ipc_epoll_fd;
+}
+
 void ipc_send_response(const char *response) {
-    // For now, responses are written to stdout/stderr
-    // In a full implementation, we could use a response FIFO
+    // FIFO writers cannot read a reply; socket clients get theirs inline
     fprintf(stdout, "VaultWM IPC: %s\n", response);
     fflush(stdout);
 }
 
+/* Queue bytes for a socket client; flushed once per dispatch pass */
+static int connection_queue(IPCConnection *conn, const char *data, size_t len) {
+    if (conn->out_len + len > IPC_OUTPUT_MAX) {
+        return 0;  // Client stopped reading; caller drops it
+    }
+    
+    if (conn->out_len + len > conn->out_cap) {
+        size_t new_cap = conn->out_cap ? conn->out_cap * 2 : 4096;
+        char *new_out;
+        while (new_cap < conn->out_len + len) {
+            new_cap *= 2;
+        }
+        new_out = realloc(conn->out, new_cap);
+        if (!new_out) {
+            return 0;
+        }
+        conn->out = new_out;
+        conn->out_cap = new_cap;
+    }
+    
+    memcpy(conn->out + conn->out_len, data, len);
+    conn->out_len += len;
+    return 1;
+}
+
+/* Write as much queued output as the socket accepts. MSG_NOSIGNAL: a client
+ * that went away is EPIPE, not a SIGPIPE that kills the WM */
+static int connection_flush(IPCConnection *conn) {
+    while (conn->out_len > 0) {
+        ssize_t n = send(conn->fd, conn->out, conn->out_len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!conn->want_write) {
+                    conn->want_write = epoll_watch(conn->fd, conn,
+                        (conn->eof ? 0 : EPOLLIN) | EPOLLOUT, EPOLL_CTL_MOD);
+                }
+                return 1;
+            }
+            return 0;
+        }
+        memmove(conn->out, conn->out + n, conn->out_len - (size_t)n);
+        conn->out_len -= (size_t)n;
+    }
+    
+    if (conn->want_write) {
+        epoll_watch(conn->fd, conn, conn->eof ? 0 : EPOLLIN, EPOLL_CTL_MOD);
+        conn->want_write = 0;
+    }
+    return 1;
+}
+
 /* Parse command and arguments from input string */
 int ipc_parse_command(const char *input, char *cmd, size_t cmd_size, char *args, size_t args_size) {
     const char *space;
@@ -158,17 +360,221 @@ void ipc_set_command_handler(ipc_command_handler_t handler) {
     command_handler = handler;
 }
 
-void ipc_process_commands(void) {
-    char input[IPC_CMD_MAX];
+static unsigned int parse_event_classes(const char *args) {
+    unsigned int mask = 0;
+    
+    if (args[0] == '\0' || strstr(args, "all")) {
+        return IPC_EVENT_ALL;
+    }
+    if (strstr(args, "workspace")) mask |= IPC_EVENT_WORKSPACE;
+    if (strstr(args, "window")) mask |= IPC_EVENT_WINDOW;
+    if (strstr(args, "focus")) mask |= IPC_EVENT_FOCUS;
+    if (strstr(args, "layout")) mask |= IPC_EVENT_LAYOUT;
+    if (strstr(args, "theme")) mask |= IPC_EVENT_THEME;
+    
+    return mask;
+}
+
+/* Execute one request line; reply is the full response line without newline */
+static int ipc_execute(IPCConnection *conn, char *input, char *reply, size_t reply_size) {
     char cmd[IPC_CMD_MAX];
     char args[IPC_CMD_MAX];
-    ssize_t bytes_read;
-    size_t input_len;
+    char text[IPC_RESPONSE_MAX];
+    size_t input_len = strlen(input);
     
-    if (!ipc_initialized || ipc_fifo_fd < 0) {
-        return;
+    // Remove trailing newline and carriage return
+    while (input_len > 0 && (input[input_len - 1] == '\n' || input[input_len - 1] == '\r')) {
+        input[--input_len] = '\0';
     }
     
+    // Validate input
+    if (!validate_command(input, input_len)) {
+        snprintf(reply, reply_size, IPC_REPLY_ERROR ": Invalid command format");
+        return 0;
+    }
+    
+    // Parse command and arguments
+    if (!ipc_parse_command(input, cmd, sizeof(cmd), args, sizeof(args))) {
+        snprintf(reply, reply_size, IPC_REPLY_ERROR ": Failed to parse command");
+        return 0;
+    }
+    
+    // Check command whitelist (check base command, not with arguments)
+    if (!is_command_allowed(cmd)) {
+        snprintf(reply, reply_size, IPC_REPLY_ERROR ": Command not allowed");
+        return 0;
+    }
+    
+    // Subscriptions are connection state, handled here rather than by the WM
+    if (strcmp(cmd, IPC_CMD_SUBSCRIBE) == 0) {
+        unsigned int mask = parse_event_classes(args);
+        if (!conn || mask == 0) {
+            snprintf(reply, reply_size, IPC_REPLY_ERROR ": Cannot subscribe");
+            return 0;
+        }
+        conn->subscriptions |= mask;
+        snprintf(reply, reply_size, IPC_REPLY_OK " subscribed");
+        return 1;
+    }
+    
+    // Call command handler if set
+    if (command_handler == NULL) {
+        // No handler set, just acknowledge
+        snprintf(reply, reply_size, IPC_REPLY_OK ": Command received (no handler)");
+        return 1;
+    }
+    
+    text[0] = '\0';
+    if (!command_handler(cmd, args, text, sizeof(text))) {
+        snprintf(reply, reply_size, IPC_REPLY_ERROR ": %s", text[0] ? text : "Command failed");
+        return 0;
+    }
+    if (text[0]) {
+        snprintf(reply, reply_size, IPC_REPLY_OK " %s", text);
+    } else {
+        snprintf(reply, reply_size, IPC_REPLY_OK);
+    }
+    return 1;
+}
+
+static void ipc_accept_connections(void) {
+    for (;;) {
+        int fd = accept4(ipc_listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        int i;
+        
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                fprintf(stderr, "VaultWM IPC: accept failed: %s\n", strerror(errno));
+            }
+            return;
+        }
+        
+        for (i = 0; i < IPC_MAX_CONNECTIONS; i++) {
+            if (connections[i].fd < 0) {
+                break;
+            }
+        }
+        if (i == IPC_MAX_CONNECTIONS) {
+            static const char busy[] = IPC_REPLY_ERROR ": Too many connections\n";
+            if (send(fd, busy, sizeof(busy) - 1, MSG_NOSIGNAL) < 0) {
+                // Nothing more to tell the client
+            }
+            close(fd);
+            continue;
+        }
+        
+        memset(&connections[i], 0, sizeof(IPCConnection));
+        connections[i].fd = fd;
+        if (!epoll_watch(fd, &connections[i], EPOLLIN, EPOLL_CTL_ADD)) {
+            close(fd);
+            connections[i].fd = -1;
+        }
+    }
+}
+
+/* Execute up to budget buffered requests (0 = all); returns the count or -1 */
+static int connection_execute(IPCConnection *conn, int budget) {
+    char reply[IPC_RESPONSE_MAX];
+    size_t start = 0;
+    int executed = 0;
+    
+    while ((budget <= 0 || executed < budget) && !conn->dead) {
+        char *line = conn->in + start;
+        char *nl = memchr(line, '\n', conn->in_len - start);
+        
+        if (!nl) {
+            break;
+        }
+        *nl = '\0';
+        start = (size_t)(nl - conn->in) + 1;
+        
+        if (conn->discarding) {
+            snprintf(reply, sizeof(reply), IPC_REPLY_ERROR ": Command too long");
+            conn->discarding = 0;
+        } else {
+            ipc_execute(conn, line, reply, sizeof(reply) - 1);
+        }
+        executed++;
+        
+        strcat(reply, "\n");
+        if (!connection_queue(conn, reply, strlen(reply))) {
+            return -1;
+        }
+    }
+    
+    if (start > 0) {
+        memmove(conn->in, conn->in + start, conn->in_len - start);
+        conn->in_len -= start;
+    }
+    
+    // A full buffer without a newline can only be one over-long request
+    if (conn->in_len == sizeof(conn->in)) {
+        conn->discarding = 1;
+        conn->in_len = 0;
+    }
+    
+    conn->backlog = (memchr(conn->in, '\n', conn->in_len) != NULL);
+    return executed;
+}
+
+/* One bounded read, then execute pipelined requests and answer in one write */
+static int ipc_service_connection(IPCConnection *conn, unsigned int events, int budget) {
+    int executed = 0;
+    int alive = 1;
+    
+    if ((events & (EPOLLIN | EPOLLHUP)) && !conn->eof && conn->in_len < sizeof(conn->in)) {
+        ssize_t n = read(conn->fd, conn->in + conn->in_len, sizeof(conn->in) - conn->in_len);
+        if (n > 0) {
+            conn->in_len += (size_t)n;
+        } else if (n == 0) {
+            conn->eof = 1;  // Half-closed: answer what was sent, then drop
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            alive = 0;
+        }
+    }
+    
+    if (alive) {
+        servicing = conn;
+        executed = connection_execute(conn, budget);
+        servicing = NULL;
+        if (executed < 0) {
+            executed = 0;
+            alive = 0;  // Client stopped reading its replies
+        }
+        if (conn->dead) {
+            alive = 0;  // An event broadcast found it gone
+        }
+    }
+    
+    if (events & EPOLLERR) {
+        alive = 0;
+    }
+    
+    // Deliver whatever we owe before deciding whether to drop the client
+    if (alive && conn->out_len > 0 && !connection_flush(conn)) {
+        alive = 0;
+    }
+    
+    if (alive && conn->eof && !conn->backlog && conn->out_len == 0) {
+        alive = 0;
+    } else if (alive && conn->eof && !conn->want_write) {
+        epoll_watch(conn->fd, conn, 0, EPOLL_CTL_MOD);  // Stop level-triggered EOF wakeups
+    }
+    
+    if (!alive) {
+        connection_close(conn);
+    }
+    return executed;
+}
+
+/* FIFO requests are fire-and-forget; responses only go to stdout */
+static int ipc_service_fifo(void) {
+    char input[IPC_CMD_MAX];
+    char reply[IPC_RESPONSE_MAX];
+    ssize_t bytes_read;
+    char *line, *saveptr;
+    int executed = 0;
+    
     // Read command from FIFO (non-blocking) with bounds checking
     bytes_read = read(ipc_fifo_fd, input, IPC_CMD_MAX - 1);
     
@@ -177,53 +583,132 @@ void ipc_process_commands(void) {
         if (errno != EAGAIN && errno != EWOULDBLOCK) {
             fprintf(stderr, "VaultWM IPC: Error reading from FIFO: %s\n", strerror(errno));
         }
-        return;
+        return 0;
     }
     
     if (bytes_read == 0) {
         // EOF - no data available
-        return;
+        return 0;
     }
     
     // Ensure null termination
-    if (bytes_read >= IPC_CMD_MAX - 1) {
-        bytes_read = IPC_CMD_MAX - 1;
-    }
     input[bytes_read] = '\0';
     
-    // Remove trailing newline and carriage return
-    while (bytes_read > 0 && (input[bytes_read - 1] == '\n' || input[bytes_read - 1] == '\r')) {
-        bytes_read--;
-        input[bytes_read] = '\0';
+    // Several echo'd commands may arrive in one read
+    for (line = strtok_r(input, "\n", &saveptr); line; line = strtok_r(NULL, "\n", &saveptr)) {
+        if (line[0] == '\0' || line[0] == '\r') {
+            continue;
+        }
+        ipc_execute(NULL, line, reply, sizeof(reply));
+        ipc_send_response(reply);
+        executed++;
     }
+    return executed;
+}
+
+int ipc_dispatch(int budget) {
+    struct epoll_event events[IPC_MAX_CONNECTIONS + 2];
+    static int next_backlog = 0;
+    int executed = 0;
+    int n, i;
     
-    input_len = (size_t)bytes_read;
+    if (!ipc_initialized || ipc_epoll_fd < 0) {
+        return 0;
+    }
     
-    // Validate input
-    if (!validate_command(input, input_len)) {
-        ipc_send_response("ERROR: Invalid command format");
-        return;
+    // Requests left over from the last budgeted turn go first; epoll won't
+    // report them again because their bytes were already read
+    for (i = 0; i < IPC_MAX_CONNECTIONS && (budget <= 0 || executed < budget); i++) {
+        IPCConnection *conn = &connections[(next_backlog + i) % IPC_MAX_CONNECTIONS];
+        if (conn->fd >= 0 && conn->backlog) {
+            executed += ipc_service_connection(conn, 0, budget > 0 ? budget - executed : 0);
+        }
     }
+    next_backlog = (next_backlog + 1) % IPC_MAX_CONNECTIONS;
     
-    // Parse command and arguments
-    if (!ipc_parse_command(input, cmd, sizeof(cmd), args, sizeof(args))) {
-        ipc_send_response("ERROR: Failed to parse command");
+    if (budget > 0 && executed >= budget) {
+        return executed;
+    }
+    
+    n = epoll_wait(ipc_epoll_fd, events, IPC_MAX_CONNECTIONS + 2, 0);
+    for (i = 0; i < n; i++) {
+        void *tag = events[i].data.ptr;
+        int remaining = budget > 0 ? budget - executed : 0;
+        
+        if (tag == &ipc_listen_fd) {
+            ipc_accept_connections();
+        } else if (budget > 0 && remaining <= 0) {
+            continue;  // Level-triggered: still readable next iteration
+        } else if (tag == &ipc_fifo_fd) {
+            executed += ipc_service_fifo();
+        } else {
+            IPCConnection *conn = (IPCConnection *)tag;
+            if (conn->fd >= 0) {
+                executed += ipc_service_connection(conn, events[i].events, remaining);
+            }
+        }
+    }
+    
+    return executed;
+}
+
+int ipc_pending(void) {
+    int i;
+    
+    for (i = 0; i < IPC_MAX_CONNECTIONS; i++) {
+        if (connections[i].fd >= 0 && connections[i].backlog) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void ipc_process_commands(void) {
+    ipc_dispatch(0);
+}
+
+void ipc_broadcast_event(unsigned int event_class, const char *fmt, ...) {
+    char line[IPC_RESPONSE_MAX];
+    va_list ap;
+    int len, i;
+    
+    if (!ipc_initialized) {
         return;
     }
     
-    // Check command whitelist (check base command, not with arguments)
-    if (!is_command_allowed(cmd)) {
-        ipc_send_response("ERROR: Command not allowed");
+    // Cheap exit when nobody listens, so callers need not check first
+    for (i = 0; i < IPC_MAX_CONNECTIONS; i++) {
+        if (connections[i].fd >= 0 && (connections[i].subscriptions & event_class)) {
+            break;
+        }
+    }
+    if (i == IPC_MAX_CONNECTIONS) {
         return;
     }
     
-    // Call command handler if set
-    if (command_handler != NULL) {
-        command_handler(cmd, args);
-        ipc_send_response("OK: Command executed");
-    } else {
-        // No handler set, just acknowledge
-        ipc_send_response("OK: Command received (no handler)");
+    len = snprintf(line, sizeof(line), IPC_REPLY_EVENT " ");
+    va_start(ap, fmt);
+    len += vsnprintf(line + len, sizeof(line) - (size_t)len - 1, fmt, ap);
+    va_end(ap);
+    if (len > (int)sizeof(line) - 2) {
+        len = (int)sizeof(line) - 2;
+    }
+    line[len++] = '\n';
+    line[len] = '\0';
+    
+    for (; i < IPC_MAX_CONNECTIONS; i++) {
+        IPCConnection *conn = &connections[i];
+        if (conn->fd < 0 || conn->dead || !(conn->subscriptions & event_class)) {
+            continue;
+        }
+        if (!connection_queue(conn, line, (size_t)len) || !connection_flush(conn)) {
+            // A handler may be broadcasting on behalf of this very client; its
+            // request loop still uses the buffers, so leave the close to it
+            if (conn == servicing) {
+                conn->dead = 1;
+            } else {
+                connection_close(conn);
+            }
+        }
     }
 }
-
@@ -1,26 +1,61 @@
 /*
  * VaultWM IPC (Inter-Process Communication)
- * Named pipe (FIFO) based IPC for external script control
+ * Named pipe (FIFO) and Unix socket based IPC for external script control
  */
 
 #ifndef VAULTWM_IPC_H
 #define VAULTWM_IPC_H
 
+#include <stddef.h>
+
 #define IPC_FIFO_PATH "/tmp/vaultwm-ipc"
 #define IPC_CMD_MAX 256
 #define IPC_RESPONSE_MAX 512
 
+/* Unix socket endpoint (persistent connections, one reply line per request) */
+#define IPC_SOCKET_ENV "VAULTWM_IPC_SOCKET"
+#define IPC_SOCKET_NAME "vaultwm-ipc.sock"
+#define IPC_SOCKET_PATH_MAX 108
+#define IPC_MAX_CONNECTIONS 32
+#define IPC_OUTPUT_MAX (256 * 1024)  // Per-connection reply backlog before we drop the client
+
 /* IPC Commands */
 #define IPC_CMD_QUIT "quit"
 #define IPC_CMD_RELOAD "reload"
+#define IPC_CMD_RESTART "restart"
+#define IPC_CMD_THEME "theme"
 #define IPC_CMD_WORKSPACE "workspace"
 #define IPC_CMD_MOVE_TO_WORKSPACE "move_to_workspace"
 #define IPC_CMD_FOCUS_NEXT "focus_next"
 #define IPC_CMD_FOCUS_PREV "focus_prev"
+#define IPC_CMD_FOCUS "focus"
+#define IPC_CMD_MOVE "move"
+#define IPC_CMD_TAG "tag"
+#define IPC_CMD_VIEW "view"
+#define IPC_CMD_TOGGLE_VIEW "toggle_view"
 #define IPC_CMD_CLOSE_WINDOW "close_window"
 #define IPC_CMD_TOGGLE_FLOAT "toggle_float"
 #define IPC_CMD_TOGGLE_LAYOUT "toggle_layout"
+#define IPC_CMD_RESIZE_SPLIT "resize_split"
+#define IPC_CMD_SET_LAYOUT "set_layout"
+#define IPC_CMD_ANIMATIONS "animations"
+#define IPC_CMD_PLUGINS "plugins"
 #define IPC_CMD_GET_STATUS "get_status"
+#define IPC_CMD_SUBSCRIBE "subscribe"
+
+/* Event classes a socket client can subscribe to */
+#define IPC_EVENT_WORKSPACE (1u << 0)
+#define IPC_EVENT_WINDOW (1u << 1)
+#define IPC_EVENT_FOCUS (1u << 2)
+#define IPC_EVENT_LAYOUT (1u << 3)
+#define IPC_EVENT_THEME (1u << 4)
+#define IPC_EVENT_ALL (IPC_EVENT_WORKSPACE | IPC_EVENT_WINDOW | IPC_EVENT_FOCUS | IPC_EVENT_LAYOUT | \
+                       IPC_EVENT_THEME)
+
+/* Reply line prefixes on the socket protocol */
+#define IPC_REPLY_OK "OK"
+#define IPC_REPLY_ERROR "ERROR"
+#define IPC_REPLY_EVENT "EVENT"
 
 /* Initialize IPC */
 int ipc_init(void);
@@ -31,11 +66,18 @@ void ipc_cleanup(void);
 /* Process IPC commands */
 void ipc_process_commands(void);
 
+/* Execute at most budget requests (0 = no limit); returns requests executed */
+int ipc_dispatch(int budget);
+
+/* Non-zero if requests are buffered that a previous budget left unexecuted */
+int ipc_pending(void);
+
 /* Send IPC response */
 void ipc_send_response(const char *response);
 
-/* Command handler callback type */
-typedef void (*ipc_command_handler_t)(const char *cmd, const char *args);
+/* Command handler callback type.
+ * Writes an optional reply text into reply and returns 1 on success, 0 on error. */
+typedef int (*ipc_command_handler_t)(const char *cmd, const char *args, char *reply, size_t reply_size);
 
 /* Set command handler callback */
 void ipc_set_command_handler(ipc_command_handler_t handler);
@@ -43,5 +85,13 @@ void ipc_set_command_handler(ipc_command_handler_t handler);
 /* Parse command and arguments from input string */
 int ipc_parse_command(const char *input, char *cmd, size_t cmd_size, char *args, size_t args_size);
 
-#endif /* VAULTWM_IPC_H */
+/* Resolve the socket path ($VAULTWM_IPC_SOCKET, $XDG_RUNTIME_DIR, then /tmp) */
+int ipc_socket_path(char *path, size_t path_size);
+
+/* Pollable descriptor that becomes readable when any IPC endpoint has work */
+int ipc_get_fd(void);
 
+/* Push an event line to every socket client subscribed to event_class */
+void ipc_broadcast_event(unsigned int event_class, const char *fmt, ...);
+
+#endif /* VAULTWM_IPC_H */
@@ -0,0 +1,120 @@
+/*
+ * VaultWM Event Loop Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include "event-loop.h"
+
+void event_loop_init(EventLoop *loop) {
+    memset(loop, 0, sizeof(EventLoop));
+}
+
+int event_loop_add_source(EventLoop *loop, const char *name, int fd, int budget,
+                          EventSourceDispatch dispatch, EventSourcePending pending, void *data) {
+    EventSource *src;
+    
+    if (!loop || fd < 0 || !dispatch || loop->num_sources >= EVENT_LOOP_MAX_SOURCES) {
+        return -1;
+    }
+    
+    src = &loop->sources[loop->num_sources];
+    memset(src, 0, sizeof(EventSource));
+    src->name = name;
+    src->fd = fd;
+    src->budget = budget;
+    src->dispatch = dispatch;
+    src->pending = pending;
+    src->data = data;
+    
+    return loop->num_sources++;
+}
+
+void event_loop_remove_source(EventLoop *loop, int fd) {
+    int i;
+    
+    for (i = 0; i < loop->num_sources; i++) {
+        if (loop->sources[i].fd == fd) {
+            memmove(&loop->sources[i], &loop->sources[i + 1],
+                (loop->num_sources - i - 1) * sizeof(EventSource));
+            loop->num_sources--;
+            loop->next_first = 0;
+            return;
+        }
+    }
+}
+
+void event_loop_set_budget(EventLoop *loop, int fd, int budget) {
+    int i;
+    
+    for (i = 0; i < loop->num_sources; i++) {
+        if (loop->sources[i].fd == fd) {
+            loop->sources[i].budget = budget;
+        }
+    }
+}
+
+int event_loop_backlogged(const EventLoop *loop) {
+    int i;
+    
+    for (i = 0; i < loop->num_sources; i++) {
+        if (loop->sources[i].backlog) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int event_loop_iterate(EventLoop *loop, int timeout_ms) {
+    struct pollfd fds[EVENT_LOOP_MAX_SOURCES];
+    int ready[EVENT_LOOP_MAX_SOURCES];
+    int n = loop->num_sources;
+    int i, ret, total = 0;
+    
+    // Work left over from a budgeted turn must not wait for the timeout
+    for (i = 0; i < n; i++) {
+        EventSource *src = &loop->sources[i];
+        ready[i] = src->backlog || (src->pending && src->pending(src->data));
+        if (ready[i]) {
+            timeout_ms = 0;
+        }
+        fds[i].fd = src->fd;
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+    
+    ret = poll(fds, (nfds_t)n, timeout_ms);
+    if (ret < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    
+    // One turn per source, rotating who goes first so equal budgets stay fair
+    for (i = 0; i < n; i++) {
+        int idx = (loop->next_first + i) % n;
+        EventSource *src = &loop->sources[idx];
+        int handled;
+        
+        if (!ready[idx] && !(fds[idx].revents & (POLLIN | POLLHUP | POLLERR))) {
+            continue;
+        }
+        
+        handled = src->dispatch(src->data, src->budget);
+        if (handled < 0) {
+            handled = 0;
+        }
+        src->dispatched += (unsigned long)handled;
+        src->backlog = (src->budget > 0 && handled >= src->budget);
+        if (src->backlog) {
+            src->exhausted++;
+        }
+        total += handled;
+    }
+    
+    if (n > 0) {
+        loop->next_first = (loop->next_first + 1) % n;
+    }
+    
+    return total;
+}
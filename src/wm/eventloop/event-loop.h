@@ -0,0 +1,56 @@
+/*
+ * VaultWM Event Loop
+ * poll()-based dispatcher with per-source budgets so that no input
+ * source (X events, IPC, timers) can starve the others
+ */
+
+#ifndef VAULTWM_EVENT_LOOP_H
+#define VAULTWM_EVENT_LOOP_H
+
+#define EVENT_LOOP_MAX_SOURCES 16
+
+/* Handle at most budget items (budget 0 = no limit); return items handled */
+typedef int (*EventSourceDispatch)(void *data, int budget);
+
+/* Return non-zero if work is already buffered in user space (e.g. Xlib's queue) */
+typedef int (*EventSourcePending)(void *data);
+
+typedef struct {
+    const char *name;
+    int fd;
+    int budget;                    // Items per iteration, 0 = unlimited
+    EventSourceDispatch dispatch;
+    EventSourcePending pending;    // Optional
+    void *data;
+    int backlog;                   // Budget was exhausted last iteration
+    unsigned long dispatched;      // Items handled since start
+    unsigned long exhausted;       // Iterations that hit the budget
+} EventSource;
+
+typedef struct {
+    EventSource sources[EVENT_LOOP_MAX_SOURCES];
+    int num_sources;
+    int next_first;                // Round-robin start for the next iteration
+} EventLoop;
+
+/* Initialize an empty loop */
+void event_loop_init(EventLoop *loop);
+
+/* Register a source; returns its index or -1 */
+int event_loop_add_source(EventLoop *loop, const char *name, int fd, int budget,
+                          EventSourceDispatch dispatch, EventSourcePending pending, void *data);
+
+/* Remove the source watching fd */
+void event_loop_remove_source(EventLoop *loop, int fd);
+
+/* Change the per-iteration budget of a source */
+void event_loop_set_budget(EventLoop *loop, int fd, int budget);
+
+/* Non-zero if any source used its whole budget last iteration (work is queueing up) */
+int event_loop_backlogged(const EventLoop *loop);
+
+/* Wait up to timeout_ms for work, then give each ready source one budgeted turn.
+ * Returns the number of items dispatched, or -1 on poll failure. */
+int event_loop_iterate(EventLoop *loop, int timeout_ms);
+
+#endif /* VAULTWM_EVENT_LOOP_H */
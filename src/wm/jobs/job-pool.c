@@ -0,0 +1,364 @@
+/*
+ * VaultWM Job Pool Implementation
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include "job-pool.h"
+
+typedef struct Job {
+    JobFunc run;
+    JobFunc done;
+    void *arg;
+    const void *owner;
+    struct Job *next;             // Completion list
+} Job;
+
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;         // Guards the ring
+    Job *ring[JOB_QUEUE_SIZE];
+    unsigned int head, tail;      // Thieves take from head, the owner from tail
+    const void *running;          // Owner of the job in progress; cleared under pool_lock
+} Worker;
+
+static Worker workers[JOB_POOL_MAX_WORKERS];
+static int num_workers = 0;
+static int next_worker = 0;       // Round-robin for jobs from the event thread
+static __thread int self = -1;    // Worker index of the calling thread
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;  // A job was queued, or stopping
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;  // A job finished
+static int queued = 0;
+static int unfinished = 0;        // Submitted, completion not yet listed
+static int stopping = 0;
+static Job *done_head = NULL, *done_tail = NULL;
+static int done_fd = -1;
+
+static int push(Worker *w, Job *job) {
+    int ok;
+    
+    pthread_mutex_lock(&w->lock);
+    ok = w->tail - w->head < JOB_QUEUE_SIZE;
+    if (ok) w->ring[w->tail++ % JOB_QUEUE_SIZE] = job;
+    pthread_mutex_unlock(&w->lock);
+    return ok;
+}
+
+/* Newest first from our own queue (its data is still warm), oldest first from a
+ * victim's; the taker is marked running before the job leaves the ring, so
+ * job_pool_flush() never misses it */
+static Job* take(Worker *w, Worker *taker, int own) {
+    Job *job = NULL;
+    
+    pthread_mutex_lock(&w->lock);
+    if (w->tail != w->head) {
+        job = own ? w->ring[--w->tail % JOB_QUEUE_SIZE] : w->ring[w->head++ % JOB_QUEUE_SIZE];
+        __atomic_store_n(&taker->running, job->owner, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return job;
+}
+
+static Job* find_work(int index) {
+    Job *job = take(&workers[index], &workers[index], 1);
+    int i;
+    
+    for (i = 1; !job && i < num_workers; i++) {
+        job = take(&workers[(index + i) % num_workers], &workers[index], 0);
+    }
+    if (job) {
+        pthread_mutex_lock(&pool_lock);
+        queued--;
+        pthread_mutex_unlock(&pool_lock);
+    }
+    return job;
+}
+
+/* Called with pool_lock held; returns 1 if the list was empty */
+static int add_completion(Job *job) {
+    int was_empty = done_head == NULL;
+    
+    job->next = NULL;
+    if (done_tail) {
+        done_tail->next = job;
+    } else {
+        done_head = job;
+    }
+    done_tail = job;
+    return was_empty;
+}
+
+static void* worker_main(void *data) {
+    Worker *w = data;
+    uint64_t one = 1;
+    
+    self = (int)(w - workers);
+    for (;;) {
+        Job *job = find_work(self);
+        if (!job) {
+            pthread_mutex_lock(&pool_lock);
+            while (!queued && !stopping) {
+                pthread_cond_wait(&work_cond, &pool_lock);
+            }
+            int quit = stopping && !queued;
+            pthread_mutex_unlock(&pool_lock);
+            if (quit) break;
+            continue;
+        }
+        
+        job->run(job->arg);
+        
+        // Wake the event loop only when the list goes non-empty; it drains the rest
+        pthread_mutex_lock(&pool_lock);
+        int wake = add_completion(job);
+        unfinished--;
+        __atomic_store_n(&w->running, NULL, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&idle_cond);
+        pthread_mutex_unlock(&pool_lock);
+        if (wake && write(done_fd, &one, sizeof(one)) < 0) {
+            // Counter saturated: the loop is already woken
+        }
+    }
+    return NULL;
+}
+
+/* Let the first started workers finish the queue and exit */
+static void stop_workers(int started) {
+    int i;
+    
+    pthread_mutex_lock(&pool_lock);
+    stopping = 1;
+    pthread_cond_broadcast(&work_cond);
+    pthread_mutex_unlock(&pool_lock);
+    for (i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    for (i = 0; i < num_workers; i++) {
+        pthread_mutex_destroy(&workers[i].lock);
+    }
+    num_workers = 0;
+}
+
+int job_pool_init(int count) {
+    sigset_t all, old;
+    int i;
+    
+    if (num_workers > 0) return 1;
+    if (count <= 0) count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (count <= 0) count = 1;
+    if (count > JOB_POOL_MAX_WORKERS) count = JOB_POOL_MAX_WORKERS;
+    
+    done_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (done_fd < 0) return 0;
+    
+    // Every worker steals from every other, so all of them exist before any starts
+    for (i = 0; i < count; i++) {
+        workers[i].head = workers[i].tail = 0;
+        workers[i].running = NULL;
+        pthread_mutex_init(&workers[i].lock, NULL);
+    }
+    num_workers = count;
+    stopping = 0;
+    
+    // Signals stay with the event thread
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    for (i = 0; i < count; i++) {
+        if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) break;
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    
+    if (i < count) {
+        stop_workers(i);
+        close(done_fd);
+        done_fd = -1;
+        return 0;
+    }
+    return 1;
+}
+
+void job_pool_cleanup(void) {
+    if (num_workers == 0) return;
+    
+    stop_workers(num_workers);
+    
+    // Completions may submit follow-up jobs; those now run inline
+    job_pool_dispatch(0);
+    close(done_fd);
+    done_fd = -1;
+}
+
+int job_pool_get_fd(void) {
+    return done_fd;
+}
+
+int job_submit(JobFunc run, JobFunc done, void *arg, const void *owner) {
+    int i, first;
+    
+    if (num_workers == 0) {
+        run(arg);
+        if (done) done(arg);
+        return 1;
+    }
+    
+    Job *job = malloc(sizeof(Job));
+    if (!job) return 0;
+    job->run = run;
+    job->done = done;
+    job->arg = arg;
+    job->owner = owner;
+    
+    // Counted before a worker can finish it, so job_pool_drain() never sees a gap
+    pthread_mutex_lock(&pool_lock);
+    unfinished++;
+    pthread_mutex_unlock(&pool_lock);
+    
+    first = self >= 0 ? self : next_worker++ % num_workers;
+    for (i = 0; i < num_workers; i++) {
+        if (push(&workers[(first + i) % num_workers], job)) break;
+    }
+    if (i == num_workers) {
+        pthread_mutex_lock(&pool_lock);
+        unfinished--;
+        pthread_mutex_unlock(&pool_lock);
+        free(job);
+        return 0;
+    }
+    
+    pthread_mutex_lock(&pool_lock);
+    queued++;
+    pthread_cond_signal(&work_cond);
+    pthread_mutex_unlock(&pool_lock);
+    return 1;
+}
+
+int job_pool_dispatch(int budget) {
+    uint64_t count;
+    int n;
+    
+    if (done_fd >= 0 && read(done_fd, &count, sizeof(count)) < 0) {
+        // Nothing signalled: woken by a backlog or pending()
+    }
+    for (n = 0; budget == 0 || n < budget; n++) {
+        pthread_mutex_lock(&pool_lock);
+        Job *job = done_head;
+        if (job) {
+            done_head = job->next;
+            if (!done_head) done_tail = NULL;
+        }
+        pthread_mutex_unlock(&pool_lock);
+        if (!job) break;
+        
+        if (job->done) job->done(job->arg);
+        free(job);
+    }
+    return n;
+}
+
+int job_pool_pending(void) {
+    int pending;
+    
+    pthread_mutex_lock(&pool_lock);
+    pending = done_head != NULL;
+    pthread_mutex_unlock(&pool_lock);
+    return pending;
+}
+
+static int owner_running(const void *owner) {
+    int i;
+    
+    for (i = 0; i < num_workers; i++) {
+        if (__atomic_load_n(&workers[i].running, __ATOMIC_ACQUIRE) == owner) return 1;
+    }
+    return 0;
+}
+
+/* Move owner's queued jobs out of every ring; returns them in queue order */
+static Job* unqueue(const void *owner) {
+    Job *list = NULL, **tail = &list;
+    int i;
+    
+    for (i = 0; i < num_workers; i++) {
+        Worker *w = &workers[i];
+        unsigned int pos, keep;
+        pthread_mutex_lock(&w->lock);
+        for (pos = keep = w->head; pos != w->tail; pos++) {
+            Job *job = w->ring[pos % JOB_QUEUE_SIZE];
+            if (job->owner == owner) {
+                job->next = NULL;
+                *tail = job;
+                tail = &job->next;
+            } else {
+                w->ring[keep++ % JOB_QUEUE_SIZE] = job;
+            }
+        }
+        w->tail = keep;
+        pthread_mutex_unlock(&w->lock);
+    }
+    return list;
+}
+
+void job_pool_flush(const void *owner) {
+    for (;;) {
+        Job *list = unqueue(owner), *job, **tail = &list;
+        int ran = 0;
+        
+        // Queued: run them here rather than wait behind other owners' work
+        for (job = list; job; job = job->next) {
+            pthread_mutex_lock(&pool_lock);
+            queued--;
+            unfinished--;
+            pthread_mutex_unlock(&pool_lock);
+            job->run(job->arg);
+            tail = &job->next;
+            ran++;
+        }
+        
+        // Running: wait, then take their completions along with the rest of owner's
+        pthread_mutex_lock(&pool_lock);
+        while (owner_running(owner)) {
+            pthread_cond_wait(&idle_cond, &pool_lock);
+        }
+        Job **link = &done_head;
+        done_tail = NULL;
+        while (*link) {
+            job = *link;
+            if (job->owner == owner) {
+                *link = job->next;
+                job->next = NULL;
+                *tail = job;
+                tail = &job->next;
+                ran++;
+            } else {
+                done_tail = job;
+                link = &job->next;
+            }
+        }
+        pthread_mutex_unlock(&pool_lock);
+        if (!ran) break;
+        
+        // Completions may queue more work for owner; go round until none is left
+        while (list) {
+            job = list;
+            list = job->next;
+            if (job->done) job->done(job->arg);
+            free(job);
+        }
+    }
+}
+
+void job_pool_drain(void) {
+    do {
+        pthread_mutex_lock(&pool_lock);
+        while (unfinished > 0) {
+            pthread_cond_wait(&idle_cond, &pool_lock);
+        }
+        pthread_mutex_unlock(&pool_lock);
+    } while (job_pool_dispatch(0) > 0);  // Completions may have queued more
+}
@@ -0,0 +1,47 @@
+/*
+ * VaultWM Job Pool
+ * A few worker threads for blocking work (file and /proc reads) that must
+ * not stall the X thread. Each worker owns a queue and steals from the
+ * others when it runs dry; finished jobs come back through an eventfd and
+ * their completions run on the event thread
+ */
+
+#ifndef VAULTWM_JOB_POOL_H
+#define VAULTWM_JOB_POOL_H
+
+#define JOB_POOL_MAX_WORKERS 4
+#define JOB_QUEUE_SIZE 64            // Per worker
+
+/* run: on a worker, must not touch WM state. done: on the event thread, owns arg */
+typedef void (*JobFunc)(void *arg);
+
+/* Start the worker threads (0 = one per CPU, at most JOB_POOL_MAX_WORKERS);
+ * returns 1 on success. Without a pool, jobs run inline as they are submitted */
+int job_pool_init(int workers);
+
+/* Stop the workers once the queued jobs are done, then run all completions */
+void job_pool_cleanup(void);
+
+/* Wait for every queued and running job and run all completions; the workers
+ * and the completion fd stay up */
+void job_pool_drain(void);
+
+/* Completion descriptor for the event loop, -1 without a pool */
+int job_pool_get_fd(void);
+
+/* Queue run(arg), followed by done(arg) on the event thread (done may be NULL).
+ * owner tags the job for job_pool_flush(). From a worker, the job goes on that
+ * worker's own queue. Returns 0 if every queue is full */
+int job_submit(JobFunc run, JobFunc done, void *arg, const void *owner);
+
+/* Run up to budget completions (0 = all); returns the number run */
+int job_pool_dispatch(int budget);
+
+/* Non-zero if completions are waiting */
+int job_pool_pending(void);
+
+/* Finish every job of owner now, queued ones on the calling thread, and run their
+ * completions; e.g. before unloading the code they point into */
+void job_pool_flush(const void *owner);
+
+#endif /* VAULTWM_JOB_POOL_H */
@@ -0,0 +1,382 @@
+/*
+ * VaultWM BSP Tree Implementation
+ */
+
+#include <string.h>
+#include "bsp.h"
+
+#define BSP_PHI_RATIO 0.618033988749  // 1 / golden ratio
+
+static unsigned int hash_slot(Window win) {
+    return (unsigned int)((unsigned long)win * 2654435761u) & (BSP_HASH_SIZE - 1);
+}
+
+static int hash_find(BSPTree *tree, Window win) {
+    unsigned int slot = hash_slot(win);
+    
+    while (tree->hash[slot] != BSP_NONE) {
+        if (tree->nodes[tree->hash[slot]].win == win) {
+            return tree->hash[slot];
+        }
+        slot = (slot + 1) & (BSP_HASH_SIZE - 1);
+    }
+    return BSP_NONE;
+}
+
+static void hash_add(BSPTree *tree, int idx) {
+    unsigned int slot = hash_slot(tree->nodes[idx].win);
+    
+    while (tree->hash[slot] != BSP_NONE) {
+        slot = (slot + 1) & (BSP_HASH_SIZE - 1);
+    }
+    tree->hash[slot] = (short)idx;
+}
+
+// Linear probing delete: shift later entries of the run back so lookups never stop early
+static void hash_del(BSPTree *tree, Window win) {
+    unsigned int slot = hash_slot(win);
+    unsigned int next, home;
+    
+    while (tree->hash[slot] != BSP_NONE && tree->nodes[tree->hash[slot]].win != win) {
+        slot = (slot + 1) & (BSP_HASH_SIZE - 1);
+    }
+    if (tree->hash[slot] == BSP_NONE) {
+        return;
+    }
+    
+    next = slot;
+    for (;;) {
+        tree->hash[slot] = BSP_NONE;
+        do {
+            next = (next + 1) & (BSP_HASH_SIZE - 1);
+            if (tree->hash[next] == BSP_NONE) {
+                return;
+            }
+            home = hash_slot(tree->nodes[tree->hash[next]].win);
+        } while (((next - home) & (BSP_HASH_SIZE - 1)) < ((next - slot) & (BSP_HASH_SIZE - 1)));
+        tree->hash[slot] = tree->hash[next];
+        slot = next;
+    }
+}
+
+void bsp_init(BSPTree *tree) {
+    int i;
+    
+    memset(tree, 0, sizeof(BSPTree));
+    tree->root = BSP_NONE;
+    tree->tail = BSP_NONE;
+    for (i = 0; i < BSP_MAX_NODES; i++) {
+        tree->nodes[i].parent = (i + 1 < BSP_MAX_NODES) ? i + 1 : BSP_NONE;
+    }
+    for (i = 0; i < BSP_HASH_SIZE; i++) {
+        tree->hash[i] = BSP_NONE;
+    }
+    tree->free_head = 0;
+    tree->force = 1;
+}
+
+static int node_alloc(BSPTree *tree) {
+    int idx = tree->free_head;
+    BSPNode *n;
+    
+    if (idx == BSP_NONE) {
+        return BSP_NONE;
+    }
+    n = &tree->nodes[idx];
+    tree->free_head = n->parent;
+    memset(n, 0, sizeof(BSPNode));
+    n->parent = n->first = n->second = BSP_NONE;
+    n->in_use = 1;
+    n->dirty = 1;
+    return idx;
+}
+
+static void node_free(BSPTree *tree, int idx) {
+    tree->nodes[idx].in_use = 0;
+    tree->nodes[idx].parent = tree->free_head;
+    tree->free_head = idx;
+}
+
+// Flag idx for recompute and make it reachable from the root
+static void mark_dirty(BSPTree *tree, int idx) {
+    int p = tree->nodes[idx].parent;
+    
+    tree->nodes[idx].dirty = 1;
+    while (p != BSP_NONE && !tree->nodes[p].child_dirty) {
+        tree->nodes[p].child_dirty = 1;
+        p = tree->nodes[p].parent;
+    }
+}
+
+// Put child where old was under old's parent (or at the root)
+static void replace_child(BSPTree *tree, int old, int child) {
+    int p = tree->nodes[old].parent;
+    
+    tree->nodes[child].parent = p;
+    if (p == BSP_NONE) {
+        tree->root = child;
+    } else if (tree->nodes[p].first == old) {
+        tree->nodes[p].first = child;
+    } else {
+        tree->nodes[p].second = child;
+    }
+}
+
+int bsp_contains(BSPTree *tree, Window win) {
+    return hash_find(tree, win) != BSP_NONE;
+}
+
+int bsp_insert(BSPTree *tree, Window win) {
+    int leaf, split, tail;
+    
+    if (win == None || bsp_contains(tree, win)) {
+        return 0;
+    }
+    
+    leaf = node_alloc(tree);
+    if (leaf == BSP_NONE) {
+        return 0;
+    }
+    tree->nodes[leaf].win = win;
+    
+    if (tree->root == BSP_NONE) {
+        tree->root = leaf;
+    } else {
+        split = node_alloc(tree);
+        if (split == BSP_NONE) {
+            node_free(tree, leaf);
+            return 0;
+        }
+        
+        tail = tree->tail;
+        
+        // The split inherits the tail's rect so only its two children change
+        tree->nodes[split].x = tree->nodes[tail].x;
+        tree->nodes[split].y = tree->nodes[tail].y;
+        tree->nodes[split].width = tree->nodes[tail].width;
+        tree->nodes[split].height = tree->nodes[tail].height;
+        replace_child(tree, tail, split);
+        tree->nodes[split].first = tail;
+        tree->nodes[split].second = leaf;
+        tree->nodes[tail].parent = split;
+        tree->nodes[leaf].parent = split;
+        mark_dirty(tree, split);
+    }
+    
+    hash_add(tree, leaf);
+    tree->tail = leaf;
+    tree->num_leaves++;
+    return 1;
+}
+
+int bsp_remove(BSPTree *tree, Window win) {
+    int leaf = hash_find(tree, win);
+    int parent, sibling;
+    
+    if (leaf == BSP_NONE) {
+        return 0;
+    }
+    
+    hash_del(tree, win);
+    parent = tree->nodes[leaf].parent;
+    if (parent == BSP_NONE) {
+        tree->root = BSP_NONE;
+    } else {
+        sibling = (tree->nodes[parent].first == leaf) ?
+            tree->nodes[parent].second : tree->nodes[parent].first;
+        replace_child(tree, parent, sibling);
+        node_free(tree, parent);
+        mark_dirty(tree, sibling);
+    }
+    node_free(tree, leaf);
+    tree->num_leaves--;
+    
+    // Fall back to the end of the second-child chain, where inserts go
+    if (tree->tail == leaf) {
+        tree->tail = tree->root;
+        while (tree->tail != BSP_NONE && tree->nodes[tree->tail].second != BSP_NONE) {
+            tree->tail = tree->nodes[tree->tail].second;
+        }
+    }
+    return 1;
+}
+
+static double default_ratio(int mode) {
+    return (mode == LAYOUT_FIBONACCI) ? BSP_PHI_RATIO : 0.5;
+}
+
+int bsp_adjust_ratio(BSPTree *tree, Window win, double delta) {
+    int leaf = hash_find(tree, win);
+    int parent;
+    double ratio, share;
+    
+    if (leaf == BSP_NONE || tree->nodes[leaf].parent == BSP_NONE) {
+        return 0;
+    }
+    
+    parent = tree->nodes[leaf].parent;
+    ratio = tree->nodes[parent].ratio > 0 ? tree->nodes[parent].ratio : default_ratio(tree->mode);
+    share = (tree->nodes[parent].first == leaf) ? ratio : 1.0 - ratio;
+    share += delta;
+    if (share < BSP_RATIO_MIN) share = BSP_RATIO_MIN;
+    if (share > BSP_RATIO_MAX) share = BSP_RATIO_MAX;
+    tree->nodes[parent].ratio = (tree->nodes[parent].first == leaf) ? share : 1.0 - share;
+    mark_dirty(tree, parent);
+    return 1;
+}
+
+int bsp_swap(BSPTree *tree, Window a, Window b) {
+    int la = hash_find(tree, a);
+    int lb = hash_find(tree, b);
+    
+    if (la == BSP_NONE || lb == BSP_NONE || la == lb) {
+        return 0;
+    }
+    
+    // The map is keyed by window, so both entries move with their window
+    hash_del(tree, a);
+    hash_del(tree, b);
+    tree->nodes[la].win = b;
+    tree->nodes[lb].win = a;
+    hash_add(tree, la);
+    hash_add(tree, lb);
+    mark_dirty(tree, la);
+    mark_dirty(tree, lb);
+    return 1;
+}
+
+void bsp_sync(BSPTree *tree, const LayoutClient *clients, int num_clients) {
+    Window stale[BSP_MAX_NODES];
+    int pending[BSP_MAX_NODES];
+    int i, idx, seen = 0, num_stale = 0, top = 0;
+    
+    tree->generation++;
+    for (i = 0; i < num_clients; i++) {
+        if (clients[i].is_floating) continue;
+        
+        idx = hash_find(tree, clients[i].win);
+        if (idx == BSP_NONE && bsp_insert(tree, clients[i].win)) {
+            idx = hash_find(tree, clients[i].win);
+        }
+        if (idx != BSP_NONE && tree->nodes[idx].seen != tree->generation) {
+            tree->nodes[idx].seen = tree->generation;
+            seen++;
+        }
+    }
+    
+    // Every leaf listed: nothing went missing (the usual case, and always after
+    // callers bsp_remove() what they unmanage), so no search
+    if (seen == tree->num_leaves) {
+        return;
+    }
+    
+    // A window was floated or hidden: find the leaves not listed in the tree itself
+    if (tree->root != BSP_NONE) {
+        pending[top++] = tree->root;
+    }
+    while (top > 0) {
+        BSPNode *n = &tree->nodes[pending[--top]];
+        if (n->first != BSP_NONE) {
+            pending[top++] = n->first;
+            pending[top++] = n->second;
+        } else if (n->seen != tree->generation) {
+            stale[num_stale++] = n->win;
+        }
+    }
+    for (i = 0; i < num_stale; i++) {
+        bsp_remove(tree, stale[i]);
+    }
+}
+
+// Walk only nodes that are dirty, lead to dirty nodes, or whose rect moved
+static int bsp_update(BSPTree *tree, int idx, int x, int y, int width, int height, int depth) {
+    BSPNode *n = &tree->nodes[idx];
+    int fx, fy, fw, fh, sx, sy, sw, sh;
+    int vertical, reverse, count;
+    double ratio;
+    int moved = n->x != x || n->y != y || n->width != width || n->height != height;
+    
+    if (!tree->force && !n->dirty && !n->child_dirty && !moved) {
+        return 0;
+    }
+    
+    // Nodes we only pass through on the way to a dirty descendant are not recomputed
+    count = (tree->force || n->dirty || moved) ? 1 : 0;
+    
+    n->x = x;
+    n->y = y;
+    n->width = width;
+    n->height = height;
+    n->dirty = 0;
+    n->child_dirty = 0;
+    if (n->first == BSP_NONE) {
+        return count;
+    }
+    
+    // Dwindle follows the longer side; fibonacci alternates and turns a spiral
+    if (tree->mode == LAYOUT_FIBONACCI) {
+        vertical = (depth % 2) == 0;
+        reverse = (depth % 4) >= 2;
+    } else {
+        vertical = width >= height;
+        reverse = 0;
+    }
+    ratio = n->ratio > 0 ? n->ratio : default_ratio(tree->mode);
+    
+    if (vertical) {
+        fw = (int)(width * ratio);
+        sw = width - fw;
+        fh = sh = height;
+        fy = sy = y;
+        fx = reverse ? x + sw : x;
+        sx = reverse ? x : x + fw;
+    } else {
+        fh = (int)(height * ratio);
+        sh = height - fh;
+        fw = sw = width;
+        fx = sx = x;
+        fy = reverse ? y + sh : y;
+        sy = reverse ? y : y + fh;
+    }
+    
+    count += bsp_update(tree, n->first, fx, fy, fw, fh, depth + 1);
+    count += bsp_update(tree, n->second, sx, sy, sw, sh, depth + 1);
+    return count;
+}
+
+int bsp_layout(BSPTree *tree, int mode, int x, int y, int width, int height, int gap) {
+    int count;
+    
+    if (mode != tree->mode || x != tree->x || y != tree->y ||
+        width != tree->width || height != tree->height || gap != tree->gap) {
+        tree->force = 1;
+    }
+    tree->mode = mode;
+    tree->x = x;
+    tree->y = y;
+    tree->width = width;
+    tree->height = height;
+    tree->gap = gap;
+    
+    if (tree->root == BSP_NONE) {
+        return 0;
+    }
+    count = bsp_update(tree, tree->root, x, y, width, height, 0);
+    tree->force = 0;
+    return count;
+}
+
+int bsp_geometry(BSPTree *tree, Window win, LayoutClient *out) {
+    int idx = hash_find(tree, win);
+    BSPNode *n;
+    
+    if (idx == BSP_NONE) {
+        return 0;
+    }
+    n = &tree->nodes[idx];
+    out->x = n->x + tree->gap;
+    out->y = n->y + tree->gap;
+    out->width = n->width - (tree->gap * 2);
+    out->height = n->height - (tree->gap * 2);
+    return 1;
+}
@@ -0,0 +1,73 @@
+/*
+ * VaultWM BSP Tree
+ * Persistent binary space partition per workspace for the dwindle and
+ * fibonacci layouts; edits touch O(depth) nodes and relayout only walks
+ * the subtrees that changed
+ */
+
+#ifndef VAULTWM_BSP_H
+#define VAULTWM_BSP_H
+
+#include <X11/Xlib.h>
+#include "layouts.h"
+
+#define BSP_MAX_NODES 512       // Two per client: leaf plus the split above it
+#define BSP_HASH_SIZE 1024      // Window -> leaf index, power of two
+#define BSP_NONE -1
+#define BSP_RATIO_MIN 0.1
+#define BSP_RATIO_MAX 0.9
+
+typedef struct {
+    int parent, first, second;  // BSP_NONE when absent; leaves have no children
+    Window win;                 // Leaves only
+    double ratio;               // Share of the first child, 0 = layout default
+    int in_use;
+    int dirty;                  // Recompute this subtree even if its rect is unchanged
+    int child_dirty;            // Some descendant is dirty
+    int x, y, width, height;    // Last computed rect, before gaps
+    unsigned int seen;          // Sync generation
+} BSPNode;
+
+typedef struct {
+    BSPNode nodes[BSP_MAX_NODES];
+    short hash[BSP_HASH_SIZE];
+    int root;
+    int tail;                   // Newest leaf, split by the next insert
+    int free_head;              // Free nodes chained through parent
+    int num_leaves;
+    int mode;                   // Layout used for the last pass
+    int x, y, width, height, gap;
+    int force;                  // Area or mode changed: walk everything once
+    unsigned int generation;
+} BSPTree;
+
+/* Initialize an empty tree */
+void bsp_init(BSPTree *tree);
+
+/* Split the newest leaf to make room for win; returns 1 on success */
+int bsp_insert(BSPTree *tree, Window win);
+
+/* Remove win; its sibling takes over the parent's space. Returns 1 if found */
+int bsp_remove(BSPTree *tree, Window win);
+
+/* Non-zero if win is in the tree */
+int bsp_contains(BSPTree *tree, Window win);
+
+/* Grow (delta > 0) or shrink win's share of its split; kept across relayouts */
+int bsp_adjust_ratio(BSPTree *tree, Window win, double delta);
+
+/* Exchange the leaves of two windows; returns 1 if both are in the tree */
+int bsp_swap(BSPTree *tree, Window a, Window b);
+
+/* Insert tiled clients that are missing and drop leaves no longer listed. The
+ * tree is only searched for such leaves when some leaf was not listed, so
+ * bsp_remove() windows as they go away */
+void bsp_sync(BSPTree *tree, const LayoutClient *clients, int num_clients);
+
+/* Recompute geometry for LAYOUT_DWINDLE or LAYOUT_FIBONACCI; returns nodes recomputed */
+int bsp_layout(BSPTree *tree, int mode, int x, int y, int width, int height, int gap);
+
+/* Copy win's rect (with gaps applied) into out; returns 1 if found */
+int bsp_geometry(BSPTree *tree, Window win, LayoutClient *out);
+
+#endif /* VAULTWM_BSP_H */
@@ -0,0 +1,169 @@
+/*
+ * VaultWM Layout Engine Implementation
+ */
+
+#include <string.h>
+#include <X11/Xutil.h>
+#include "layout-engine.h"
+#include "../plugins/layout-plugins.h"
+
+#define LAYOUT_MAX_CLIENTS 256
+
+typedef void (*LayoutFunc)(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap);
+
+static const LayoutFunc layout_funcs[LAYOUT_COUNT] = {
+    [LAYOUT_TILING] = layout_tiling,
+    [LAYOUT_FLOATING] = NULL,
+    [LAYOUT_MONOCLE] = layout_monocle,
+    [LAYOUT_GRID] = layout_grid,
+    [LAYOUT_FIBONACCI] = layout_fibonacci,
+    [LAYOUT_DWINDLE] = layout_dwindle,
+};
+
+void layout_arrange(int mode, BSPTree *tree, LayoutClient *clients, int num_clients,
+                    int x, int y, int width, int height, int gap) {
+    LayoutClient tiled[LAYOUT_MAX_CLIENTS];
+    int index[LAYOUT_MAX_CLIENTS];
+    int i, n = 0;
+    
+    if (mode < 0 || mode >= LAYOUT_COUNT + layout_plugin_count() ||
+        (mode < LAYOUT_COUNT && !layout_funcs[mode])) {
+        return;  // Floating: windows manage their own position
+    }
+    
+    // Layouts place clients by position, so floating windows must not leave holes
+    for (i = 0; i < num_clients && n < LAYOUT_MAX_CLIENTS; i++) {
+        if (!clients[i].is_floating) {
+            tiled[n] = clients[i];
+            index[n++] = i;
+        }
+    }
+    
+    if (mode >= LAYOUT_COUNT) {
+        // Plugin layouts get the whole batch in one call; one that cannot run now gets tiling
+        if (layout_plugin_arrange(mode - LAYOUT_COUNT, tiled, n, x, y, width, height, gap) < 0) {
+            layout_funcs[LAYOUT_TILING](tiled, n, x, y, width, height, gap);
+        }
+    } else if (tree && (mode == LAYOUT_DWINDLE || mode == LAYOUT_FIBONACCI)) {
+        // Only subtrees touched since the last pass are recomputed
+        bsp_sync(tree, tiled, n);
+        bsp_layout(tree, mode, x, y, width, height, gap);
+        for (i = 0; i < n; i++) {
+            bsp_geometry(tree, tiled[i].win, &tiled[i]);
+        }
+    } else {
+        layout_funcs[mode](tiled, n, x, y, width, height, gap);
+    }
+    
+    // Terminals and the like only take whole cells; settle that here, not in a second configure
+    layout_constrain(tiled, n);
+    
+    for (i = 0; i < n; i++) {
+        clients[index[i]] = tiled[i];
+    }
+}
+
+void layout_constrain(LayoutClient *clients, int num_clients) {
+    int i;
+    
+    for (i = 0; i < num_clients; i++) {
+        const SizeHints *h = &clients[i].hints;
+        long w, ht;
+        
+        if (clients[i].is_floating) continue;
+        
+        // Aspect and increments apply to the part above the base size
+        w = clients[i].width - h->base_width;
+        ht = clients[i].height - h->base_height;
+        if (h->max_aspect_x > 0 && h->max_aspect_y > 0 && w * h->max_aspect_y > ht * h->max_aspect_x) {
+            w = ht * h->max_aspect_x / h->max_aspect_y;
+        } else if (h->min_aspect_x > 0 && h->min_aspect_y > 0 && w * h->min_aspect_y < ht * h->min_aspect_x) {
+            ht = w * h->min_aspect_y / h->min_aspect_x;
+        }
+        if (h->inc_width > 1 && w > 0) w -= w % h->inc_width;
+        if (h->inc_height > 1 && ht > 0) ht -= ht % h->inc_height;
+        w += h->base_width;
+        ht += h->base_height;
+        
+        if (w < h->min_width) w = h->min_width;
+        if (ht < h->min_height) ht = h->min_height;
+        if (h->max_width > 0 && w > h->max_width) w = h->max_width;
+        if (h->max_height > 0 && ht > h->max_height) ht = h->max_height;
+        
+        clients[i].width = (int)w;
+        clients[i].height = (int)ht;
+    }
+}
+
+int layout_read_size_hints(Display *dpy, Window win, SizeHints *hints) {
+    XSizeHints size;
+    long supplied = 0;
+    
+    memset(hints, 0, sizeof(SizeHints));
+    if (!XGetWMNormalHints(dpy, win, &size, &supplied)) {
+        return 0;
+    }
+    
+    if (size.flags & PBaseSize) {
+        hints->base_width = size.base_width;
+        hints->base_height = size.base_height;
+    } else if (size.flags & PMinSize) {
+        hints->base_width = size.min_width;
+        hints->base_height = size.min_height;
+    }
+    if (size.flags & PMinSize) {
+        hints->min_width = size.min_width;
+        hints->min_height = size.min_height;
+    } else if (size.flags & PBaseSize) {
+        hints->min_width = size.base_width;
+        hints->min_height = size.base_height;
+    }
+    if (size.flags & PMaxSize) {
+        hints->max_width = size.max_width;
+        hints->max_height = size.max_height;
+    }
+    if (size.flags & PResizeInc) {
+        hints->inc_width = size.width_inc;
+        hints->inc_height = size.height_inc;
+    }
+    if (size.flags & PAspect) {
+        hints->min_aspect_x = size.min_aspect.x;
+        hints->min_aspect_y = size.min_aspect.y;
+        hints->max_aspect_x = size.max_aspect.x;
+        hints->max_aspect_y = size.max_aspect.y;
+    }
+    return (size.flags & (PBaseSize | PMinSize | PMaxSize | PResizeInc | PAspect)) != 0;
+}
+
+int layout_rect_changed(const LayoutClient *a, const LayoutClient *b) {
+    return a->x != b->x || a->y != b->y || a->width != b->width || a->height != b->height;
+}
+
+int layout_commit(Display *dpy, const LayoutClient *target, LayoutClient *applied, int num_clients) {
+    XWindowChanges wc;
+    unsigned int mask;
+    int i, reconfigured = 0;
+    
+    for (i = 0; i < num_clients; i++) {
+        const LayoutClient *t = &target[i];
+        LayoutClient *a = &applied[i];
+        
+        if (t->win == None || !layout_rect_changed(t, a)) {
+            continue;
+        }
+        
+        // Only the fields that moved go on the wire
+        memset(&wc, 0, sizeof(wc));
+        mask = 0;
+        if (t->x != a->x) { wc.x = t->x; mask |= CWX; }
+        if (t->y != a->y) { wc.y = t->y; mask |= CWY; }
+        if (t->width != a->width) { wc.width = t->width > 0 ? t->width : 1; mask |= CWWidth; }
+        if (t->height != a->height) { wc.height = t->height > 0 ? t->height : 1; mask |= CWHeight; }
+        
+        XConfigureWindow(dpy, t->win, mask, &wc);
+        *a = *t;
+        reconfigured++;
+    }
+    
+    return reconfigured;
+}
@@ -0,0 +1,35 @@
+/*
+ * VaultWM Layout Engine
+ * Runs any LAYOUT_* mode into a geometry buffer and reconfigures only
+ * the windows whose rectangle changed since the last commit
+ */
+
+#ifndef VAULTWM_LAYOUT_ENGINE_H
+#define VAULTWM_LAYOUT_ENGINE_H
+
+#include <X11/Xlib.h>
+#include "layouts.h"
+#include "bsp.h"
+
+/* Compute target geometry for the tiled clients; floating clients keep theirs.
+ * Results are passed through layout_constrain() before they are returned.
+ * Dwindle and fibonacci use the workspace's persistent tree when one is given;
+ * modes from LAYOUT_COUNT up select loaded layout plugins. */
+void layout_arrange(int mode, BSPTree *tree, LayoutClient *clients, int num_clients,
+                    int x, int y, int width, int height, int gap);
+
+/* Snap each tiled client's size to its hints (aspect, increments, min/max) in one
+ * pass over the buffer, keeping the top-left corner. Floating clients are skipped. */
+void layout_constrain(LayoutClient *clients, int num_clients);
+
+/* Read win's WM_NORMAL_HINTS into hints; returns 1 if it sets any, 0 (hints zeroed) if not */
+int layout_read_size_hints(Display *dpy, Window win, SizeHints *hints);
+
+/* Non-zero if the two rectangles differ */
+int layout_rect_changed(const LayoutClient *a, const LayoutClient *b);
+
+/* Send configure requests for clients whose target differs from applied, then
+ * record the target as applied. Returns the number of windows reconfigured. */
+int layout_commit(Display *dpy, const LayoutClient *target, LayoutClient *applied, int num_clients);
+
+#endif /* VAULTWM_LAYOUT_ENGINE_H */
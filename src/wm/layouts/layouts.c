@@ -6,6 +6,35 @@
 #include <stdlib.h>
 #include "layouts.h"
 
+/* Tiling layout - equal-height rows */
+void layout_tiling(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap) {
+    if (num_clients == 0) return;
+    
+    int row_height = (height - (gap * 2)) / num_clients;
+    int i;
+    for (i = 0; i < num_clients; i++) {
+        if (clients[i].is_floating) continue;
+        
+        clients[i].x = x + gap;
+        clients[i].y = y + gap + (i * row_height);
+        clients[i].width = width - (gap * 2);
+        clients[i].height = row_height - gap;
+    }
+}
+
+/* Monocle layout - all windows share the full area */
+void layout_monocle(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap) {
+    int i;
+    for (i = 0; i < num_clients; i++) {
+        if (clients[i].is_floating) continue;
+        
+        clients[i].x = x + gap;
+        clients[i].y = y + gap;
+        clients[i].width = width - (gap * 2);
+        clients[i].height = height - (gap * 2);
+    }
+}
+
 /* Grid layout - divide screen into equal cells */
 void layout_grid(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap) {
     if (num_clients == 0) return;
@@ -29,46 +58,46 @@ void layout_grid(LayoutClient *clients, int num_clients, int x, int y, int width
     }
 }
 
-/* Fibonacci layout - golden ratio spiral */
+/* Fibonacci layout - golden ratio spiral.
+ * Each window takes width/phi of what is left; iterative so large client
+ * counts cannot exhaust the stack. */
 void layout_fibonacci(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap) {
-    if (num_clients == 0) return;
-    if (num_clients == 1) {
-        if (!clients[0].is_floating) {
-            clients[0].x = x + gap;
-            clients[0].y = y + gap;
-            clients[0].width = width - (gap * 2);
-            clients[0].height = height - (gap * 2);
-        }
-        return;
-    }
-    
     // Golden ratio
     double phi = 1.618033988749;
-    int main_width = (int)(width / phi);
-    int main_height = (int)(height / phi);
-    
-    // Main window (largest)
-    if (!clients[0].is_floating) {
-        clients[0].x = x + gap;
-        clients[0].y = y + gap;
-        clients[0].width = main_width - gap;
-        clients[0].height = height - (gap * 2);
-    }
-    
-    // Remaining windows in spiral
-    int remaining_x = x + main_width;
-    int remaining_y = y;
-    int remaining_width = width - main_width;
-    int remaining_height = height;
+    int i;
     
-    if (num_clients > 1) {
-        layout_fibonacci(&clients[1], num_clients - 1, remaining_x, remaining_y, 
-                       remaining_width, remaining_height, gap);
+    for (i = 0; i < num_clients; i++) {
+        LayoutClient *c = &clients[i];
+        
+        if (i == num_clients - 1) {
+            // Last window fills the remainder
+            if (!c->is_floating) {
+                c->x = x + gap;
+                c->y = y + gap;
+                c->width = width - (gap * 2);
+                c->height = height - (gap * 2);
+            }
+            break;
+        }
+        
+        int main_width = (int)(width / phi);
+        
+        if (!c->is_floating) {
+            c->x = x + gap;
+            c->y = y + gap;
+            c->width = main_width - gap;
+            c->height = height - (gap * 2);
+        }
+        
+        // Remaining windows in spiral
+        x += main_width;
+        width -= main_width;
     }
 }
 
-/* Dwindle layout - binary tree split */
-void layout_dwindle(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap) {
+/* Dwindle split; direction comes from depth so the result never depends on call history */
+static void dwindle_split(LayoutClient *clients, int num_clients, int x, int y, int width, int height,
+                          int gap, int depth) {
     if (num_clients == 0) return;
     if (num_clients == 1) {
         if (!clients[0].is_floating) {
@@ -80,26 +109,26 @@ void layout_dwindle(LayoutClient *clients, int num_clients, int x, int y, int wi
         return;
     }
     
-    // Split direction alternates
-    static int split_horizontal = 1;
-    split_horizontal = !split_horizontal;
-    
     int mid = num_clients / 2;
     
-    if (split_horizontal) {
+    if (depth % 2 == 1) {
         // Horizontal split
         int top_height = height / 2;
         int bottom_height = height - top_height;
         
-        layout_dwindle(clients, mid, x, y, width, top_height, gap);
-        layout_dwindle(&clients[mid], num_clients - mid, x, y + top_height, width, bottom_height, gap);
+        dwindle_split(clients, mid, x, y, width, top_height, gap, depth + 1);
+        dwindle_split(&clients[mid], num_clients - mid, x, y + top_height, width, bottom_height, gap, depth + 1);
     } else {
         // Vertical split
         int left_width = width / 2;
         int right_width = width - left_width;
         
-        layout_dwindle(clients, mid, x, y, left_width, height, gap);
-        layout_dwindle(&clients[mid], num_clients - mid, x + left_width, y, right_width, height, gap);
+        dwindle_split(clients, mid, x, y, left_width, height, gap, depth + 1);
+        dwindle_split(&clients[mid], num_clients - mid, x + left_width, y, right_width, height, gap, depth + 1);
     }
 }
 
+/* Dwindle layout - binary tree split */
+void layout_dwindle(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap) {
+    dwindle_split(clients, num_clients, x, y, width, height, gap, 0);
+}
@@ -14,13 +14,31 @@
 #define LAYOUT_GRID 3
 #define LAYOUT_FIBONACCI 4
 #define LAYOUT_DWINDLE 5
+#define LAYOUT_COUNT 6
+
+/* WM_NORMAL_HINTS, resolved so base and min fall back on each other as in ICCCM */
+typedef struct {
+    int min_width, min_height;   // 0 = none
+    int max_width, max_height;
+    int base_width, base_height;
+    int inc_width, inc_height;   // Resize steps, e.g. one terminal cell
+    int min_aspect_x, min_aspect_y;  // Width:height bounds, 0 = none
+    int max_aspect_x, max_aspect_y;
+} SizeHints;
 
 typedef struct {
     Window win;
     int x, y, width, height;
     int is_floating;
+    SizeHints hints;             // Tiled sizes are snapped to these after every layout
 } LayoutClient;
 
+/* Tiling layout - windows stacked top to bottom with equal heights */
+void layout_tiling(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap);
+
+/* Monocle layout - every window fills the area, focus decides which is on top */
+void layout_monocle(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap);
+
 /* Grid layout - arrange windows in a grid */
 void layout_grid(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap);
 
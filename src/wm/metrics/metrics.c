@@ -0,0 +1,370 @@
+/*
+ * VaultWM Metrics Implementation
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <X11/X.h>
+#include "metrics.h"
+
+#define METRICS_REQUEST_MAX 1024
+#define METRICS_RENDER_MAX 16384
+
+typedef struct {
+    const char *name;
+    const char *help;
+    const char *type;
+} MetricInfo;
+
+static const MetricInfo metric_info[METRIC_COUNT] = {
+    [METRIC_LAYOUT_PASSES] = { "vaultwm_layout_passes_total", "Layout passes run", "counter" },
+    [METRIC_LAYOUT_RECONFIGURES] = { "vaultwm_layout_reconfigures_total", "Windows reconfigured by layout passes", "counter" },
+    [METRIC_ANIMATION_FRAMES] = { "vaultwm_animation_frames_total", "Animation frames committed", "counter" },
+    [METRIC_ANIMATION_DROPPED] = { "vaultwm_animation_dropped_frames_total", "Display refreshes missed while animating", "counter" },
+    [METRIC_ANIMATION_SKIPPED] = { "vaultwm_animation_skipped_total", "Layout transitions applied without animating", "counter" },
+    [METRIC_IPC_COMMANDS] = { "vaultwm_ipc_commands_total", "IPC commands executed", "counter" },
+    [METRIC_IPC_ERRORS] = { "vaultwm_ipc_errors_total", "IPC commands that failed", "counter" },
+    [METRIC_X_REQUESTS] = { "vaultwm_x_requests_total", "X requests issued", "counter" },
+    [METRIC_SCRAPES] = { "vaultwm_metrics_scrapes_total", "Metrics scrapes served", "counter" },
+    [METRIC_CLIENTS] = { "vaultwm_clients", "Managed client windows", "gauge" },
+    [METRIC_WORKSPACE] = { "vaultwm_workspace", "Current workspace number", "gauge" },
+    [METRIC_MONITORS] = { "vaultwm_monitors", "Connected monitors", "gauge" },
+    [METRIC_CPU_USAGE] = { "vaultwm_cpu_usage_percent", "System CPU usage sampled by the WM", "gauge" },
+    [METRIC_MEMORY_USAGE] = { "vaultwm_memory_usage_percent", "System memory usage sampled by the WM", "gauge" },
+};
+
+static const char *event_names[METRICS_MAX_EVENT_TYPES] = {
+    [KeyPress] = "KeyPress", [KeyRelease] = "KeyRelease",
+    [ButtonPress] = "ButtonPress", [ButtonRelease] = "ButtonRelease",
+    [MotionNotify] = "MotionNotify", [EnterNotify] = "EnterNotify",
+    [LeaveNotify] = "LeaveNotify", [FocusIn] = "FocusIn", [FocusOut] = "FocusOut",
+    [KeymapNotify] = "KeymapNotify", [Expose] = "Expose",
+    [GraphicsExpose] = "GraphicsExpose", [NoExpose] = "NoExpose",
+    [VisibilityNotify] = "VisibilityNotify", [CreateNotify] = "CreateNotify",
+    [DestroyNotify] = "DestroyNotify", [UnmapNotify] = "UnmapNotify",
+    [MapNotify] = "MapNotify", [MapRequest] = "MapRequest",
+    [ReparentNotify] = "ReparentNotify", [ConfigureNotify] = "ConfigureNotify",
+    [ConfigureRequest] = "ConfigureRequest", [GravityNotify] = "GravityNotify",
+    [ResizeRequest] = "ResizeRequest", [CirculateNotify] = "CirculateNotify",
+    [CirculateRequest] = "CirculateRequest", [PropertyNotify] = "PropertyNotify",
+    [SelectionClear] = "SelectionClear", [SelectionRequest] = "SelectionRequest",
+    [SelectionNotify] = "SelectionNotify", [ColormapNotify] = "ColormapNotify",
+    [ClientMessage] = "ClientMessage", [MappingNotify] = "MappingNotify",
+    [GenericEvent] = "GenericEvent",
+};
+
+typedef struct {
+    int fd;
+    char in[METRICS_REQUEST_MAX];
+    size_t in_len;
+    char *out;
+    size_t out_len;
+    size_t out_sent;
+} MetricsConnection;
+
+static double metric_values[METRIC_COUNT];
+static unsigned long event_counts[METRICS_MAX_EVENT_TYPES];
+static unsigned long event_other = 0;  // Extension events (XRandR etc.)
+static metrics_collect_t collector = NULL;
+
+static int metrics_epoll_fd = -1;
+static int metrics_listen_fd = -1;
+static char metrics_socket_file[METRICS_SOCKET_PATH_MAX];
+static MetricsConnection connections[METRICS_MAX_CONNECTIONS];
+
+void metrics_inc(MetricId id) {
+    if (id >= 0 && id < METRIC_COUNT) {
+        metric_values[id] += 1.0;
+    }
+}
+
+void metrics_add(MetricId id, double value) {
+    if (id >= 0 && id < METRIC_COUNT) {
+        metric_values[id] += value;
+    }
+}
+
+void metrics_set(MetricId id, double value) {
+    if (id >= 0 && id < METRIC_COUNT) {
+        metric_values[id] = value;
+    }
+}
+
+void metrics_count_event(int type) {
+    if (type >= 0 && type < METRICS_MAX_EVENT_TYPES && event_names[type]) {
+        event_counts[type]++;
+    } else {
+        event_other++;
+    }
+}
+
+void metrics_set_collector(metrics_collect_t collect) {
+    collector = collect;
+}
+
+// Append to buf at *pos; sets *pos past buf_size on overflow
+static void render_append(char *buf, size_t buf_size, size_t *pos, const char *fmt, ...) {
+    va_list ap;
+    int n;
+    
+    if (*pos >= buf_size) {
+        return;
+    }
+    
+    va_start(ap, fmt);
+    n = vsnprintf(buf + *pos, buf_size - *pos, fmt, ap);
+    va_end(ap);
+    
+    *pos = (n < 0) ? buf_size : *pos + (size_t)n;
+}
+
+size_t metrics_render(char *buf, size_t buf_size) {
+    size_t pos = 0;
+    int i;
+    
+    if (!buf || buf_size == 0) {
+        return 0;
+    }
+    
+    for (i = 0; i < METRIC_COUNT; i++) {
+        render_append(buf, buf_size, &pos, "# HELP %s %s\n# TYPE %s %s\n%s %.15g\n",
+            metric_info[i].name, metric_info[i].help,
+            metric_info[i].name, metric_info[i].type,
+            metric_info[i].name, metric_values[i]);
+    }
+    
+    render_append(buf, buf_size, &pos,
+        "# HELP vaultwm_x_events_total X events handled by type\n"
+        "# TYPE vaultwm_x_events_total counter\n");
+    for (i = 0; i < METRICS_MAX_EVENT_TYPES; i++) {
+        if (event_names[i] && event_counts[i] > 0) {
+            render_append(buf, buf_size, &pos, "vaultwm_x_events_total{type=\"%s\"} %lu\n",
+                event_names[i], event_counts[i]);
+        }
+    }
+    render_append(buf, buf_size, &pos, "vaultwm_x_events_total{type=\"other\"} %lu\n", event_other);
+    
+    return (pos < buf_size) ? pos : 0;
+}
+
+int metrics_socket_path(char *path, size_t path_size) {
+    const char *env = getenv(METRICS_SOCKET_ENV);
+    const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+    int n;
+    
+    if (!path || path_size == 0) {
+        return 0;
+    }
+    
+    if (env && env[0] != '\0') {
+        n = snprintf(path, path_size, "%s", env);
+    } else if (runtime_dir && runtime_dir[0] == '/') {
+        n = snprintf(path, path_size, "%s/%s", runtime_dir, METRICS_SOCKET_NAME);
+    } else {
+        n = snprintf(path, path_size, "/tmp/vaultwm-metrics-%u.sock", (unsigned int)getuid());
+    }
+    
+    return (n > 0 && (size_t)n < path_size) ? 1 : 0;
+}
+
+static int epoll_watch(int fd, void *tag, unsigned int events, int op) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = tag;
+    return epoll_ctl(metrics_epoll_fd, op, fd, &ev) == 0;
+}
+
+int metrics_init(void) {
+    struct sockaddr_un addr;
+    int i;
+    
+    for (i = 0; i < METRICS_MAX_CONNECTIONS; i++) {
+        connections[i].fd = -1;
+    }
+    
+    if (!metrics_socket_path(metrics_socket_file, sizeof(metrics_socket_file))) {
+        fprintf(stderr, "VaultWM: Metrics socket path too long\n");
+        return 0;
+    }
+    
+    metrics_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    metrics_listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (metrics_epoll_fd < 0 || metrics_listen_fd < 0) {
+        fprintf(stderr, "VaultWM: Failed to create metrics socket: %s\n", strerror(errno));
+        metrics_cleanup();
+        return 0;
+    }
+    
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", metrics_socket_file);
+    
+    unlink(metrics_socket_file);
+    if (bind(metrics_listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        chmod(metrics_socket_file, 0600) < 0 ||
+        listen(metrics_listen_fd, METRICS_MAX_CONNECTIONS) < 0 ||
+        !epoll_watch(metrics_listen_fd, &metrics_listen_fd, EPOLLIN, EPOLL_CTL_ADD)) {
+        fprintf(stderr, "VaultWM: Failed to bind metrics socket %s: %s\n",
+            metrics_socket_file, strerror(errno));
+        metrics_cleanup();
+        return 0;
+    }
+    
+    return 1;
+}
+
+static void connection_close(MetricsConnection *conn) {
+    if (conn->fd >= 0) {
+        epoll_ctl(metrics_epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+        close(conn->fd);
+    }
+    free(conn->out);
+    memset(conn, 0, sizeof(*conn));
+    conn->fd = -1;
+}
+
+void metrics_cleanup(void) {
+    int i;
+    
+    for (i = 0; i < METRICS_MAX_CONNECTIONS; i++) {
+        if (connections[i].fd >= 0) {
+            connection_close(&connections[i]);
+        }
+    }
+    
+    if (metrics_listen_fd >= 0) {
+        close(metrics_listen_fd);
+        metrics_listen_fd = -1;
+        unlink(metrics_socket_file);
+    }
+    
+    if (metrics_epoll_fd >= 0) {
+        close(metrics_epoll_fd);
+        metrics_epoll_fd = -1;
+    }
+}
+
+int metrics_get_fd(void) {
+    return metrics_epoll_fd;
+}
+
+static void metrics_accept(void) {
+    int i, fd;
+    
+    while ((fd = accept4(metrics_listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        for (i = 0; i < METRICS_MAX_CONNECTIONS; i++) {
+            if (connections[i].fd < 0) {
+                break;
+            }
+        }
+        if (i == METRICS_MAX_CONNECTIONS || !epoll_watch(fd, &connections[i], EPOLLIN, EPOLL_CTL_ADD)) {
+            close(fd);  // Scrapers retry; never block the WM on them
+            continue;
+        }
+        connections[i].fd = fd;
+    }
+}
+
+// Build the reply: HTTP/1.0 for "GET" requests (curl --unix-socket), bare text otherwise
+static int connection_respond(MetricsConnection *conn) {
+    char body[METRICS_RENDER_MAX];
+    size_t body_len;
+    int http = (conn->in_len >= 4 && strncmp(conn->in, "GET ", 4) == 0);
+    int header_len = 0;
+    
+    metrics_inc(METRIC_SCRAPES);
+    if (collector) {
+        collector();
+    }
+    
+    body_len = metrics_render(body, sizeof(body));
+    conn->out = malloc(body_len + 256);
+    if (!conn->out) {
+        return 0;
+    }
+    
+    if (http) {
+        header_len = snprintf(conn->out, 256,
+            "HTTP/1.0 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: %zu\r\n"
+            "Connection: close\r\n\r\n", body_len);
+    }
+    memcpy(conn->out + header_len, body, body_len);
+    conn->out_len = (size_t)header_len + body_len;
+    conn->out_sent = 0;
+    
+    return epoll_watch(conn->fd, conn, EPOLLOUT, EPOLL_CTL_MOD);
+}
+
+static void connection_service(MetricsConnection *conn, unsigned int events) {
+    ssize_t n;
+    
+    if (conn->out) {
+        // A scraper that timed out and hung up is EPIPE, not SIGPIPE
+        while (conn->out_sent < conn->out_len) {
+            n = send(conn->fd, conn->out + conn->out_sent, conn->out_len - conn->out_sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return;
+                }
+                break;
+            }
+            conn->out_sent += (size_t)n;
+        }
+        connection_close(conn);  // One scrape per connection
+        return;
+    }
+    
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        n = read(conn->fd, conn->in + conn->in_len, sizeof(conn->in) - conn->in_len);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (n > 0) {
+            conn->in_len += (size_t)n;
+        }
+        
+        // The request ends at the first newline, at EOF, or when the buffer fills
+        if (n <= 0 || memchr(conn->in, '\n', conn->in_len) || conn->in_len == sizeof(conn->in)) {
+            if (!connection_respond(conn)) {
+                connection_close(conn);
+            }
+        }
+    }
+}
+
+int metrics_dispatch(int budget) {
+    struct epoll_event events[METRICS_MAX_CONNECTIONS + 1];
+    int n, i, serviced = 0;
+    int max = METRICS_MAX_CONNECTIONS + 1;
+    
+    if (metrics_epoll_fd < 0) {
+        return 0;
+    }
+    if (budget > 0 && budget < max) {
+        max = budget;
+    }
+    
+    n = epoll_wait(metrics_epoll_fd, events, max, 0);
+    for (i = 0; i < n; i++) {
+        if (events[i].data.ptr == &metrics_listen_fd) {
+            metrics_accept();
+        } else {
+            connection_service((MetricsConnection *)events[i].data.ptr, events[i].events);
+        }
+        serviced++;
+    }
+    
+    return serviced;
+}
@@ -0,0 +1,72 @@
+/*
+ * VaultWM Metrics
+ * In-process counters and gauges exported in Prometheus text format
+ * on a local Unix socket
+ */
+
+#ifndef VAULTWM_METRICS_H
+#define VAULTWM_METRICS_H
+
+#include <stddef.h>
+
+#define METRICS_SOCKET_ENV "VAULTWM_METRICS_SOCKET"
+#define METRICS_SOCKET_NAME "vaultwm-metrics.sock"
+#define METRICS_SOCKET_PATH_MAX 108
+#define METRICS_MAX_CONNECTIONS 8
+#define METRICS_MAX_EVENT_TYPES 64   // Covers the core X protocol event codes
+
+typedef enum {
+    METRIC_LAYOUT_PASSES,        // counter
+    METRIC_LAYOUT_RECONFIGURES,  // counter, windows whose geometry a layout pass changed
+    METRIC_ANIMATION_FRAMES,     // counter, sampled from the animator
+    METRIC_ANIMATION_DROPPED,    // counter, refreshes missed while animating
+    METRIC_ANIMATION_SKIPPED,    // counter, transitions applied without animating
+    METRIC_IPC_COMMANDS,         // counter
+    METRIC_IPC_ERRORS,           // counter
+    METRIC_X_REQUESTS,           // counter, sampled from the Xlib request sequence
+    METRIC_SCRAPES,              // counter
+    METRIC_CLIENTS,              // gauge
+    METRIC_WORKSPACE,            // gauge
+    METRIC_MONITORS,             // gauge
+    METRIC_CPU_USAGE,            // gauge
+    METRIC_MEMORY_USAGE,         // gauge
+    METRIC_COUNT
+} MetricId;
+
+/* Called before each scrape so gauges can be sampled lazily */
+typedef void (*metrics_collect_t)(void);
+
+/* Increment a counter */
+void metrics_inc(MetricId id);
+
+/* Add to a counter */
+void metrics_add(MetricId id, double value);
+
+/* Set a counter or gauge to an absolute value */
+void metrics_set(MetricId id, double value);
+
+/* Count one X event of the given type */
+void metrics_count_event(int type);
+
+/* Install the scrape-time collector */
+void metrics_set_collector(metrics_collect_t collect);
+
+/* Render all metrics in Prometheus text format; returns bytes written or 0 if buf is too small */
+size_t metrics_render(char *buf, size_t buf_size);
+
+/* Resolve the socket path ($VAULTWM_METRICS_SOCKET, $XDG_RUNTIME_DIR, then /tmp) */
+int metrics_socket_path(char *path, size_t path_size);
+
+/* Start the metrics endpoint */
+int metrics_init(void);
+
+/* Stop the endpoint and remove the socket */
+void metrics_cleanup(void);
+
+/* Pollable descriptor that becomes readable when a scrape needs service */
+int metrics_get_fd(void);
+
+/* Service at most budget ready connections (0 = no limit); returns connections serviced */
+int metrics_dispatch(int budget);
+
+#endif /* VAULTWM_METRICS_H */
@@ -10,6 +10,27 @@
 #include <string.h>
 #include "monitor.h"
 
+/* Refresh rate of a CRTC's mode: pixel clock over pixels per frame */
+static int mode_refresh_mhz(XRRScreenResources *resources, RRMode mode) {
+    int i;
+    
+    for (i = 0; i < resources->nmode; i++) {
+        XRRModeInfo *m = &resources->modes[i];
+        double lines;
+        
+        if (m->id != mode) continue;
+        
+        lines = m->vTotal;
+        if (m->modeFlags & RR_DoubleScan) lines *= 2;
+        if (m->modeFlags & RR_Interlace) lines /= 2;
+        if (m->hTotal == 0 || lines <= 0) {
+            return 0;
+        }
+        return (int)((double)m->dotClock * 1000.0 / ((double)m->hTotal * lines) + 0.5);
+    }
+    return 0;
+}
+
 int monitor_init(Display *dpy, MonitorManager *mm) {
     int event_base, error_base;
     XRRScreenResources *resources;
@@ -25,6 +46,7 @@ int monitor_init(Display *dpy, MonitorManager *mm) {
         mm->monitors[0].width = DisplayWidth(dpy, DefaultScreen(dpy));
         mm->monitors[0].height = DisplayHeight(dpy, DefaultScreen(dpy));
         mm->monitors[0].primary = 1;
+        mm->monitors[0].refresh_mhz = 0;
         mm->monitors[0].root = RootWindow(dpy, DefaultScreen(dpy));
         strncpy(mm->monitors[0].name, "Default", sizeof(mm->monitors[0].name) - 1);
         mm->primary_monitor = 0;
@@ -57,6 +79,7 @@ int monitor_init(Display *dpy, MonitorManager *mm) {
                 mon->width = crtc_info->width;
                 mon->height = crtc_info->height;
                 mon->primary = (output_info->crtc == resources->outputs[0]) ? 1 : 0;
+                mon->refresh_mhz = mode_refresh_mhz(resources, crtc_info->mode);
                 mon->root = RootWindow(dpy, DefaultScreen(dpy));
                 
                 strncpy(mon->name, output_info->name, sizeof(mon->name) - 1);
@@ -84,6 +107,7 @@ int monitor_init(Display *dpy, MonitorManager *mm) {
         mm->monitors[0].width = DisplayWidth(dpy, DefaultScreen(dpy));
         mm->monitors[0].height = DisplayHeight(dpy, DefaultScreen(dpy));
         mm->monitors[0].primary = 1;
+        mm->monitors[0].refresh_mhz = 0;
         mm->monitors[0].root = RootWindow(dpy, DefaultScreen(dpy));
         strncpy(mm->monitors[0].name, "Default", sizeof(mm->monitors[0].name) - 1);
         mm->primary_monitor = 0;
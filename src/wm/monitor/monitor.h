@@ -14,6 +14,7 @@ typedef struct {
     int x, y;
     int width, height;
     int primary;
+    int refresh_mhz;  // Refresh rate in millihertz, 0 = unknown
     char name[64];
     Window root;
 } Monitor;
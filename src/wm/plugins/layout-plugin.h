@@ -0,0 +1,61 @@
+/*
+ * VaultWM Layout Plugin ABI
+ * Public header for layout plugins. A plugin receives every tiled client
+ * of a workspace in one batch of parallel arrays and fills in the output
+ * geometry; it never calls back into the window manager.
+ */
+
+#ifndef VAULTWM_LAYOUT_PLUGIN_H
+#define VAULTWM_LAYOUT_PLUGIN_H
+
+#include <stdint.h>
+
+/* Bumped on any incompatible change to the structures below */
+#define VAULTWM_LAYOUT_ABI_VERSION 1
+
+/* Symbol every layout plugin exports */
+#define VAULTWM_LAYOUT_ENTRY "vaultwm_layout_plugin"
+
+/* Plugin flags */
+#define VAULTWM_LAYOUT_REENTRANT (1u << 0)  // arrange() touches only its arguments; may run off the event thread
+
+typedef struct {
+    int32_t x, y, width, height;
+} VaultLayoutRect;
+
+/* One workspace worth of clients, structure-of-arrays. Inputs are read-only;
+ * the plugin writes out_* for every index whose floating flag is 0. */
+typedef struct {
+    uint32_t count;
+    const uint64_t *ids;         // X window ids
+    const uint8_t *floating;     // 1 = leave alone
+    const int32_t *min_width;    // Size hints, 0 = none
+    const int32_t *min_height;
+    const int32_t *max_width;
+    const int32_t *max_height;
+    int32_t *out_x;
+    int32_t *out_y;
+    int32_t *out_width;
+    int32_t *out_height;
+} VaultLayoutBatch;
+
+typedef struct {
+    uint32_t abi_version;        // VAULTWM_LAYOUT_ABI_VERSION the plugin was built against
+    uint32_t flags;
+    const char *name;            // Shown in the status bar and used by "set_layout"
+    /* Returns 0 on success; on failure the host keeps the previous geometry */
+    int (*arrange)(const VaultLayoutRect *area, int32_t gap, const VaultLayoutBatch *batch, void *state);
+    void (*cleanup)(void *state);  // Optional
+    void *state;
+} VaultLayoutPlugin;
+
+/* Entry point: return the descriptor, or NULL if host_abi_version is unsupported */
+typedef const VaultLayoutPlugin *(*VaultLayoutEntryFunc)(uint32_t host_abi_version);
+
+/* Optional entry point used instead when a rebuilt plugin replaces a loaded one.
+ * *previous_state is the outgoing instance's state; set it to NULL to take it
+ * over, otherwise the outgoing cleanup() receives it as usual. */
+#define VAULTWM_LAYOUT_RELOAD_ENTRY "vaultwm_layout_plugin_reload"
+typedef const VaultLayoutPlugin *(*VaultLayoutReloadFunc)(uint32_t host_abi_version, void **previous_state);
+
+#endif /* VAULTWM_LAYOUT_PLUGIN_H */
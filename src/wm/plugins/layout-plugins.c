@@ -0,0 +1,434 @@
+/*
+ * VaultWM Layout Plugin Host Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <pwd.h>
+#include "layout-plugins.h"
+#include "plugin-watch.h"
+#include "plugin-manifest.h"
+#include "plugin-stats.h"
+
+#define LAYOUT_PLUGIN_BATCH_MAX 256
+#define LAYOUT_MANIFEST_FILE "layouts.manifest"
+
+/* Known from the manifest at startup; opened the first time a workspace uses it */
+typedef struct {
+    void *handle;                // NULL until active
+    int fd;                      // Open for the handle's lifetime; see plugin_dlopen()
+    const VaultLayoutPlugin *desc;  // NULL until active
+    char path[PLUGIN_PATH_MAX];  // Where it was loaded from, to match watcher events
+    char name[PLUGIN_MANIFEST_NAME_MAX];
+    uint32_t flags;
+    int failed;                  // Activation failed; not retried until the file is replaced
+    PluginStats stats;           // Per instance: a reload starts with a clean record
+} LoadedLayout;
+
+/* Per-call scratch (about 10 KB), on the stack so concurrent arranges never share it */
+typedef struct {
+    uint64_t ids[LAYOUT_PLUGIN_BATCH_MAX];
+    uint8_t floating[LAYOUT_PLUGIN_BATCH_MAX];
+    int32_t min_width[LAYOUT_PLUGIN_BATCH_MAX];
+    int32_t min_height[LAYOUT_PLUGIN_BATCH_MAX];
+    int32_t max_width[LAYOUT_PLUGIN_BATCH_MAX];
+    int32_t max_height[LAYOUT_PLUGIN_BATCH_MAX];
+    int32_t out_x[LAYOUT_PLUGIN_BATCH_MAX];
+    int32_t out_y[LAYOUT_PLUGIN_BATCH_MAX];
+    int32_t out_width[LAYOUT_PLUGIN_BATCH_MAX];
+    int32_t out_height[LAYOUT_PLUGIN_BATCH_MAX];
+} LayoutBatchStorage;
+
+static LoadedLayout layouts[LAYOUT_PLUGINS_MAX];
+static int num_layouts = 0;
+
+static PluginManifest manifest;
+static char manifest_path[PLUGIN_PATH_MAX];  // Empty: no cache, every plugin is opened at startup
+
+/* Map path and take a checked descriptor from it. With previous_state set, a reload
+ * entry gets the chance to adopt that state. Returns 1 with out filled, or 0 with
+ * nothing left open */
+static int open_layout(const char *path, const LoadedLayout *current, void **previous_state,
+                       LoadedLayout *out) {
+    VaultLayoutEntryFunc entry;
+    VaultLayoutReloadFunc reload;
+    const VaultLayoutPlugin *desc;
+    int fd;
+    
+    // Overwritten in place: loading it again would only hand back the old mapping
+    if (current && !plugin_file_replaced(path, current->fd)) {
+        fprintf(stderr, "VaultWM: %s was rewritten in place, not reloaded; "
+            "install plugins with install(1) or mv\n", path);
+        return 0;
+    }
+    
+    void *handle = plugin_dlopen(path, &fd);
+    if (!handle) {
+        return 0;
+    }
+    
+    reload = previous_state ? (VaultLayoutReloadFunc)dlsym(handle, VAULTWM_LAYOUT_RELOAD_ENTRY) : NULL;
+    entry = (VaultLayoutEntryFunc)dlsym(handle, VAULTWM_LAYOUT_ENTRY);
+    if (reload) {
+        desc = reload(VAULTWM_LAYOUT_ABI_VERSION, previous_state);
+    } else {
+        desc = entry ? entry(VAULTWM_LAYOUT_ABI_VERSION) : NULL;
+    }
+    if (!desc) {
+        fprintf(stderr, "VaultWM: %s is not a layout plugin for ABI %d\n", path, VAULTWM_LAYOUT_ABI_VERSION);
+        dlclose(handle);
+        close(fd);
+        return 0;
+    }
+    
+    // Same version only: the structures are passed by pointer, so any change breaks them
+    if (desc->abi_version != VAULTWM_LAYOUT_ABI_VERSION || !desc->arrange ||
+        !desc->name || desc->name[0] == '\0') {
+        fprintf(stderr, "VaultWM: Layout %s has ABI %u, expected %d\n",
+            path, desc->abi_version, VAULTWM_LAYOUT_ABI_VERSION);
+        dlclose(handle);
+        close(fd);
+        return 0;
+    }
+    
+    out->handle = handle;
+    out->fd = fd;
+    out->desc = desc;
+    snprintf(out->path, sizeof(out->path), "%s", path);
+    snprintf(out->name, sizeof(out->name), "%s", desc->name);
+    out->flags = desc->flags;
+    out->failed = 0;
+    plugin_stats_reset(&out->stats);
+    return 1;
+}
+
+/* Note what path turned out to be, so the next startup need not open it */
+static void remember(const char *path, const struct stat *st, const LoadedLayout *l) {
+    if (manifest_path[0]) {
+        plugin_manifest_update(&manifest, path, st, l->name, 0, l->flags, 0);
+    }
+}
+
+static void save_manifest(void) {
+    if (manifest_path[0] && manifest.dirty) {
+        plugin_manifest_save(&manifest, manifest_path);
+    }
+}
+
+int layout_plugin_load(const char *path) {
+    LoadedLayout loaded;
+    struct stat st;
+    
+    if (num_layouts >= LAYOUT_PLUGINS_MAX) {
+        fprintf(stderr, "VaultWM: Maximum layout plugin limit reached\n");
+        return -1;
+    }
+    
+    if (stat(path, &st) != 0 || !open_layout(path, NULL, NULL, &loaded)) {
+        return -1;
+    }
+    remember(path, &st, &loaded);
+    
+    if (layout_plugin_find(loaded.desc->name) >= 0) {
+        fprintf(stderr, "VaultWM: Layout %s already loaded, skipping %s\n", loaded.desc->name, path);
+        dlclose(loaded.handle);
+        close(loaded.fd);
+        return -1;
+    }
+    
+    layouts[num_layouts] = loaded;
+    return num_layouts++;
+}
+
+/* Known from the manifest: listed under its cached name, opened on first use */
+static int layout_plugin_register(const PluginManifestEntry *e) {
+    LoadedLayout *l;
+    
+    if (num_layouts >= LAYOUT_PLUGINS_MAX) {
+        fprintf(stderr, "VaultWM: Maximum layout plugin limit reached\n");
+        return -1;
+    }
+    if (layout_plugin_find(e->name) >= 0) {
+        fprintf(stderr, "VaultWM: Layout %s already loaded, skipping %s\n", e->name, e->path);
+        return -1;
+    }
+    
+    l = &layouts[num_layouts];
+    memset(l, 0, sizeof(*l));
+    l->fd = -1;
+    snprintf(l->path, sizeof(l->path), "%s", e->path);
+    snprintf(l->name, sizeof(l->name), "%s", e->name);
+    l->flags = e->caps;
+    return num_layouts++;
+}
+
+/* Open a registered plugin the first time it is needed */
+static int activate(int index) {
+    LoadedLayout *l = &layouts[index];
+    LoadedLayout opened;
+    struct stat st;
+    int other;
+    
+    if (l->desc) return 1;
+    if (l->failed) return 0;
+    
+    if (stat(l->path, &st) != 0 || !open_layout(l->path, NULL, NULL, &opened)) {
+        l->failed = 1;
+        if (manifest_path[0]) plugin_manifest_forget(&manifest, l->path);
+        save_manifest();
+        return 0;
+    }
+    
+    // The cache was stale (file changed while the WM was not running): take it as it is now
+    other = layout_plugin_find(opened.name);
+    if (other >= 0 && other != index) {
+        fprintf(stderr, "VaultWM: Layout %s already loaded, skipping %s\n", opened.name, l->path);
+        dlclose(opened.handle);
+        close(opened.fd);
+        l->failed = 1;
+        return 0;
+    }
+    if (strcmp(opened.name, l->name) != 0 || opened.flags != l->flags) {
+        remember(l->path, &st, &opened);
+        save_manifest();
+    }
+    *l = opened;
+    return 1;
+}
+
+int layout_plugin_reload(const char *path) {
+    LoadedLayout fresh, old;
+    struct stat st;
+    int i, other;
+    
+    for (i = 0; i < num_layouts && strcmp(layouts[i].path, path) != 0; i++);
+    if (i == num_layouts) {
+        i = layout_plugin_load(path);
+        save_manifest();
+        return i;
+    }
+    
+    // The new instance is complete before the old one is touched; any failure keeps the old
+    void *old_state = layouts[i].desc ? layouts[i].desc->state : NULL;
+    void *state = old_state;
+    if (stat(path, &st) != 0 ||
+        !open_layout(path, layouts[i].desc ? &layouts[i] : NULL, layouts[i].desc ? &state : NULL, &fresh)) {
+        return -1;
+    }
+    other = layout_plugin_find(fresh.name);
+    if (other >= 0 && other != i) {
+        fprintf(stderr, "VaultWM: Layout %s already loaded, keeping the old %s\n", fresh.desc->name, path);
+        dlclose(fresh.handle);
+        close(fresh.fd);
+        return -1;
+    }
+    
+    old = layouts[i];
+    layouts[i] = fresh;
+    remember(path, &st, &fresh);
+    save_manifest();
+    
+    // Retire the old instance, if it was ever opened; its state goes with it unless the new one adopted it
+    if (old.desc) {
+        if (old.desc->cleanup && (state || !old_state)) {
+            old.desc->cleanup(state);
+        }
+        dlclose(old.handle);
+        close(old.fd);
+    }
+    return i;
+}
+
+static int load_directory(const char *dir_path) {
+    DIR *dir;
+    struct dirent *entry;
+    char path[512];
+    struct stat st;
+    int loaded = 0;
+    
+    dir = opendir(dir_path);
+    if (!dir) {
+        return 0;
+    }
+    
+    while ((entry = readdir(dir)) != NULL) {
+        const PluginManifestEntry *known;
+        
+        if (!plugin_is_library_name(entry->d_name)) {
+            continue;
+        }
+        
+        snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+        
+        // Unchanged since it was last opened: list it without loading it
+        known = manifest_path[0] ? plugin_manifest_lookup(&manifest, path, &st) : NULL;
+        if ((known ? layout_plugin_register(known) : layout_plugin_load(path)) >= 0) {
+            loaded++;
+        }
+    }
+    
+    closedir(dir);
+    return loaded;
+}
+
+static int user_layout_dir(char *path, size_t size) {
+    struct passwd *pw = getpwuid(getuid());
+    
+    if (!pw) {
+        return 0;
+    }
+    snprintf(path, size, LAYOUT_PLUGIN_DIR_USER_FORMAT, pw->pw_dir);
+    return 1;
+}
+
+int layout_plugins_load_all(void) {
+    char user_dir[512];
+    int loaded;
+    
+    if (plugin_manifest_path(LAYOUT_MANIFEST_FILE, manifest_path, sizeof(manifest_path))) {
+        plugin_manifest_load(&manifest, manifest_path);
+    } else {
+        manifest_path[0] = '\0';
+    }
+    
+    // User layouts first so they can shadow a system layout of the same name
+    loaded = 0;
+    if (user_layout_dir(user_dir, sizeof(user_dir))) {
+        loaded += load_directory(user_dir);
+    }
+    loaded += load_directory(LAYOUT_PLUGIN_DIR_SYSTEM);
+    
+    save_manifest();  // Drops uninstalled plugins, adds newly opened ones
+    return loaded;
+}
+
+int layout_plugins_watch(void) {
+    char user_dir[512];
+    char *p;
+    int watched = 0;
+    
+    // Created if missing, so the first "make install" of a new plugin is seen too
+    if (user_layout_dir(user_dir, sizeof(user_dir))) {
+        for (p = strchr(user_dir + 1, '/'); p; p = strchr(p + 1, '/')) {
+            *p = '\0';
+            mkdir(user_dir, 0755);
+            *p = '/';
+        }
+        mkdir(user_dir, 0755);
+        watched += plugin_watch_add_dir(user_dir);
+    }
+    watched += plugin_watch_add_dir(LAYOUT_PLUGIN_DIR_SYSTEM);
+    
+    return watched;
+}
+
+void layout_plugins_cleanup(void) {
+    int i;
+    
+    for (i = 0; i < num_layouts; i++) {
+        if (!layouts[i].desc) continue;  // Never used this session
+        if (layouts[i].desc->cleanup) {
+            layouts[i].desc->cleanup(layouts[i].desc->state);
+        }
+        dlclose(layouts[i].handle);
+        close(layouts[i].fd);
+    }
+    num_layouts = 0;
+}
+
+int layout_plugin_count(void) {
+    return num_layouts;
+}
+
+const char* layout_plugin_name(int index) {
+    return (index >= 0 && index < num_layouts) ? layouts[index].name : NULL;
+}
+
+int layout_plugin_find(const char *name) {
+    int i;
+    
+    for (i = 0; i < num_layouts; i++) {
+        if (strcmp(layouts[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+PluginStats* layout_plugin_stats(int index) {
+    return (index >= 0 && index < num_layouts) ? &layouts[index].stats : NULL;
+}
+
+int layout_plugin_reentrant(int index) {
+    return (index >= 0 && index < num_layouts) &&
+        (layouts[index].flags & VAULTWM_LAYOUT_REENTRANT);
+}
+
+int layout_plugin_arrange(int index, LayoutClient *clients, int num_clients,
+                          int x, int y, int width, int height, int gap) {
+    LayoutBatchStorage storage;
+    LayoutBatchStorage *s = &storage;
+    VaultLayoutBatch batch;
+    VaultLayoutRect area;
+    uint64_t start;
+    int i, ok;
+    
+    if (index < 0 || index >= num_layouts || num_clients < 0 || num_clients > LAYOUT_PLUGIN_BATCH_MAX ||
+        !activate(index) || !plugin_stats_begin(&layouts[index].stats, &start)) {
+        return -1;
+    }
+    
+    // AoS -> SoA; outputs start at the current geometry so a lazy plugin is harmless
+    for (i = 0; i < num_clients; i++) {
+        s->ids[i] = (uint64_t)clients[i].win;
+        s->floating[i] = clients[i].is_floating ? 1 : 0;
+        s->min_width[i] = clients[i].hints.min_width;
+        s->min_height[i] = clients[i].hints.min_height;
+        s->max_width[i] = clients[i].hints.max_width;
+        s->max_height[i] = clients[i].hints.max_height;
+        s->out_x[i] = clients[i].x;
+        s->out_y[i] = clients[i].y;
+        s->out_width[i] = clients[i].width;
+        s->out_height[i] = clients[i].height;
+    }
+    
+    batch.count = (uint32_t)num_clients;
+    batch.ids = s->ids;
+    batch.floating = s->floating;
+    batch.min_width = s->min_width;
+    batch.min_height = s->min_height;
+    batch.max_width = s->max_width;
+    batch.max_height = s->max_height;
+    batch.out_x = s->out_x;
+    batch.out_y = s->out_y;
+    batch.out_width = s->out_width;
+    batch.out_height = s->out_height;
+    
+    area.x = x;
+    area.y = y;
+    area.width = width;
+    area.height = height;
+    
+    ok = layouts[index].desc->arrange(&area, gap, &batch, layouts[index].desc->state) == 0;
+    plugin_stats_end(&layouts[index].stats, layouts[index].name, start);
+    if (ok) {
+        for (i = 0; i < num_clients; i++) {
+            if (clients[i].is_floating) continue;
+            
+            clients[i].x = s->out_x[i];
+            clients[i].y = s->out_y[i];
+            clients[i].width = s->out_width[i];
+            clients[i].height = s->out_height[i];
+        }
+    }
+    
+    return ok;
+}
@@ -0,0 +1,58 @@
+/*
+ * VaultWM Layout Plugin Host
+ * Loads layout plugins and runs them on batches of LayoutClients
+ */
+
+#ifndef VAULTWM_LAYOUT_PLUGINS_H
+#define VAULTWM_LAYOUT_PLUGINS_H
+
+#include "layout-plugin.h"
+#include "plugin-stats.h"
+#include "../layouts/layouts.h"
+
+#define LAYOUT_PLUGINS_MAX 16
+#define LAYOUT_PLUGIN_DIR_SYSTEM "/usr/share/vaultos/layouts"
+#define LAYOUT_PLUGIN_DIR_USER_FORMAT "%s/.local/share/vaultos/layouts"
+
+/* Open one plugin now; returns its index or -1 */
+int layout_plugin_load(const char *path);
+
+/* List every *.so in the user and system layout directories; returns the number
+ * found. Plugins the manifest cache still describes are not opened until a
+ * workspace first arranges with them */
+int layout_plugins_load_all(void);
+
+/* A plugin file was written: a plugin loaded from path is replaced in place (same
+ * index, so workspaces keep their mode), anything else is loaded as new. On any
+ * failure the loaded version stays. Returns the plugin's index or -1 */
+int layout_plugin_reload(const char *path);
+
+/* Add the layout directories to the plugin watcher; returns the number watched */
+int layout_plugins_watch(void);
+
+/* Unload all plugins */
+void layout_plugins_cleanup(void);
+
+/* Number of available plugins, opened or not */
+int layout_plugin_count(void);
+
+/* Name of plugin index, or NULL */
+const char* layout_plugin_name(int index);
+
+/* Index of the plugin called name, or -1 */
+int layout_plugin_find(const char *name);
+
+/* Call accounting for plugin index, or NULL */
+PluginStats* layout_plugin_stats(int index);
+
+/* Non-zero if the plugin declared VAULTWM_LAYOUT_REENTRANT */
+int layout_plugin_reentrant(int index);
+
+/* Run plugin index over the tiled clients in one call, opening it on first use
+ * (from the event thread only). Returns 1 on success, 0 if the plugin failed
+ * (clients keep their geometry), -1 if it could not be called: missing, or
+ * throttled or disabled for overrunning its time budget */
+int layout_plugin_arrange(int index, LayoutClient *clients, int num_clients,
+                          int x, int y, int width, int height, int gap);
+
+#endif /* VAULTWM_LAYOUT_PLUGINS_H */
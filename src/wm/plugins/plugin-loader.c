@@ -12,19 +12,168 @@
 #include <unistd.h>
 #include <pwd.h>
 #include "plugin-loader.h"
+#include "plugin-watch.h"
+#include "plugin-manifest.h"
+#include "plugin-stats.h"
+#include "../jobs/job-pool.h"
 
 #define MAX_PLUGINS 64
 #define PLUGIN_DIR_SYSTEM "/usr/share/vaultos/plugins"
 #define PLUGIN_DIR_USER_FORMAT "%s/.local/share/vaultos/plugins"
+#define PLUGIN_MANIFEST_FILE "plugins.manifest"
 
 static Plugin plugins[MAX_PLUGINS];
 static int num_plugins = 0;
 
+/* Host side of each plugin, kept out of Plugin so the plugin ABI is unchanged */
+static char plugin_paths[MAX_PLUGINS][PLUGIN_PATH_MAX];
+static int plugin_fds[MAX_PLUGINS];
+static uint32_t plugin_caps[MAX_PLUGINS];
+static PluginStats plugin_stats[MAX_PLUGINS];
+
+/* Installed plugins, opened or not; only used once plugin_load_all() has found a cache */
+static PluginManifest manifest;
+static char manifest_path[PLUGIN_PATH_MAX];
+
+/* Per-hook subscriber lists, rebuilt whenever the set of plugins changes */
+typedef struct {
+    PluginEventFunc func;
+    Plugin *plugin;
+    PluginStats *stats;
+} HookSubscriber;
+
+static HookSubscriber hook_subscribers[PLUGIN_HOOK_COUNT][MAX_PLUGINS];
+static int hook_counts[PLUGIN_HOOK_COUNT];
+static uint32_t hooks_pending;  // Subscribed to by plugins not opened yet
+
+uint32_t plugin_hook_mask = 0;
+
+/* A job submitted by a plugin; the handle tags it for job_pool_flush() and finds
+ * the plugin again on completion, wherever plugins[] has moved it */
+typedef struct {
+    void *handle;
+    PluginJobRun run;
+    PluginJobDone done;
+    void *arg;
+} PluginJob;
+
+/* Instance inside plugin_init or plugin_reload, not in plugins[] yet */
+static Plugin *initialising = NULL;
+
+static void run_plugin_job(void *data) {
+    PluginJob *job = data;
+    job->run(job->arg);
+}
+
+static void finish_plugin_job(void *data) {
+    PluginJob *job = data;
+    uint64_t start;
+    int i;
+    
+    for (i = 0; i < num_plugins && plugins[i].handle != job->handle; i++);
+    if (i < num_plugins && plugin_stats_begin(&plugin_stats[i], &start)) {
+        job->done(&plugins[i], job->arg);
+        plugin_stats_end(&plugin_stats[i], plugins[i].name, start);
+    } else if (i == num_plugins && initialising && initialising->handle == job->handle) {
+        job->done(initialising, job->arg);  // Flushed by a failed plugin_init or plugin_reload
+    }
+    free(job);  // Otherwise disabled, throttled or already gone
+}
+
+static int submit_plugin_job(Plugin *plugin, PluginJobRun run, PluginJobDone done, void *arg) {
+    PluginJob *job = malloc(sizeof(PluginJob));
+    
+    if (!job || !run || !done) {
+        free(job);
+        return 0;
+    }
+    job->handle = plugin->handle;
+    job->run = run;
+    job->done = done;
+    job->arg = arg;
+    if (!job_submit(run_plugin_job, finish_plugin_job, job, plugin->handle)) {
+        free(job);
+        return 0;
+    }
+    return 1;
+}
+
+/* Close a plugin's library once nothing it queued can still run */
+static void close_plugin(void *handle, int fd) {
+    job_pool_flush(handle);
+    dlclose(handle);
+    close(fd);
+}
+
+static int is_open(const char *plugin_path) {
+    int i;
+    
+    for (i = 0; i < num_plugins; i++) {
+        if (strcmp(plugin_paths[i], plugin_path) == 0) return 1;
+    }
+    return 0;
+}
+
+static void rebuild_hooks(void) {
+    int hook, i;
+    
+    memset(hook_counts, 0, sizeof(hook_counts));
+    plugin_hook_mask = 0;
+    for (i = 0; i < num_plugins; i++) {
+        PluginEventFunc func = (PluginEventFunc)dlsym(plugins[i].handle, "plugin_event");
+        if (!func) continue;
+        for (hook = 0; hook < PLUGIN_HOOK_COUNT; hook++) {
+            if (!(plugins[i].hooks & PLUGIN_HOOK_BIT(hook))) continue;
+            hook_subscribers[hook][hook_counts[hook]].func = func;
+            hook_subscribers[hook][hook_counts[hook]].plugin = &plugins[i];
+            hook_subscribers[hook][hook_counts[hook]].stats = &plugin_stats[i];
+            hook_counts[hook]++;
+            plugin_hook_mask |= PLUGIN_HOOK_BIT(hook);
+        }
+    }
+    
+    hooks_pending = 0;
+    for (i = 0; manifest_path[0] && i < manifest.count; i++) {
+        if (manifest.entries[i].seen && manifest.entries[i].hooks && !is_open(manifest.entries[i].path)) {
+            hooks_pending |= manifest.entries[i].hooks;
+        }
+    }
+    plugin_hook_mask |= hooks_pending;
+}
+
+static uint32_t exported_caps(void *handle) {
+    uint32_t caps = 0;
+    
+    if (dlsym(handle, "plugin_output")) caps |= PLUGIN_CAP_OUTPUT;
+    if (dlsym(handle, "plugin_update")) caps |= PLUGIN_CAP_UPDATE;
+    if (dlsym(handle, "plugin_cleanup")) caps |= PLUGIN_CAP_CLEANUP;
+    if (dlsym(handle, "plugin_reload")) caps |= PLUGIN_CAP_RELOAD;
+    if (dlsym(handle, "plugin_event")) caps |= PLUGIN_CAP_EVENT;
+    return caps;
+}
+
+/* Record plugin index as what its file is, for the next startup */
+static void remember(int index, const struct stat *st) {
+    if (manifest_path[0]) {
+        plugin_manifest_update(&manifest, plugin_paths[index], st, plugins[index].name,
+            (uint32_t)plugins[index].type, plugin_caps[index],
+            (plugin_caps[index] & PLUGIN_CAP_EVENT) ? plugins[index].hooks : 0);
+    }
+}
+
+static void save_manifest(void) {
+    if (manifest_path[0] && manifest.dirty) {
+        plugin_manifest_save(&manifest, manifest_path);
+    }
+}
+
 /* Load plugin from shared library */
 int plugin_load(const char *plugin_path, const char *plugin_name) {
     void *handle;
     PluginInitFunc init_func;
     Plugin *plugin;
+    struct stat st;
+    int fd;
     
     if (num_plugins >= MAX_PLUGINS) {
         fprintf(stderr, "VaultWM: Maximum plugin limit reached\n");
@@ -32,9 +181,12 @@ int plugin_load(const char *plugin_path, const char *plugin_name) {
     }
     
     // Open shared library
-    handle = dlopen(plugin_path, RTLD_LAZY);
+    if (stat(plugin_path, &st) != 0) {
+        fprintf(stderr, "VaultWM: Plugin %s not found\n", plugin_path);
+        return 0;
+    }
+    handle = plugin_dlopen(plugin_path, &fd);
     if (!handle) {
-        fprintf(stderr, "VaultWM: Failed to load plugin %s: %s\n", plugin_path, dlerror());
         return 0;
     }
     
@@ -43,6 +195,7 @@ int plugin_load(const char *plugin_path, const char *plugin_name) {
     if (!init_func) {
         fprintf(stderr, "VaultWM: Plugin %s missing init function\n", plugin_name);
         dlclose(handle);
+        close(fd);
         return 0;
     }
     
@@ -53,14 +206,89 @@ int plugin_load(const char *plugin_path, const char *plugin_name) {
     strncpy(plugin->name, plugin_name, sizeof(plugin->name) - 1);
     plugin->name[sizeof(plugin->name) - 1] = '\0';
     plugin->handle = handle;
+    plugin->submit = submit_plugin_job;
     
+    initialising = plugin;
     if (init_func(plugin) != 0) {
         fprintf(stderr, "VaultWM: Plugin %s initialization failed\n", plugin_name);
-        dlclose(handle);
+        close_plugin(handle, fd);
+        initialising = NULL;
         return 0;
     }
+    initialising = NULL;
     
+    snprintf(plugin_paths[num_plugins], PLUGIN_PATH_MAX, "%s", plugin_path);
+    plugin_fds[num_plugins] = fd;
+    plugin_caps[num_plugins] = exported_caps(handle);
+    plugin_stats_reset(&plugin_stats[num_plugins]);
+    remember(num_plugins, &st);
     num_plugins++;
+    rebuild_hooks();
+    return 1;
+}
+
+/* Replace the plugin loaded from plugin_path with the file now there */
+int plugin_reload(const char *plugin_path) {
+    Plugin fresh;
+    PluginReloadFunc reload_func;
+    PluginInitFunc init_func;
+    PluginCleanupFunc cleanup;
+    struct stat st;
+    void *handle;
+    int i, fd, ok;
+    
+    for (i = 0; i < num_plugins && strcmp(plugin_paths[i], plugin_path) != 0; i++);
+    if (i == num_plugins) {
+        return 0;  // Not opened yet: plugin_get() will open the new file
+    }
+    
+    if (stat(plugin_path, &st) != 0 || !plugin_file_replaced(plugin_path, plugin_fds[i])) {
+        fprintf(stderr, "VaultWM: %s was rewritten in place, not reloaded\n", plugin_path);
+        return 0;
+    }
+    handle = plugin_dlopen(plugin_path, &fd);
+    if (!handle) {
+        return 0;
+    }
+    
+    // The old instance's jobs complete against it before its data can be taken over
+    job_pool_flush(plugins[i].handle);
+    
+    // Initialise the new instance beside the old one; plugin_reload() may take over previous->data
+    memset(&fresh, 0, sizeof(Plugin));
+    memcpy(fresh.name, plugins[i].name, sizeof(fresh.name));
+    fresh.handle = handle;
+    fresh.submit = submit_plugin_job;
+    reload_func = (PluginReloadFunc)dlsym(handle, "plugin_reload");
+    init_func = (PluginInitFunc)dlsym(handle, "plugin_init");
+    initialising = &fresh;
+    if (reload_func) {
+        ok = reload_func(&fresh, &plugins[i]) == 0;
+    } else {
+        ok = init_func && init_func(&fresh) == 0;
+    }
+    if (!ok) {
+        fprintf(stderr, "VaultWM: Plugin %s reload failed, keeping the loaded version\n", plugins[i].name);
+        close_plugin(handle, fd);
+        initialising = NULL;
+        return 0;
+    }
+    initialising = NULL;
+    
+    // Old instance out: cleanup sees whatever data the new instance left it
+    cleanup = (PluginCleanupFunc)dlsym(plugins[i].handle, "plugin_cleanup");
+    if (cleanup) {
+        cleanup(&plugins[i]);
+    }
+    close_plugin(plugins[i].handle, plugin_fds[i]);
+    
+    plugins[i] = fresh;
+    plugin_fds[i] = fd;
+    plugin_caps[i] = exported_caps(handle);
+    plugin_stats_reset(&plugin_stats[i]);  // A fixed build gets a clean record
+    remember(i, &st);
+    save_manifest();
+    rebuild_hooks();
     return 1;
 }
 
@@ -71,15 +299,21 @@ void plugin_unload(const char *plugin_name) {
     for (i = 0; i < num_plugins; i++) {
         if (strcmp(plugins[i].name, plugin_name) == 0) {
             PluginCleanupFunc cleanup = (PluginCleanupFunc)dlsym(plugins[i].handle, "plugin_cleanup");
+            job_pool_flush(plugins[i].handle);  // Outstanding jobs complete first
             if (cleanup) {
                 cleanup(&plugins[i]);
             }
             
-            dlclose(plugins[i].handle);
+            close_plugin(plugins[i].handle, plugin_fds[i]);
             
             // Remove from array
             memmove(&plugins[i], &plugins[i + 1], (num_plugins - i - 1) * sizeof(Plugin));
+            memmove(plugin_paths[i], plugin_paths[i + 1], (num_plugins - i - 1) * sizeof(plugin_paths[0]));
+            memmove(&plugin_fds[i], &plugin_fds[i + 1], (num_plugins - i - 1) * sizeof(int));
+            memmove(&plugin_caps[i], &plugin_caps[i + 1], (num_plugins - i - 1) * sizeof(uint32_t));
+            memmove(&plugin_stats[i], &plugin_stats[i + 1], (num_plugins - i - 1) * sizeof(PluginStats));
             num_plugins--;
+            rebuild_hooks();
             return;
         }
     }
@@ -99,32 +333,32 @@ int plugin_load_directory(const char *dir_path) {
     }
     
     while ((entry = readdir(dir)) != NULL) {
-        // Skip . and ..
-        if (entry->d_name[0] == '.') {
+        // Only "*.so": hidden files, "foo.so.bak" and the like are not plugins
+        if (!plugin_is_library_name(entry->d_name)) {
             continue;
         }
         
         snprintf(plugin_path, sizeof(plugin_path), "%s/%s", dir_path, entry->d_name);
         
         // Check if it's a file
-        if (stat(plugin_path, &st) != 0) {
+        if (stat(plugin_path, &st) != 0 || !S_ISREG(st.st_mode)) {
             continue;
         }
         
-        // Check if it's a shared library
-        if (S_ISREG(st.st_mode) && strstr(entry->d_name, ".so") != NULL) {
-            // Extract plugin name (remove .so extension)
-            char plugin_name[256];
-            strncpy(plugin_name, entry->d_name, sizeof(plugin_name) - 1);
-            plugin_name[sizeof(plugin_name) - 1] = '\0';
-            char *dot = strrchr(plugin_name, '.');
-            if (dot) {
-                *dot = '\0';
-            }
-            
-            if (plugin_load(plugin_path, plugin_name)) {
-                loaded++;
-            }
+        // Known and unchanged: plugin_get() opens it when it is first asked for
+        if (manifest_path[0] && plugin_manifest_lookup(&manifest, plugin_path, &st)) {
+            loaded++;
+            continue;
+        }
+        
+        // Extract plugin name (remove .so extension)
+        char plugin_name[256];
+        strncpy(plugin_name, entry->d_name, sizeof(plugin_name) - 1);
+        plugin_name[sizeof(plugin_name) - 1] = '\0';
+        plugin_name[strlen(plugin_name) - 3] = '\0';
+        
+        if (plugin_load(plugin_path, plugin_name)) {
+            loaded++;
         }
     }
     
@@ -132,31 +366,72 @@ int plugin_load_directory(const char *dir_path) {
     return loaded;
 }
 
-/* Load all plugins (system and user) */
+/* Find all plugins (system and user), opening only the ones the manifest does not know */
 int plugin_load_all(void) {
     int loaded = 0;
     char user_plugin_dir[512];
     struct passwd *pw;
     
-    // Load system plugins
-    if (plugin_load_directory(PLUGIN_DIR_SYSTEM) > 0) {
-        loaded++;
+    if (plugin_manifest_path(PLUGIN_MANIFEST_FILE, manifest_path, sizeof(manifest_path))) {
+        plugin_manifest_load(&manifest, manifest_path);
+    } else {
+        manifest_path[0] = '\0';
     }
     
+    // Load system plugins
+    loaded += plugin_load_directory(PLUGIN_DIR_SYSTEM);
+    
     // Load user plugins
     pw = getpwuid(getuid());
     if (pw) {
         snprintf(user_plugin_dir, sizeof(user_plugin_dir), PLUGIN_DIR_USER_FORMAT, pw->pw_dir);
-        if (plugin_load_directory(user_plugin_dir) > 0) {
-            loaded++;
-        }
+        loaded += plugin_load_directory(user_plugin_dir);
     }
     
+    save_manifest();
+    rebuild_hooks();  // Subscribers that were only listed still count
     return loaded;
 }
 
-/* Get plugin by name */
+/* Watch the system and user plugin directories */
+int plugin_watch_dirs(void) {
+    char user_plugin_dir[512];
+    struct passwd *pw;
+    int watched;
+    
+    watched = plugin_watch_add_dir(PLUGIN_DIR_SYSTEM);
+    pw = getpwuid(getuid());
+    if (pw) {
+        snprintf(user_plugin_dir, sizeof(user_plugin_dir), PLUGIN_DIR_USER_FORMAT, pw->pw_dir);
+        watched += plugin_watch_add_dir(user_plugin_dir);
+    }
+    
+    return watched;
+}
+
+/* 1 if path is a file directly in the system or user plugin directory */
+int plugin_in_dirs(const char *path) {
+    char user_plugin_dir[512];
+    const char *slash = strrchr(path, '/');
+    struct passwd *pw;
+    size_t len;
+    
+    if (!slash) return 0;
+    len = (size_t)(slash - path);
+    if (strlen(PLUGIN_DIR_SYSTEM) == len && strncmp(path, PLUGIN_DIR_SYSTEM, len) == 0) {
+        return 1;
+    }
+    pw = getpwuid(getuid());
+    if (pw) {
+        snprintf(user_plugin_dir, sizeof(user_plugin_dir), PLUGIN_DIR_USER_FORMAT, pw->pw_dir);
+        return strlen(user_plugin_dir) == len && strncmp(path, user_plugin_dir, len) == 0;
+    }
+    return 0;
+}
+
+/* Get plugin by name, opening it on first use */
 Plugin* plugin_get(const char *plugin_name) {
+    char path[PLUGIN_PATH_MAX];
     int i;
     
     for (i = 0; i < num_plugins; i++) {
@@ -165,10 +440,75 @@ Plugin* plugin_get(const char *plugin_name) {
         }
     }
     
+    for (i = 0; manifest_path[0] && i < manifest.count; i++) {
+        if (!manifest.entries[i].seen || strcmp(manifest.entries[i].name, plugin_name) != 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s", manifest.entries[i].path);
+        if (plugin_load(path, plugin_name)) {
+            save_manifest();
+            return &plugins[num_plugins - 1];
+        }
+        plugin_manifest_forget(&manifest, path);  // Opened again at the next startup
+        save_manifest();
+        rebuild_hooks();
+        return NULL;
+    }
+    
     return NULL;
 }
 
-/* Get all plugins */
+/* Names of the plugins of type (0 = any) that export every capability in caps */
+int plugin_list(PluginType type, uint32_t caps, const char **names, int max) {
+    int i, j, count = 0;
+    
+    for (i = 0; i < num_plugins && count < max; i++) {
+        if ((!type || plugins[i].type == type) && (plugin_caps[i] & caps) == caps) {
+            names[count++] = plugins[i].name;
+        }
+    }
+    for (i = 0; manifest_path[0] && i < manifest.count && count < max; i++) {
+        const PluginManifestEntry *e = &manifest.entries[i];
+        if (!e->seen || (type && e->type != (uint32_t)type) || (e->caps & caps) != caps) continue;
+        for (j = 0; j < num_plugins && strcmp(plugins[j].name, e->name) != 0; j++);
+        if (j == num_plugins) {
+            names[count++] = e->name;  // Not opened yet
+        }
+    }
+    
+    return count;
+}
+
+/* Call accounting for plugin index of plugin_get_all() */
+PluginStats* plugin_get_stats(int index) {
+    return (index >= 0 && index < num_plugins) ? &plugin_stats[index] : NULL;
+}
+
+/* Run plugin_update of every plugin that has one, opening them on the first tick */
+void plugin_update_all(void) {
+    const char *names[MAX_PLUGINS];
+    char wanted[MAX_PLUGINS][PLUGIN_NAME_MAX];
+    uint64_t start;
+    int count, i;
+    
+    // Copied: opening a plugin can rewrite the manifest the names point into
+    count = plugin_list((PluginType)0, PLUGIN_CAP_UPDATE, names, MAX_PLUGINS);
+    for (i = 0; i < count; i++) {
+        snprintf(wanted[i], sizeof(wanted[i]), "%s", names[i]);
+    }
+    for (i = 0; i < count; i++) {
+        Plugin *plugin = plugin_get(wanted[i]);
+        if (!plugin) continue;
+        
+        int index = (int)(plugin - plugins);
+        PluginUpdateFunc update = (PluginUpdateFunc)dlsym(plugin->handle, "plugin_update");
+        if (!update || !plugin_stats_begin(&plugin_stats[index], &start)) continue;
+        update(plugin);
+        plugin_stats_end(&plugin_stats[index], plugin->name, start);
+    }
+}
+
+/* Get all opened plugins */
 Plugin* plugin_get_all(int *count) {
     if (count) {
         *count = num_plugins;
@@ -182,12 +522,45 @@ void plugin_cleanup_all(void) {
     
     for (i = 0; i < num_plugins; i++) {
         PluginCleanupFunc cleanup = (PluginCleanupFunc)dlsym(plugins[i].handle, "plugin_cleanup");
+        job_pool_flush(plugins[i].handle);
         if (cleanup) {
             cleanup(&plugins[i]);
         }
-        dlclose(plugins[i].handle);
+        close_plugin(plugins[i].handle, plugin_fds[i]);
     }
     
     num_plugins = 0;
+    manifest_path[0] = '\0';
+    rebuild_hooks();
+}
+
+void plugin_dispatch(const PluginEvent *event) {
+    uint32_t bit;
+    int i;
+    
+    if ((unsigned int)event->hook >= PLUGIN_HOOK_COUNT) return;
+    bit = PLUGIN_HOOK_BIT(event->hook);
+    
+    // First time this event fires for a listed plugin: open it now. Backwards, since a
+    // plugin that fails to open is forgotten and the last entry moves into its slot
+    if (hooks_pending & bit) {
+        char name[PLUGIN_MANIFEST_NAME_MAX];
+        for (i = manifest.count - 1; i >= 0; i--) {
+            const PluginManifestEntry *e = &manifest.entries[i];
+            if (e->seen && (e->hooks & bit) && !is_open(e->path)) {
+                memcpy(name, e->name, sizeof(name));
+                plugin_get(name);  // Rebuilds the subscriber lists
+            }
+        }
+        hooks_pending &= ~bit;
+    }
+    
+    for (i = 0; i < hook_counts[event->hook]; i++) {
+        HookSubscriber *sub = &hook_subscribers[event->hook][i];
+        uint64_t start;
+        if (!plugin_stats_begin(sub->stats, &start)) continue;
+        sub->func(sub->plugin, event);
+        plugin_stats_end(sub->stats, sub->plugin->name, start);
+    }
 }
 
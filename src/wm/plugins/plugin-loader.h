@@ -6,6 +6,7 @@
 #define VAULTWM_PLUGIN_LOADER_H
 
 #include <stdint.h>
+#include "plugin-stats.h"
 
 #define PLUGIN_NAME_MAX 64
 #define PLUGIN_VERSION_MAX 16
@@ -18,41 +19,125 @@ typedef enum {
     PLUGIN_TYPE_APP = 4
 } PluginType;
 
-/* Plugin structure */
+/* Optional exports, recorded in the plugin manifest so hosts can find e.g. every
+ * status bar slot without opening a plugin */
+#define PLUGIN_CAP_OUTPUT  (1u << 0)  // plugin_output
+#define PLUGIN_CAP_UPDATE  (1u << 1)  // plugin_update
+#define PLUGIN_CAP_CLEANUP (1u << 2)  // plugin_cleanup
+#define PLUGIN_CAP_RELOAD  (1u << 3)  // plugin_reload
+#define PLUGIN_CAP_EVENT   (1u << 4)  // plugin_event
+
+/* Window manager events a plugin can subscribe to */
+typedef enum {
+    PLUGIN_HOOK_WINDOW_MAPPED,       // A window was taken under management
+    PLUGIN_HOOK_WINDOW_UNMAPPED,     // A managed window went away
+    PLUGIN_HOOK_FOCUS_CHANGED,
+    PLUGIN_HOOK_WORKSPACE_SWITCHED,
+    PLUGIN_HOOK_PRE_LAYOUT,          // A workspace is about to be arranged
+    PLUGIN_HOOK_LAYOUT_COMMITTED,    // New geometry was sent to the X server
+    PLUGIN_HOOK_COUNT
+} PluginHook;
+
+#define PLUGIN_HOOK_BIT(hook) (1u << (hook))
+
 typedef struct {
+    PluginHook hook;
+    unsigned long window;    // X window id, 0 if the event has none
+    int workspace;           // 1-based
+    int count;               // PRE_LAYOUT: clients to arrange; LAYOUT_COMMITTED: windows reconfigured
+} PluginEvent;
+
+typedef struct Plugin Plugin;
+
+/* Blocking half of a plugin job, on a worker thread: may read files and /proc,
+ * must not touch the Plugin or call back into the WM */
+typedef void (*PluginJobRun)(void *arg);
+
+/* Its completion, on the event thread; owns arg */
+typedef void (*PluginJobDone)(Plugin *plugin, void *arg);
+
+/* Plugin structure */
+struct Plugin {
     char name[PLUGIN_NAME_MAX];
     char version[PLUGIN_VERSION_MAX];
     PluginType type;
     void *handle;
     void *data;  // Plugin-specific data
-} Plugin;
+    uint32_t hooks;  // PLUGIN_HOOK_BIT()s to receive through plugin_event; set in plugin_init
+    /* Set by the host before plugin_init: queue run(arg) on a worker, then done(plugin,
+     * arg) back on the event thread. Every job finishes before the plugin is cleaned
+     * up or replaced. Returns 0 if the queue is full */
+    int (*submit)(Plugin *plugin, PluginJobRun run, PluginJobDone done, void *arg);
+};
 
 /* Plugin function types */
 typedef int (*PluginInitFunc)(Plugin *plugin);
 typedef void (*PluginCleanupFunc)(Plugin *plugin);
 typedef const char* (*PluginOutputFunc)(Plugin *plugin);
 typedef void (*PluginUpdateFunc)(Plugin *plugin);
+typedef int (*PluginReloadFunc)(Plugin *plugin, Plugin *previous);
+typedef void (*PluginEventFunc)(Plugin *plugin, const PluginEvent *event);
+
+/* Union of every hook some plugin, opened or not, subscribed to */
+extern uint32_t plugin_hook_mask;
 
 /* Load plugin from path */
 int plugin_load(const char *plugin_path, const char *plugin_name);
 
+/* Replace the plugin loaded from plugin_path with the file now there. The new
+ * library's optional plugin_reload(plugin, previous) runs instead of plugin_init
+ * and may take over previous->data (set it to NULL); plugin_cleanup(previous)
+ * then runs on the old one. On failure the old plugin stays. Returns 1 on success */
+int plugin_reload(const char *plugin_path);
+
+/* Add the plugin directories to the plugin watcher (plugin-watch.h) */
+int plugin_watch_dirs(void);
+
+/* 1 if path is in one of those directories, i.e. not a layout plugin */
+int plugin_in_dirs(const char *path);
+
 /* Unload plugin */
 void plugin_unload(const char *plugin_name);
 
-/* Load all plugins from directory */
+/* Load all *.so plugins from directory; with a manifest (after plugin_load_all)
+ * plugins it still describes are only listed. Returns the number available */
 int plugin_load_directory(const char *dir_path);
 
-/* Load all plugins (system and user) */
+/* Find all plugins (system and user). Only new or changed plugins are opened;
+ * the rest wait for plugin_get(). Returns the number available */
 int plugin_load_all(void);
 
-/* Get plugin by name */
+/* Get plugin by name, opening it the first time it is asked for */
 Plugin* plugin_get(const char *plugin_name);
 
-/* Get all plugins */
+/* Names of available plugins of type (0 = any) exporting all caps, opened or
+ * not; valid until the next load. Returns the number stored in names */
+int plugin_list(PluginType type, uint32_t caps, const char **names, int max);
+
+/* Get all opened plugins */
 Plugin* plugin_get_all(int *count);
 
+/* Call accounting for plugin index of plugin_get_all(), or NULL */
+PluginStats* plugin_get_stats(int index);
+
+/* Call plugin_update of every plugin exporting it, timed against the budget;
+ * plugins only listed so far are opened on the first call */
+void plugin_update_all(void);
+
 /* Cleanup all plugins */
 void plugin_cleanup_all(void);
 
+/* Deliver an event to its subscribers, in load order, opening any that are
+ * not open yet. plugin_event must not load or unload plugins. Use plugin_notify() */
+void plugin_dispatch(const PluginEvent *event);
+
+/* The host's call site: one test of a bit when nobody listens */
+static inline void plugin_notify(PluginHook hook, unsigned long window, int workspace, int count) {
+    if (plugin_hook_mask & PLUGIN_HOOK_BIT(hook)) {
+        PluginEvent event = { hook, window, workspace, count };
+        plugin_dispatch(&event);
+    }
+}
+
 #endif /* VAULTWM_PLUGIN_LOADER_H */
 
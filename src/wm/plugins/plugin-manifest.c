@@ -0,0 +1,211 @@
+/*
+ * VaultWM Plugin Manifest Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "plugin-manifest.h"
+
+/* One line per plugin, tab-separated, path last so it may contain spaces:
+ * hash  mtime  size  inode  type  caps  hooks  name  path */
+#define MANIFEST_HEADER "# vaultwm plugin manifest %d\n"
+
+int plugin_manifest_path(const char *file, char *path, size_t size) {
+    const char *cache = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    char dir[PLUGIN_PATH_MAX];
+    
+    if (cache && cache[0] == '/') {
+        snprintf(dir, sizeof(dir), "%s", cache);
+    } else if (home) {
+        snprintf(dir, sizeof(dir), "%s/.cache", home);
+        mkdir(dir, 0755);
+    } else {
+        return 0;
+    }
+    
+    strncat(dir, "/" PLUGIN_MANIFEST_DIR, sizeof(dir) - strlen(dir) - 1);
+    mkdir(dir, 0755);
+    return snprintf(path, size, "%s/%s", dir, file) < (int)size;
+}
+
+/* FNV-1a over the file; only read when the stat no longer matches */
+static int hash_file(const char *path, uint64_t *hash) {
+    unsigned char buf[8192];
+    uint64_t h = 0xcbf29ce484222325ULL;
+    ssize_t n, i;
+    
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        for (i = 0; i < n; i++) {
+            h = (h ^ buf[i]) * 0x100000001b3ULL;
+        }
+    }
+    close(fd);
+    if (n < 0) return 0;
+    *hash = h;
+    return 1;
+}
+
+static PluginManifestEntry* find(PluginManifest *m, const char *path) {
+    int i;
+    
+    for (i = 0; i < m->count; i++) {
+        if (strcmp(m->entries[i].path, path) == 0) return &m->entries[i];
+    }
+    return NULL;
+}
+
+static void set_stat(PluginManifestEntry *e, const struct stat *st) {
+    e->mtime = (int64_t)st->st_mtime;
+    e->size = (int64_t)st->st_size;
+    e->ino = (uint64_t)st->st_ino;
+}
+
+static int stat_matches(const PluginManifestEntry *e, const struct stat *st) {
+    return e->mtime == (int64_t)st->st_mtime && e->size == (int64_t)st->st_size &&
+        e->ino == (uint64_t)st->st_ino;
+}
+
+int plugin_manifest_load(PluginManifest *m, const char *cache_path) {
+    char line[PLUGIN_PATH_MAX + PLUGIN_MANIFEST_NAME_MAX + 128];
+    int version = 0;
+    
+    m->count = 0;
+    m->dirty = 0;
+    
+    FILE *f = fopen(cache_path, "r");
+    if (!f) return 0;
+    
+    // A manifest from another version is rebuilt rather than half-trusted
+    if (!fgets(line, sizeof(line), f) || sscanf(line, MANIFEST_HEADER, &version) != 1 ||
+        version != PLUGIN_MANIFEST_VERSION) {
+        fclose(f);
+        m->dirty = 1;
+        return 0;
+    }
+    
+    while (m->count < PLUGIN_MANIFEST_MAX && fgets(line, sizeof(line), f)) {
+        PluginManifestEntry *e = &m->entries[m->count];
+        char *name, *path, *end;
+        int consumed = 0;
+        
+        end = line + strcspn(line, "\n");
+        if (*end != '\n') break;  // Truncated: drop it and the rest
+        *end = '\0';
+        
+        if (sscanf(line, "%" SCNx64 "\t%" SCNd64 "\t%" SCNd64 "\t%" SCNu64 "\t%" SCNu32 "\t%" SCNu32 "\t%" SCNx32 "\t%n",
+                   &e->hash, &e->mtime, &e->size, &e->ino, &e->type, &e->caps, &e->hooks, &consumed) != 7 || !consumed) {
+            m->dirty = 1;
+            continue;
+        }
+        name = line + consumed;
+        path = strchr(name, '\t');
+        if (!path || path == name || (size_t)(path - name) >= sizeof(e->name) ||
+            strlen(path + 1) >= sizeof(e->path) || path[1] != '/') {
+            m->dirty = 1;
+            continue;
+        }
+        *path++ = '\0';
+        memcpy(e->name, name, strlen(name) + 1);
+        memcpy(e->path, path, strlen(path) + 1);
+        e->seen = 0;
+        m->count++;
+    }
+    
+    fclose(f);
+    return m->count;
+}
+
+int plugin_manifest_save(PluginManifest *m, const char *cache_path) {
+    char tmp[PLUGIN_PATH_MAX + 8];
+    int i, kept = 0;
+    
+    for (i = 0; i < m->count; i++) {
+        if (!m->entries[i].seen) {
+            m->dirty = 1;  // Uninstalled
+            continue;
+        }
+        m->entries[kept++] = m->entries[i];
+    }
+    m->count = kept;
+    if (!m->dirty) return 1;
+    
+    snprintf(tmp, sizeof(tmp), "%s.tmp", cache_path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) return 0;
+    
+    fprintf(f, MANIFEST_HEADER, PLUGIN_MANIFEST_VERSION);
+    for (i = 0; i < m->count; i++) {
+        const PluginManifestEntry *e = &m->entries[i];
+        fprintf(f, "%016" PRIx64 "\t%" PRId64 "\t%" PRId64 "\t%" PRIu64 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIx32 "\t%s\t%s\n",
+            e->hash, e->mtime, e->size, e->ino, e->type, e->caps, e->hooks, e->name, e->path);
+    }
+    
+    int ok = fflush(f) == 0 && !ferror(f);
+    if (fclose(f) != 0) ok = 0;
+    if (ok && rename(tmp, cache_path) == 0) {
+        m->dirty = 0;
+        return 1;
+    }
+    unlink(tmp);
+    return 0;
+}
+
+PluginManifestEntry* plugin_manifest_lookup(PluginManifest *m, const char *path, const struct stat *st) {
+    PluginManifestEntry *e = find(m, path);
+    uint64_t hash;
+    
+    if (!e) return NULL;
+    if (!stat_matches(e, st)) {
+        // Touched or reinstalled: still good if the bytes are the same build
+        if (e->size != (int64_t)st->st_size || !hash_file(path, &hash) || hash != e->hash) {
+            return NULL;
+        }
+        set_stat(e, st);
+        m->dirty = 1;
+    }
+    e->seen = 1;
+    return e;
+}
+
+PluginManifestEntry* plugin_manifest_update(PluginManifest *m, const char *path, const struct stat *st,
+                                            const char *name, uint32_t type, uint32_t caps, uint32_t hooks) {
+    PluginManifestEntry *e = find(m, path);
+    uint64_t hash;
+    
+    // Tabs and newlines would break the line format; such a plugin is just never cached
+    if (strlen(name) >= PLUGIN_MANIFEST_NAME_MAX || strlen(path) >= PLUGIN_PATH_MAX ||
+        strpbrk(name, "\t\n") || strpbrk(path, "\t\n") || !hash_file(path, &hash)) {
+        return NULL;
+    }
+    if (!e) {
+        if (m->count >= PLUGIN_MANIFEST_MAX) return NULL;
+        e = &m->entries[m->count++];
+        snprintf(e->path, sizeof(e->path), "%s", path);
+    }
+    
+    snprintf(e->name, sizeof(e->name), "%s", name);
+    e->type = type;
+    e->caps = caps;
+    e->hooks = hooks;
+    e->hash = hash;
+    set_stat(e, st);
+    e->seen = 1;
+    m->dirty = 1;
+    return e;
+}
+
+void plugin_manifest_forget(PluginManifest *m, const char *path) {
+    PluginManifestEntry *e = find(m, path);
+    
+    if (e) {
+        *e = m->entries[--m->count];
+        m->dirty = 1;
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * VaultWM Plugin Manifest
+ * On-disk cache of what each installed plugin is (name, type, capabilities),
+ * keyed by the file's stat and content hash, so startup can list plugins
+ * without dlopen()ing them
+ */
+
+#ifndef VAULTWM_PLUGIN_MANIFEST_H
+#define VAULTWM_PLUGIN_MANIFEST_H
+
+#include <stdint.h>
+#include <sys/stat.h>
+#include "plugin-watch.h"
+
+#define PLUGIN_MANIFEST_MAX 128
+#define PLUGIN_MANIFEST_NAME_MAX 64
+#define PLUGIN_MANIFEST_VERSION 2
+#define PLUGIN_MANIFEST_DIR "vaultos"   // Under $XDG_CACHE_HOME, default ~/.cache
+
+typedef struct {
+    char path[PLUGIN_PATH_MAX];
+    char name[PLUGIN_MANIFEST_NAME_MAX];
+    uint32_t type;       // Host-defined (PluginType for the generic loader)
+    uint32_t caps;       // Host-defined capability bits
+    uint32_t hooks;      // Events the plugin subscribed to, so it can be opened when one fires
+    int64_t mtime;
+    int64_t size;
+    uint64_t ino;
+    uint64_t hash;       // FNV-1a of the contents, to recognise a reinstalled identical build
+    int seen;            // Found by the current scan; not stored
+} PluginManifestEntry;
+
+typedef struct {
+    PluginManifestEntry entries[PLUGIN_MANIFEST_MAX];
+    int count;
+    int dirty;           // Differs from the file it was loaded from
+} PluginManifest;
+
+/* $XDG_CACHE_HOME/vaultos/<file>, creating the directory. Returns 1 on success */
+int plugin_manifest_path(const char *file, char *path, size_t size);
+
+/* Read a manifest; a missing, foreign or damaged file gives an empty one.
+ * Returns the number of entries */
+int plugin_manifest_load(PluginManifest *m, const char *cache_path);
+
+/* Drop entries the last scan did not see, then write the manifest if it
+ * changed (to a temporary file renamed over the old one). Returns 1 on success */
+int plugin_manifest_save(PluginManifest *m, const char *cache_path);
+
+/* Entry for path if it still describes the file st was taken from: same
+ * inode, size and mtime, or else the same contents. Marks it seen. NULL means
+ * the plugin has to be opened to find out what it is */
+PluginManifestEntry* plugin_manifest_lookup(PluginManifest *m, const char *path, const struct stat *st);
+
+/* Record what opening path showed; st is the stat it was opened under.
+ * Returns the entry, or NULL if the manifest is full or name cannot be stored */
+PluginManifestEntry* plugin_manifest_update(PluginManifest *m, const char *path, const struct stat *st,
+                                            const char *name, uint32_t type, uint32_t caps, uint32_t hooks);
+
+/* Forget path, so the next startup opens it again */
+void plugin_manifest_forget(PluginManifest *m, const char *path);
+
+#endif /* VAULTWM_PLUGIN_MANIFEST_H */
@@ -0,0 +1,132 @@
+/*
+ * VaultWM Plugin Accounting Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include "plugin-stats.h"
+
+static uint64_t budget_ns = 0;
+static unsigned int disable_after = 0;
+
+void plugin_stats_set_budget(unsigned int budget_ms, unsigned int max_strikes) {
+    budget_ns = (uint64_t)budget_ms * 1000000ULL;
+    disable_after = max_strikes;
+}
+
+uint64_t plugin_stats_now(void) {
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);  // vDSO: no system call
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int plugin_stats_begin(PluginStats *stats, uint64_t *start) {
+    if (stats->health == PLUGIN_HEALTH_DISABLED) {
+        stats->skipped++;
+        return 0;
+    }
+    
+    *start = plugin_stats_now();
+    if (stats->health == PLUGIN_HEALTH_THROTTLED) {
+        if (*start < stats->next_call_ns) {
+            stats->skipped++;
+            return 0;
+        }
+        stats->next_call_ns = *start + PLUGIN_THROTTLE_INTERVAL_MS * 1000000ULL;
+    }
+    return 1;
+}
+
+static int bucket_of(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    int b = 0;
+    
+    while (us && b < PLUGIN_STATS_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void plugin_stats_end(PluginStats *stats, const char *name, uint64_t start) {
+    uint64_t ns = plugin_stats_now() - start;
+    PluginHealth was = stats->health;
+    
+    stats->calls++;
+    stats->total_ns += ns;
+    if (ns > stats->max_ns) stats->max_ns = ns;
+    stats->buckets[bucket_of(ns)]++;
+    
+    if (!budget_ns || ns <= budget_ns) {
+        // A long enough clean run forgives earlier stalls, but keeps the record
+        if (stats->strikes && ++stats->good_run >= PLUGIN_STRIKE_RESET) {
+            stats->strikes = 0;
+            stats->good_run = 0;
+            if (stats->health == PLUGIN_HEALTH_THROTTLED) stats->health = PLUGIN_HEALTH_WARNED;
+        }
+        return;
+    }
+    
+    stats->overruns++;
+    stats->strikes++;
+    stats->good_run = 0;
+    if (disable_after && stats->strikes >= disable_after) {
+        stats->health = PLUGIN_HEALTH_DISABLED;
+    } else if (stats->strikes >= PLUGIN_THROTTLE_AFTER && stats->health != PLUGIN_HEALTH_THROTTLED) {
+        stats->health = PLUGIN_HEALTH_THROTTLED;
+        stats->next_call_ns = start + ns + PLUGIN_THROTTLE_INTERVAL_MS * 1000000ULL;
+    } else if (stats->health == PLUGIN_HEALTH_OK) {
+        stats->health = PLUGIN_HEALTH_WARNED;
+    }
+    
+    if (stats->health != was) {
+        fprintf(stderr, "VaultWM: Plugin %s took %" PRIu64 " us (budget %" PRIu64 " us), now %s\n",
+            name, ns / 1000, budget_ns / 1000, plugin_health_name(stats->health));
+    }
+}
+
+void plugin_stats_reset(PluginStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+uint64_t plugin_stats_percentile_us(const PluginStats *stats, int pct) {
+    uint64_t seen = 0, want;
+    int b;
+    
+    if (!stats->calls) return 0;
+    want = (stats->calls * (uint64_t)pct + 99) / 100;
+    for (b = 0; b < PLUGIN_STATS_BUCKETS - 1; b++) {
+        seen += stats->buckets[b];
+        if (seen >= want) return 1ULL << b;
+    }
+    return (stats->max_ns + 999) / 1000;  // Open-ended top bucket: the worst call seen
+}
+
+const char* plugin_health_name(PluginHealth health) {
+    switch (health) {
+        case PLUGIN_HEALTH_OK: return "ok";
+        case PLUGIN_HEALTH_WARNED: return "warned";
+        case PLUGIN_HEALTH_THROTTLED: return "throttled";
+        case PLUGIN_HEALTH_DISABLED: return "disabled";
+    }
+    return "unknown";
+}
+
+int plugin_stats_format(const PluginStats *stats, char *buf, size_t size) {
+    int len, b;
+    
+    len = snprintf(buf, size, "%s calls=%" PRIu64 " skipped=%" PRIu64 " overruns=%" PRIu64
+        " mean_us=%" PRIu64 " p99_us=%" PRIu64 " max_us=%" PRIu64 " hist=",
+        plugin_health_name(stats->health), stats->calls, stats->skipped, stats->overruns,
+        stats->calls ? stats->total_ns / stats->calls / 1000 : 0,
+        plugin_stats_percentile_us(stats, 99), stats->max_ns / 1000);
+    
+    // Bucket counts, comma-separated, <1us first
+    for (b = 0; b < PLUGIN_STATS_BUCKETS && len > 0 && (size_t)len < size; b++) {
+        len += snprintf(buf + len, size - (size_t)len, b ? ",%u" : "%u", stats->buckets[b]);
+    }
+    return len;
+}
@@ -0,0 +1,66 @@
+/*
+ * VaultWM Plugin Accounting
+ * Per-plugin call counts and latency histograms, and the time budget that
+ * warns about, then rations, then stops a plugin that keeps stalling the
+ * event loop
+ */
+
+#ifndef VAULTWM_PLUGIN_STATS_H
+#define VAULTWM_PLUGIN_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PLUGIN_STATS_BUCKETS 16          // Power-of-two microseconds: <1us, <2us, ... <16ms, the rest
+#define PLUGIN_THROTTLE_AFTER 3          // Strikes before calls are rationed
+#define PLUGIN_THROTTLE_INTERVAL_MS 1000 // A rationed plugin is called at most this often
+#define PLUGIN_STRIKE_RESET 100          // Calls within budget in a row that clear the strikes
+
+typedef enum {
+    PLUGIN_HEALTH_OK,
+    PLUGIN_HEALTH_WARNED,     // Overran at least once
+    PLUGIN_HEALTH_THROTTLED,  // Overran repeatedly; most calls are skipped
+    PLUGIN_HEALTH_DISABLED    // Not called again until reloaded or reset
+} PluginHealth;
+
+typedef struct {
+    uint64_t calls;
+    uint64_t skipped;         // Calls not made while throttled or disabled
+    uint64_t overruns;        // Calls over budget, ever
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t next_call_ns;    // Throttled: earliest time of the next call
+    uint32_t buckets[PLUGIN_STATS_BUCKETS];
+    uint32_t strikes;         // Overruns since the last run of good calls
+    uint32_t good_run;
+    PluginHealth health;
+} PluginStats;
+
+/* Per-call budget (0 = unlimited) and the strikes after which a plugin is
+ * disabled (0 = never) */
+void plugin_stats_set_budget(unsigned int budget_ms, unsigned int max_strikes);
+
+/* CLOCK_MONOTONIC in nanoseconds */
+uint64_t plugin_stats_now(void);
+
+/* Whether the plugin may be called now; sets *start if so, counts a skip if not */
+int plugin_stats_begin(PluginStats *stats, uint64_t *start);
+
+/* Account a call that began at start, escalating if it overran. name is
+ * only used for the log line on a change of health */
+void plugin_stats_end(PluginStats *stats, const char *name, uint64_t start);
+
+/* Forget everything, re-enabling the plugin */
+void plugin_stats_reset(PluginStats *stats);
+
+/* Upper bound of the bucket holding the pct-th percentile call, in microseconds */
+uint64_t plugin_stats_percentile_us(const PluginStats *stats, int pct);
+
+/* "ok", "warned", "throttled" or "disabled" */
+const char* plugin_health_name(PluginHealth health);
+
+/* One line: health, calls, skips, overruns, mean/p99/max and the histogram
+ * (p99 is the upper edge of its bucket). Returns the length written */
+int plugin_stats_format(const PluginStats *stats, char *buf, size_t size);
+
+#endif /* VAULTWM_PLUGIN_STATS_H */
@@ -0,0 +1,135 @@
+/*
+ * VaultWM Plugin Watcher Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "plugin-watch.h"
+
+/* A finished write or a rename into place; the partial file of an in-progress copy is never seen */
+#define PLUGIN_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO)
+#define PLUGIN_WATCH_BATCH 32  // Distinct files reported per read; more wait for the next one
+
+typedef struct {
+    int wd;
+    char path[PLUGIN_PATH_MAX];
+} WatchedDir;
+
+static int watch_fd = -1;
+static WatchedDir dirs[PLUGIN_WATCH_DIRS_MAX];
+static int num_dirs = 0;
+
+int plugin_watch_add_dir(const char *dir) {
+    int wd, i;
+    
+    if (!dir || num_dirs >= PLUGIN_WATCH_DIRS_MAX || strlen(dir) >= PLUGIN_PATH_MAX) return 0;
+    
+    if (watch_fd < 0) {
+        watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watch_fd < 0) return 0;
+    }
+    
+    wd = inotify_add_watch(watch_fd, dir, PLUGIN_WATCH_MASK | IN_ONLYDIR);
+    if (wd < 0) return 0;
+    for (i = 0; i < num_dirs; i++) {
+        if (dirs[i].wd == wd) return 1;  // Same directory by another name
+    }
+    dirs[num_dirs].wd = wd;
+    snprintf(dirs[num_dirs].path, sizeof(dirs[num_dirs].path), "%s", dir);
+    num_dirs++;
+    return 1;
+}
+
+int plugin_watch_get_fd(void) {
+    return watch_fd;
+}
+
+static const char* dir_path(int wd) {
+    int i;
+    for (i = 0; i < num_dirs; i++) {
+        if (dirs[i].wd == wd) return dirs[i].path;
+    }
+    return NULL;
+}
+
+int plugin_watch_read(PluginChangedFunc changed, void *data) {
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    char paths[PLUGIN_WATCH_BATCH][PLUGIN_PATH_MAX];
+    struct stat st;
+    int count = 0, reported = 0, i;
+    ssize_t len;
+    
+    if (watch_fd < 0) return 0;
+    
+    /* Collect first: an install is often several events (write, then rename) for one file */
+    while ((len = read(watch_fd, buf, sizeof(buf))) > 0) {
+        char *p = buf;
+        while (p < buf + len) {
+            struct inotify_event *ev = (struct inotify_event *)p;
+            const char *dir = dir_path(ev->wd);
+            p += sizeof(struct inotify_event) + ev->len;
+            
+            if (!dir || !ev->len || !plugin_is_library_name(ev->name) || count >= PLUGIN_WATCH_BATCH) continue;
+            
+            char path[PLUGIN_PATH_MAX];
+            snprintf(path, sizeof(path), "%s/%s", dir, ev->name);
+            for (i = 0; i < count && strcmp(paths[i], path) != 0; i++);
+            if (i == count) {
+                memcpy(paths[count++], path, sizeof(path));
+            }
+        }
+    }
+    
+    for (i = 0; i < count; i++) {
+        if (stat(paths[i], &st) != 0 || !S_ISREG(st.st_mode)) continue;  // Gone again
+        changed(paths[i], data);
+        reported++;
+    }
+    return reported;
+}
+
+void plugin_watch_cleanup(void) {
+    if (watch_fd >= 0) {
+        close(watch_fd);
+        watch_fd = -1;
+    }
+    num_dirs = 0;
+}
+
+int plugin_is_library_name(const char *name) {
+    size_t len = strlen(name);
+    return name[0] != '.' && len > 3 && strcmp(name + len - 3, ".so") == 0;
+}
+
+int plugin_file_replaced(const char *path, int fd) {
+    struct stat now, loaded;
+    
+    if (stat(path, &now) != 0 || fstat(fd, &loaded) != 0) return 0;
+    return now.st_ino != loaded.st_ino || now.st_dev != loaded.st_dev;
+}
+
+void* plugin_dlopen(const char *path, int *fd) {
+    char fd_path[32];
+    void *handle;
+    
+    /* The loader reuses an open library when the name matches; a /proc/self/fd name is
+     * unique while the fd stays open, so a replaced file is always mapped afresh */
+    *fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (*fd < 0) {
+        fprintf(stderr, "VaultWM: Failed to open plugin %s\n", path);
+        return NULL;
+    }
+    snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", *fd);
+    handle = dlopen(fd_path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        fprintf(stderr, "VaultWM: Failed to load plugin %s: %s\n", path, dlerror());
+        close(*fd);
+        *fd = -1;
+    }
+    return handle;
+}
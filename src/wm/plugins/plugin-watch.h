@@ -0,0 +1,44 @@
+/*
+ * VaultWM Plugin Watcher
+ * inotify on the plugin directories, so a rebuilt .so is reloaded in
+ * place instead of waiting for the next WM start
+ */
+
+#ifndef VAULTWM_PLUGIN_WATCH_H
+#define VAULTWM_PLUGIN_WATCH_H
+
+#define PLUGIN_PATH_MAX 512
+#define PLUGIN_WATCH_DIRS_MAX 8
+
+/* Called once per .so that was written or moved into a watched directory */
+typedef void (*PluginChangedFunc)(const char *path, void *data);
+
+/* Watch dir for new and replaced *.so files; the first call creates the inotify
+ * instance. Missing directories are skipped. Returns 1 if dir is watched */
+int plugin_watch_add_dir(const char *dir);
+
+/* inotify fd for the event loop, -1 before the first directory */
+int plugin_watch_get_fd(void);
+
+/* Drain pending events and report each changed plugin once, however many events
+ * its installation took. Deleted files are not reported: a loaded plugin stays
+ * mapped and keeps working. Returns the number of plugins reported */
+int plugin_watch_read(PluginChangedFunc changed, void *data);
+
+/* Stop watching */
+void plugin_watch_cleanup(void);
+
+/* Non-hidden *.so: "foo.so.bak" and editor backups are not plugins */
+int plugin_is_library_name(const char *name);
+
+/* 1 if path now names a different file than the loaded fd: check before
+ * plugin_dlopen(), since loading the same file again returns the old mapping */
+int plugin_file_replaced(const char *path, int fd);
+
+/* dlopen(RTLD_NOW | RTLD_LOCAL) the file now at path, even when a library
+ * loaded from that path is still open: the dynamic loader would otherwise hand
+ * back the old mapping. *fd must stay open until the handle is dlclose()d.
+ * Returns NULL (with the reason printed) on failure */
+void* plugin_dlopen(const char *path, int *fd);
+
+#endif /* VAULTWM_PLUGIN_WATCH_H */
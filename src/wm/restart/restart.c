@@ -0,0 +1,188 @@
+/*
+ * VaultWM Restart Implementation
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "restart.h"
+
+/* Frame: magic, version, payload length, payload checksum (little-endian u32 each) */
+#define RESTART_HEADER_SIZE 16
+
+static int reserve(StateBuffer *sb, size_t extra) {
+    if (sb->error) return 0;
+    if (sb->len + extra <= sb->cap) return 1;
+    
+    size_t cap = sb->cap ? sb->cap * 2 : 4096;
+    while (cap < sb->len + extra) cap *= 2;
+    unsigned char *grown = realloc(sb->data, cap);
+    if (!grown) {
+        sb->error = 1;
+        return 0;
+    }
+    sb->data = grown;
+    sb->cap = cap;
+    return 1;
+}
+
+/* FNV-1a; catches a truncated or foreign fd, not an adversary */
+static uint32_t checksum(const unsigned char *data, size_t len) {
+    uint32_t h = 2166136261u;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void put_le32(unsigned char *p, uint32_t v) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = v >> 24;
+}
+
+static uint32_t get_le32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void state_init(StateBuffer *sb) {
+    memset(sb, 0, sizeof(*sb));
+}
+
+void state_free(StateBuffer *sb) {
+    free(sb->data);
+    memset(sb, 0, sizeof(*sb));
+}
+
+void state_put_uint(StateBuffer *sb, uint32_t v) {
+    if (!reserve(sb, 5)) return;
+    while (v >= 0x80) {
+        sb->data[sb->len++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    sb->data[sb->len++] = (unsigned char)v;
+}
+
+void state_put_int(StateBuffer *sb, int32_t v) {
+    state_put_uint(sb, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+void state_put_str(StateBuffer *sb, const char *s) {
+    size_t len = s ? strlen(s) : 0;
+    state_put_uint(sb, (uint32_t)len);
+    if (!reserve(sb, len)) return;
+    memcpy(sb->data + sb->len, s, len);
+    sb->len += len;
+}
+
+uint32_t state_get_uint(StateBuffer *sb) {
+    uint32_t v = 0;
+    int shift;
+    
+    for (shift = 0; !sb->error && shift < 35; shift += 7) {
+        if (sb->pos >= sb->len) break;
+        unsigned char b = sb->data[sb->pos++];
+        v |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    sb->error = 1;
+    return 0;
+}
+
+int32_t state_get_int(StateBuffer *sb) {
+    uint32_t v = state_get_uint(sb);
+    return (int32_t)((v >> 1) ^ (~(v & 1) + 1));
+}
+
+void state_get_str(StateBuffer *sb, char *out, size_t size) {
+    uint32_t len = state_get_uint(sb);
+    
+    out[0] = '\0';
+    if (sb->error || len > sb->len - sb->pos) {
+        sb->error = 1;
+        return;
+    }
+    size_t copy = len < size ? len : size - 1;
+    memcpy(out, sb->data + sb->pos, copy);
+    out[copy] = '\0';
+    sb->pos += len;
+}
+
+int restart_handoff(const StateBuffer *sb) {
+    unsigned char header[RESTART_HEADER_SIZE];
+    char fd_str[16];
+    
+    if (sb->error || sb->len > RESTART_MAX_STATE) return -1;
+    
+    // No MFD_CLOEXEC: the new image inherits it
+    int fd = memfd_create("vaultwm-state", 0);
+    if (fd < 0) return -1;
+    
+    put_le32(header, RESTART_MAGIC);
+    put_le32(header + 4, RESTART_VERSION);
+    put_le32(header + 8, (uint32_t)sb->len);
+    put_le32(header + 12, checksum(sb->data, sb->len));
+    if (write(fd, header, sizeof(header)) != (ssize_t)sizeof(header) ||
+        (sb->len > 0 && write(fd, sb->data, sb->len) != (ssize_t)sb->len)) {
+        close(fd);
+        return -1;
+    }
+    
+    snprintf(fd_str, sizeof(fd_str), "%d", fd);
+    setenv(RESTART_FD_ENV, fd_str, 1);
+    return fd;
+}
+
+int restart_receive(StateBuffer *sb) {
+    const char *env = getenv(RESTART_FD_ENV);
+    unsigned char header[RESTART_HEADER_SIZE];
+    struct stat st;
+    char *end;
+    int ok = 0;
+    
+    state_init(sb);
+    if (!env) return 0;
+    long fd = strtol(env, &end, 10);
+    unsetenv(RESTART_FD_ENV);  // Not for our children, nor a later restart
+    if (*end != '\0' || fd < 0) return 0;
+    
+    if (fstat((int)fd, &st) == 0 && st.st_size >= RESTART_HEADER_SIZE &&
+        st.st_size <= RESTART_HEADER_SIZE + RESTART_MAX_STATE &&
+        pread((int)fd, header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+        get_le32(header) == RESTART_MAGIC && get_le32(header + 4) == RESTART_VERSION &&
+        get_le32(header + 8) == (uint64_t)st.st_size - RESTART_HEADER_SIZE) {
+        size_t len = get_le32(header + 8);
+        if (reserve(sb, len ? len : 1) &&
+            (len == 0 || pread((int)fd, sb->data, len, RESTART_HEADER_SIZE) == (ssize_t)len) &&
+            checksum(sb->data, len) == get_le32(header + 12)) {
+            sb->len = len;
+            ok = 1;
+        }
+    }
+    close((int)fd);
+    
+    if (!ok) state_free(sb);
+    return ok;
+}
+
+int restart_self_path(char *path, size_t size) {
+    static const char deleted[] = " (deleted)";
+    ssize_t len = readlink("/proc/self/exe", path, size - 1);
+    
+    if (len <= 0) return 0;
+    path[len] = '\0';
+    
+    // Replaced on disk (e.g. by make install): restart into whatever is at that path now
+    size_t dlen = sizeof(deleted) - 1;
+    if ((size_t)len > dlen && strcmp(path + len - dlen, deleted) == 0) {
+        path[len - dlen] = '\0';
+    }
+    return 1;
+}
@@ -0,0 +1,61 @@
+/*
+ * VaultWM Restart
+ * In-place restart: WM state is written in a compact varint encoding to a
+ * memfd that survives execve, and read back by the new process before it
+ * draws anything
+ */
+
+#ifndef VAULTWM_RESTART_H
+#define VAULTWM_RESTART_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RESTART_FD_ENV "VAULTWM_RESTORE_FD"
+#define RESTART_MAGIC 0x534d5756u    // "VWMS" little-endian
+#define RESTART_VERSION 2
+#define RESTART_MAX_STATE (4 * 1024 * 1024)
+
+/* Growable byte buffer with a read cursor. Any overflow, truncation or
+ * allocation failure sets error; later reads return 0 / empty strings. */
+typedef struct {
+    unsigned char *data;
+    size_t len, cap;
+    size_t pos;
+    int error;
+} StateBuffer;
+
+/* Empty buffer */
+void state_init(StateBuffer *sb);
+
+/* Free the buffer */
+void state_free(StateBuffer *sb);
+
+/* LEB128 unsigned varint */
+void state_put_uint(StateBuffer *sb, uint32_t v);
+
+/* Zigzag-encoded signed varint, so small negative coordinates stay short */
+void state_put_int(StateBuffer *sb, int32_t v);
+
+/* Length-prefixed string */
+void state_put_str(StateBuffer *sb, const char *s);
+
+uint32_t state_get_uint(StateBuffer *sb);
+int32_t state_get_int(StateBuffer *sb);
+
+/* Copy a string into out (truncated to size - 1) */
+void state_get_str(StateBuffer *sb, char *out, size_t size);
+
+/* Write the buffer, framed with magic, version, length and checksum, to a memfd
+ * that is inherited across execve and advertised in RESTART_FD_ENV. Returns the fd or -1 */
+int restart_handoff(const StateBuffer *sb);
+
+/* Take over a state fd left by restart_handoff(); returns 1 with the payload in sb
+ * (read cursor at 0), 0 if there is none or it does not validate. The fd is closed
+ * and the variable cleared either way. */
+int restart_receive(StateBuffer *sb);
+
+/* Path of the running binary, i.e. what a replaced binary was installed as; 0 on failure */
+int restart_self_path(char *path, size_t size);
+
+#endif /* VAULTWM_RESTART_H */
@@ -0,0 +1,398 @@
+/*
+ * VaultWM Spatial Index Implementation
+ */
+
+#include <string.h>
+#include <limits.h>
+#include "spatial.h"
+
+static unsigned int hash_slot(Window win) {
+    return (unsigned int)((unsigned long)win * 2654435761u) & (SPATIAL_HASH_SIZE - 1);
+}
+
+static int hash_find(const SpatialIndex *idx, Window win) {
+    unsigned int h = hash_slot(win);
+    
+    while (idx->hash[h] != SPATIAL_NONE) {
+        if (idx->rects[idx->hash[h]].win == win) {
+            return idx->hash[h];
+        }
+        h = (h + 1) & (SPATIAL_HASH_SIZE - 1);
+    }
+    return SPATIAL_NONE;
+}
+
+static void hash_add(SpatialIndex *idx, int slot) {
+    unsigned int h = hash_slot(idx->rects[slot].win);
+    
+    while (idx->hash[h] != SPATIAL_NONE) {
+        h = (h + 1) & (SPATIAL_HASH_SIZE - 1);
+    }
+    idx->hash[h] = (short)slot;
+}
+
+// Linear probing delete with backward shift, as in the BSP window map
+static void hash_del(SpatialIndex *idx, Window win) {
+    unsigned int h = hash_slot(win);
+    unsigned int next, home;
+    
+    while (idx->hash[h] != SPATIAL_NONE && idx->rects[idx->hash[h]].win != win) {
+        h = (h + 1) & (SPATIAL_HASH_SIZE - 1);
+    }
+    if (idx->hash[h] == SPATIAL_NONE) {
+        return;
+    }
+    
+    next = h;
+    for (;;) {
+        idx->hash[h] = SPATIAL_NONE;
+        do {
+            next = (next + 1) & (SPATIAL_HASH_SIZE - 1);
+            if (idx->hash[next] == SPATIAL_NONE) {
+                return;
+            }
+            home = hash_slot(idx->rects[idx->hash[next]].win);
+        } while (((next - home) & (SPATIAL_HASH_SIZE - 1)) < ((next - h) & (SPATIAL_HASH_SIZE - 1)));
+        idx->hash[h] = idx->hash[next];
+        h = next;
+    }
+}
+
+static int key_of(const SpatialRect *r, int horizontal) {
+    return horizontal ? r->cx2 : r->cy2;
+}
+
+// First position whose (key, win) is not less than the given pair
+static int lower_bound(const SpatialIndex *idx, const short *order, int horizontal, int key, Window win) {
+    int lo = 0, hi = idx->count;
+    
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        const SpatialRect *r = &idx->rects[order[mid]];
+        int k = key_of(r, horizontal);
+        
+        if (k < key || (k == key && r->win < win)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void order_insert(SpatialIndex *idx, short *order, int horizontal, int slot) {
+    const SpatialRect *r = &idx->rects[slot];
+    int pos = lower_bound(idx, order, horizontal, key_of(r, horizontal), r->win);
+    
+    memmove(&order[pos + 1], &order[pos], (size_t)(idx->count - pos) * sizeof(short));
+    order[pos] = (short)slot;
+}
+
+static void order_remove(SpatialIndex *idx, short *order, int horizontal, int slot) {
+    const SpatialRect *r = &idx->rects[slot];
+    int pos = lower_bound(idx, order, horizontal, key_of(r, horizontal), r->win);
+    
+    if (pos < idx->count && order[pos] == slot) {
+        memmove(&order[pos], &order[pos + 1], (size_t)(idx->count - pos - 1) * sizeof(short));
+    }
+}
+
+// First edge whose (pos, owner) is not less than the given pair
+static int edge_lower_bound(const EdgeList *list, int pos, Window owner) {
+    int lo = 0, hi = list->count;
+    
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        const Edge *e = &list->edges[mid];
+        
+        if (e->pos < pos || (e->pos == pos && e->owner < owner)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int edge_insert(EdgeList *list, int pos, int start, int end, Window owner) {
+    int at;
+    
+    if (list->count >= EDGE_LIST_MAX) {
+        return 0;
+    }
+    at = edge_lower_bound(list, pos, owner);
+    memmove(&list->edges[at + 1], &list->edges[at], (size_t)(list->count - at) * sizeof(Edge));
+    list->edges[at].pos = pos;
+    list->edges[at].start = start;
+    list->edges[at].end = end;
+    list->edges[at].owner = owner;
+    list->count++;
+    return 1;
+}
+
+static void edge_remove(EdgeList *list, int pos, Window owner) {
+    int at = edge_lower_bound(list, pos, owner);
+    
+    if (at < list->count && list->edges[at].pos == pos && list->edges[at].owner == owner) {
+        memmove(&list->edges[at], &list->edges[at + 1], (size_t)(list->count - at - 1) * sizeof(Edge));
+        list->count--;
+    }
+}
+
+/* Move one side of a window. The extent is not part of the sort key, so a side
+ * that only slid along itself is patched in place. */
+static void edge_move(EdgeList *list, int old_pos, int pos, int start, int end, Window owner) {
+    int at;
+    
+    if (old_pos != pos) {
+        edge_remove(list, old_pos, owner);
+        edge_insert(list, pos, start, end, owner);
+        return;
+    }
+    for (at = edge_lower_bound(list, pos, owner);
+         at < list->count && list->edges[at].pos == pos && list->edges[at].owner == owner; at++) {
+        list->edges[at].start = start;
+        list->edges[at].end = end;
+    }
+}
+
+static void edges_add_rect(EdgeIndex *edges, const SpatialRect *r) {
+    edge_insert(&edges->vertical, r->x, r->y, r->y + r->height, r->win);
+    edge_insert(&edges->vertical, r->x + r->width, r->y, r->y + r->height, r->win);
+    edge_insert(&edges->horizontal, r->y, r->x, r->x + r->width, r->win);
+    edge_insert(&edges->horizontal, r->y + r->height, r->x, r->x + r->width, r->win);
+}
+
+static void edges_remove_rect(EdgeIndex *edges, const SpatialRect *r) {
+    edge_remove(&edges->vertical, r->x, r->win);
+    edge_remove(&edges->vertical, r->x + r->width, r->win);
+    edge_remove(&edges->horizontal, r->y, r->win);
+    edge_remove(&edges->horizontal, r->y + r->height, r->win);
+}
+
+void spatial_init(SpatialIndex *idx) {
+    int i;
+    
+    memset(idx, 0, sizeof(SpatialIndex));
+    for (i = 0; i < SPATIAL_HASH_SIZE; i++) {
+        idx->hash[i] = SPATIAL_NONE;
+    }
+    for (i = 0; i < SPATIAL_MAX; i++) {
+        idx->free_slots[i] = (short)(SPATIAL_MAX - 1 - i);
+    }
+    idx->num_free = SPATIAL_MAX;
+}
+
+int spatial_update(SpatialIndex *idx, Window win, int x, int y, int width, int height) {
+    int slot = hash_find(idx, win);
+    int cx2 = 2 * x + width;
+    int cy2 = 2 * y + height;
+    SpatialRect *r;
+    
+    if (slot == SPATIAL_NONE) {
+        if (win == None || idx->num_free == 0) {
+            return 0;
+        }
+        slot = idx->free_slots[--idx->num_free];
+        r = &idx->rects[slot];
+        r->win = win;
+        r->x = x;
+        r->y = y;
+        r->width = width;
+        r->height = height;
+        r->cx2 = cx2;
+        r->cy2 = cy2;
+        hash_add(idx, slot);
+        edges_add_rect(&idx->edges, r);
+        order_insert(idx, idx->by_x, 1, slot);
+        order_insert(idx, idx->by_y, 0, slot);
+        idx->count++;
+        return 1;
+    }
+    
+    // Only an order whose centre moved has to be touched
+    r = &idx->rects[slot];
+    if (r->cx2 != cx2) {
+        order_remove(idx, idx->by_x, 1, slot);
+        idx->count--;
+        r->cx2 = cx2;
+        order_insert(idx, idx->by_x, 1, slot);
+        idx->count++;
+    }
+    if (r->cy2 != cy2) {
+        order_remove(idx, idx->by_y, 0, slot);
+        idx->count--;
+        r->cy2 = cy2;
+        order_insert(idx, idx->by_y, 0, slot);
+        idx->count++;
+    }
+    
+    // Sides only move along with the axis that changed; the others get a new extent
+    if (r->x != x || r->width != width || r->y != y || r->height != height) {
+        edge_move(&idx->edges.vertical, r->x, x, y, y + height, win);
+        edge_move(&idx->edges.vertical, r->x + r->width, x + width, y, y + height, win);
+        edge_move(&idx->edges.horizontal, r->y, y, x, x + width, win);
+        edge_move(&idx->edges.horizontal, r->y + r->height, y + height, x, x + width, win);
+    }
+    r->x = x;
+    r->y = y;
+    r->width = width;
+    r->height = height;
+    return 1;
+}
+
+int spatial_remove(SpatialIndex *idx, Window win) {
+    int slot = hash_find(idx, win);
+    
+    if (slot == SPATIAL_NONE) {
+        return 0;
+    }
+    order_remove(idx, idx->by_x, 1, slot);
+    order_remove(idx, idx->by_y, 0, slot);
+    edges_remove_rect(&idx->edges, &idx->rects[slot]);
+    hash_del(idx, win);
+    idx->count--;
+    idx->rects[slot].win = None;
+    idx->free_slots[idx->num_free++] = (short)slot;
+    return 1;
+}
+
+int spatial_contains(const SpatialIndex *idx, Window win) {
+    return hash_find(idx, win) != SPATIAL_NONE;
+}
+
+Window spatial_neighbor(const SpatialIndex *idx, Window win, Direction dir) {
+    int slot = hash_find(idx, win);
+    const SpatialRect *from, *c;
+    const short *order;
+    int horizontal, forward, pos, step;
+    long key, best_score = LONG_MAX;
+    Window best = None;
+    
+    if (slot == SPATIAL_NONE || dir < 0 || dir >= DIR_COUNT) {
+        return None;
+    }
+    
+    from = &idx->rects[slot];
+    horizontal = (dir == DIR_LEFT || dir == DIR_RIGHT);
+    forward = (dir == DIR_RIGHT || dir == DIR_DOWN);
+    order = horizontal ? idx->by_x : idx->by_y;
+    key = key_of(from, horizontal);
+    
+    // Candidates are strictly past our centre; start at the nearest and walk away
+    if (forward) {
+        pos = lower_bound(idx, order, horizontal, (int)key + 1, 0);
+        step = 1;
+    } else {
+        pos = lower_bound(idx, order, horizontal, (int)key, 0) - 1;
+        step = -1;
+    }
+    
+    for (; pos >= 0 && pos < idx->count; pos += step) {
+        long primary, offset, score;
+        
+        c = &idx->rects[order[pos]];
+        primary = key_of(c, horizontal) - key;
+        if (primary < 0) primary = -primary;
+        
+        // The score never drops below the distance along the axis, so nothing further can win
+        if (primary >= best_score) {
+            break;
+        }
+        
+        offset = key_of(c, !horizontal) - key_of(from, !horizontal);
+        if (offset < 0) offset = -offset;
+        score = primary + SPATIAL_PERPENDICULAR_WEIGHT * offset;
+        if (score < best_score) {
+            best_score = score;
+            best = c->win;
+        }
+    }
+    return best;
+}
+
+void edge_index_init(EdgeIndex *edges) {
+    memset(edges, 0, sizeof(EdgeIndex));
+}
+
+int edge_index_add(EdgeIndex *edges, int vertical, int pos, int start, int end) {
+    return edge_insert(vertical ? &edges->vertical : &edges->horizontal, pos, start, end, None);
+}
+
+/* Nearest edge within threshold of side that overlaps [lo, hi] along the edge,
+ * ignoring win's own sides. Updates *best (distance) and *delta; the scan only
+ * covers the window of positions that can still beat the current best. */
+static void edge_nearest(const EdgeList *list, Window win, int side, int lo, int hi,
+                         int *best, int *delta) {
+    int at;
+    
+    if (!list) {
+        return;
+    }
+    for (at = edge_lower_bound(list, side - *best, 0);
+         at < list->count && list->edges[at].pos <= side + *best; at++) {
+        const Edge *e = &list->edges[at];
+        int dist = e->pos - side;
+        
+        if (e->owner == win && win != None) continue;
+        if (e->end < lo || e->start > hi) continue;
+        if (dist < 0) dist = -dist;
+        if (dist < *best) {
+            *best = dist;
+            *delta = e->pos - side;
+        }
+    }
+}
+
+static int snap_axis(const EdgeList *own, const EdgeList *fixed, Window win,
+                     int *pos, int *size, int lo, int hi, int threshold, int resizing) {
+    int best = threshold + 1, delta = 0;
+    
+    if (!resizing) {
+        edge_nearest(own, win, *pos, lo, hi, &best, &delta);
+        edge_nearest(fixed, win, *pos, lo, hi, &best, &delta);
+    }
+    edge_nearest(own, win, *pos + *size, lo, hi, &best, &delta);
+    edge_nearest(fixed, win, *pos + *size, lo, hi, &best, &delta);
+    
+    if (best > threshold || delta == 0) {
+        return 0;
+    }
+    if (resizing) {
+        if (*size + delta < 1) {
+            return 0;
+        }
+        *size += delta;
+    } else {
+        *pos += delta;
+    }
+    return 1;
+}
+
+int spatial_snap(const SpatialIndex *idx, const EdgeIndex *fixed, Window win,
+                 int *x, int *y, int *width, int *height, int threshold, int resizing) {
+    int snapped = 0;
+    
+    if (threshold <= 0) {
+        return 0;
+    }
+    
+    // Vertical edges line up x; they must overlap the window vertically, and vice versa
+    snapped |= snap_axis(idx ? &idx->edges.vertical : NULL, fixed ? &fixed->vertical : NULL, win,
+                         x, width, *y, *y + *height, threshold, resizing);
+    snapped |= snap_axis(idx ? &idx->edges.horizontal : NULL, fixed ? &fixed->horizontal : NULL, win,
+                         y, height, *x, *x + *width, threshold, resizing);
+    return snapped;
+}
+
+int spatial_direction(const char *name) {
+    static const char *names[DIR_COUNT] = { "left", "right", "up", "down" };
+    int i;
+    
+    for (i = 0; i < DIR_COUNT; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,95 @@
+/*
+ * VaultWM Spatial Index
+ * Window rectangles kept sorted by centre x and centre y so directional
+ * focus and movement find their neighbour with a binary search and a
+ * scan that stops as soon as no further window can score better, plus
+ * sorted edge lists per axis for snapping during drags
+ */
+
+#ifndef VAULTWM_SPATIAL_H
+#define VAULTWM_SPATIAL_H
+
+#include <X11/Xlib.h>
+
+#define SPATIAL_MAX 256              // One entry per managed window of a workspace
+#define SPATIAL_HASH_SIZE 512        // Window -> slot, power of two
+#define SPATIAL_NONE (-1)
+#define SPATIAL_PERPENDICULAR_WEIGHT 2  // Sideways centre offset counts double against distance ahead
+#define EDGE_LIST_MAX (2 * SPATIAL_MAX)  // Two sides per window on each axis
+
+typedef enum {
+    DIR_LEFT,
+    DIR_RIGHT,
+    DIR_UP,
+    DIR_DOWN,
+    DIR_COUNT
+} Direction;
+
+typedef struct {
+    Window win;
+    int x, y, width, height;
+    int cx2, cy2;                    // Doubled centre, so it stays integral
+} SpatialRect;
+
+/* One side of a window or a fixed boundary (screen, monitor seam, status bar) */
+typedef struct {
+    int pos;                         // x of a vertical edge, y of a horizontal one
+    int start, end;                  // Extent along the edge
+    Window owner;                    // None for fixed edges
+} Edge;
+
+typedef struct {
+    Edge edges[EDGE_LIST_MAX];       // Sorted by (pos, owner, start)
+    int count;
+} EdgeList;
+
+typedef struct {
+    EdgeList vertical;               // Left and right sides
+    EdgeList horizontal;             // Top and bottom sides
+} EdgeIndex;
+
+typedef struct {
+    SpatialRect rects[SPATIAL_MAX];  // Slot storage, unordered
+    short by_x[SPATIAL_MAX];         // Slots ordered by (cx2, win)
+    short by_y[SPATIAL_MAX];         // Slots ordered by (cy2, win)
+    short hash[SPATIAL_HASH_SIZE];
+    short free_slots[SPATIAL_MAX];
+    int count;
+    int num_free;
+    EdgeIndex edges;                 // Sides of every indexed window
+} SpatialIndex;
+
+/* Empty the index */
+void spatial_init(SpatialIndex *idx);
+
+/* Insert a window or move it to a new rectangle; unchanged rectangles cost one lookup.
+ * Returns 1 on success, 0 if the index is full */
+int spatial_update(SpatialIndex *idx, Window win, int x, int y, int width, int height);
+
+/* Drop a window; returns 1 if it was indexed */
+int spatial_remove(SpatialIndex *idx, Window win);
+
+/* Non-zero if win is indexed */
+int spatial_contains(const SpatialIndex *idx, Window win);
+
+/* Closest window from win's rectangle in direction dir, or None */
+Window spatial_neighbor(const SpatialIndex *idx, Window win, Direction dir);
+
+/* Empty an edge index */
+void edge_index_init(EdgeIndex *edges);
+
+/* Add a fixed edge; vertical edges sit at x = pos and span y from start to end.
+ * Returns 1 on success, 0 if the list is full */
+int edge_index_add(EdgeIndex *edges, int vertical, int pos, int start, int end);
+
+/* Snap a dragged window to the nearest edges of other windows or of fixed
+ * within threshold pixels. A move shifts x/y so any side lines up; a resize
+ * grows or shrinks width/height so the right and bottom sides line up.
+ * Returns non-zero if anything snapped. */
+int spatial_snap(const SpatialIndex *idx, const EdgeIndex *fixed, Window win,
+                 int *x, int *y, int *width, int *height, int threshold, int resizing);
+
+/* Parse "left", "right", "up" or "down"; returns -1 for anything else */
+int spatial_direction(const char *name);
+
+#endif /* VAULTWM_SPATIAL_H */
@@ -9,17 +9,13 @@
 #include <X11/Xatom.h>
 #include "window-tags.h"
 
-#define TAG_ATOM_NAME "_VAULTWM_TAGS"
-
-static Atom tag_atom = None;
-
 int tag_manager_init(TagManager *tm) {
     if (!tm) {
         return 0;
     }
     
     tm->num_tags = 0;
-    tm->next_mask = 1;  // Start with bit 1 (bit 0 reserved)
+    tm->next_mask = 1;  // First tag gets bit 0
     memset(tm->tags, 0, sizeof(tm->tags));
     
     return 1;
@@ -70,29 +66,126 @@ Tag* tag_get(TagManager *tm, int index) {
     return &tm->tags[index];
 }
 
-void window_add_tag(Window win, unsigned int tag_mask) {
-    // This would store tags in window properties
-    // Simplified implementation - full version would use X11 properties
+unsigned int tag_parse_mask(TagManager *tm, const char *list) {
+    char buf[MAX_TAGS * TAG_NAME_MAX], *name, *save = NULL;
+    unsigned int mask = 0;
+    
+    if (!tm || !list) {
+        return 0;
+    }
+    if (strcmp(list, "all") == 0) {
+        return TAG_ALL;
+    }
+    
+    strncpy(buf, list, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    for (name = strtok_r(buf, ",", &save); name; name = strtok_r(NULL, ",", &save)) {
+        Tag *tag = tag_find(tm, name);
+        if (!tag) {
+            return 0;
+        }
+        mask |= tag->mask;
+    }
+    return mask;
 }
 
-void window_remove_tag(Window win, unsigned int tag_mask) {
-    // Remove tag from window
+void tag_manager_cleanup(TagManager *tm) {
+    if (tm) {
+        tm->num_tags = 0;
+        tm->next_mask = 1;
+    }
 }
 
-unsigned int window_get_tags(Window win) {
-    // Retrieve tags from window properties
-    return 0;
+void tag_table_init(TagTable *tt) {
+    memset(tt, 0, sizeof(TagTable));
 }
 
-int window_has_tag(Window win, unsigned int tag_mask) {
-    unsigned int tags = window_get_tags(win);
-    return (tags & tag_mask) != 0;
+int tag_table_set(TagTable *tt, int slot, unsigned int mask) {
+    uint64_t bit;
+    int t;
+    
+    if (!tt || slot < 0 || slot > tt->count || slot >= TAG_SLOTS) {
+        return 0;
+    }
+    
+    mask &= TAG_ALL;
+    bit = 1ull << (slot % 64);
+    for (t = 0; t < MAX_TAGS; t++) {
+        if (mask & (1u << t)) {
+            tt->members[t][slot / 64] |= bit;
+        } else {
+            tt->members[t][slot / 64] &= ~bit;
+        }
+    }
+    tt->masks[slot] = (uint16_t)mask;
+    if (slot == tt->count) {
+        tt->count++;
+    }
+    return 1;
 }
 
-void tag_manager_cleanup(TagManager *tm) {
-    if (tm) {
-        tm->num_tags = 0;
-        tm->next_mask = 1;
+void tag_table_remove(TagTable *tt, int slot) {
+    int t, w, first;
+    uint64_t low;
+    
+    if (!tt || slot < 0 || slot >= tt->count) {
+        return;
+    }
+    
+    // Per tag: keep the bits below slot, shift everything above it down by one
+    first = slot / 64;
+    low = (1ull << (slot % 64)) - 1;
+    for (t = 0; t < MAX_TAGS; t++) {
+        uint64_t *m = tt->members[t];
+        m[first] = (m[first] & low) | ((m[first] >> 1) & ~low);
+        for (w = first; w < TAG_WORDS - 1; w++) {
+            m[w] |= m[w + 1] << 63;
+            m[w + 1] >>= 1;
+        }
+    }
+    memmove(&tt->masks[slot], &tt->masks[slot + 1], (size_t)(tt->count - slot - 1) * sizeof(uint16_t));
+    tt->count--;
+    tt->masks[tt->count] = 0;
+}
+
+void tag_table_view(const TagTable *tt, unsigned int view, uint64_t *visible) {
+    int t, w;
+    
+    memset(visible, 0, TAG_WORDS * sizeof(uint64_t));
+    for (t = 0; t < MAX_TAGS; t++) {
+        if (!(view & (1u << t))) continue;
+        for (w = 0; w < TAG_WORDS; w++) {
+            visible[w] |= tt->members[t][w];
+        }
     }
 }
 
+static Atom tag_atom(Display *dpy) {
+    return XInternAtom(dpy, TAG_ATOM_NAME, False);
+}
+
+int window_tags_load(Display *dpy, Window win, unsigned int *mask) {
+    Atom type;
+    int format;
+    unsigned long count, after;
+    unsigned char *data = NULL;
+    int found = 0;
+    
+    if (XGetWindowProperty(dpy, win, tag_atom(dpy), 0, 1, False, XA_CARDINAL,
+            &type, &format, &count, &after, &data) != Success) {
+        return 0;
+    }
+    if (data && type == XA_CARDINAL && format == 32 && count == 1) {
+        *mask = (unsigned int)(*(unsigned long *)data) & TAG_ALL;
+        found = (*mask != 0);
+    }
+    if (data) XFree(data);
+    return found;
+}
+
+void window_tags_store(Display *dpy, Window win, unsigned int mask) {
+    unsigned long value = mask & TAG_ALL;
+    
+    XChangeProperty(dpy, win, tag_atom(dpy), XA_CARDINAL, 32, PropModeReplace,
+        (unsigned char *)&value, 1);
+}
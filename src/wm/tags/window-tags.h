@@ -1,16 +1,21 @@
 /*
  * VaultWM Window Tagging System
- * Tag windows for organization and filtering
+ * Tag windows for organization and filtering; dwm-style views show the
+ * union of any set of tags, computed word-wide over per-tag bitsets
  */
 
 #ifndef VAULTWM_WINDOW_TAGS_H
 #define VAULTWM_WINDOW_TAGS_H
 
+#include <stdint.h>
 #include <X11/Xlib.h>
 
 #define MAX_TAGS 16
 #define TAG_NAME_MAX 32
-#define MAX_TAGS_PER_WINDOW 8
+#define TAG_ALL ((1u << MAX_TAGS) - 1)
+#define TAG_SLOTS 256                // One per client slot of a workspace
+#define TAG_WORDS (TAG_SLOTS / 64)
+#define TAG_ATOM_NAME "_VAULTWM_TAGS"
 
 typedef struct {
     char name[TAG_NAME_MAX];
@@ -23,6 +28,14 @@ typedef struct {
     unsigned int next_mask;
 } TagManager;
 
+/* Tags of one workspace's clients, indexed like its client array. Each tag keeps a
+ * bitset of the slots carrying it, so a view is a handful of 64-bit ORs. */
+typedef struct {
+    uint64_t members[MAX_TAGS][TAG_WORDS];
+    uint16_t masks[TAG_SLOTS];       // Per slot, packed
+    int count;
+} TagTable;
+
 /* Initialize tag manager */
 int tag_manager_init(TagManager *tm);
 
@@ -35,20 +48,28 @@ Tag* tag_find(TagManager *tm, const char *name);
 /* Get tag by index */
 Tag* tag_get(TagManager *tm, int index);
 
-/* Add tag to window */
-void window_add_tag(Window win, unsigned int tag_mask);
+/* Mask for a comma-separated list of tag names, or "all"; 0 if any name is unknown */
+unsigned int tag_parse_mask(TagManager *tm, const char *list);
 
-/* Remove tag from window */
-void window_remove_tag(Window win, unsigned int tag_mask);
+/* Cleanup tag manager */
+void tag_manager_cleanup(TagManager *tm);
 
-/* Get window tags */
-unsigned int window_get_tags(Window win);
+/* Empty a tag table */
+void tag_table_init(TagTable *tt);
 
-/* Filter windows by tag */
-int window_has_tag(Window win, unsigned int tag_mask);
+/* Set the tags of slot (slot == count appends). Returns 1 on success */
+int tag_table_set(TagTable *tt, int slot, unsigned int mask);
 
-/* Cleanup tag manager */
-void tag_manager_cleanup(TagManager *tm);
+/* Drop a slot and shift the ones above down, mirroring a memmove of the client array */
+void tag_table_remove(TagTable *tt, int slot);
 
-#endif /* VAULTWM_WINDOW_TAGS_H */
+/* Slots with at least one tag in view, as a bitset of TAG_WORDS words */
+void tag_table_view(const TagTable *tt, unsigned int view, uint64_t *visible);
+
+/* Read _VAULTWM_TAGS; returns 1 and sets *mask if the window carries it */
+int window_tags_load(Display *dpy, Window win, unsigned int *mask);
 
+/* Mirror a window's tags to _VAULTWM_TAGS so they survive a restart */
+void window_tags_store(Display *dpy, Window win, unsigned int mask);
+
+#endif /* VAULTWM_WINDOW_TAGS_H */
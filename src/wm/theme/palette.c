@@ -0,0 +1,144 @@
+/*
+ * VaultWM Palette Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include "palette.h"
+#include "../config/config.h"
+
+/* .colors keys, WM-specific ones first; the GTK/terminal ones are what every
+ * VaultOS theme already defines, so themes work before they grow WM_* keys */
+static const struct {
+    const char *key;
+    PaletteColor color;
+    int fallback;
+} palette_keys[] = {
+    { "WM_BORDER_FOCUSED", PALETTE_BORDER_FOCUSED, 0 },
+    { "WM_BORDER_UNFOCUSED", PALETTE_BORDER_UNFOCUSED, 0 },
+    { "WM_BORDER_URGENT", PALETTE_BORDER_URGENT, 0 },
+    { "WM_BAR_BACKGROUND", PALETTE_BAR_BACKGROUND, 0 },
+    { "WM_BAR_FOREGROUND", PALETTE_BAR_FOREGROUND, 0 },
+    { "GTK_BORDER", PALETTE_BORDER_FOCUSED, 1 },
+    { "TERM_RED", PALETTE_BORDER_URGENT, 1 },
+    { "GTK_BG", PALETTE_BAR_BACKGROUND, 1 },
+    { "GTK_FG", PALETTE_BAR_FOREGROUND, 1 },
+};
+
+#define PALETTE_KEY_COUNT (sizeof(palette_keys) / sizeof(palette_keys[0]))
+
+void palette_default(Palette *palette) {
+    palette->name[0] = '\0';
+    palette->colors[PALETTE_BORDER_FOCUSED] = COLOR_PIPBOY_GREEN;
+    palette->colors[PALETTE_BORDER_UNFOCUSED] = COLOR_DARK_GREEN;
+    palette->colors[PALETTE_BORDER_URGENT] = COLOR_ALERT_RED;
+    palette->colors[PALETTE_BAR_BACKGROUND] = COLOR_BLACK;
+    palette->colors[PALETTE_BAR_FOREGROUND] = COLOR_PIPBOY_GREEN;
+}
+
+int palette_find(const char *name, char *path, size_t size) {
+    char file[PALETTE_NAME_MAX];
+    const char *home = getenv("HOME");
+    size_t len = 0;
+    
+    /* Lowercase without dashes: "Vault-Tec" -> vaulttec; no path separators or dots */
+    for (; *name; name++) {
+        if (*name == '-') continue;
+        if (!isalnum((unsigned char)*name) && *name != '_') return 0;
+        if (len + 1 >= sizeof(file)) return 0;
+        file[len++] = (char)tolower((unsigned char)*name);
+    }
+    if (len == 0) return 0;
+    file[len] = '\0';
+    
+    if (home) {
+        snprintf(path, size, "%s/" PALETTE_USER_DIR "/%s.colors", home, file);
+        if (access(path, R_OK) == 0) return 1;
+    }
+    snprintf(path, size, PALETTE_SYSTEM_DIR "/%s.colors", file);
+    return access(path, R_OK) == 0;
+}
+
+/* "#RRGGBB" or "0xRRGGBB", optionally quoted */
+static int parse_color(const char *s, unsigned long *out) {
+    char *end;
+    size_t len = strlen(s);
+    
+    if (len >= 2 && (s[0] == '"' || s[0] == '\'') && s[len - 1] == s[0]) {
+        s++;
+        len -= 2;
+    }
+    if (len == 7 && s[0] == '#') {
+        s++;
+        len--;
+    } else if (len == 8 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        s += 2;
+        len -= 2;
+    } else {
+        return 0;
+    }
+    if (!isxdigit((unsigned char)s[0])) return 0;  // strtoul would take a sign or spaces
+    unsigned long v = strtoul(s, &end, 16);
+    if (end != s + len) return 0;
+    *out = v;
+    return 1;
+}
+
+int palette_load(const char *path, Palette *palette) {
+    Palette loaded = *palette;
+    int from_wm_key[PALETTE_COLOR_COUNT] = { 0 };
+    char line[256];
+    size_t i;
+    long size = 0;
+    
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    
+    while (fgets(line, sizeof(line), f)) {
+        size += (long)strlen(line);
+        if (size > PALETTE_FILE_MAX) {
+            fclose(f);
+            return 0;
+        }
+        
+        char *key = line, *value, *end;
+        while (isspace((unsigned char)*key)) key++;
+        if (*key == '#' || *key == '\0') continue;
+        if (strncmp(key, "export ", 7) == 0) key += 7;
+        if (!(value = strchr(key, '='))) continue;
+        *value++ = '\0';
+        end = value + strcspn(value, "\r\n");
+        while (end > value && isspace((unsigned char)end[-1])) end--;
+        *end = '\0';
+        
+        for (i = 0; i < PALETTE_KEY_COUNT; i++) {
+            PaletteColor color = palette_keys[i].color;
+            unsigned long v;
+            if (strcmp(key, palette_keys[i].key) != 0) continue;
+            if (palette_keys[i].fallback && from_wm_key[color]) break;  // WM_* wins wherever it appears
+            if (parse_color(value, &v)) {
+                loaded.colors[color] = v;
+                if (!palette_keys[i].fallback) from_wm_key[color] = 1;
+            }
+            break;
+        }
+    }
+    
+    int ok = !ferror(f);
+    fclose(f);
+    if (ok) *palette = loaded;
+    return ok;
+}
+
+unsigned int palette_diff(const Palette *a, const Palette *b) {
+    unsigned int changed = 0;
+    int i;
+    
+    for (i = 0; i < PALETTE_COLOR_COUNT; i++) {
+        if (a->colors[i] != b->colors[i]) changed |= PALETTE_BIT(i);
+    }
+    return changed;
+}
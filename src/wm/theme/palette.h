@@ -0,0 +1,55 @@
+/*
+ * VaultWM Palette
+ * Every colour the WM draws with, as one value that is replaced whole:
+ * loaded from a VaultOS theme's .colors file, compared against the live
+ * palette, and only the entries that differ are repainted
+ */
+
+#ifndef VAULTWM_PALETTE_H
+#define VAULTWM_PALETTE_H
+
+#include <stddef.h>
+
+#define PALETTE_NAME_MAX 32
+#define PALETTE_USER_DIR ".local/share/vaultos/colors"   // Under HOME, searched first
+#define PALETTE_SYSTEM_DIR "/usr/share/vaultos/colors"   // Installed by vaultos-themes
+#define PALETTE_FILE_MAX (64 * 1024)
+
+typedef enum {
+    PALETTE_BORDER_FOCUSED,
+    PALETTE_BORDER_UNFOCUSED,
+    PALETTE_BORDER_URGENT,
+    PALETTE_BAR_BACKGROUND,
+    PALETTE_BAR_FOREGROUND,
+    PALETTE_COLOR_COUNT
+} PaletteColor;
+
+/* palette_diff() bit for a colour */
+#define PALETTE_BIT(color) (1u << (color))
+#define PALETTE_BORDERS (PALETTE_BIT(PALETTE_BORDER_FOCUSED) | PALETTE_BIT(PALETTE_BORDER_UNFOCUSED) | \
+                         PALETTE_BIT(PALETTE_BORDER_URGENT))
+#define PALETTE_BAR (PALETTE_BIT(PALETTE_BAR_BACKGROUND) | PALETTE_BIT(PALETTE_BAR_FOREGROUND))
+
+typedef struct {
+    char name[PALETTE_NAME_MAX];  // Theme it came from, "" for the built-in colours
+    unsigned long colors[PALETTE_COLOR_COUNT];  // 0xRRGGBB
+} Palette;
+
+/* The compile-time Pip-Boy colours from config.h */
+void palette_default(Palette *palette);
+
+/* Path of theme name's .colors file, user directory first. Names are matched
+ * the way the theme tools write them ("Pip-Boy" finds pipboy.colors); anything
+ * that is not a plain name is refused. Returns 1 if a readable file was found */
+int palette_find(const char *name, char *path, size_t size);
+
+/* Read a .colors file (shell KEY="#RRGGBB" lines) over palette. WM_* keys are
+ * used where present, the theme's GTK_* colours otherwise; entries the file
+ * has neither for are left as they were. palette is untouched unless the
+ * whole file reads. Returns 1 on success */
+int palette_load(const char *path, Palette *palette);
+
+/* PALETTE_BIT()s of the colours that differ */
+unsigned int palette_diff(const Palette *a, const Palette *b);
+
+#endif /* VAULTWM_PALETTE_H */
@@ -8,57 +8,101 @@
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
 #include <X11/keysym.h>
+#include <X11/cursorfont.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <time.h>
-#include <sys/select.h>
 #include <sys/time.h>
 #include <ctype.h>
+#include <errno.h>
 #include "../config/config.h"
+#include "../config/runtime-config/ipc.h"
+#include "../config/runtime-config/config-parser.h"
+#include "../config/runtime-config/config-watch.h"
+#include "../eventloop/event-loop.h"
+#include "../jobs/job-pool.h"
+#include "../layouts/layouts.h"
+#include "../layouts/layout-engine.h"
+#include "../layouts/bsp.h"
+#include "../spatial/spatial.h"
+#include "../plugins/layout-plugins.h"
+#include "../plugins/plugin-watch.h"
+#include "../plugins/plugin-loader.h"
+#include "../animation/animation.h"
+#include "../metrics/metrics.h"
 #include "../monitor/monitor.h"
 #include "../window-rules/window-rules.h"
+#include "../tags/window-tags.h"
+#include "../restart/restart.h"
+#include "../theme/palette.h"
+#include "../wayland/backend-abstraction.h"
+#include "../wayland/x11-backend.h"
 
 #define MAX_WINDOWS 256
-#define PIPBOY_GREEN COLOR_PIPBOY_GREEN
-#define BLACK COLOR_BLACK
-#define DARK_GREEN COLOR_DARK_GREEN
 
 typedef struct {
     Window win;
     int x, y, width, height;
     int is_floating;
     int is_mapped;
+    SizeHints hints;  // WM_NORMAL_HINTS, read at manage time and on PropertyNotify
+    char class_name[RULE_NAME_MAX];  // Cached rule inputs, refreshed on PropertyNotify
+    char instance_name[RULE_NAME_MAX];
+    char window_type[RULE_NAME_MAX];
+    RuleResult rule;  // Last resolution; a late relabel applies only what changed
+    int ignore_unmaps;  // Our own unmaps (tag views) still to be reported
 } Client;
 
 typedef struct Workspace {
     Client clients[MAX_WINDOWS];
     int num_clients;
     int layout_mode;  // 0 = tiling, 1 = floating, 2 = monocle
+    int layout_dirty;  // Clients or layout changed since the last pass; hidden workspaces wait until shown
+    BSPTree bsp;  // Dwindle/fibonacci splits, kept across relayouts
+    SpatialIndex spatial;  // Client rectangles for directional focus and movement
+    TagTable tags;  // Tag bitmask per client slot; hidden clients keep their slot
+    unsigned int view;  // Tags shown, dwm-style union; TAG_ALL shows everything
 } Workspace;
 
 typedef struct {
+    BackendDisplay *backend;  // Window operations; the same connection as dpy
     Display *dpy;
     Window root;
     int screen;
     int screen_width, screen_height;
-    Workspace workspaces[MAX_WORKSPACES];
+    Workspace **workspaces;  // Indexed by number - 1, NULL until first used
+    int workspace_slots;
     int current_workspace;
     int current_client;
     Window status_bar;
     GC gc;
     Atom wm_protocols;
     Atom wm_delete_window;
+    Atom net_wm_name;
+    Atom net_wm_window_type;
     int is_resizing;
     int is_moving;
     int resize_start_x, resize_start_y;
     int move_start_x, move_start_y;
+    int snap_dx, snap_dy;  // Snapped minus pointer-following geometry while dragging
+    EdgeIndex screen_edges;  // Monitor sides and seams, status bar; windows snap to these
     MonitorManager monitor_mgr;  // Multi-monitor support
     int current_monitor;  // Currently active monitor
     WindowRules window_rules;  // Window rules system
+    VaultWMConfig config;  // ~/.config/vaultwm/config over the config.h defaults
+    Palette palette;  // Colours in use: the configured borders, or a theme's palette
+    KeyCode keys[CONFIG_KEY_COUNT];  // config.keys resolved at grab time, 0 = unbound
+    TagManager tag_mgr;  // Tag names "1"-"9" plus any created over IPC
+    int running;  // Cleared by the quit command
+    int restart_requested;  // Set by the restart command; acted on between loop iterations
+    char **argv;  // Passed on unchanged to the restarted binary
+    EventLoop loop;  // X, IPC and timer sources with per-iteration budgets
+    Animator anim;  // Slides windows between layouts at the display refresh rate
 } VaultWM;
 
 VaultWM wm;
@@ -67,43 +111,93 @@ VaultWM wm;
 void setup_wm(void);
 void cleanup_wm(void);
 void handle_event(XEvent *e);
+int dispatch_x_events(void *data, int budget);
+int x_events_pending(void *data);
+int dispatch_ipc(void *data, int budget);
+int ipc_events_pending(void *data);
+int dispatch_metrics(void *data, int budget);
+void collect_metrics(void);
+int dispatch_animation(void *data, int budget);
+int dispatch_jobs(void *data, int budget);
+int jobs_pending(void *data);
+int refresh_system_sample(void);
+int commit_geometry(void *data, const LayoutClient *target, LayoutClient *shown, int num_clients);
+int count_ipc_command(const char *cmd, const char *args, char *reply, size_t reply_size);
 void handle_keypress(XKeyEvent *e);
 void handle_buttonpress(XButtonEvent *e);
 void handle_motion_notify(XMotionEvent *e);
 void handle_configure_request(XConfigureRequestEvent *e);
 void handle_map_request(XMapRequestEvent *e);
 void handle_unmap_notify(XUnmapEvent *e);
-void manage_window(Window w);
+void handle_destroy_notify(XDestroyWindowEvent *e);
+int handle_x_error(Display *dpy, XErrorEvent *e);
+void handle_property_notify(XPropertyEvent *e);
+int manage_window(Window w);
+void setup_client_window(Window w);
+void read_window_class(Window w, char *class_name, char *instance_name, size_t size);
+void read_window_title(Window w, char *out, size_t size);
+void read_window_type(Window w, char *out, size_t size);
+void load_window_rules(void);
+int config_dir(char *path, size_t size);
+int read_config_file(VaultWMConfig *config);
+void reload_config(void);
+void reload_config_async(void);
+void apply_config(unsigned int changed);
+int build_palette(const char *theme, Palette *palette);
+void set_palette(const Palette *next);
+void grab_keys(void);
+int dispatch_config(void *data, int budget);
+int dispatch_plugins(void *data, int budget);
+void reapply_window_rules(Workspace *ws, int index, int changed);
 void unmanage_window(Window w);
 void tile_windows(void);
+void arrange_workspace(Workspace *ws);
 void draw_status_bar(void);
 void update_status_bar(void);
 void focus_client(int index);
 void focus_next(void);
 void focus_prev(void);
+void focus_direction(Direction dir);
+void move_direction(Direction dir);
+void build_screen_edges(void);
 void switch_workspace(int workspace);
 void move_client(int index, int dx, int dy);
 void resize_client(int index, int dw, int dh);
 void launch_application(const char *cmd);
+void close_client(int index);
+void move_client_to_workspace(int index, int workspace);
+int client_visible(Workspace *ws, int index);
+void set_view(Workspace *ws, unsigned int view);
+void toggle_client_tags(int index, unsigned int mask);
+void scan_windows(void);
+void save_state(StateBuffer *sb);
+int restore_state(void);
+void restart_wm(void);
+int handle_ipc_command(const char *cmd, const char *args, char *reply, size_t reply_size);
 Workspace* current_workspace(void);
+Workspace* get_workspace(int workspace);
+
+static XErrorHandler default_x_error = NULL;
 
 void setup_wm(void) {
-    wm.dpy = XOpenDisplay(NULL);
-    if (!wm.dpy) {
+    // Events, atoms, grabs and drawing are still Xlib, so only X11 will do
+    WMBackend *backend = backend_detect_and_init(&wm.backend);
+    if (!backend || backend->type != BACKEND_X11) {
         fprintf(stderr, "VaultWM: Cannot open display\n");
+        if (backend) backend->cleanup(wm.backend);
         exit(1);
     }
-
+    wm.dpy = x11_display(wm.backend);
+    default_x_error = XSetErrorHandler(handle_x_error);
+    
     wm.screen = DefaultScreen(wm.dpy);
     wm.root = RootWindow(wm.dpy, wm.screen);
-    wm.screen_width = DisplayWidth(wm.dpy, wm.screen);
-    wm.screen_height = DisplayHeight(wm.dpy, wm.screen);
     
     // Validate screen dimensions
-    if (wm.screen_width <= 0 || wm.screen_height <= 0) {
+    if (!backend_get_screen_size(wm.backend, &wm.screen_width, &wm.screen_height)) {
         fprintf(stderr, "VaultWM: Invalid screen dimensions: %dx%d\n", 
                 wm.screen_width, wm.screen_height);
-        XCloseDisplay(wm.dpy);
+        backend_cleanup(wm.backend);
         exit(1);
     }
     
@@ -111,33 +205,59 @@ void setup_wm(void) {
     wm.current_client = -1;
     wm.is_resizing = 0;
     wm.is_moving = 0;
+    wm.running = 1;
+    
+    /* Runtime configuration over the compiled-in defaults */
+    char path[512];
+    read_config_file(&wm.config);
+    plugin_stats_set_budget(wm.config.plugin_budget_ms, wm.config.plugin_max_overruns);
+    if (!build_palette(wm.config.theme, &wm.palette)) {
+        fprintf(stderr, "VaultWM: Warning: theme '%s' not found, using configured colours\n", wm.config.theme);
+        build_palette("", &wm.palette);
+    }
     
     /* Initialize window rules */
     window_rules_init(&wm.window_rules);
-    // Load rules from config file
-    char rules_path[512];
-    const char *home = getenv("HOME");
-    if (home) {
-        snprintf(rules_path, sizeof(rules_path), "%s/.config/vaultwm/rules", home);
-        window_rules_load(rules_path, &wm.window_rules);
+    load_window_rules();
+    
+    /* Workers for blocking reads; up first, since plugins may submit jobs from plugin_init */
+    if (!job_pool_init(JOB_WORKERS)) {
+        fprintf(stderr, "VaultWM: Warning: no worker threads, blocking work runs inline\n");
     }
     
-    /* Initialize workspaces */
+    /* Layout plugins extend the Mod4+t cycle after the built-in modes; loaded before
+     * the first workspaces so default_layout may name one */
+    layout_plugins_load_all();
+    
+    /* Extension plugins; those that subscribed to hooks are opened when a hook first fires */
+    plugin_load_all();
+    
+    /* Tags 1-9 for the Mod4+Ctrl keys; more can be created by name over IPC */
+    tag_manager_init(&wm.tag_mgr);
+    char tag_name[2] = "1";
+    for (tag_name[0] = '1'; tag_name[0] <= '9'; tag_name[0]++) {
+        tag_create(&wm.tag_mgr, tag_name);
+    }
+    
+    /* Workspaces 1-9 always exist; higher ones come and go on demand */
     int i;
-    for (i = 0; i < MAX_WORKSPACES; i++) {
-        wm.workspaces[i].num_clients = 0;
-        wm.workspaces[i].layout_mode = 0;  // Start in tiling mode
+    for (i = 0; i < DEFAULT_WORKSPACES; i++) {
+        if (!get_workspace(i)) {
+            fprintf(stderr, "VaultWM: Failed to allocate workspaces\n");
+            backend_cleanup(wm.backend);
+            exit(1);
+        }
     }
-
+    
     /* Create status bar window */
     XSetWindowAttributes attrs;
-    attrs.background_pixel = BLACK;
+    attrs.background_pixel = wm.palette.colors[PALETTE_BAR_BACKGROUND];
     attrs.override_redirect = True;
     attrs.event_mask = ExposureMask | ButtonPressMask;
     
     wm.status_bar = XCreateWindow(
         wm.dpy, wm.root,
-        0, 0, wm.screen_width, STATUS_BAR_HEIGHT,
+        0, 0, wm.screen_width, wm.config.status_bar_height,
         0, DefaultDepth(wm.dpy, wm.screen),
         CopyFromParent, DefaultVisual(wm.dpy, wm.screen),
         CWBackPixel | CWOverrideRedirect | CWEventMask,
@@ -146,20 +266,15 @@ void setup_wm(void) {
     
     if (wm.status_bar == None) {
         fprintf(stderr, "VaultWM: Failed to create status bar window\n");
-        XCloseDisplay(wm.dpy);
+        backend_cleanup(wm.backend);
         exit(1);
     }
     
-    if (XMapWindow(wm.dpy, wm.status_bar) == 0) {
-        fprintf(stderr, "VaultWM: Failed to map status bar window\n");
-        XDestroyWindow(wm.dpy, wm.status_bar);
-        XCloseDisplay(wm.dpy);
-        exit(1);
-    }
+    backend_map_window(wm.backend, wm.status_bar);
     
     /* Create graphics context for status bar */
     XGCValues gc_vals;
-    gc_vals.foreground = PIPBOY_GREEN;
+    gc_vals.foreground = wm.palette.colors[PALETTE_BAR_FOREGROUND];
     gc_vals.font = XLoadFont(wm.dpy, "fixed");
     
     if (gc_vals.font == None) {
@@ -170,70 +285,374 @@ void setup_wm(void) {
     wm.gc = XCreateGC(wm.dpy, wm.status_bar, GCForeground | GCFont, &gc_vals);
     if (wm.gc == None) {
         fprintf(stderr, "VaultWM: Failed to create graphics context\n");
-        XDestroyWindow(wm.dpy, wm.status_bar);
-        XCloseDisplay(wm.dpy);
+        backend_destroy_window(wm.backend, wm.status_bar);
+        backend_cleanup(wm.backend);
         exit(1);
     }
-
+    
     /* Set up atoms */
     wm.wm_protocols = XInternAtom(wm.dpy, "WM_PROTOCOLS", False);
     wm.wm_delete_window = XInternAtom(wm.dpy, "WM_DELETE_WINDOW", False);
-
+    wm.net_wm_name = XInternAtom(wm.dpy, "_NET_WM_NAME", False);
+    wm.net_wm_window_type = XInternAtom(wm.dpy, "_NET_WM_WINDOW_TYPE", False);
+    
     /* Select events */
     XSelectInput(wm.dpy, wm.root,
         SubstructureRedirectMask | SubstructureNotifyMask |
         ButtonPressMask | ButtonReleaseMask | KeyPressMask | PointerMotionMask);
+    
+    grab_keys();
+    
+    /* Set root window cursor */
+    Cursor cursor = XCreateFontCursor(wm.dpy, XC_left_ptr);
+    XDefineCursor(wm.dpy, wm.root, cursor);
+    
+    /* Monitors; the primary one's refresh rate paces layout animation */
+    monitor_init(wm.dpy, &wm.monitor_mgr);
+    build_screen_edges();
+    Monitor *primary = monitor_get_primary(&wm.monitor_mgr);
+    animation_init(&wm.anim, primary ? primary->refresh_mhz : 0, ANIMATION_DURATION_MS,
+        ANIMATION_MAX_WINDOWS, commit_geometry, NULL);
+    
+    /* Event sources; budgets keep an IPC flood from starving input and vice versa */
+    event_loop_init(&wm.loop);
+    event_loop_add_source(&wm.loop, "x11", ConnectionNumber(wm.dpy), X_EVENT_BUDGET,
+        dispatch_x_events, x_events_pending, NULL);
+    
+    /* IPC (FIFO for scripts, socket for vaultwmctl/libvaultwm-ipc) */
+    if (ipc_init()) {
+        ipc_set_command_handler(count_ipc_command);
+        event_loop_add_source(&wm.loop, "ipc", ipc_get_fd(), IPC_COMMAND_BUDGET,
+            dispatch_ipc, ipc_events_pending, NULL);
+    } else {
+        fprintf(stderr, "VaultWM: Warning: IPC disabled\n");
+    }
+    
+    /* Prometheus-format metrics for local scrapers */
+    if (metrics_init()) {
+        metrics_set_collector(collect_metrics);
+        event_loop_add_source(&wm.loop, "metrics", metrics_get_fd(), METRICS_SCRAPE_BUDGET,
+            dispatch_metrics, NULL, NULL);
+    } else {
+        fprintf(stderr, "VaultWM: Warning: metrics endpoint disabled\n");
+    }
+    
+    if (animation_get_fd(&wm.anim) >= 0) {
+        event_loop_add_source(&wm.loop, "animation", animation_get_fd(&wm.anim), 0,
+            dispatch_animation, NULL, NULL);
+    }
+    
+    /* Saved edits to config and rules apply without a reload command */
+    if (config_dir(path, sizeof(path)) && config_watch_init(path)) {
+        event_loop_add_source(&wm.loop, "config", config_watch_get_fd(), 1,
+            dispatch_config, NULL, NULL);
+    } else {
+        fprintf(stderr, "VaultWM: Warning: config hot reload disabled\n");
+    }
+    
+    /* Installing a rebuilt layout or extension plugin swaps it in without a restart */
+    int watched = layout_plugins_watch();
+    watched += plugin_watch_dirs();
+    if (watched) {
+        event_loop_add_source(&wm.loop, "plugins", plugin_watch_get_fd(), 1,
+            dispatch_plugins, NULL, NULL);
+    }
+    
+    /* Finished jobs hand their results back here */
+    if (job_pool_get_fd() >= 0) {
+        event_loop_add_source(&wm.loop, "jobs", job_pool_get_fd(), JOB_COMPLETION_BUDGET,
+            dispatch_jobs, jobs_pending, NULL);
+    }
+    
+    /* After a restart, take the handed-down state first; scanning then only adopts
+     * windows the previous instance did not manage */
+    restore_state();
+    
+    /* Adopt windows left from a previous instance, hidden ones included */
+    scan_windows();
+    
+    draw_status_bar();
+}
 
-    /* Grab keys - Basic */
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_Return),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_q),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_t),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_f),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_d),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    
-    /* Navigation keys - Arrow keys */
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_Left),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_Right),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_Up),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_Down),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    
-    /* Navigation keys - hjkl (vim-style) */
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_h),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_j),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_k),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_l),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    
-    /* Workspace keys (1-9) */
+/* (Re)grab every Mod4 binding; configured keys are resolved from their keysym names */
+void grab_keys(void) {
+    int i;
+    
+    XUngrabKey(wm.dpy, AnyKey, AnyModifier, wm.root);
+    
+    /* Rebindable keys */
+    for (i = 0; i < CONFIG_KEY_COUNT; i++) {
+        KeySym sym = XStringToKeysym(wm.config.keys[i]);
+        wm.keys[i] = sym != NoSymbol ? XKeysymToKeycode(wm.dpy, sym) : 0;
+        if (!wm.keys[i]) {
+            fprintf(stderr, "VaultWM: Warning: unknown key '%s', left unbound\n", wm.config.keys[i]);
+            continue;
+        }
+        XGrabKey(wm.dpy, wm.keys[i], Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
+    }
+    
+    /* Navigation keys - arrows and hjkl (vim-style); with Shift they move the window */
+    KeySym nav_keys[] = { XK_Left, XK_Right, XK_Up, XK_Down, XK_h, XK_j, XK_k, XK_l };
+    size_t nav;
+    for (nav = 0; nav < sizeof(nav_keys) / sizeof(nav_keys[0]); nav++) {
+        XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, nav_keys[nav]),
+            Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
+        XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, nav_keys[nav]),
+            Mod4Mask | ShiftMask, wm.root, True, GrabModeAsync, GrabModeAsync);
+    }
+    
+    /* Workspace keys (1-9); with Ctrl they toggle a tag view, with Ctrl+Shift a window tag */
     int key;
     for (key = XK_1; key <= XK_9; key++) {
         XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, key),
             Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
+        XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, key),
+            Mod4Mask | ControlMask, wm.root, True, GrabModeAsync, GrabModeAsync);
+        XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, key),
+            Mod4Mask | ControlMask | ShiftMask, wm.root, True, GrabModeAsync, GrabModeAsync);
+    }
+}
+
+/* ~/.config/vaultwm, where config and rules live; 0 if HOME is not set */
+int config_dir(char *path, size_t size) {
+    const char *home = getenv("HOME");
+    if (!home) return 0;
+    snprintf(path, size, "%s/.config/vaultwm", home);
+    return 1;
+}
+
+/* ~/.config/vaultwm/config over the defaults (all defaults if there is none);
+ * lines that do not parse are skipped and reported with their position */
+int read_config_file(VaultWMConfig *config) {
+    ConfigErrors errors;
+    char path[512];
+    int i;
+    
+    get_default_config(config);
+    if (!config_dir(path, sizeof(path))) return 0;
+    strncat(path, "/config", sizeof(path) - strlen(path) - 1);
+    if (!config_load(path, config, &errors)) {
+        get_default_config(config);  // Removed or unreadable: back to the built-in values
+        return 0;
     }
+    for (i = 0; i < errors.count && i < CONFIG_MAX_ERRORS; i++) {
+        fprintf(stderr, "VaultWM: %s:%d:%d: %s\n", path, errors.errors[i].line,
+                errors.errors[i].column, errors.errors[i].message);
+    }
+    if (errors.count > CONFIG_MAX_ERRORS) {
+        fprintf(stderr, "VaultWM: %s: %d more errors\n", path, errors.count - CONFIG_MAX_ERRORS);
+    }
+    return 1;
+}
+
+/* Reloads are numbered so a slow read never overwrites a newer one */
+static unsigned long config_generation = 0;
+static unsigned long config_applied = 0;
+
+typedef struct {
+    VaultWMConfig config;
+    unsigned long generation;
+} ConfigLoad;
+
+static void apply_loaded_config(const VaultWMConfig *updated, unsigned long generation) {
+    if (generation <= config_applied) return;
+    config_applied = generation;
     
-    /* Window management keys */
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_r),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
-    XGrabKey(wm.dpy, XKeysymToKeycode(wm.dpy, XK_m),
-        Mod4Mask, wm.root, True, GrabModeAsync, GrabModeAsync);
+    unsigned int changed = config_diff(&wm.config, updated);
+    wm.config = *updated;
+    apply_config(changed);
+}
 
-    /* Set root window cursor */
-    Cursor cursor = XCreateFontCursor(wm.dpy, XC_left_ptr);
-    XDefineCursor(wm.dpy, wm.root, cursor);
+/* Re-read the config file and touch only what the differences affect */
+void reload_config(void) {
+    VaultWMConfig updated;
+    
+    read_config_file(&updated);
+    apply_loaded_config(&updated, ++config_generation);
+}
 
-    draw_status_bar();
+/* Job: read and parse the file on a worker */
+static void read_config_job(void *arg) {
+    ConfigLoad *load = arg;
+    read_config_file(&load->config);
+}
+
+static void apply_config_job(void *arg) {
+    ConfigLoad *load = arg;
+    apply_loaded_config(&load->config, load->generation);
+    free(load);
+}
+
+/* reload_config() off the event thread; the changes apply when the read completes */
+void reload_config_async(void) {
+    ConfigLoad *load = malloc(sizeof(ConfigLoad));
+    
+    if (load) {
+        load->generation = ++config_generation;
+        if (job_submit(read_config_job, apply_config_job, load, NULL)) return;
+        free(load);
+    }
+    reload_config();
+}
+
+/* Bring the running WM in line with a config that differs in the CONFIG_CHANGED_* bits */
+void apply_config(unsigned int changed) {
+    int i, j;
+    
+    if (changed & CONFIG_CHANGED_BORDER) {
+        for (i = 0; i < wm.workspace_slots; i++) {
+            Workspace *ws = wm.workspaces[i];
+            if (!ws) continue;
+            for (j = 0; j < ws->num_clients; j++) {
+                backend_set_border_width(wm.backend, ws->clients[j].win, wm.config.border_width);
+            }
+        }
+    }
+    
+    /* A new theme in the file replaces whatever was picked over IPC; new border
+     * colours alone keep the theme in use and show through only without one */
+    if (changed & (CONFIG_CHANGED_COLORS | CONFIG_CHANGED_THEME)) {
+        const char *theme = (changed & CONFIG_CHANGED_THEME) ? wm.config.theme : wm.palette.name;
+        Palette next;
+        if (build_palette(theme, &next)) {
+            set_palette(&next);
+        } else {
+            fprintf(stderr, "VaultWM: Warning: theme '%s' not found, colours unchanged\n", theme);
+        }
+    }
+    
+    /* Health so far stands; only later calls are judged by the new budget */
+    if (changed & CONFIG_CHANGED_PLUGINS) {
+        plugin_stats_set_budget(wm.config.plugin_budget_ms, wm.config.plugin_max_overruns);
+    }
+    
+    if (changed & CONFIG_CHANGED_BAR) {
+        backend_resize_window(wm.backend, wm.status_bar, wm.screen_width, wm.config.status_bar_height);
+        build_screen_edges();
+    }
+    
+    if (changed & CONFIG_CHANGED_KEYS) {
+        grab_keys();
+    }
+    
+    /* Gaps and the bar change the work area of every workspace; hidden ones relayout when shown */
+    if (changed & (CONFIG_CHANGED_GAPS | CONFIG_CHANGED_BAR)) {
+        for (i = 0; i < wm.workspace_slots; i++) {
+            if (wm.workspaces[i]) wm.workspaces[i]->layout_dirty = 1;
+        }
+        tile_windows();
+    }
+    
+    if (changed & (CONFIG_CHANGED_BAR | CONFIG_CHANGED_STATUS)) {
+        update_status_bar();
+    }
+}
+
+/* The configured colours, overridden by theme's palette unless theme is "".
+ * Returns 0 if the theme cannot be found or read */
+int build_palette(const char *theme, Palette *palette) {
+    char path[512];
+    
+    palette_default(palette);
+    palette->colors[PALETTE_BORDER_FOCUSED] = wm.config.border_color_focused;
+    palette->colors[PALETTE_BORDER_UNFOCUSED] = wm.config.border_color_unfocused;
+    palette->colors[PALETTE_BORDER_URGENT] = wm.config.border_color_urgent;
+    if (!theme[0]) return 1;
+    if (!palette_find(theme, path, sizeof(path)) || !palette_load(path, palette)) return 0;
+    snprintf(palette->name, sizeof(palette->name), "%s", theme);
+    return 1;
+}
+
+/* Make next the palette in use and repaint only what differs, in one batch flushed
+ * together: borders on every workspace (hidden ones too, so nothing shows old colours
+ * when switched to), then the bar. Subscribers hear about a change of theme. */
+void set_palette(const Palette *next) {
+    unsigned int changed = palette_diff(&wm.palette, next);
+    int renamed = strcmp(wm.palette.name, next->name) != 0;
+    int i, j;
+    
+    wm.palette = *next;
+    
+    if (changed & PALETTE_BORDERS) {
+        for (i = 0; i < wm.workspace_slots; i++) {
+            Workspace *ws = wm.workspaces[i];
+            if (!ws) continue;
+            for (j = 0; j < ws->num_clients; j++) {
+                int focused = (i == wm.current_workspace && j == wm.current_client);
+                backend_set_border_color(wm.backend, ws->clients[j].win, wm.palette.colors[focused ?
+                    PALETTE_BORDER_FOCUSED : PALETTE_BORDER_UNFOCUSED]);
+            }
+        }
+    }
+    if (changed & PALETTE_BAR) {
+        XSetWindowBackground(wm.dpy, wm.status_bar, wm.palette.colors[PALETTE_BAR_BACKGROUND]);
+        XSetForeground(wm.dpy, wm.gc, wm.palette.colors[PALETTE_BAR_FOREGROUND]);
+    }
+    if (changed) {
+        update_status_bar();  // Clears to the new background and flushes the whole batch
+    }
+    if (renamed) {
+        ipc_broadcast_event(IPC_EVENT_THEME, "theme %s", wm.palette.name[0] ? wm.palette.name : "none");
+    }
+}
+
+/* Event loop callback: saved edits to config or rules */
+int dispatch_config(void *data, int budget) {
+    (void)data;
+    (void)budget;
+    unsigned int changed = config_watch_read();
+    
+    if (changed & CONFIG_WATCH_CONFIG) reload_config_async();
+    if (changed & CONFIG_WATCH_RULES) load_window_rules();
+    return changed ? 1 : 0;
+}
+
+static void plugin_changed(const char *path, void *data) {
+    int *relayout = data;
+    int index, i;
+    
+    // Extensions take effect at their next hook; only a layout needs a relayout
+    if (plugin_in_dirs(path)) {
+        if (plugin_reload(path)) {
+            fprintf(stderr, "VaultWM: Plugin reloaded from %s\n", path);
+        }
+        return;
+    }
+    
+    index = layout_plugin_reload(path);
+    if (index < 0) return;  // Reason already printed; the loaded version keeps running
+    fprintf(stderr, "VaultWM: Layout plugin %s loaded from %s\n", layout_plugin_name(index), path);
+    for (i = 0; i < wm.workspace_slots; i++) {
+        if (wm.workspaces[i] && wm.workspaces[i]->layout_mode == LAYOUT_COUNT + index) {
+            wm.workspaces[i]->layout_dirty = 1;
+            *relayout = 1;
+        }
+    }
+}
+
+/* Event loop callback: a layout or extension plugin was installed or rebuilt */
+int dispatch_plugins(void *data, int budget) {
+    (void)data;
+    (void)budget;
+    int relayout = 0;
+    int reported = plugin_watch_read(plugin_changed, &relayout);
+    
+    if (relayout) tile_windows();
+    if (reported) update_status_bar();
+    return reported ? 1 : 0;
+}
+
+/* ~/.config/vaultwm/rules, or a couple of built-in floats when there is no file */
+void load_window_rules(void) {
+    char rules_path[512];
+    
+    if (config_dir(rules_path, sizeof(rules_path))) {
+        strncat(rules_path, "/rules", sizeof(rules_path) - strlen(rules_path) - 1);
+        if (window_rules_load(rules_path, &wm.window_rules)) return;
+    }
+    window_rules_cleanup(&wm.window_rules);
+    window_rules_add(&wm.window_rules, "*Gimp*", "*", NULL, NULL, RULE_TYPE_FLOAT, "true");
+    window_rules_add(&wm.window_rules, "*Pidgin*", "*", NULL, NULL, RULE_TYPE_FLOAT, "true");
 }
 
 void cleanup_wm(void) {
@@ -241,15 +660,31 @@ void cleanup_wm(void) {
         return;  // Already cleaned up or never initialized
     }
     
+    // Let running jobs finish and apply their results while the display is still open
+    job_pool_cleanup();
+    
+    // Stop accepting IPC commands and scrapes
+    ipc_cleanup();
+    metrics_cleanup();
+    config_watch_cleanup();
+    plugin_watch_cleanup();
+    
     // Clean up monitor manager
     monitor_cleanup(&wm.monitor_mgr);
     
     // Clean up window rules
     window_rules_cleanup(&wm.window_rules);
     
+    // Unload layout plugins
+    layout_plugins_cleanup();
+    plugin_cleanup_all();
+    
+    // Stop the frame timer
+    animation_cleanup(&wm.anim);
+    
     // Clean up status bar
     if (wm.status_bar != None) {
-        XDestroyWindow(wm.dpy, wm.status_bar);
+        backend_destroy_window(wm.backend, wm.status_bar);
         wm.status_bar = None;
     }
     
@@ -261,20 +696,25 @@ void cleanup_wm(void) {
     
     // Unmap and destroy all managed windows
     int i, j;
-    for (i = 0; i < MAX_WORKSPACES; i++) {
-        Workspace *ws = &wm.workspaces[i];
+    for (i = 0; i < wm.workspace_slots; i++) {
+        Workspace *ws = wm.workspaces[i];
+        if (!ws) continue;
         for (j = 0; j < ws->num_clients; j++) {
             if (ws->clients[j].win != None) {
-                XUnmapWindow(wm.dpy, ws->clients[j].win);
-                XDestroyWindow(wm.dpy, ws->clients[j].win);
+                backend_unmap_window(wm.backend, ws->clients[j].win);
+                backend_destroy_window(wm.backend, ws->clients[j].win);
             }
         }
-        ws->num_clients = 0;
+        free(ws);
     }
+    free(wm.workspaces);
+    wm.workspaces = NULL;
+    wm.workspace_slots = 0;
     
     // Close display
-    XCloseDisplay(wm.dpy);
+    backend_cleanup(wm.backend);
     wm.dpy = NULL;
+    wm.backend = NULL;
 }
 
 /* Cached system information */
@@ -416,6 +856,67 @@ const char* get_network_status(void) {
     return cached_net_status;
 }
 
+/* What the bar and the metrics gauges show; the readers above run on a worker */
+typedef struct {
+    int cpu_usage;
+    int mem_usage;
+    const char *net_status;
+} SystemSample;
+
+static SystemSample system_sample = { 0, 0, "DOWN" };
+static int sample_in_flight = 0;  // One at a time: the caches above are not locked
+
+static void sample_system_job(void *arg) {
+    SystemSample *sample = arg;
+    
+    sample->cpu_usage = get_cpu_usage();
+    sample->mem_usage = get_memory_usage();
+    sample->net_status = get_network_status();
+}
+
+static void apply_system_sample(void *arg) {
+    system_sample = *(SystemSample *)arg;
+    free(arg);
+    sample_in_flight = 0;
+    update_status_bar();
+}
+
+/* Start reading /proc; returns 1 if the bar is redrawn once the figures are in */
+int refresh_system_sample(void) {
+    SystemSample *sample;
+    
+    if (sample_in_flight) return 0;
+    sample = malloc(sizeof(SystemSample));
+    if (!sample) return 0;
+    sample_in_flight = 1;
+    if (job_submit(sample_system_job, apply_system_sample, sample, NULL)) return 1;
+    sample_in_flight = 0;
+    free(sample);
+    return 0;
+}
+
+/* Human-readable layout name for the bar and IPC */
+static const char* layout_name(int mode) {
+    switch (mode) {
+        case LAYOUT_TILING: return "Tiling";
+        case LAYOUT_FLOATING: return "Floating";
+        case LAYOUT_MONOCLE: return "Monocle";
+        case LAYOUT_GRID: return "Grid";
+        case LAYOUT_FIBONACCI: return "Fibonacci";
+        case LAYOUT_DWINDLE: return "Dwindle";
+        default: return mode >= LAYOUT_COUNT ? layout_plugin_name(mode - LAYOUT_COUNT) : "Unknown";
+    }
+}
+
+/* Built-in or plugin layout by (case-insensitive) name; -1 if unknown */
+static int layout_from_name(const char *name) {
+    int mode, plugin = layout_plugin_find(name);
+    for (mode = 0; mode < LAYOUT_COUNT; mode++) {
+        if (strcasecmp(name, layout_name(mode)) == 0) return mode;
+    }
+    return plugin >= 0 ? LAYOUT_COUNT + plugin : -1;
+}
+
 void draw_status_bar(void) {
     char status[512];
     char time_str[64], date_str[64];
@@ -428,31 +929,23 @@ void draw_status_bar(void) {
     strftime(time_str, sizeof(time_str), "%H:%M:%S", timeinfo);
     strftime(date_str, sizeof(date_str), "%Y-%m-%d", timeinfo);
     
-    /* Get system info */
-    int cpu_usage = get_cpu_usage();
-    int mem_usage = get_memory_usage();
-    const char *net_status = get_network_status();
-    
-    /* Format status bar */
+    /* Format status bar; workspaces 1-9 show their configured name, if any */
     Workspace *ws = current_workspace();
-    const char *layout_name;
-    switch (ws->layout_mode) {
-        case LAYOUT_TILING: layout_name = "Tiling"; break;
-        case LAYOUT_FLOATING: layout_name = "Floating"; break;
-        case LAYOUT_MONOCLE: layout_name = "Monocle"; break;
-        case LAYOUT_GRID: layout_name = "Grid"; break;
-        case LAYOUT_FIBONACCI: layout_name = "Fibonacci"; break;
-        case LAYOUT_DWINDLE: layout_name = "Dwindle"; break;
-        default: layout_name = "Unknown"; break;
+    char ws_label[48];
+    const char *ws_name = wm.current_workspace < 9 ? wm.config.workspace_names[wm.current_workspace] : "";
+    if (ws_name[0] && atoi(ws_name) != wm.current_workspace + 1) {
+        snprintf(ws_label, sizeof(ws_label), "%d:%s", wm.current_workspace + 1, ws_name);
+    } else {
+        snprintf(ws_label, sizeof(ws_label), "%d", wm.current_workspace + 1);
     }
     snprintf(status, sizeof(status), 
-        "VaultOS | WS: %d | CPU: %d%% | MEM: %d%% | NET: %s | %s | %s | Clients: %d | Layout: %s | [Pip-Boy 3000]",
-        wm.current_workspace + 1, cpu_usage, mem_usage, net_status, date_str, time_str, 
-        ws->num_clients, layout_name);
+        "VaultOS | WS: %s | CPU: %d%% | MEM: %d%% | NET: %s | %s | %s | Clients: %d | Layout: %s | [Pip-Boy 3000]",
+        ws_label, system_sample.cpu_usage, system_sample.mem_usage, system_sample.net_status, date_str, time_str, 
+        ws->num_clients, layout_name(ws->layout_mode));
     
     XClearWindow(wm.dpy, wm.status_bar);
     XDrawString(wm.dpy, wm.status_bar, wm.gc, 10, 20, status, strlen(status));
-    XFlush(wm.dpy);
+    backend_flush(wm.backend);
 }
 
 void update_status_bar(void) {
@@ -461,48 +954,196 @@ void update_status_bar(void) {
 
 /* Get pointer to current workspace */
 Workspace* current_workspace(void) {
-    return &wm.workspaces[wm.current_workspace];
+    return wm.workspaces[wm.current_workspace];
+}
+
+/* Workspace by index, created on first use; NULL if out of range or out of memory */
+Workspace* get_workspace(int workspace) {
+    if (workspace < 0 || workspace >= WORKSPACE_LIMIT) return NULL;
+    
+    if (workspace >= wm.workspace_slots) {
+        int slots = wm.workspace_slots > 0 ? wm.workspace_slots : DEFAULT_WORKSPACES;
+        while (slots <= workspace) slots *= 2;
+        if (slots > WORKSPACE_LIMIT) slots = WORKSPACE_LIMIT;
+        
+        Workspace **grown = realloc(wm.workspaces, slots * sizeof(Workspace *));
+        if (!grown) return NULL;
+        memset(grown + wm.workspace_slots, 0, (slots - wm.workspace_slots) * sizeof(Workspace *));
+        wm.workspaces = grown;
+        wm.workspace_slots = slots;
+    }
+    
+    if (!wm.workspaces[workspace]) {
+        Workspace *ws = calloc(1, sizeof(Workspace));
+        if (!ws) return NULL;
+        int mode = layout_from_name(wm.config.default_layout);
+        ws->layout_mode = mode >= 0 ? mode : LAYOUT_TILING;
+        bsp_init(&ws->bsp);
+        spatial_init(&ws->spatial);
+        tag_table_init(&ws->tags);
+        ws->view = TAG_ALL;
+        wm.workspaces[workspace] = ws;
+    }
+    return wm.workspaces[workspace];
+}
+
+/* Free a workspace above the defaults once it is empty and hidden */
+static void release_workspace(int workspace) {
+    if (workspace < DEFAULT_WORKSPACES || workspace >= wm.workspace_slots ||
+        workspace == wm.current_workspace) return;
+    
+    Workspace *ws = wm.workspaces[workspace];
+    if (ws && ws->num_clients == 0) {
+        free(ws);
+        wm.workspaces[workspace] = NULL;
+    }
+}
+
+/* Record that a workspace needs a layout pass; only the visible one runs it now */
+void arrange_workspace(Workspace *ws) {
+    ws->layout_dirty = 1;
+    if (ws == current_workspace()) {
+        tile_windows();
+    }
 }
 
 /* Switch to workspace */
 void switch_workspace(int workspace) {
-    if (workspace < 0 || workspace >= MAX_WORKSPACES) return;
+    if (workspace == wm.current_workspace) return;
+    
+    Workspace *new_ws = get_workspace(workspace);
+    if (!new_ws) return;
     
     Workspace *old_ws = current_workspace();
+    int old = wm.current_workspace;
     int i;
     
+    /* Windows about to be hidden must not be left mid-slide */
+    animation_finish(&wm.anim);
+    
     /* Hide all windows in current workspace */
     for (i = 0; i < old_ws->num_clients; i++) {
-        XUnmapWindow(wm.dpy, old_ws->clients[i].win);
+        backend_unmap_window(wm.backend, old_ws->clients[i].win);
     }
     
     /* Switch workspace */
     wm.current_workspace = workspace;
     wm.current_client = -1;
+    release_workspace(old);
     
-    /* Show all windows in new workspace */
-    Workspace *new_ws = current_workspace();
+    /* Show all windows in new workspace; its layout runs only if it changed while hidden */
     tile_windows();
-    if (new_ws->num_clients > 0) {
-        focus_client(0);
+    int first = -1;
+    for (i = 0; i < new_ws->num_clients; i++) {
+        if (!client_visible(new_ws, i)) continue;
+        backend_map_window(wm.backend, new_ws->clients[i].win);
+        if (first < 0) first = i;
+    }
+    if (first >= 0) {
+        focus_client(first);
     }
     update_status_bar();
+    ipc_broadcast_event(IPC_EVENT_WORKSPACE, "workspace %d", workspace + 1);
+    plugin_notify(PLUGIN_HOOK_WORKSPACE_SWITCHED, 0, workspace + 1, 0);
 }
 
 /* Focus next window */
 void focus_next(void) {
     Workspace *ws = current_workspace();
-    if (ws->num_clients == 0) return;
-    int next = (wm.current_client + 1) % ws->num_clients;
-    focus_client(next);
+    int i, next = wm.current_client;
+    for (i = 0; i < ws->num_clients; i++) {
+        next = (next + 1) % ws->num_clients;
+        if (client_visible(ws, next)) {
+            focus_client(next);
+            return;
+        }
+    }
 }
 
 /* Focus previous window */
 void focus_prev(void) {
+    Workspace *ws = current_workspace();
+    int i, prev = wm.current_client < 0 ? 0 : wm.current_client;
+    for (i = 0; i < ws->num_clients; i++) {
+        prev = (prev - 1 + ws->num_clients) % ws->num_clients;
+        if (client_visible(ws, prev)) {
+            focus_client(prev);
+            return;
+        }
+    }
+}
+
+/* Index of window w in a workspace, or -1 */
+static int client_index(Workspace *ws, Window w) {
+    int i;
+    if (w == None) return -1;
+    for (i = 0; i < ws->num_clients; i++) {
+        if (ws->clients[i].win == w) return i;
+    }
+    return -1;
+}
+
+/* Focus the closest window on screen in direction dir */
+void focus_direction(Direction dir) {
     Workspace *ws = current_workspace();
     if (ws->num_clients == 0) return;
-    int prev = (wm.current_client - 1 + ws->num_clients) % ws->num_clients;
-    focus_client(prev);
+    if (wm.current_client < 0 || wm.current_client >= ws->num_clients) {
+        focus_client(0);
+        return;
+    }
+    
+    Window next = spatial_neighbor(&ws->spatial, ws->clients[wm.current_client].win, dir);
+    int index = client_index(ws, next);
+    if (index >= 0) {
+        focus_client(index);
+    }
+}
+
+/* Tiled windows trade places with their neighbour in dir; floating ones step that way */
+void move_direction(Direction dir) {
+    Workspace *ws = current_workspace();
+    if (wm.current_client < 0 || wm.current_client >= ws->num_clients) return;
+    
+    Client *c = &ws->clients[wm.current_client];
+    if (c->is_floating || ws->layout_mode == LAYOUT_FLOATING) {
+        c->x += (dir == DIR_LEFT) ? -wm.config.move_step : (dir == DIR_RIGHT) ? wm.config.move_step : 0;
+        c->y += (dir == DIR_UP) ? -wm.config.move_step : (dir == DIR_DOWN) ? wm.config.move_step : 0;
+        backend_move_window(wm.backend, c->win, c->x, c->y);
+        spatial_update(&ws->spatial, c->win, c->x, c->y, c->width, c->height);
+        return;
+    }
+    
+    int index = client_index(ws, spatial_neighbor(&ws->spatial, c->win, dir));
+    if (index < 0 || ws->clients[index].is_floating) return;
+    
+    // List order places windows in most layouts, the persistent tree in dwindle/fibonacci
+    Client tmp = ws->clients[index];
+    ws->clients[index] = *c;
+    *c = tmp;
+    bsp_swap(&ws->bsp, ws->clients[index].win, c->win);
+    wm.current_client = index;
+    arrange_workspace(ws);
+}
+
+/* Fixed snap edges: every monitor's sides (which covers the seams between them)
+ * and the bottom of the status bar */
+void build_screen_edges(void) {
+    int i;
+    
+    edge_index_init(&wm.screen_edges);
+    for (i = 0; i < wm.monitor_mgr.num_monitors; i++) {
+        Monitor *m = &wm.monitor_mgr.monitors[i];
+        edge_index_add(&wm.screen_edges, 1, m->x, m->y, m->y + m->height);
+        edge_index_add(&wm.screen_edges, 1, m->x + m->width, m->y, m->y + m->height);
+        edge_index_add(&wm.screen_edges, 0, m->y, m->x, m->x + m->width);
+        edge_index_add(&wm.screen_edges, 0, m->y + m->height, m->x, m->x + m->width);
+    }
+    if (wm.monitor_mgr.num_monitors == 0) {
+        edge_index_add(&wm.screen_edges, 1, 0, 0, wm.screen_height);
+        edge_index_add(&wm.screen_edges, 1, wm.screen_width, 0, wm.screen_height);
+        edge_index_add(&wm.screen_edges, 0, wm.screen_height, 0, wm.screen_width);
+    }
+    edge_index_add(&wm.screen_edges, 0, wm.config.status_bar_height, 0, wm.screen_width);
 }
 
 /* Validate command path - check if executable exists and is safe */
@@ -651,42 +1292,50 @@ void launch_application(const char *cmd) {
     // Parent process - don't wait for child (non-blocking)
 }
 
-void manage_window(Window w) {
-    Workspace *ws = current_workspace();
-    if (!ws) {
-        fprintf(stderr, "VaultWM: Invalid workspace in manage_window\n");
-        return;
-    }
-    
-    if (ws->num_clients >= MAX_WINDOWS) {
-        fprintf(stderr, "VaultWM: Maximum window limit reached (%d)\n", MAX_WINDOWS);
-        return;
-    }
-
+/* Manage a new window on the workspace its rules pick (default: the current one).
+ * Returns 1 if it belongs on screen now, 0 if it went to a hidden workspace or was refused */
+int manage_window(Window w) {
     XWindowAttributes wa;
     if (XGetWindowAttributes(wm.dpy, w, &wa) == 0) {
         fprintf(stderr, "VaultWM: Failed to get window attributes for window 0x%lx\n", w);
-        return;
+        return 0;
     }
-
+    
     // Get window class and instance for rules
-    XClassHint class_hint;
     char class_name[256] = "";
     char instance_name[256] = "";
+    read_window_class(w, class_name, instance_name, sizeof(class_name));
     
-    if (XGetClassHint(wm.dpy, w, &class_hint)) {
-        if (class_hint.res_class) {
-            strncpy(class_name, class_hint.res_class, sizeof(class_name) - 1);
-            class_name[sizeof(class_name) - 1] = '\0';
-        }
-        if (class_hint.res_name) {
-            strncpy(instance_name, class_hint.res_name, sizeof(instance_name) - 1);
-            instance_name[sizeof(instance_name) - 1] = '\0';
-        }
-        if (class_hint.res_class) XFree(class_hint.res_class);
-        if (class_hint.res_name) XFree(class_hint.res_name);
+    // Title and window type are only fetched when some rule looks at them
+    char title[256] = "";
+    char window_type[RULE_NAME_MAX] = "";
+    if (wm.window_rules.depends & RULE_DEPENDS_TITLE) {
+        read_window_title(w, title, sizeof(title));
     }
-
+    if (wm.window_rules.depends & RULE_DEPENDS_TYPE) {
+        read_window_type(w, window_type, sizeof(window_type));
+    }
+    
+    // Resolve rules before the window is ever mapped, so it never shows up in the wrong place
+    WindowProps props = { class_name, instance_name, title, window_type };
+    RuleResult rule;
+    window_rules_apply(&wm.window_rules, &props, &rule);
+    
+    int target = wm.current_workspace;
+    if (rule.workspace >= 0 && rule.workspace < WORKSPACE_LIMIT) {
+        target = rule.workspace;
+    }
+    Workspace *ws = get_workspace(target);
+    if (!ws) {
+        fprintf(stderr, "VaultWM: Invalid workspace in manage_window\n");
+        return 0;
+    }
+    
+    if (ws->num_clients >= MAX_WINDOWS) {
+        fprintf(stderr, "VaultWM: Maximum window limit reached (%d)\n", MAX_WINDOWS);
+        return 0;
+    }
+    
     Client *c = &ws->clients[ws->num_clients];
     c->win = w;
     c->is_floating = 0;  // Default to tiling
@@ -695,100 +1344,190 @@ void manage_window(Window w) {
     c->y = 0;
     c->width = wa.width;
     c->height = wa.height;
-
-    // Apply window rules
-    window_rules_apply(&wm.window_rules, w, class_name, instance_name);
+    layout_read_size_hints(wm.dpy, w, &c->hints);
+    snprintf(c->class_name, sizeof(c->class_name), "%s", class_name);
+    snprintf(c->instance_name, sizeof(c->instance_name), "%s", instance_name);
+    snprintf(c->window_type, sizeof(c->window_type), "%s", window_type);
+    c->rule = rule;
+    c->ignore_unmaps = 0;
+    
+    /* Tags survive a restart through _VAULTWM_TAGS; new windows join the view they open in */
+    unsigned int tags;
+    if (!window_tags_load(wm.dpy, w, &tags)) {
+        tags = (ws->view == TAG_ALL) ? 1u : ws->view;
+        window_tags_store(wm.dpy, w, tags);
+    }
+    tag_table_set(&ws->tags, ws->num_clients, tags);
     
-    // Check if rule set window to floating (simplified - full implementation would parse rule value)
-    // For now, we'll check common floating applications
-    if (strstr(class_name, "Gimp") || strstr(class_name, "Gimp") ||
-        strstr(class_name, "Pidgin") || strstr(class_name, "Pidgin")) {
-        c->is_floating = 1;
+    if (rule.floating >= 0) c->is_floating = rule.floating;
+    if (rule.width > 0) {
+        c->width = rule.width;
+        c->height = rule.height;
     }
+    if (rule.has_position) {
+        c->x = rule.x;
+        c->y = rule.y;
+    }
+    if (rule.width > 0 || rule.has_position) {
+        backend_move_resize_window(wm.backend, w, c->x, c->y, c->width, c->height);
+    }
+    if (rule.layout[0]) {
+        int mode = layout_from_name(rule.layout);
+        if (mode >= 0) ws->layout_mode = mode;
+    }
+    
+    setup_client_window(w);
+    backend_set_border_color(wm.backend, w, wm.palette.colors[PALETTE_BORDER_FOCUSED]);
+    
+    ws->num_clients++;
+    int shown = (target == wm.current_workspace) && client_visible(ws, ws->num_clients - 1);
+    arrange_workspace(ws);
+    if (shown) {
+        focus_client(ws->num_clients - 1);
+    }
+    update_status_bar();
+    ipc_broadcast_event(IPC_EVENT_WINDOW, "window new 0x%lx %s", w, class_name[0] ? class_name : "-");
+    plugin_notify(PLUGIN_HOOK_WINDOW_MAPPED, w, target + 1, 0);
+    return shown;
+}
 
-    /* Set border */
-    XSetWindowBorderWidth(wm.dpy, w, BORDER_WIDTH);
-    XSetWindowBorder(wm.dpy, w, PIPBOY_GREEN);
-
+/* Border, event mask and protocols of a window being managed */
+void setup_client_window(Window w) {
+    /* Set border */
+    backend_set_border_width(wm.backend, w, wm.config.border_width);
+    
     /* Set event mask */
     XSelectInput(wm.dpy, w,
         StructureNotifyMask | EnterWindowMask | LeaveWindowMask |
         FocusChangeMask | PropertyChangeMask | ButtonPressMask | ButtonMotionMask);
-
+    
     /* Set protocols */
     Atom protocols[] = {wm.wm_delete_window};
     Status status = XSetWMProtocols(wm.dpy, w, protocols, 1);
     if (status == 0) {
         fprintf(stderr, "VaultWM: Warning: Failed to set WM protocols for window 0x%lx\n", w);
     }
+}
 
-    ws->num_clients++;
-    tile_windows();
-    if (ws->num_clients > 0) {
-        focus_client(ws->num_clients - 1);
+/* WM_CLASS: res_class and res_name, "" when unset */
+void read_window_class(Window w, char *class_name, char *instance_name, size_t size) {
+    XClassHint class_hint;
+    
+    class_name[0] = instance_name[0] = '\0';
+    if (XGetClassHint(wm.dpy, w, &class_hint)) {
+        if (class_hint.res_class) {
+            snprintf(class_name, size, "%s", class_hint.res_class);
+            XFree(class_hint.res_class);
+        }
+        if (class_hint.res_name) {
+            snprintf(instance_name, size, "%s", class_hint.res_name);
+            XFree(class_hint.res_name);
+        }
     }
-    update_status_bar();
 }
 
+/* _NET_WM_NAME (UTF-8), falling back to WM_NAME */
+void read_window_title(Window w, char *out, size_t size) {
+    XTextProperty prop;
+    
+    out[0] = '\0';
+    if (!XGetTextProperty(wm.dpy, w, &prop, wm.net_wm_name) || !prop.value || prop.nitems == 0) {
+        if (!XGetWMName(wm.dpy, w, &prop) || !prop.value) return;
+    }
+    snprintf(out, size, "%s", (char *)prop.value);
+    XFree(prop.value);
+}
+
+/* First _NET_WM_WINDOW_TYPE, lowercased without its prefix: "dialog", "utility", ... */
+void read_window_type(Window w, char *out, size_t size) {
+    static const char prefix[] = "_NET_WM_WINDOW_TYPE_";
+    Atom type, *atoms = NULL;
+    int format;
+    unsigned long count, after;
+    char *name, *p;
+    
+    out[0] = '\0';
+    if (XGetWindowProperty(wm.dpy, w, wm.net_wm_window_type, 0, 1, False, XA_ATOM,
+            &type, &format, &count, &after, (unsigned char **)&atoms) != Success || !atoms) return;
+    if (count > 0 && (name = XGetAtomName(wm.dpy, atoms[0])) != NULL) {
+        p = strncmp(name, prefix, sizeof(prefix) - 1) == 0 ? name + sizeof(prefix) - 1 : name;
+        snprintf(out, size, "%s", p);
+        for (p = out; *p; p++) *p = tolower((unsigned char)*p);
+        XFree(name);
+    }
+    XFree(atoms);
+}
+
+/* Forget w on whichever workspace holds it; hidden ones included, since
+ * their windows can be destroyed while unmapped */
 void unmanage_window(Window w) {
-    Workspace *ws = current_workspace();
-    int i;
-    for (i = 0; i < ws->num_clients; i++) {
-        if (ws->clients[i].win == w) {
-            /* Remove from array */
-            memmove(&ws->clients[i], &ws->clients[i + 1],
-                (ws->num_clients - i - 1) * sizeof(Client));
-            ws->num_clients--;
-            if (wm.current_client >= ws->num_clients) {
-                wm.current_client = ws->num_clients - 1;
-            }
-            tile_windows();
-            update_status_bar();
-            return;
+    int n, i;
+    for (n = 0; n < wm.workspace_slots; n++) {
+        Workspace *ws = wm.workspaces[n];
+        if (!ws) continue;
+        i = client_index(ws, w);
+        if (i < 0) continue;
+        
+        /* Remove from array */
+        animation_forget(&wm.anim, w);
+        spatial_remove(&ws->spatial, w);
+        bsp_remove(&ws->bsp, w);  // Spares the next layout pass a search for it
+        tag_table_remove(&ws->tags, i);
+        memmove(&ws->clients[i], &ws->clients[i + 1],
+            (ws->num_clients - i - 1) * sizeof(Client));
+        ws->num_clients--;
+        if (n == wm.current_workspace && wm.current_client >= ws->num_clients) {
+            wm.current_client = ws->num_clients - 1;
         }
+        arrange_workspace(ws);
+        update_status_bar();
+        ipc_broadcast_event(IPC_EVENT_WINDOW, "window close 0x%lx", w);
+        plugin_notify(PLUGIN_HOOK_WINDOW_UNMAPPED, w, n + 1, 0);
+        release_workspace(n);
+        return;
     }
 }
 
 void tile_windows(void) {
     Workspace *ws = current_workspace();
+    if (!ws->layout_dirty) return;
+    ws->layout_dirty = 0;
     if (ws->num_clients == 0) return;
-
-    int usable_height = wm.screen_height - STATUS_BAR_HEIGHT - (WINDOW_GAP * 2);
-    int usable_width = wm.screen_width - (WINDOW_GAP * 2);
-    int y = STATUS_BAR_HEIGHT + WINDOW_GAP;
-    
-    if (ws->layout_mode == 0) {
-        /* Tiling layout */
-        int height = usable_height / ws->num_clients;
-        int i;
-        for (i = 0; i < ws->num_clients; i++) {
-            if (!ws->clients[i].is_floating) {
-                XMoveResizeWindow(wm.dpy, ws->clients[i].win,
-                    WINDOW_GAP, y, usable_width, height - WINDOW_GAP);
-                ws->clients[i].x = WINDOW_GAP;
-                ws->clients[i].y = y;
-                ws->clients[i].width = usable_width;
-                ws->clients[i].height = height - WINDOW_GAP;
-                y += height;
-            }
-        }
-    } else if (ws->layout_mode == 2) {
-        /* Monocle layout - fullscreen */
-        int i;
-        for (i = 0; i < ws->num_clients; i++) {
-            if (!ws->clients[i].is_floating && i == wm.current_client) {
-                XMoveResizeWindow(wm.dpy, ws->clients[i].win,
-                    0, STATUS_BAR_HEIGHT, wm.screen_width, usable_height);
-                ws->clients[i].x = 0;
-                ws->clients[i].y = STATUS_BAR_HEIGHT;
-                ws->clients[i].width = wm.screen_width;
-                ws->clients[i].height = usable_height;
-            } else if (!ws->clients[i].is_floating) {
-                XUnmapWindow(wm.dpy, ws->clients[i].win);
-            }
+    
+    metrics_inc(METRIC_LAYOUT_PASSES);
+    plugin_notify(PLUGIN_HOOK_PRE_LAYOUT, 0, wm.current_workspace + 1, ws->num_clients);
+    
+    /* Compute every client's target, then touch only windows that moved */
+    LayoutClient target[MAX_WINDOWS], applied[MAX_WINDOWS];
+    int i;
+    for (i = 0; i < ws->num_clients; i++) {
+        Client *c = &ws->clients[i];
+        applied[i].win = c->win;
+        applied[i].x = c->x;
+        applied[i].y = c->y;
+        applied[i].width = c->width;
+        applied[i].height = c->height;
+        applied[i].is_floating = c->is_floating || !client_visible(ws, i);  // Hidden by the view: keep out of the layout
+        applied[i].hints = c->hints;
+    }
+    memcpy(target, applied, ws->num_clients * sizeof(LayoutClient));
+    
+    layout_arrange(ws->layout_mode, &ws->bsp, target, ws->num_clients, 0, wm.config.status_bar_height,
+        wm.screen_width, wm.screen_height - wm.config.status_bar_height, wm.config.gap_size);
+    /* Slide when idle and few windows move; jump straight there under load */
+    animation_transition(&wm.anim, target, applied, ws->num_clients,
+        animation_now_ns(), event_loop_backlogged(&wm.loop));
+    
+    for (i = 0; i < ws->num_clients; i++) {
+        Client *c = &ws->clients[i];
+        c->x = applied[i].x;
+        c->y = applied[i].y;
+        c->width = applied[i].width;
+        c->height = applied[i].height;
+        if (client_visible(ws, i)) {
+            spatial_update(&ws->spatial, c->win, c->x, c->y, c->width, c->height);  // No-op when unchanged
         }
     }
-    /* Floating layout - windows manage their own position */
 }
 
 void focus_client(int index) {
@@ -806,7 +1545,7 @@ void focus_client(int index) {
     /* Unfocus previous client */
     if (wm.current_client >= 0 && wm.current_client < ws->num_clients) {
         if (ws->clients[wm.current_client].win != None) {
-            XSetWindowBorder(wm.dpy, ws->clients[wm.current_client].win, DARK_GREEN);
+            backend_set_border_color(wm.backend, ws->clients[wm.current_client].win, wm.palette.colors[PALETTE_BORDER_UNFOCUSED]);
         }
     }
     
@@ -817,66 +1556,618 @@ void focus_client(int index) {
         return;
     }
     
-    XRaiseWindow(wm.dpy, ws->clients[index].win);
-    XSetInputFocus(wm.dpy, ws->clients[index].win, RevertToPointerRoot, CurrentTime);
-    XSetWindowBorder(wm.dpy, ws->clients[index].win, PIPBOY_GREEN);
+    backend_focus_window(wm.backend, ws->clients[index].win);
+    backend_set_border_color(wm.backend, ws->clients[index].win, wm.palette.colors[PALETTE_BORDER_FOCUSED]);
     tile_windows();  /* Update layout for monocle */
     update_status_bar();
+    ipc_broadcast_event(IPC_EVENT_FOCUS, "focus 0x%lx", ws->clients[index].win);
+    plugin_notify(PLUGIN_HOOK_FOCUS_CHANGED, ws->clients[index].win, wm.current_workspace + 1, 0);
 }
 
-void handle_keypress(XKeyEvent *e) {
-    if (e->state != Mod4Mask) return;
+/* Ask a client to close via WM_DELETE_WINDOW */
+void close_client(int index) {
+    Workspace *ws = current_workspace();
+    if (index < 0 || index >= ws->num_clients) return;
     
+    XEvent ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.xclient.type = ClientMessage;
+    ev.xclient.window = ws->clients[index].win;
+    ev.xclient.message_type = wm.wm_protocols;
+    ev.xclient.format = 32;
+    ev.xclient.data.l[0] = wm.wm_delete_window;
+    ev.xclient.data.l[1] = CurrentTime;
+    XSendEvent(wm.dpy, ws->clients[index].win, False, NoEventMask, &ev);
+}
+
+/* Move a client of the current workspace to another workspace */
+void move_client_to_workspace(int index, int workspace) {
     Workspace *ws = current_workspace();
-    KeyCode keycode = e->keycode;
+    if (workspace == wm.current_workspace) return;
+    if (index < 0 || index >= ws->num_clients) return;
+    
+    Workspace *target = get_workspace(workspace);
+    if (!target) return;
+    if (target->num_clients >= MAX_WINDOWS) {
+        fprintf(stderr, "VaultWM: Workspace %d is full\n", workspace + 1);
+        return;
+    }
+    
+    Client c = ws->clients[index];
+    backend_unmap_window(wm.backend, c.win);
+    tag_table_set(&target->tags, target->num_clients, ws->tags.masks[index]);
+    tag_table_remove(&ws->tags, index);
+    target->clients[target->num_clients++] = c;
+    target->layout_dirty = 1;  // Arranged when the target is next shown
+    spatial_remove(&ws->spatial, c.win);
+    bsp_remove(&ws->bsp, c.win);
+    spatial_update(&target->spatial, c.win, c.x, c.y, c.width, c.height);
+    
+    memmove(&ws->clients[index], &ws->clients[index + 1],
+        (ws->num_clients - index - 1) * sizeof(Client));
+    ws->num_clients--;
+    wm.current_client = -1;
+    
+    arrange_workspace(ws);
+    if (ws->num_clients > 0) {
+        focus_client(index < ws->num_clients ? index : ws->num_clients - 1);
+    }
+    update_status_bar();
+}
+
+/* Non-zero if the client has a tag in its workspace's view */
+int client_visible(Workspace *ws, int index) {
+    return (ws->tags.masks[index] & ws->view) != 0;
+}
+
+/* Show the union of the tags in view (0 = everything). Visibility is diffed
+ * word by word, then the workspace gets a single layout pass and commit. */
+void set_view(Workspace *ws, unsigned int view) {
+    uint64_t before[TAG_WORDS], after[TAG_WORDS];
+    int w, i, on_screen = (ws == current_workspace());
+    
+    view &= TAG_ALL;
+    if (view == 0) view = TAG_ALL;
+    if (view == ws->view) return;
+    
+    tag_table_view(&ws->tags, ws->view, before);
+    tag_table_view(&ws->tags, view, after);
+    ws->view = view;
+    
+    for (w = 0; w < TAG_WORDS; w++) {
+        uint64_t changed = before[w] ^ after[w];
+        while (changed) {
+            i = w * 64 + __builtin_ctzll(changed);
+            changed &= changed - 1;
+            Client *c = &ws->clients[i];
+            if (after[w] & (1ull << (i % 64))) {
+                if (on_screen) backend_map_window(wm.backend, c->win);
+            } else {
+                if (on_screen) {
+                    c->ignore_unmaps++;
+                    backend_unmap_window(wm.backend, c->win);
+                }
+                spatial_remove(&ws->spatial, c->win);
+                bsp_remove(&ws->bsp, c->win);
+            }
+        }
+    }
+    
+    arrange_workspace(ws);
+    if (on_screen) {
+        if (wm.current_client < 0 || wm.current_client >= ws->num_clients ||
+            !client_visible(ws, wm.current_client)) {
+            wm.current_client = -1;
+            focus_next();
+        }
+        update_status_bar();
+    }
+    ipc_broadcast_event(IPC_EVENT_WORKSPACE, "view 0x%x", view);
+}
+
+/* Flip tags on a client of the current workspace; a window always keeps at least one */
+void toggle_client_tags(int index, unsigned int mask) {
+    Workspace *ws = current_workspace();
+    if (index < 0 || index >= ws->num_clients) return;
+    
+    unsigned int tags = (ws->tags.masks[index] ^ mask) & TAG_ALL;
+    if (tags == 0) return;
+    
+    Client *c = &ws->clients[index];
+    tag_table_set(&ws->tags, index, tags);
+    window_tags_store(wm.dpy, c->win, tags);
+    if (!client_visible(ws, index)) {
+        c->ignore_unmaps++;
+        backend_unmap_window(wm.backend, c->win);
+        spatial_remove(&ws->spatial, c->win);
+        bsp_remove(&ws->bsp, c->win);
+        wm.current_client = -1;
+        focus_next();
+    }
+    arrange_workspace(ws);
+}
+
+/* Manage existing top-level windows: mapped ones, and unmapped ones that carry
+ * _VAULTWM_TAGS because a tag view had hidden them */
+void scan_windows(void) {
+    Window root_ret, parent_ret, *children = NULL;
+    unsigned int i, n = 0;
+    
+    if (!XQueryTree(wm.dpy, wm.root, &root_ret, &parent_ret, &children, &n)) return;
+    for (i = 0; i < n; i++) {
+        XWindowAttributes wa;
+        unsigned int mask;
+        int w, managed = 0;
+        for (w = 0; w < wm.workspace_slots && !managed; w++) {
+            managed = wm.workspaces[w] && client_index(wm.workspaces[w], children[i]) >= 0;
+        }
+        if (managed || children[i] == wm.status_bar || !XGetWindowAttributes(wm.dpy, children[i], &wa) ||
+            wa.override_redirect) continue;
+        if (wa.map_state != IsViewable && !window_tags_load(wm.dpy, children[i], &mask)) continue;
+        if (manage_window(children[i])) {
+            backend_map_window(wm.backend, children[i]);
+        } else if (wa.map_state == IsViewable) {
+            /* Ruled to another workspace or outside the view; no UnmapNotify for us to act on */
+            Workspace *ws = current_workspace();
+            int index = client_index(ws, children[i]);
+            if (index >= 0) ws->clients[index].ignore_unmaps++;
+            backend_unmap_window(wm.backend, children[i]);
+        }
+    }
+    if (children) XFree(children);
+}
+
+/* Everything restore_state() reads back, in RESTART_VERSION order: focus, theme, tags
+ * created over IPC, then each workspace's layout, view and clients in stacking order */
+void save_state(StateBuffer *sb) {
+    Workspace *ws = current_workspace();
+    int i, j, workspaces = 0;
+    
+    state_put_uint(sb, (uint32_t)wm.current_workspace);
+    state_put_uint(sb, wm.current_client >= 0 && wm.current_client < ws->num_clients ?
+        (uint32_t)ws->clients[wm.current_client].win : 0);
+    state_put_str(sb, wm.palette.name);  // May have been picked over IPC
+    
+    /* Tags 1-9 always exist; the rest get their bits back by being created in order */
+    state_put_uint(sb, wm.tag_mgr.num_tags > 9 ? (uint32_t)(wm.tag_mgr.num_tags - 9) : 0);
+    for (i = 9; i < wm.tag_mgr.num_tags; i++) {
+        state_put_str(sb, wm.tag_mgr.tags[i].name);
+    }
+    
+    for (i = 0; i < wm.workspace_slots; i++) {
+        if (wm.workspaces[i]) workspaces++;
+    }
+    state_put_uint(sb, (uint32_t)workspaces);
+    for (i = 0; i < wm.workspace_slots; i++) {
+        if (!(ws = wm.workspaces[i])) continue;
+        state_put_uint(sb, (uint32_t)i);
+        state_put_str(sb, layout_name(ws->layout_mode));  // By name: plugin modes may renumber
+        state_put_uint(sb, ws->view);
+        state_put_uint(sb, (uint32_t)ws->num_clients);
+        for (j = 0; j < ws->num_clients; j++) {
+            Client *c = &ws->clients[j];
+            state_put_uint(sb, (uint32_t)c->win);
+            state_put_int(sb, c->x);
+            state_put_int(sb, c->y);
+            state_put_int(sb, c->width);
+            state_put_int(sb, c->height);
+            state_put_uint(sb, (uint32_t)c->is_floating);
+            state_put_uint(sb, ws->tags.masks[j]);
+        }
+    }
+}
+
+/* One client record from save_state(). The window keeps its geometry and map state;
+ * rules are resolved only so a later relabel knows what was applied. */
+static void restore_client(Workspace *ws, StateBuffer *sb) {
+    XWindowAttributes wa;
+    char title[256] = "";
+    Window w = (Window)state_get_uint(sb);
+    int x = state_get_int(sb);
+    int y = state_get_int(sb);
+    int width = state_get_int(sb);
+    int height = state_get_int(sb);
+    int floating = state_get_uint(sb) != 0;
+    unsigned int tags = state_get_uint(sb) & TAG_ALL;
+    
+    // Closed during the handoff, or a broken record
+    if (sb->error || w == None || ws->num_clients >= MAX_WINDOWS ||
+        !XGetWindowAttributes(wm.dpy, w, &wa) || wa.override_redirect) return;
+    
+    Client *c = &ws->clients[ws->num_clients];
+    memset(c, 0, sizeof(*c));
+    c->win = w;
+    c->x = x;
+    c->y = y;
+    c->width = width > 0 ? width : wa.width;
+    c->height = height > 0 ? height : wa.height;
+    c->is_floating = floating;
+    c->is_mapped = 1;
+    layout_read_size_hints(wm.dpy, w, &c->hints);
+    read_window_class(w, c->class_name, c->instance_name, sizeof(c->class_name));
+    if (wm.window_rules.depends & RULE_DEPENDS_TITLE) {
+        read_window_title(w, title, sizeof(title));
+    }
+    if (wm.window_rules.depends & RULE_DEPENDS_TYPE) {
+        read_window_type(w, c->window_type, sizeof(c->window_type));
+    }
+    WindowProps props = { c->class_name, c->instance_name, title, c->window_type };
+    window_rules_apply(&wm.window_rules, &props, &c->rule);
+    
+    tag_table_set(&ws->tags, ws->num_clients, tags ? tags : 1u);
+    setup_client_window(w);
+    backend_set_border_color(wm.backend, w, wm.palette.colors[PALETTE_BORDER_UNFOCUSED]);
+    ws->num_clients++;
+}
 
-    if (keycode == XKeysymToKeycode(wm.dpy, XK_Return)) {
+/* Take over the state a restart handed down, before anything is drawn. Nothing is
+ * mapped or unmapped: windows are where the previous instance left them. Returns 1
+ * if there was state to restore */
+int restore_state(void) {
+    StateBuffer sb;
+    char name[TAG_NAME_MAX];
+    uint32_t i, j, count;
+    
+    if (!restart_receive(&sb)) return 0;
+    
+    int current = (int)state_get_uint(&sb);
+    Window focused = (Window)state_get_uint(&sb);
+    char theme[PALETTE_NAME_MAX];
+    state_get_str(&sb, theme, sizeof(theme));
+    Palette palette;
+    if (!sb.error && strcmp(theme, wm.palette.name) != 0 && build_palette(theme, &palette)) {
+        set_palette(&palette);
+    }
+    count = state_get_uint(&sb);
+    for (i = 0; i < count && !sb.error; i++) {
+        state_get_str(&sb, name, sizeof(name));
+        if (!tag_find(&wm.tag_mgr, name)) tag_create(&wm.tag_mgr, name);
+    }
+    
+    count = state_get_uint(&sb);
+    for (i = 0; i < count && !sb.error; i++) {
+        char layout[64];
+        int index = (int)state_get_uint(&sb);
+        state_get_str(&sb, layout, sizeof(layout));
+        unsigned int view = state_get_uint(&sb) & TAG_ALL;
+        uint32_t clients = state_get_uint(&sb);
+        Workspace *ws = sb.error ? NULL : get_workspace(index);
+        if (!ws) break;
+        
+        int mode = layout_from_name(layout);
+        if (mode >= 0) ws->layout_mode = mode;  // A plugin that did not load keeps the default
+        ws->view = view ? view : TAG_ALL;
+        for (j = 0; j < clients && !sb.error; j++) {
+            restore_client(ws, &sb);
+        }
+        ws->layout_dirty = 1;
+    }
+    if (sb.error) {
+        fprintf(stderr, "VaultWM: Warning: restart state truncated, adopting the rest\n");
+    }
+    state_free(&sb);
+    
+    if (current >= 0 && current < WORKSPACE_LIMIT && get_workspace(current)) {
+        wm.current_workspace = current;
+    }
+    tile_windows();
+    Workspace *ws = current_workspace();
+    int index = client_index(ws, focused);
+    if (index >= 0 && client_visible(ws, index)) {
+        focus_client(index);
+    } else {
+        focus_next();
+    }
+    return 1;
+}
+
+/* Replace this process with the binary it was started from (re-read from disk, so a
+ * rebuilt WM takes over), handing the state down through a memfd. Windows are left
+ * alone: no unmap, no destroy. Only returns if the exec fails. */
+void restart_wm(void) {
+    StateBuffer sb;
+    char path[4096];
+    
+    // A config read in flight applies before the state is saved. The pool stays up:
+    // a cancelled restart carries on with it, and exec ends the workers
+    job_pool_drain();
+    animation_finish(&wm.anim);  // Hand down where windows end up, not a mid-slide frame
+    state_init(&sb);
+    save_state(&sb);
+    int fd = restart_handoff(&sb);
+    state_free(&sb);
+    if (fd < 0 || !restart_self_path(path, sizeof(path))) {
+        fprintf(stderr, "VaultWM: Cannot hand over state, restart cancelled\n");
+        if (fd >= 0) close(fd);
+        unsetenv(RESTART_FD_ENV);
+        return;
+    }
+    
+    // Give the sockets and the root window's redirect to the next instance
+    ipc_cleanup();
+    metrics_cleanup();
+    config_watch_cleanup();
+    plugin_watch_cleanup();
+    animation_cleanup(&wm.anim);
+    backend_cleanup(wm.backend);
+    wm.dpy = NULL;
+    wm.backend = NULL;
+    
+    execv(path, wm.argv);
+    execv("/proc/self/exe", wm.argv);  // Binary moved away: restart the image we run
+    fprintf(stderr, "VaultWM: restart failed: %s\n", strerror(errno));
+    exit(1);
+}
+
+/* Accounting of the extension or layout plugin called name, or NULL */
+static PluginStats* find_plugin_stats(const char *name) {
+    Plugin *plugins;
+    int count, i;
+    
+    plugins = plugin_get_all(&count);
+    for (i = 0; i < count; i++) {
+        if (strcmp(plugins[i].name, name) == 0) return plugin_get_stats(i);
+    }
+    i = layout_plugin_find(name);
+    return i >= 0 ? layout_plugin_stats(i) : NULL;
+}
+
+/* "name=health:calls:p99_us" per plugin, as many as fit one reply */
+static void list_plugin_stats(char *reply, size_t reply_size) {
+    Plugin *plugins;
+    int count, i, len = 0;
+    
+    reply[0] = '\0';
+    plugins = plugin_get_all(&count);
+    for (i = 0; i < count + layout_plugin_count() && (size_t)len < reply_size; i++) {
+        const char *name = i < count ? plugins[i].name : layout_plugin_name(i - count);
+        PluginStats *stats = i < count ? plugin_get_stats(i) : layout_plugin_stats(i - count);
+        len += snprintf(reply + len, reply_size - (size_t)len, "%s%s=%s:%llu:%llu", len ? " " : "",
+            name, plugin_health_name(stats->health), (unsigned long long)stats->calls,
+            (unsigned long long)plugin_stats_percentile_us(stats, 99));
+    }
+}
+
+/* Execute an IPC command (FIFO or socket) */
+int handle_ipc_command(const char *cmd, const char *args, char *reply, size_t reply_size) {
+    Workspace *ws = current_workspace();
+    
+    if (strcmp(cmd, IPC_CMD_QUIT) == 0) {
+        wm.running = 0;
+    } else if (strcmp(cmd, IPC_CMD_RESTART) == 0) {
+        /* Always the binary we were started as; the restart itself waits for the
+         * reply to go out, at the end of this loop iteration */
+        char path[4096] = "";
+        if (!restart_self_path(path, sizeof(path)) || access(path, X_OK) != 0) {
+            snprintf(reply, reply_size, "Cannot execute %s", path);
+            return 0;
+        }
+        wm.restart_requested = 1;
+    } else if (strcmp(cmd, IPC_CMD_RELOAD) == 0) {
+        if (!getenv("HOME")) {
+            snprintf(reply, reply_size, "HOME not set");
+            return 0;
+        }
+        reload_config();
+        load_window_rules();
+    } else if (strcmp(cmd, IPC_CMD_THEME) == 0) {
+        /* No argument: report the theme in use */
+        Palette next;
+        if (args[0] == '\0') {
+            snprintf(reply, reply_size, "%s", wm.palette.name[0] ? wm.palette.name : "none");
+            return 1;
+        }
+        if (!build_palette(strcmp(args, "none") == 0 ? "" : args, &next)) {
+            snprintf(reply, reply_size, "Unknown theme");
+            return 0;
+        }
+        set_palette(&next);
+    } else if (strcmp(cmd, IPC_CMD_WORKSPACE) == 0 || strcmp(cmd, IPC_CMD_MOVE_TO_WORKSPACE) == 0) {
+        char *end;
+        long n = strtol(args, &end, 10);
+        if (end == args || n < 1 || n > WORKSPACE_LIMIT) {
+            snprintf(reply, reply_size, "Workspace must be 1-%d", WORKSPACE_LIMIT);
+            return 0;
+        }
+        if (strcmp(cmd, IPC_CMD_WORKSPACE) == 0) {
+            switch_workspace((int)n - 1);
+        } else {
+            move_client_to_workspace(wm.current_client, (int)n - 1);
+        }
+    } else if (strcmp(cmd, IPC_CMD_FOCUS_NEXT) == 0) {
+        focus_next();
+    } else if (strcmp(cmd, IPC_CMD_FOCUS_PREV) == 0) {
+        focus_prev();
+    } else if (strcmp(cmd, IPC_CMD_FOCUS) == 0 || strcmp(cmd, IPC_CMD_MOVE) == 0) {
+        int dir = spatial_direction(args);
+        if (dir < 0) {
+            snprintf(reply, reply_size, "Direction must be left, right, up or down");
+            return 0;
+        }
+        if (strcmp(cmd, IPC_CMD_FOCUS) == 0) {
+            focus_direction((Direction)dir);
+        } else {
+            move_direction((Direction)dir);
+        }
+    } else if (strcmp(cmd, IPC_CMD_CLOSE_WINDOW) == 0) {
+        close_client(wm.current_client);
+    } else if (strcmp(cmd, IPC_CMD_TAG) == 0 || strcmp(cmd, IPC_CMD_VIEW) == 0 ||
+               strcmp(cmd, IPC_CMD_TOGGLE_VIEW) == 0) {
+        /* Tags are created on first use when tagging a window */
+        if (strcmp(cmd, IPC_CMD_TAG) == 0 && !strchr(args, ',') && strcmp(args, "all") != 0 &&
+            !tag_find(&wm.tag_mgr, args) && args[0] && !tag_create(&wm.tag_mgr, args)) {
+            snprintf(reply, reply_size, "Tag limit is %d", MAX_TAGS);
+            return 0;
+        }
+        unsigned int mask = tag_parse_mask(&wm.tag_mgr, args);
+        if (mask == 0) {
+            snprintf(reply, reply_size, "Unknown tag");
+            return 0;
+        }
+        if (strcmp(cmd, IPC_CMD_TAG) == 0) {
+            toggle_client_tags(wm.current_client, mask);
+        } else if (strcmp(cmd, IPC_CMD_VIEW) == 0) {
+            set_view(ws, mask);
+        } else {
+            set_view(ws, (ws->view == TAG_ALL ? 0 : ws->view) ^ mask);
+        }
+    } else if (strcmp(cmd, IPC_CMD_TOGGLE_FLOAT) == 0) {
+        if (wm.current_client >= 0 && wm.current_client < ws->num_clients) {
+            ws->clients[wm.current_client].is_floating = !ws->clients[wm.current_client].is_floating;
+            arrange_workspace(ws);
+        }
+    } else if (strcmp(cmd, IPC_CMD_TOGGLE_LAYOUT) == 0) {
+        ws->layout_mode = (ws->layout_mode + 1) % (LAYOUT_COUNT + layout_plugin_count());
+        arrange_workspace(ws);
+        update_status_bar();
+        ipc_broadcast_event(IPC_EVENT_LAYOUT, "layout %s", layout_name(ws->layout_mode));
+    } else if (strcmp(cmd, IPC_CMD_SET_LAYOUT) == 0) {
+        int mode = layout_from_name(args);
+        if (mode < 0) {
+            snprintf(reply, reply_size, "Unknown layout");
+            return 0;
+        }
+        ws->layout_mode = mode;
+        arrange_workspace(ws);
+        update_status_bar();
+        ipc_broadcast_event(IPC_EVENT_LAYOUT, "layout %s", layout_name(ws->layout_mode));
+    } else if (strcmp(cmd, IPC_CMD_ANIMATIONS) == 0) {
+        if (strcmp(args, "on") != 0 && strcmp(args, "off") != 0) {
+            snprintf(reply, reply_size, "Usage: animations <on|off>");
+            return 0;
+        }
+        animation_set_enabled(&wm.anim, strcmp(args, "on") == 0);
+        if (strcmp(args, "on") == 0 && !wm.anim.enabled) {
+            snprintf(reply, reply_size, "Animation unavailable");
+            return 0;
+        }
+    } else if (strcmp(cmd, IPC_CMD_PLUGINS) == 0) {
+        /* No argument: every plugin in brief; a name: its full accounting; "<name> reset"
+         * clears it, re-enabling a plugin the budget switched off */
+        char name[PLUGIN_NAME_MAX], action[16] = "";
+        if (args[0] == '\0') {
+            list_plugin_stats(reply, reply_size);
+            return 1;
+        }
+        PluginStats *stats = NULL;
+        if (sscanf(args, "%63s %15s", name, action) >= 1) stats = find_plugin_stats(name);
+        if (!stats || (action[0] && strcmp(action, "reset") != 0)) {
+            snprintf(reply, reply_size, stats ? "Usage: plugins [<name> [reset]]" : "Unknown plugin");
+            return 0;
+        }
+        if (action[0]) {
+            plugin_stats_reset(stats);
+        } else {
+            plugin_stats_format(stats, reply, reply_size);
+        }
+    } else if (strcmp(cmd, IPC_CMD_RESIZE_SPLIT) == 0) {
+        char *end;
+        double delta = strtod(args, &end);
+        if (end == args || delta < -BSP_RATIO_MAX || delta > BSP_RATIO_MAX) {
+            snprintf(reply, reply_size, "Usage: resize_split <delta>");
+            return 0;
+        }
+        if (wm.current_client < 0 || wm.current_client >= ws->num_clients ||
+            !bsp_adjust_ratio(&ws->bsp, ws->clients[wm.current_client].win, delta)) {
+            snprintf(reply, reply_size, "Focused window is not in a split");
+            return 0;
+        }
+        arrange_workspace(ws);
+    } else if (strcmp(cmd, IPC_CMD_GET_STATUS) == 0) {
+        Window focused = (wm.current_client >= 0 && wm.current_client < ws->num_clients) ?
+            ws->clients[wm.current_client].win : None;
+        snprintf(reply, reply_size, "workspace=%d clients=%d layout=%s focused=0x%lx",
+            wm.current_workspace + 1, ws->num_clients, layout_name(ws->layout_mode), focused);
+    } else {
+        snprintf(reply, reply_size, "Unknown command");
+        return 0;
+    }
+    
+    backend_flush(wm.backend);
+    return 1;
+}
+
+/* IPC handler installed with ipc_set_command_handler(); counts commands for the metrics */
+int count_ipc_command(const char *cmd, const char *args, char *reply, size_t reply_size) {
+    int ok = handle_ipc_command(cmd, args, reply, reply_size);
+    
+    metrics_inc(METRIC_IPC_COMMANDS);
+    if (!ok) {
+        metrics_inc(METRIC_IPC_ERRORS);
+    }
+    return ok;
+}
+
+/* Direction bound to an arrow or hjkl key, or -1 */
+static int key_direction(KeyCode keycode) {
+    if (keycode == XKeysymToKeycode(wm.dpy, XK_Left) || keycode == XKeysymToKeycode(wm.dpy, XK_h)) return DIR_LEFT;
+    if (keycode == XKeysymToKeycode(wm.dpy, XK_Right) || keycode == XKeysymToKeycode(wm.dpy, XK_l)) return DIR_RIGHT;
+    if (keycode == XKeysymToKeycode(wm.dpy, XK_Up) || keycode == XKeysymToKeycode(wm.dpy, XK_k)) return DIR_UP;
+    if (keycode == XKeysymToKeycode(wm.dpy, XK_Down) || keycode == XKeysymToKeycode(wm.dpy, XK_j)) return DIR_DOWN;
+    return -1;
+}
+
+void handle_keypress(XKeyEvent *e) {
+    Workspace *ws = current_workspace();
+    KeyCode keycode = e->keycode;
+    int dir = key_direction(keycode);
+    
+    /* Mod4+Shift+direction moves the focused window */
+    if (e->state == (Mod4Mask | ShiftMask) && dir >= 0) {
+        move_direction((Direction)dir);
+        return;
+    }
+    
+    /* Mod4+Ctrl+N toggles tag N in the view, Mod4+Ctrl+Shift+N on the focused window */
+    if ((e->state & ~ShiftMask) == (Mod4Mask | ControlMask) &&
+        keycode >= XKeysymToKeycode(wm.dpy, XK_1) && keycode <= XKeysymToKeycode(wm.dpy, XK_9)) {
+        unsigned int mask = 1u << (keycode - XKeysymToKeycode(wm.dpy, XK_1));
+        if (e->state & ShiftMask) {
+            toggle_client_tags(wm.current_client, mask);
+        } else {
+            set_view(ws, (ws->view == TAG_ALL ? 0 : ws->view) ^ mask);
+        }
+        return;
+    }
+    if (e->state != Mod4Mask) return;
+    
+    char cmd[160];
+    if (keycode == wm.keys[CONFIG_KEY_TERMINAL]) {
         /* Launch terminal */
-        launch_application(TERMINAL_CMD " || " TERMINAL_FALLBACK);
-    } else if (keycode == XKeysymToKeycode(wm.dpy, XK_d)) {
+        snprintf(cmd, sizeof(cmd), "%s || %s", wm.config.terminal_cmd, wm.config.terminal_fallback);
+        launch_application(cmd);
+    } else if (keycode == wm.keys[CONFIG_KEY_LAUNCHER]) {
         /* Launch application launcher */
-        launch_application(LAUNCHER_CMD " || " LAUNCHER_FALLBACK);
-    } else if (keycode == XKeysymToKeycode(wm.dpy, XK_q)) {
+        snprintf(cmd, sizeof(cmd), "%s || %s", wm.config.launcher_cmd, wm.config.launcher_fallback);
+        launch_application(cmd);
+    } else if (keycode == wm.keys[CONFIG_KEY_CLOSE]) {
         /* Quit focused window */
-        if (wm.current_client >= 0 && wm.current_client < ws->num_clients) {
-            XEvent ev;
-            ev.xclient.type = ClientMessage;
-            ev.xclient.window = ws->clients[wm.current_client].win;
-            ev.xclient.message_type = wm.wm_protocols;
-            ev.xclient.format = 32;
-            ev.xclient.data.l[0] = wm.wm_delete_window;
-            ev.xclient.data.l[1] = CurrentTime;
-            XSendEvent(wm.dpy, ws->clients[wm.current_client].win, False, NoEventMask, &ev);
-        }
-    } else if (keycode == XKeysymToKeycode(wm.dpy, XK_t)) {
+        close_client(wm.current_client);
+    } else if (keycode == wm.keys[CONFIG_KEY_TOGGLE_LAYOUT]) {
         /* Toggle layout: Tiling -> Floating -> Monocle */
-        ws->layout_mode = (ws->layout_mode + 1) % 6;  // Cycle through all layouts
-        tile_windows();
+        ws->layout_mode = (ws->layout_mode + 1) % (LAYOUT_COUNT + layout_plugin_count());  // Built-in layouts, then plugins
+        arrange_workspace(ws);
         update_status_bar();
-    } else if (keycode == XKeysymToKeycode(wm.dpy, XK_f)) {
+        ipc_broadcast_event(IPC_EVENT_LAYOUT, "layout %s", layout_name(ws->layout_mode));
+    } else if (keycode == wm.keys[CONFIG_KEY_TOGGLE_FLOAT]) {
         /* Toggle floating for current window */
         if (wm.current_client >= 0 && wm.current_client < ws->num_clients) {
             ws->clients[wm.current_client].is_floating = 
                 !ws->clients[wm.current_client].is_floating;
-            tile_windows();
+            arrange_workspace(ws);
         }
-    } else if (keycode == XKeysymToKeycode(wm.dpy, XK_Left) || 
-               keycode == XKeysymToKeycode(wm.dpy, XK_h)) {
-        /* Focus previous window */
-        focus_prev();
-    } else if (keycode == XKeysymToKeycode(wm.dpy, XK_Right) || 
-               keycode == XKeysymToKeycode(wm.dpy, XK_l)) {
-        /* Focus next window */
-        focus_next();
+    } else if (dir >= 0) {
+        /* Focus the neighbour on screen (arrows / hjkl) */
+        focus_direction((Direction)dir);
     } else if (keycode >= XKeysymToKeycode(wm.dpy, XK_1) && 
                keycode <= XKeysymToKeycode(wm.dpy, XK_9)) {
         /* Switch workspace (1-9) */
         int workspace = keycode - XKeysymToKeycode(wm.dpy, XK_1);
         switch_workspace(workspace);
-    } else if (keycode == XKeysymToKeycode(wm.dpy, XK_r)) {
+    } else if (keycode == wm.keys[CONFIG_KEY_RESIZE]) {
         /* Enter resize mode */
         wm.is_resizing = 1;
-    } else if (keycode == XKeysymToKeycode(wm.dpy, XK_m)) {
+    } else if (keycode == wm.keys[CONFIG_KEY_MOVE]) {
         /* Enter move mode */
         wm.is_moving = 1;
     }
@@ -896,32 +2187,184 @@ void handle_configure_request(XConfigureRequestEvent *e) {
 }
 
 void handle_map_request(XMapRequestEvent *e) {
-    manage_window(e->window);
-    XMapWindow(wm.dpy, e->window);
+    if (manage_window(e->window)) {
+        backend_map_window(wm.backend, e->window);
+    }
 }
 
 void handle_unmap_notify(XUnmapEvent *e) {
+    /* Reported to both the window and root; act once, and not on unmaps we made for a view */
+    if (e->event != wm.root) return;
+    Workspace *ws = current_workspace();
+    int index = client_index(ws, e->window);
+    if (index < 0) return;  // Hidden workspaces are unmapped by us on switch
+    if (ws->clients[index].ignore_unmaps > 0) {
+        ws->clients[index].ignore_unmaps--;
+        return;
+    }
     unmanage_window(e->window);
 }
 
+/* Windows hidden by a view or a workspace send no UnmapNotify when they go */
+void handle_destroy_notify(XDestroyWindowEvent *e) {
+    if (e->event != wm.root) return;
+    unmanage_window(e->window);
+}
+
+/* Requests race with clients closing their windows; BadWindow is expected
+ * then, anything else goes to Xlib's handler */
+int handle_x_error(Display *dpy, XErrorEvent *e) {
+    if (e->error_code == BadWindow) {
+        return 0;
+    }
+    return default_x_error(dpy, e);
+}
+
+/* Size hints are cached; refetch only when the client changes them */
+void handle_property_notify(XPropertyEvent *e) {
+    int i, j, changed = 0;
+    
+    if (e->state == PropertyDelete) {
+        return;
+    }
+    
+    // Rules are only re-evaluated for properties some rule actually looks at
+    if (e->atom == XA_WM_CLASS) {
+        changed = RULE_DEPENDS_CLASS;
+    } else if (e->atom == XA_WM_NAME || e->atom == wm.net_wm_name) {
+        changed = RULE_DEPENDS_TITLE;
+    } else if (e->atom == wm.net_wm_window_type) {
+        changed = RULE_DEPENDS_TYPE;
+    } else if (e->atom != XA_WM_NORMAL_HINTS) {
+        return;
+    }
+    if (changed && !(wm.window_rules.depends & changed)) {
+        return;
+    }
+    
+    for (i = 0; i < wm.workspace_slots; i++) {
+        Workspace *ws = wm.workspaces[i];
+        if (!ws) continue;
+        for (j = 0; j < ws->num_clients; j++) {
+            Client *c = &ws->clients[j];
+            if (c->win != e->window) continue;
+            
+            if (changed) {
+                reapply_window_rules(ws, j, changed);
+                return;
+            }
+            
+            SizeHints hints;
+            layout_read_size_hints(wm.dpy, c->win, &hints);
+            if (memcmp(&hints, &c->hints, sizeof(SizeHints)) != 0) {
+                c->hints = hints;
+                if (!c->is_floating) arrange_workspace(ws);
+            }
+            return;
+        }
+    }
+}
+
+/* Re-resolve rules after a client relabels itself (Spotify, Electron apps set
+ * WM_CLASS or the title after mapping). Only values whose resolution changed
+ * are applied, so later user changes to the window are left alone. */
+void reapply_window_rules(Workspace *ws, int index, int changed) {
+    Client *c = &ws->clients[index];
+    char title[256] = "";
+    int dirty = 0;
+    
+    if (changed == RULE_DEPENDS_CLASS) {
+        read_window_class(c->win, c->class_name, c->instance_name, sizeof(c->class_name));
+    } else if (changed == RULE_DEPENDS_TYPE) {
+        read_window_type(c->win, c->window_type, sizeof(c->window_type));
+    }
+    
+    WindowProps props = { c->class_name, c->instance_name, NULL, c->window_type };
+    if (changed == RULE_DEPENDS_TITLE && !window_rules_title_sensitive(&wm.window_rules, &props)) {
+        return;  // Terminals retitle constantly; no rule for this class cares
+    }
+    if (wm.window_rules.depends & RULE_DEPENDS_TITLE) {
+        read_window_title(c->win, title, sizeof(title));
+        props.title = title;
+    }
+    
+    RuleResult rule, old = c->rule;
+    window_rules_apply(&wm.window_rules, &props, &rule);
+    c->rule = rule;
+    
+    if (rule.floating >= 0 && rule.floating != old.floating) {
+        c->is_floating = rule.floating;
+        dirty = 1;
+    }
+    if ((rule.width > 0 && (rule.width != old.width || rule.height != old.height)) ||
+        (rule.has_position && (!old.has_position || rule.x != old.x || rule.y != old.y))) {
+        if (rule.width > 0) {
+            c->width = rule.width;
+            c->height = rule.height;
+        }
+        if (rule.has_position) {
+            c->x = rule.x;
+            c->y = rule.y;
+        }
+        backend_move_resize_window(wm.backend, c->win, c->x, c->y, c->width, c->height);
+        spatial_update(&ws->spatial, c->win, c->x, c->y, c->width, c->height);
+    }
+    if (rule.layout[0] && strcmp(rule.layout, old.layout) != 0) {
+        int mode = layout_from_name(rule.layout);
+        if (mode >= 0 && mode != ws->layout_mode) {
+            ws->layout_mode = mode;
+            dirty = 1;
+        }
+    }
+    if (dirty) {
+        arrange_workspace(ws);
+        if (ws == current_workspace()) update_status_bar();
+    }
+    
+    // Moving is last: it copies the client out of this workspace
+    if (rule.workspace >= 0 && rule.workspace < WORKSPACE_LIMIT && rule.workspace != old.workspace &&
+        ws == current_workspace()) {
+        move_client_to_workspace(index, rule.workspace);
+    }
+}
+
 void handle_motion_notify(XMotionEvent *e) {
     Workspace *ws = current_workspace();
     if (wm.is_resizing && wm.current_client >= 0 && wm.current_client < ws->num_clients) {
         Client *c = &ws->clients[wm.current_client];
         int dx = e->x_root - wm.resize_start_x;
         int dy = e->y_root - wm.resize_start_y;
-        XResizeWindow(wm.dpy, c->win, c->width + dx, c->height + dy);
-        c->width += dx;
-        c->height += dy;
+        int width = c->width - wm.snap_dx + dx;
+        int height = c->height - wm.snap_dy + dy;
+        int raw_w = width, raw_h = height;
+        /* Snap from where the pointer would put the corner, so the window sticks and then lets go */
+        spatial_snap(&ws->spatial, &wm.screen_edges, c->win, &c->x, &c->y, &width, &height,
+            wm.config.snap_threshold, 1);
+        wm.snap_dx = width - raw_w;
+        wm.snap_dy = height - raw_h;
+        if (width < 1) width = 1;
+        if (height < 1) height = 1;
+        backend_resize_window(wm.backend, c->win, width, height);
+        c->width = width;
+        c->height = height;
+        spatial_update(&ws->spatial, c->win, c->x, c->y, c->width, c->height);
         wm.resize_start_x = e->x_root;
         wm.resize_start_y = e->y_root;
     } else if (wm.is_moving && wm.current_client >= 0 && wm.current_client < ws->num_clients) {
         Client *c = &ws->clients[wm.current_client];
         int dx = e->x_root - wm.move_start_x;
         int dy = e->y_root - wm.move_start_y;
-        XMoveWindow(wm.dpy, c->win, c->x + dx, c->y + dy);
-        c->x += dx;
-        c->y += dy;
+        int x = c->x - wm.snap_dx + dx;
+        int y = c->y - wm.snap_dy + dy;
+        int raw_x = x, raw_y = y;
+        spatial_snap(&ws->spatial, &wm.screen_edges, c->win, &x, &y, &c->width, &c->height,
+            wm.config.snap_threshold, 0);
+        wm.snap_dx = x - raw_x;
+        wm.snap_dy = y - raw_y;
+        backend_move_window(wm.backend, c->win, x, y);
+        c->x = x;
+        c->y = y;
+        spatial_update(&ws->spatial, c->win, c->x, c->y, c->width, c->height);
         wm.move_start_x = e->x_root;
         wm.move_start_y = e->y_root;
     }
@@ -960,6 +2403,8 @@ void handle_buttonpress(XButtonEvent *e) {
 }
 
 void handle_event(XEvent *e) {
+    metrics_count_event(e->type);
+    
     switch (e->type) {
         case KeyPress:
             handle_keypress(&e->xkey);
@@ -970,6 +2415,7 @@ void handle_event(XEvent *e) {
                 e->xkey.keycode == XKeysymToKeycode(wm.dpy, XK_m)) {
                 wm.is_resizing = 0;
                 wm.is_moving = 0;
+                wm.snap_dx = wm.snap_dy = 0;
             }
             break;
         case ButtonPress:
@@ -978,6 +2424,7 @@ void handle_event(XEvent *e) {
         case ButtonRelease:
             wm.is_resizing = 0;
             wm.is_moving = 0;
+            wm.snap_dx = wm.snap_dy = 0;
             break;
         case MotionNotify:
             handle_motion_notify(&e->xmotion);
@@ -991,6 +2438,12 @@ void handle_event(XEvent *e) {
         case UnmapNotify:
             handle_unmap_notify(&e->xunmap);
             break;
+        case DestroyNotify:
+            handle_destroy_notify(&e->xdestroywindow);
+            break;
+        case PropertyNotify:
+            handle_property_notify(&e->xproperty);
+            break;
         case Expose:
             if (e->xexpose.window == wm.status_bar) {
                 draw_status_bar();
@@ -999,41 +2452,124 @@ void handle_event(XEvent *e) {
     }
 }
 
-int main(void) {
-    setup_wm();
-
+/* Event loop source: handle up to budget X events */
+int dispatch_x_events(void *data, int budget) {
     XEvent ev;
+    int handled = 0;
+    (void)data;
+    
+    while ((budget <= 0 || handled < budget) && backend_pending_events(wm.backend)) {
+        backend_wait_event(wm.backend, &ev);
+        handle_event(&ev);
+        handled++;
+    }
+    return handled;
+}
+
+/* Xlib may have read events into its queue while servicing other requests */
+int x_events_pending(void *data) {
+    (void)data;
+    return XEventsQueued(wm.dpy, QueuedAlready) > 0;
+}
+
+/* Event loop source: execute up to budget IPC commands */
+int dispatch_ipc(void *data, int budget) {
+    int handled = ipc_dispatch(budget);
+    (void)data;
+    if (handled > 0) {
+        backend_flush(wm.backend);
+    }
+    return handled;
+}
+
+int ipc_events_pending(void *data) {
+    (void)data;
+    return ipc_pending();
+}
+
+/* Event loop source: answer pending metrics scrapes */
+int dispatch_metrics(void *data, int budget) {
+    (void)data;
+    return metrics_dispatch(budget);
+}
+
+/* Event loop source: one animation frame per display refresh */
+int dispatch_animation(void *data, int budget) {
+    (void)data;
+    return animation_dispatch(&wm.anim, budget);
+}
+
+/* Event loop source: apply the results of finished jobs */
+int dispatch_jobs(void *data, int budget) {
+    (void)data;
+    return job_pool_dispatch(budget);
+}
+
+int jobs_pending(void *data) {
+    (void)data;
+    return job_pool_pending();
+}
+
+/* Animator commit hook: diffed configure requests, flushed so the frame shows this refresh */
+int commit_geometry(void *data, const LayoutClient *target, LayoutClient *shown, int num_clients) {
+    int changed = layout_commit(wm.dpy, target, shown, num_clients);
+    (void)data;
+    
+    metrics_add(METRIC_LAYOUT_RECONFIGURES, changed);
+    if (changed > 0) {
+        backend_flush(wm.backend);
+        plugin_notify(PLUGIN_HOOK_LAYOUT_COMMITTED, 0, wm.current_workspace + 1, changed);
+    }
+    return changed;
+}
+
+/* Sample gauges at scrape time so idle periods cost nothing */
+void collect_metrics(void) {
+    int i, clients = 0;
+    
+    for (i = 0; i < wm.workspace_slots; i++) {
+        if (wm.workspaces[i]) clients += wm.workspaces[i]->num_clients;
+    }
+    
+    // Xlib numbers every request it sends; the next sequence minus one is the total issued
+    metrics_set(METRIC_X_REQUESTS, (double)(NextRequest(wm.dpy) - 1));
+    metrics_set(METRIC_ANIMATION_FRAMES, wm.anim.frames);
+    metrics_set(METRIC_ANIMATION_DROPPED, wm.anim.dropped);
+    metrics_set(METRIC_ANIMATION_SKIPPED, wm.anim.skipped);
+    metrics_set(METRIC_CLIENTS, clients);
+    metrics_set(METRIC_WORKSPACE, wm.current_workspace + 1);
+    metrics_set(METRIC_MONITORS, monitor_count(&wm.monitor_mgr));
+    metrics_set(METRIC_CPU_USAGE, system_sample.cpu_usage);
+    metrics_set(METRIC_MEMORY_USAGE, system_sample.mem_usage);
+}
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    wm.argv = argv;
+    setup_wm();
+    
     time_t last_status_update = 0;
     
-    while (1) {
-        /* Check for X events with timeout for status bar updates */
-        fd_set fds;
-        struct timeval tv;
-        int x_fd = ConnectionNumber(wm.dpy);
+    while (wm.running) {
+        /* Wait for X/IPC work, waking at least twice a second for the status bar */
+        backend_flush(wm.backend);
+        event_loop_iterate(&wm.loop, 500);
         
-        FD_ZERO(&fds);
-        FD_SET(x_fd, &fds);
-        tv.tv_sec = 0;
-        tv.tv_usec = 500000;  /* 0.5 second timeout */
-        
-        int ret = select(x_fd + 1, &fds, NULL, NULL, &tv);
-        
-        if (ret > 0 && FD_ISSET(x_fd, &fds)) {
-            /* X event available */
-            while (XPending(wm.dpy)) {
-                XNextEvent(wm.dpy, &ev);
-                handle_event(&ev);
-            }
-        }
-        
-        /* Update status bar every second */
+        /* Update status bar every status_bar_update_interval seconds; with a fresh
+         * /proc sample on its way, its completion redraws instead */
         time_t now = time(NULL);
-        if (now != last_status_update) {
-            update_status_bar();
+        if (now - last_status_update >= wm.config.status_bar_update_interval) {
+            if (!refresh_system_sample()) update_status_bar();
+            plugin_update_all();
             last_status_update = now;
         }
+        
+        if (wm.restart_requested) {
+            wm.restart_requested = 0;
+            restart_wm();
+        }
     }
-
+    
     cleanup_wm();
     return 0;
 }
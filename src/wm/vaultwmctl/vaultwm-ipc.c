@@ -0,0 +1,275 @@
+/*
+ * libvaultwm-ipc - VaultWM IPC Client Library Implementation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "vaultwm-ipc.h"
+#include "../config/runtime-config/ipc.h"
+#include "../config/runtime-config/ipc-path.h"
+
+/* The server's lookup, from the header both are built with */
+int vaultwm_ipc_default_path(char *path, size_t path_size) {
+    return ipc_resolve_socket_path(path, path_size);
+}
+
+VaultWMIPC* vaultwm_ipc_connect(const char *socket_path) {
+    struct sockaddr_un addr;
+    char path[IPC_SOCKET_PATH_MAX];
+    VaultWMIPC *ipc;
+    
+    if (!socket_path) {
+        if (!vaultwm_ipc_default_path(path, sizeof(path))) {
+            return NULL;
+        }
+        socket_path = path;
+    }
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        return NULL;
+    }
+    
+    ipc = calloc(1, sizeof(VaultWMIPC));
+    if (!ipc) {
+        return NULL;
+    }
+    
+    ipc->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (ipc->fd < 0) {
+        free(ipc);
+        return NULL;
+    }
+    
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+    
+    if (connect(ipc->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(ipc->fd);
+        free(ipc);
+        return NULL;
+    }
+    
+    return ipc;
+}
+
+void vaultwm_ipc_disconnect(VaultWMIPC *ipc) {
+    VaultWMEvent *ev;
+    
+    if (!ipc) {
+        return;
+    }
+    
+    while ((ev = ipc->events) != NULL) {
+        ipc->events = ev->next;
+        free(ev);
+    }
+    if (ipc->fd >= 0) {
+        close(ipc->fd);
+    }
+    free(ipc);
+}
+
+int vaultwm_ipc_flush(VaultWMIPC *ipc) {
+    size_t off = 0;
+    
+    if (!ipc) {
+        return 0;
+    }
+    
+    while (off < ipc->out_len) {
+        ssize_t n = write(ipc->fd, ipc->out + off, ipc->out_len - off);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        off += (size_t)n;
+    }
+    
+    ipc->out_len = 0;
+    return 1;
+}
+
+int vaultwm_ipc_send(VaultWMIPC *ipc, const char *command) {
+    size_t len;
+    
+    if (!ipc || !command) {
+        return 0;
+    }
+    
+    len = strlen(command);
+    while (len > 0 && (command[len - 1] == '\n' || command[len - 1] == '\r')) {
+        len--;
+    }
+    if (len == 0 || len >= IPC_CMD_MAX || memchr(command, '\n', len)) {
+        return 0;
+    }
+    
+    // Requests are only written when the buffer fills or the caller flushes
+    if (ipc->out_len + len + 1 > sizeof(ipc->out) && !vaultwm_ipc_flush(ipc)) {
+        return 0;
+    }
+    
+    memcpy(ipc->out + ipc->out_len, command, len);
+    ipc->out[ipc->out_len + len] = '\n';
+    ipc->out_len += len + 1;
+    ipc->pending++;
+    return 1;
+}
+
+/* Pop one complete line from the input buffer, reading more as needed */
+static int read_line(VaultWMIPC *ipc, char *line, size_t line_size) {
+    for (;;) {
+        char *nl = memchr(ipc->in, '\n', ipc->in_len);
+        ssize_t n;
+        
+        if (nl) {
+            size_t len = (size_t)(nl - ipc->in);
+            size_t copy = (len < line_size - 1) ? len : line_size - 1;
+            memcpy(line, ipc->in, copy);
+            line[copy] = '\0';
+            memmove(ipc->in, nl + 1, ipc->in_len - len - 1);
+            ipc->in_len -= len + 1;
+            return 1;
+        }
+        
+        if (ipc->in_len == sizeof(ipc->in)) {
+            ipc->in_len = 0;  // Oversized line from a misbehaving server
+        }
+        
+        n = read(ipc->fd, ipc->in + ipc->in_len, sizeof(ipc->in) - ipc->in_len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return 0;
+        }
+        ipc->in_len += (size_t)n;
+    }
+}
+
+static int is_event_line(const char *line) {
+    size_t len = strlen(IPC_REPLY_EVENT);
+    return strncmp(line, IPC_REPLY_EVENT, len) == 0 && line[len] == ' ';
+}
+
+static void queue_event(VaultWMIPC *ipc, const char *line) {
+    VaultWMEvent *ev = malloc(sizeof(VaultWMEvent));
+    if (!ev) {
+        return;
+    }
+    strncpy(ev->line, line, sizeof(ev->line) - 1);
+    ev->line[sizeof(ev->line) - 1] = '\0';
+    ev->next = NULL;
+    if (ipc->events_tail) {
+        ipc->events_tail->next = ev;
+    } else {
+        ipc->events = ev;
+    }
+    ipc->events_tail = ev;
+}
+
+int vaultwm_ipc_read_reply(VaultWMIPC *ipc, char *reply, size_t reply_size) {
+    char line[VAULTWM_IPC_LINE_MAX];
+    
+    if (!ipc || ipc->pending == 0) {
+        return VAULTWM_IPC_IO_ERROR;
+    }
+    if (ipc->out_len > 0 && !vaultwm_ipc_flush(ipc)) {
+        return VAULTWM_IPC_IO_ERROR;
+    }
+    
+    for (;;) {
+        if (!read_line(ipc, line, sizeof(line))) {
+            return VAULTWM_IPC_IO_ERROR;
+        }
+        if (is_event_line(line)) {
+            queue_event(ipc, line);
+            continue;
+        }
+        break;
+    }
+    
+    ipc->pending--;
+    if (reply && reply_size > 0) {
+        strncpy(reply, line, reply_size - 1);
+        reply[reply_size - 1] = '\0';
+    }
+    
+    return strncmp(line, IPC_REPLY_OK, strlen(IPC_REPLY_OK)) == 0 ? VAULTWM_IPC_OK : VAULTWM_IPC_ERROR;
+}
+
+int vaultwm_ipc_command(VaultWMIPC *ipc, const char *command, char *reply, size_t reply_size) {
+    // Drain earlier pipelined replies so this one is matched to its request
+    while (ipc && ipc->pending > 0) {
+        if (vaultwm_ipc_read_reply(ipc, NULL, 0) == VAULTWM_IPC_IO_ERROR) {
+            return VAULTWM_IPC_IO_ERROR;
+        }
+    }
+    
+    if (!vaultwm_ipc_send(ipc, command) || !vaultwm_ipc_flush(ipc)) {
+        return VAULTWM_IPC_IO_ERROR;
+    }
+    
+    return vaultwm_ipc_read_reply(ipc, reply, reply_size);
+}
+
+int vaultwm_ipc_subscribe(VaultWMIPC *ipc, const char *event_classes) {
+    char request[IPC_CMD_MAX];
+    
+    snprintf(request, sizeof(request), "%s %s", IPC_CMD_SUBSCRIBE,
+             (event_classes && event_classes[0]) ? event_classes : "all");
+    
+    return vaultwm_ipc_command(ipc, request, NULL, 0);
+}
+
+int vaultwm_ipc_read_event(VaultWMIPC *ipc, char *event, size_t event_size) {
+    char line[VAULTWM_IPC_LINE_MAX];
+    const char *payload;
+    
+    if (!ipc || !event || event_size == 0) {
+        return 0;
+    }
+    
+    if (ipc->events) {
+        VaultWMEvent *ev = ipc->events;
+        ipc->events = ev->next;
+        if (!ipc->events) {
+            ipc->events_tail = NULL;
+        }
+        strncpy(line, ev->line, sizeof(line) - 1);
+        line[sizeof(line) - 1] = '\0';
+        free(ev);
+    } else {
+        for (;;) {
+            if (!read_line(ipc, line, sizeof(line))) {
+                return 0;
+            }
+            if (is_event_line(line)) {
+                break;
+            }
+            if (ipc->pending > 0) {
+                ipc->pending--;  // Reply nobody waited for
+            }
+        }
+    }
+    
+    payload = line + strlen(IPC_REPLY_EVENT) + 1;
+    strncpy(event, payload, event_size - 1);
+    event[event_size - 1] = '\0';
+    return 1;
+}
+
+int vaultwm_ipc_pending(VaultWMIPC *ipc) {
+    return ipc ? ipc->pending : 0;
+}
+
+int vaultwm_ipc_fd(VaultWMIPC *ipc) {
+    return ipc ? ipc->fd : -1;
+}
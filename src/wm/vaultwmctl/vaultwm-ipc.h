@@ -0,0 +1,68 @@
+/*
+ * libvaultwm-ipc - VaultWM IPC Client Library
+ * Persistent, pipelined connection to the VaultWM IPC socket
+ */
+
+#ifndef VAULTWM_IPC_CLIENT_H
+#define VAULTWM_IPC_CLIENT_H
+
+#include <stddef.h>
+
+#define VAULTWM_IPC_LINE_MAX 512
+#define VAULTWM_IPC_BUFFER_SIZE 8192
+
+/* Reply status */
+#define VAULTWM_IPC_OK 1
+#define VAULTWM_IPC_ERROR 0
+#define VAULTWM_IPC_IO_ERROR -1
+
+typedef struct VaultWMEvent {
+    struct VaultWMEvent *next;
+    char line[VAULTWM_IPC_LINE_MAX];
+} VaultWMEvent;
+
+typedef struct {
+    int fd;
+    char out[VAULTWM_IPC_BUFFER_SIZE];  // Requests not yet written
+    size_t out_len;
+    char in[VAULTWM_IPC_BUFFER_SIZE];   // Bytes read but not yet consumed
+    size_t in_len;
+    int pending;                        // Requests sent whose reply has not been read
+    VaultWMEvent *events;               // Events received while waiting for replies
+    VaultWMEvent *events_tail;
+} VaultWMIPC;
+
+/* Connect to the WM; socket_path NULL uses the default location */
+VaultWMIPC* vaultwm_ipc_connect(const char *socket_path);
+
+/* Close the connection and free queued events */
+void vaultwm_ipc_disconnect(VaultWMIPC *ipc);
+
+/* Queue a request without waiting for its reply (pipelining) */
+int vaultwm_ipc_send(VaultWMIPC *ipc, const char *command);
+
+/* Write all queued requests to the socket */
+int vaultwm_ipc_flush(VaultWMIPC *ipc);
+
+/* Read the reply to the oldest outstanding request */
+int vaultwm_ipc_read_reply(VaultWMIPC *ipc, char *reply, size_t reply_size);
+
+/* Send one request and wait for its reply */
+int vaultwm_ipc_command(VaultWMIPC *ipc, const char *command, char *reply, size_t reply_size);
+
+/* Subscribe to event classes ("all", or a list such as "workspace,focus") */
+int vaultwm_ipc_subscribe(VaultWMIPC *ipc, const char *event_classes);
+
+/* Block until the next event line arrives */
+int vaultwm_ipc_read_event(VaultWMIPC *ipc, char *event, size_t event_size);
+
+/* Number of requests still waiting for a reply */
+int vaultwm_ipc_pending(VaultWMIPC *ipc);
+
+/* Socket descriptor, for callers integrating with their own poll loop */
+int vaultwm_ipc_fd(VaultWMIPC *ipc);
+
+/* Resolve the default socket path */
+int vaultwm_ipc_default_path(char *path, size_t path_size);
+
+#endif /* VAULTWM_IPC_CLIENT_H */
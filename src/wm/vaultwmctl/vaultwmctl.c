@@ -0,0 +1,144 @@
+/*
+ * vaultwmctl - VaultWM Command Line Control
+ * Sends commands to a running VaultWM over one persistent IPC connection
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "vaultwm-ipc.h"
+
+#define BATCH_WINDOW 128  // Replies allowed in flight before we start reading them
+
+static int quiet = 0;
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [-s socket] [-q] command [args...]\n"
+        "       %s [-s socket] [-q] -b          (batch: one command per stdin line)\n"
+        "       %s [-s socket] -S [classes]     (subscribe: print events until EOF)\n"
+        "\n"
+        "Event classes: all, workspace, window, focus, layout, theme (comma separated)\n",
+        prog, prog, prog);
+}
+
+static int print_reply(int status, const char *reply) {
+    if (status == VAULTWM_IPC_IO_ERROR) {
+        fprintf(stderr, "vaultwmctl: connection lost\n");
+        return 2;
+    }
+    if (status == VAULTWM_IPC_ERROR) {
+        fprintf(stderr, "%s\n", reply);
+        return 1;
+    }
+    if (!quiet) {
+        printf("%s\n", reply);
+    }
+    return 0;
+}
+
+/* Pipeline stdin: keep up to BATCH_WINDOW requests in flight */
+static int run_batch(VaultWMIPC *ipc) {
+    char line[VAULTWM_IPC_LINE_MAX];
+    char reply[VAULTWM_IPC_LINE_MAX];
+    int result = 0;
+    
+    while (fgets(line, sizeof(line), stdin)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+        
+        if (!vaultwm_ipc_send(ipc, line)) {
+            fprintf(stderr, "vaultwmctl: invalid command: %s\n", line);
+            result = 1;
+            continue;
+        }
+        
+        if (vaultwm_ipc_pending(ipc) >= BATCH_WINDOW) {
+            int rc = print_reply(vaultwm_ipc_read_reply(ipc, reply, sizeof(reply)), reply);
+            if (rc == 2) {
+                return 2;
+            }
+            result |= rc;
+        }
+    }
+    
+    while (vaultwm_ipc_pending(ipc) > 0) {
+        int rc = print_reply(vaultwm_ipc_read_reply(ipc, reply, sizeof(reply)), reply);
+        if (rc == 2) {
+            return 2;
+        }
+        result |= rc;
+    }
+    
+    return result;
+}
+
+static int run_subscribe(VaultWMIPC *ipc, const char *classes) {
+    char event[VAULTWM_IPC_LINE_MAX];
+    
+    if (vaultwm_ipc_subscribe(ipc, classes) != VAULTWM_IPC_OK) {
+        fprintf(stderr, "vaultwmctl: subscribe failed\n");
+        return 1;
+    }
+    
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    while (vaultwm_ipc_read_event(ipc, event, sizeof(event))) {
+        printf("%s\n", event);
+    }
+    
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *socket_path = NULL;
+    int batch = 0, subscribe = 0;
+    char command[VAULTWM_IPC_LINE_MAX];
+    char reply[VAULTWM_IPC_LINE_MAX];
+    VaultWMIPC *ipc;
+    int opt, i, result;
+    
+    while ((opt = getopt(argc, argv, "s:bSqh")) != -1) {
+        switch (opt) {
+            case 's': socket_path = optarg; break;
+            case 'b': batch = 1; break;
+            case 'S': subscribe = 1; break;
+            case 'q': quiet = 1; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    
+    if (!batch && !subscribe && optind >= argc) {
+        usage(argv[0]);
+        return 2;
+    }
+    
+    ipc = vaultwm_ipc_connect(socket_path);
+    if (!ipc) {
+        fprintf(stderr, "vaultwmctl: cannot connect to VaultWM (is it running?)\n");
+        return 2;
+    }
+    
+    if (batch) {
+        result = run_batch(ipc);
+    } else if (subscribe) {
+        result = run_subscribe(ipc, optind < argc ? argv[optind] : "all");
+    } else {
+        // Remaining arguments form one command line
+        command[0] = '\0';
+        for (i = optind; i < argc; i++) {
+            if (i > optind) {
+                strncat(command, " ", sizeof(command) - strlen(command) - 1);
+            }
+            strncat(command, argv[i], sizeof(command) - strlen(command) - 1);
+        }
+        result = print_reply(vaultwm_ipc_command(ipc, command, reply, sizeof(reply)), reply);
+    }
+    
+    vaultwm_ipc_disconnect(ipc);
+    return result;
+}
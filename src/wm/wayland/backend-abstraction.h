@@ -1,6 +1,8 @@
 /*
  * VaultWM Backend Abstraction Layer
- * Provides unified interface for X11 and Wayland backends
+ * Provides unified interface for X11 and Wayland backends. With a single
+ * backend compiled in, the backend_*() calls below resolve to it at
+ * compile time and inline; with several, they go through WMBackend
  */
 
 #ifndef VAULTWM_BACKEND_H
@@ -8,9 +10,13 @@
 
 #include <stdint.h>
 
-/* Forward declarations */
-typedef struct Window Window;
-typedef struct Display Display;
+/* Display connection (opaque): an X11 Display or a wl_display */
+typedef struct BackendDisplay BackendDisplay;
+
+/* Window handle: an X11 window id or a Wayland surface id */
+typedef unsigned long BackendWindow;
+
+#define BACKEND_NO_WINDOW 0
 
 /* Backend types */
 typedef enum {
@@ -19,62 +25,136 @@ typedef enum {
     BACKEND_UNKNOWN
 } BackendType;
 
-/* Window structure (opaque) */
-struct Window {
-    void *native_handle;  // X11 Window or wl_surface
-    BackendType backend;
-};
-
-/* Display structure (opaque) */
-struct Display {
-    void *native_handle;  // X11 Display or wl_display
-    BackendType backend;
-};
-
 /* Backend operations */
 typedef struct {
     /* Initialization */
-    int (*init)(Display **dpy);
-    void (*cleanup)(Display *dpy);
+    int (*init)(BackendDisplay **dpy);
+    void (*cleanup)(BackendDisplay *dpy);
     
     /* Window operations */
-    int (*create_window)(Display *dpy, Window **win, int x, int y, int w, int h);
-    void (*destroy_window)(Display *dpy, Window *win);
-    void (*resize_window)(Display *dpy, Window *win, int w, int h);
-    void (*move_window)(Display *dpy, Window *win, int x, int y);
-    void (*map_window)(Display *dpy, Window *win);
-    void (*unmap_window)(Display *dpy, Window *win);
+    int (*create_window)(BackendDisplay *dpy, BackendWindow *win, int x, int y, int w, int h);
+    void (*destroy_window)(BackendDisplay *dpy, BackendWindow win);
+    void (*resize_window)(BackendDisplay *dpy, BackendWindow win, int w, int h);
+    void (*move_window)(BackendDisplay *dpy, BackendWindow win, int x, int y);
+    void (*move_resize_window)(BackendDisplay *dpy, BackendWindow win, int x, int y, int w, int h);
+    void (*map_window)(BackendDisplay *dpy, BackendWindow win);
+    void (*unmap_window)(BackendDisplay *dpy, BackendWindow win);
+    void (*raise_window)(BackendDisplay *dpy, BackendWindow win);
     
     /* Focus and input */
-    void (*focus_window)(Display *dpy, Window *win);
-    void (*set_input_focus)(Display *dpy, Window *win);
+    void (*focus_window)(BackendDisplay *dpy, BackendWindow win);     // Raise and focus
+    void (*set_input_focus)(BackendDisplay *dpy, BackendWindow win);  // Focus only
     
     /* Properties */
-    void (*set_border)(Display *dpy, Window *win, uint32_t color, int width);
-    void (*set_title)(Display *dpy, Window *win, const char *title);
+    void (*set_border_color)(BackendDisplay *dpy, BackendWindow win, unsigned long color);
+    void (*set_border_width)(BackendDisplay *dpy, BackendWindow win, int width);
+    void (*set_title)(BackendDisplay *dpy, BackendWindow win, const char *title);
     
     /* Events */
-    int (*wait_event)(Display *dpy, void *event);
-    int (*pending_events)(Display *dpy);
+    int (*wait_event)(BackendDisplay *dpy, void *event);
+    int (*pending_events)(BackendDisplay *dpy);
+    void (*flush)(BackendDisplay *dpy);
     
     /* Monitor/Output */
-    int (*get_screen_size)(Display *dpy, int *w, int *h);
-    int (*get_monitor_count)(Display *dpy);
+    int (*get_screen_size)(BackendDisplay *dpy, int *w, int *h);
     
     /* Backend info */
     BackendType type;
     const char *name;
 } WMBackend;
 
-/* Get backend for protocol */
+/* Get backend for protocol; NULL if it is not compiled in */
 WMBackend* backend_get_x11(void);
 WMBackend* backend_get_wayland(void);
 
-/* Detect and initialize backend */
-WMBackend* backend_detect_and_init(Display **dpy);
+/* Open the session's backend: Wayland if WAYLAND_DISPLAY is set and that
+ * backend is built and starts, otherwise X11. NULL if none could */
+WMBackend* backend_detect_and_init(BackendDisplay **dpy);
 
 /* Get current backend */
 WMBackend* backend_get_current(void);
 
-#endif /* VAULTWM_BACKEND_H */
+#if defined(VAULTWM_BACKEND_X11) && !defined(VAULTWM_BACKEND_WAYLAND)
+#define VAULTWM_BACKEND_STATIC 1
+#include "x11-backend.h"
+#define BACKEND_OP(op) x11_##op
+#else
+extern WMBackend *backend_current;
+#define BACKEND_OP(op) backend_current->op
+#endif
+
+/* Calls for the hot paths; one direct (usually inlined) call per operation when
+ * the backend is known at build time */
+static inline void backend_cleanup(BackendDisplay *dpy) {
+    BACKEND_OP(cleanup)(dpy);
+}
+
+static inline int backend_create_window(BackendDisplay *dpy, BackendWindow *win, int x, int y, int w, int h) {
+    return BACKEND_OP(create_window)(dpy, win, x, y, w, h);
+}
+
+static inline void backend_destroy_window(BackendDisplay *dpy, BackendWindow win) {
+    BACKEND_OP(destroy_window)(dpy, win);
+}
+
+static inline void backend_resize_window(BackendDisplay *dpy, BackendWindow win, int w, int h) {
+    BACKEND_OP(resize_window)(dpy, win, w, h);
+}
+
+static inline void backend_move_window(BackendDisplay *dpy, BackendWindow win, int x, int y) {
+    BACKEND_OP(move_window)(dpy, win, x, y);
+}
+
+static inline void backend_move_resize_window(BackendDisplay *dpy, BackendWindow win, int x, int y, int w, int h) {
+    BACKEND_OP(move_resize_window)(dpy, win, x, y, w, h);
+}
+
+static inline void backend_map_window(BackendDisplay *dpy, BackendWindow win) {
+    BACKEND_OP(map_window)(dpy, win);
+}
 
+static inline void backend_unmap_window(BackendDisplay *dpy, BackendWindow win) {
+    BACKEND_OP(unmap_window)(dpy, win);
+}
+
+static inline void backend_raise_window(BackendDisplay *dpy, BackendWindow win) {
+    BACKEND_OP(raise_window)(dpy, win);
+}
+
+static inline void backend_focus_window(BackendDisplay *dpy, BackendWindow win) {
+    BACKEND_OP(focus_window)(dpy, win);
+}
+
+static inline void backend_set_input_focus(BackendDisplay *dpy, BackendWindow win) {
+    BACKEND_OP(set_input_focus)(dpy, win);
+}
+
+static inline void backend_set_border_color(BackendDisplay *dpy, BackendWindow win, unsigned long color) {
+    BACKEND_OP(set_border_color)(dpy, win, color);
+}
+
+static inline void backend_set_border_width(BackendDisplay *dpy, BackendWindow win, int width) {
+    BACKEND_OP(set_border_width)(dpy, win, width);
+}
+
+static inline void backend_set_title(BackendDisplay *dpy, BackendWindow win, const char *title) {
+    BACKEND_OP(set_title)(dpy, win, title);
+}
+
+static inline int backend_wait_event(BackendDisplay *dpy, void *event) {
+    return BACKEND_OP(wait_event)(dpy, event);
+}
+
+static inline int backend_pending_events(BackendDisplay *dpy) {
+    return BACKEND_OP(pending_events)(dpy);
+}
+
+static inline void backend_flush(BackendDisplay *dpy) {
+    BACKEND_OP(flush)(dpy);
+}
+
+static inline int backend_get_screen_size(BackendDisplay *dpy, int *w, int *h) {
+    return BACKEND_OP(get_screen_size)(dpy, w, h);
+}
+
+#endif /* VAULTWM_BACKEND_H */
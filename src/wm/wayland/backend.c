@@ -0,0 +1,38 @@
+/*
+ * VaultWM Backend Selection
+ */
+
+#include <stdlib.h>
+#include "backend-abstraction.h"
+
+WMBackend *backend_current = NULL;
+
+#ifndef VAULTWM_BACKEND_X11
+WMBackend* backend_get_x11(void) {
+    return NULL;
+}
+#endif
+
+#ifndef VAULTWM_BACKEND_WAYLAND
+WMBackend* backend_get_wayland(void) {
+    return NULL;
+}
+#endif
+
+static int try_backend(WMBackend *backend, BackendDisplay **dpy) {
+    if (!backend || !backend->init || !backend->init(dpy)) return 0;
+    backend_current = backend;
+    return 1;
+}
+
+WMBackend* backend_detect_and_init(BackendDisplay **dpy) {
+    const char *wayland = getenv("WAYLAND_DISPLAY");
+    
+    if (wayland && wayland[0] && try_backend(backend_get_wayland(), dpy)) return backend_current;
+    if (try_backend(backend_get_x11(), dpy)) return backend_current;
+    return NULL;
+}
+
+WMBackend* backend_get_current(void) {
+    return backend_current;
+}
@@ -22,16 +22,19 @@ static WMBackend wayland_backend = {
     .destroy_window = NULL,
     .resize_window = NULL,
     .move_window = NULL,
+    .move_resize_window = NULL,
     .map_window = NULL,
     .unmap_window = NULL,
+    .raise_window = NULL,
     .focus_window = NULL,
     .set_input_focus = NULL,
-    .set_border = NULL,
+    .set_border_color = NULL,
+    .set_border_width = NULL,
     .set_title = NULL,
     .wait_event = NULL,
     .pending_events = NULL,
-    .get_screen_size = NULL,
-    .get_monitor_count = NULL
+    .flush = NULL,
+    .get_screen_size = NULL
 };
 
 WMBackend* backend_get_wayland(void) {
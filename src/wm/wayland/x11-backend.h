@@ -0,0 +1,101 @@
+/*
+ * VaultWM X11 Backend
+ * Xlib implementation of the WMBackend operations, as inline functions so
+ * that a build with only this backend calls Xlib directly. Included through
+ * backend-abstraction.h
+ */
+
+#ifndef VAULTWM_X11_BACKEND_H
+#define VAULTWM_X11_BACKEND_H
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+/* The connection behind a BackendDisplay of this backend, and back */
+static inline Display* x11_display(BackendDisplay *dpy) {
+    return (Display *)dpy;
+}
+
+static inline BackendDisplay* x11_backend_display(Display *dpy) {
+    return (BackendDisplay *)dpy;
+}
+
+/* Open $DISPLAY; returns 1 on success */
+int x11_init(BackendDisplay **dpy);
+
+void x11_cleanup(BackendDisplay *dpy);
+
+/* Plain child of the root window, not yet mapped */
+int x11_create_window(BackendDisplay *dpy, BackendWindow *win, int x, int y, int w, int h);
+
+static inline void x11_destroy_window(BackendDisplay *dpy, BackendWindow win) {
+    XDestroyWindow(x11_display(dpy), (Window)win);
+}
+
+static inline void x11_resize_window(BackendDisplay *dpy, BackendWindow win, int w, int h) {
+    XResizeWindow(x11_display(dpy), (Window)win, (unsigned int)w, (unsigned int)h);
+}
+
+static inline void x11_move_window(BackendDisplay *dpy, BackendWindow win, int x, int y) {
+    XMoveWindow(x11_display(dpy), (Window)win, x, y);
+}
+
+static inline void x11_move_resize_window(BackendDisplay *dpy, BackendWindow win, int x, int y, int w, int h) {
+    XMoveResizeWindow(x11_display(dpy), (Window)win, x, y, (unsigned int)w, (unsigned int)h);
+}
+
+static inline void x11_map_window(BackendDisplay *dpy, BackendWindow win) {
+    XMapWindow(x11_display(dpy), (Window)win);
+}
+
+static inline void x11_unmap_window(BackendDisplay *dpy, BackendWindow win) {
+    XUnmapWindow(x11_display(dpy), (Window)win);
+}
+
+static inline void x11_raise_window(BackendDisplay *dpy, BackendWindow win) {
+    XRaiseWindow(x11_display(dpy), (Window)win);
+}
+
+static inline void x11_set_input_focus(BackendDisplay *dpy, BackendWindow win) {
+    XSetInputFocus(x11_display(dpy), (Window)win, RevertToPointerRoot, CurrentTime);
+}
+
+static inline void x11_focus_window(BackendDisplay *dpy, BackendWindow win) {
+    x11_raise_window(dpy, win);
+    x11_set_input_focus(dpy, win);
+}
+
+static inline void x11_set_border_color(BackendDisplay *dpy, BackendWindow win, unsigned long color) {
+    XSetWindowBorder(x11_display(dpy), (Window)win, color);
+}
+
+static inline void x11_set_border_width(BackendDisplay *dpy, BackendWindow win, int width) {
+    XSetWindowBorderWidth(x11_display(dpy), (Window)win, (unsigned int)width);
+}
+
+static inline void x11_set_title(BackendDisplay *dpy, BackendWindow win, const char *title) {
+    XStoreName(x11_display(dpy), (Window)win, title);
+}
+
+/* event points to an XEvent */
+static inline int x11_wait_event(BackendDisplay *dpy, void *event) {
+    XNextEvent(x11_display(dpy), (XEvent *)event);
+    return 1;
+}
+
+static inline int x11_pending_events(BackendDisplay *dpy) {
+    return XPending(x11_display(dpy));
+}
+
+static inline void x11_flush(BackendDisplay *dpy) {
+    XFlush(x11_display(dpy));
+}
+
+static inline int x11_get_screen_size(BackendDisplay *dpy, int *w, int *h) {
+    Display *d = x11_display(dpy);
+    *w = DisplayWidth(d, DefaultScreen(d));
+    *h = DisplayHeight(d, DefaultScreen(d));
+    return *w > 0 && *h > 0;
+}
+
+#endif /* VAULTWM_X11_BACKEND_H */
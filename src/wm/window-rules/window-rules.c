@@ -5,16 +5,27 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <ctype.h>
 #include "window-rules.h"
 
 int window_rules_init(WindowRules *wr) {
+    int i;
+    
     if (!wr) {
         return 0;
     }
     
     wr->num_rules = 0;
+    wr->num_patterns = 0;
+    wr->depends = 0;
+    wr->memo_hits = 0;
+    wr->memo_misses = 0;
     memset(wr->rules, 0, sizeof(wr->rules));
+    memset(wr->memo, 0, sizeof(wr->memo));
+    for (i = 0; i < RULE_HASH_SIZE; i++) {
+        wr->hash[i] = RULE_NONE;
+    }
     return 1;
 }
 
@@ -33,19 +44,211 @@ static RuleType parse_rule_type(const char *type_str) {
     return 0;
 }
 
+// FNV-1a over "class\0instance"
+static unsigned int rule_hash(const char *class_name, const char *instance_name) {
+    unsigned int h = 2166136261u;
+    const char *p;
+    
+    for (p = class_name; *p; p++) {
+        h = (h ^ (unsigned char)*p) * 16777619u;
+    }
+    h = (h ^ 0) * 16777619u;
+    for (p = instance_name; *p; p++) {
+        h = (h ^ (unsigned char)*p) * 16777619u;
+    }
+    return h & (RULE_HASH_SIZE - 1);
+}
+
+static int pattern_compile(RulePattern *pat, const char *src) {
+    size_t len = strlen(src);
+    int i, start;
+    
+    memset(pat, 0, sizeof(RulePattern));
+    if (len == 0 || strcmp(src, "*") == 0) {
+        pat->kind = PATTERN_ANY;
+        return 1;
+    }
+    if (len >= sizeof(pat->text)) {
+        return 0;
+    }
+    
+    // /regex/ compiles to an automaton once; a window map only runs it
+    if (len >= 2 && src[0] == '/' && src[len - 1] == '/') {
+        memcpy(pat->text, src + 1, len - 2);
+        pat->text[len - 2] = '\0';
+        if (regcomp(&pat->regex, pat->text, REG_EXTENDED | REG_NOSUB) != 0) {
+            return 0;
+        }
+        pat->kind = PATTERN_REGEX;
+        return 1;
+    }
+    
+    strcpy(pat->text, src);
+    if (!strpbrk(src, "*?")) {
+        pat->kind = PATTERN_EXACT;
+        return 1;
+    }
+    
+    // Glob: split on '*' into literal segments ('?' still matches any one char)
+    pat->kind = PATTERN_GLOB;
+    pat->anchored_start = (src[0] != '*');
+    pat->anchored_end = (src[len - 1] != '*');
+    start = 0;
+    for (i = 0; i <= (int)len; i++) {
+        if (src[i] != '*' && src[i] != '\0') continue;
+        if (i > start) {
+            if (pat->num_segments == RULE_GLOB_SEGMENTS) {
+                return 0;
+            }
+            pat->seg_start[pat->num_segments] = (short)start;
+            pat->seg_len[pat->num_segments] = (short)(i - start);
+            pat->num_segments++;
+        }
+        start = i + 1;
+    }
+    return 1;
+}
+
+static void pattern_free(RulePattern *pat) {
+    if (pat->kind == PATTERN_REGEX) {
+        regfree(&pat->regex);
+    }
+    pat->kind = PATTERN_ANY;
+}
+
+static int segment_at(const RulePattern *pat, int seg, const char *s) {
+    const char *p = pat->text + pat->seg_start[seg];
+    int i;
+    
+    for (i = 0; i < pat->seg_len[seg]; i++) {
+        if (p[i] != '?' && p[i] != s[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int pattern_match(const RulePattern *pat, const char *s) {
+    int seg, first, last, len, pos;
+    
+    switch (pat->kind) {
+        case PATTERN_ANY:
+            return 1;
+        case PATTERN_EXACT:
+            return s && strcmp(pat->text, s) == 0;
+        case PATTERN_REGEX:
+            return s && regexec(&pat->regex, s, 0, NULL, 0) == 0;
+        case PATTERN_GLOB:
+            break;
+    }
+    if (!s) {
+        return 0;
+    }
+    
+    // Anchored ends are fixed; middle segments match leftmost-first, which is
+    // enough for '*' globs and never backtracks
+    len = (int)strlen(s);
+    first = 0;
+    last = pat->num_segments;
+    pos = 0;
+    if (pat->anchored_start) {
+        if (pat->seg_len[0] > len || !segment_at(pat, 0, s)) return 0;
+        pos = pat->seg_len[0];
+        first = 1;
+    }
+    if (pat->anchored_end && last > first) {
+        int l = pat->seg_len[last - 1];
+        if (len - l < pos || !segment_at(pat, last - 1, s + len - l)) return 0;
+        len -= l;
+        last--;
+    } else if (pat->anchored_end && pos != len) {
+        return 0;
+    }
+    for (seg = first; seg < last; seg++) {
+        while (pos + pat->seg_len[seg] <= len && !segment_at(pat, seg, s + pos)) {
+            pos++;
+        }
+        if (pos + pat->seg_len[seg] > len) return 0;
+        pos += pat->seg_len[seg];
+    }
+    return 1;
+}
+
+static int parse_flag(const char *value) {
+    if (strcmp(value, "true") == 0 || strcmp(value, "yes") == 0 ||
+        strcmp(value, "on") == 0 || strcmp(value, "1") == 0) {
+        return 1;
+    }
+    if (strcmp(value, "false") == 0 || strcmp(value, "no") == 0 ||
+        strcmp(value, "off") == 0 || strcmp(value, "0") == 0) {
+        return 0;
+    }
+    return -1;
+}
+
+// Values are parsed once here, so applying a rule is a field copy
+static int parse_rule_value(WindowRule *rule) {
+    char extra;
+    
+    switch (rule->type) {
+        case RULE_TYPE_FLOAT:
+            rule->arg[0] = parse_flag(rule->value);
+            return rule->arg[0] >= 0;
+        case RULE_TYPE_WORKSPACE:
+            return sscanf(rule->value, "%d%c", &rule->arg[0], &extra) == 1 && rule->arg[0] >= 1;
+        case RULE_TYPE_LAYOUT:
+            return rule->value[0] != '\0';
+        case RULE_TYPE_SIZE:
+            return sscanf(rule->value, "%dx%d%c", &rule->arg[0], &rule->arg[1], &extra) == 2 &&
+                   rule->arg[0] > 0 && rule->arg[1] > 0;
+        case RULE_TYPE_POSITION:
+            return sscanf(rule->value, "%d,%d%c", &rule->arg[0], &rule->arg[1], &extra) == 2;
+        default:
+            return 0;
+    }
+}
+
+static char *trim(char *s) {
+    char *end;
+    
+    while (isspace((unsigned char)*s)) s++;
+    end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1])) *--end = '\0';
+    return s;
+}
+
+/* strsep() on ':', except that a /regex/ field (title= included) runs to a '/'
+ * followed by ':' or the line end, so the pattern itself may contain ':' */
+static char *next_field(char **s) {
+    char *field = *s, *p = field;
+    
+    if (!field) {
+        return NULL;
+    }
+    while (isspace((unsigned char)*p)) p++;
+    if (strncmp(p, "title=", 6) == 0) p += 6;
+    if (*p == '/') {
+        for (p++; *p && !(p[0] == '/' && (p[1] == ':' || p[1] == '\0')); p++);
+    }
+    p = strchr(p, ':');
+    if (p) {
+        *p = '\0';
+        *s = p + 1;
+    } else {
+        *s = NULL;
+    }
+    return field;
+}
+
 int window_rules_load(const char *config_path, WindowRules *wr) {
     FILE *file;
-    char line[256];
-    char class_name[RULE_NAME_MAX];
-    char instance_name[RULE_NAME_MAX];
-    char rule_type_str[32];
-    char value[RULE_VALUE_MAX];
+    char line[512];
     
     if (!wr || !config_path) {
         return 0;
     }
     
-    window_rules_init(wr);
+    window_rules_cleanup(wr);
     
     file = fopen(config_path, "r");
     if (!file) {
@@ -53,106 +256,288 @@ int window_rules_load(const char *config_path, WindowRules *wr) {
     }
     
     while (fgets(line, sizeof(line), file) && wr->num_rules < MAX_RULES) {
+        char *fields[5], *action, *eq, *s = trim(line);
+        const char *title = NULL, *window_type = NULL;
+        int n = 0, i;
+        RuleType type;
+        
         // Skip comments and empty lines
-        if (line[0] == '#' || line[0] == '\n' || line[0] == '\0') {
+        if (s[0] == '#' || s[0] == '\0') {
             continue;
         }
         
-        // Parse rule: class:instance:type=value
-        // Or: class:type=value (instance is *)
-        int parsed = sscanf(line, "%63[^:]:%63[^:]:%31[^=]=%127s", 
-                         class_name, instance_name, rule_type_str, value);
-        
-        if (parsed == 4) {
-            // class:instance:type=value
-            RuleType type = parse_rule_type(rule_type_str);
-            if (type != 0) {
-                window_rules_add(wr, class_name, instance_name, type, value);
-            }
-        } else {
-            // Try class:type=value format
-            parsed = sscanf(line, "%63[^:]:%31[^=]=%127s", 
-                           class_name, rule_type_str, value);
-            if (parsed == 3) {
-                RuleType type = parse_rule_type(rule_type_str);
-                if (type != 0) {
-                    window_rules_add(wr, class_name, "*", type, value);
-                }
+        // class:instance[:title=pattern][:window_type=name]:type=value
+        // Or: class:type=value (instance is *). Patterns are globs or /regex/
+        while (n < 5 && (fields[n] = next_field(&s)) != NULL) {
+            n++;
+        }
+        if (n < 2 || s != NULL) {
+            fprintf(stderr, "VaultWM: Ignoring malformed rule in %s\n", config_path);
+            continue;
+        }
+        action = fields[n - 1];
+        for (i = 2; i < n - 1; i++) {
+            if (strncmp(fields[i], "title=", 6) == 0) {
+                title = fields[i] + 6;
+            } else if (strncmp(fields[i], "window_type=", 12) == 0) {
+                window_type = fields[i] + 12;
+            } else {
+                break;
             }
         }
+        eq = strchr(action, '=');
+        if (i < n - 1 || !eq) {
+            fprintf(stderr, "VaultWM: Ignoring malformed rule in %s\n", config_path);
+            continue;
+        }
+        *eq = '\0';
+        type = parse_rule_type(trim(action));
+        if (type == 0 || !window_rules_add(wr, trim(fields[0]), n > 2 ? trim(fields[1]) : "*",
+                                           title, window_type, type, trim(eq + 1))) {
+            fprintf(stderr, "VaultWM: Ignoring invalid rule %s=%s\n", action, eq + 1);
+        }
     }
     
     fclose(file);
     return 1;
 }
 
-int window_rules_add(WindowRules *wr, const char *class_name, const char *instance_name, 
-                     RuleType type, const char *value) {
-    if (!wr || wr->num_rules >= MAX_RULES) {
+int window_rules_add(WindowRules *wr, const char *class_name, const char *instance_name,
+                     const char *title, const char *window_type, RuleType type, const char *value) {
+    if (!wr || wr->num_rules >= MAX_RULES || !class_name || !instance_name || !value) {
         return 0;
     }
     
     WindowRule *rule = &wr->rules[wr->num_rules];
+    memset(rule, 0, sizeof(WindowRule));
     
     strncpy(rule->class_name, class_name, sizeof(rule->class_name) - 1);
-    rule->class_name[sizeof(rule->class_name) - 1] = '\0';
-    
     strncpy(rule->instance_name, instance_name, sizeof(rule->instance_name) - 1);
-    rule->instance_name[sizeof(rule->instance_name) - 1] = '\0';
-    
+    if (title) strncpy(rule->title, title, sizeof(rule->title) - 1);
+    if (window_type) strncpy(rule->window_type, window_type, sizeof(rule->window_type) - 1);
     rule->type = type;
-    
     strncpy(rule->value, value, sizeof(rule->value) - 1);
-    rule->value[sizeof(rule->value) - 1] = '\0';
     
     rule->priority = wr->num_rules;  // Later rules have higher priority
     
+    if (!parse_rule_value(rule) ||
+        !pattern_compile(&rule->class_pat, rule->class_name) ||
+        !pattern_compile(&rule->instance_pat, rule->instance_name) ||
+        !pattern_compile(&rule->title_pat, rule->title)) {
+        pattern_free(&rule->class_pat);
+        pattern_free(&rule->instance_pat);
+        pattern_free(&rule->title_pat);
+        return 0;
+    }
+    
+    // Plain class/instance rules are found by hash; chains stay newest (highest priority) first
+    if (rule->class_pat.kind == PATTERN_EXACT && rule->instance_pat.kind != PATTERN_GLOB &&
+        rule->instance_pat.kind != PATTERN_REGEX && rule->title_pat.kind == PATTERN_ANY &&
+        rule->window_type[0] == '\0') {
+        unsigned int h = rule_hash(rule->class_name,
+                                   rule->instance_pat.kind == PATTERN_ANY ? "*" : rule->instance_name);
+        rule->next = wr->hash[h];
+        wr->hash[h] = (short)wr->num_rules;
+    } else {
+        rule->next = RULE_NONE;
+        wr->patterns[wr->num_patterns++] = (short)wr->num_rules;
+    }
+    
+    if (rule->class_pat.kind != PATTERN_ANY || rule->instance_pat.kind != PATTERN_ANY) {
+        wr->depends |= RULE_DEPENDS_CLASS;
+    }
+    if (rule->title_pat.kind != PATTERN_ANY) {
+        wr->depends |= RULE_DEPENDS_TITLE;
+    }
+    if (rule->window_type[0]) {
+        wr->depends |= RULE_DEPENDS_TYPE;
+    }
+    memset(wr->memo, 0, sizeof(wr->memo));  // Memoized resolutions depend on the whole set
+    
     wr->num_rules++;
     return 1;
 }
 
-void window_rules_apply(WindowRules *wr, Window win, const char *class_name, const char *instance_name) {
-    int i;
-    WindowRule *best_rule = NULL;
-    int best_priority = -1;
-    
-    if (!wr || !class_name) {
+static void resolve(const WindowRule *rule, RuleResult *result, int *best) {
+    if (rule->priority <= best[rule->type]) {
         return;
     }
+    best[rule->type] = rule->priority;
     
-    // Find best matching rule (highest priority)
-    for (i = 0; i < wr->num_rules; i++) {
-        WindowRule *rule = &wr->rules[i];
+    switch (rule->type) {
+        case RULE_TYPE_FLOAT:
+            result->floating = rule->arg[0];
+            break;
+        case RULE_TYPE_WORKSPACE:
+            result->workspace = rule->arg[0] - 1;
+            break;
+        case RULE_TYPE_LAYOUT:
+            snprintf(result->layout, sizeof(result->layout), "%s", rule->value);
+            break;
+        case RULE_TYPE_SIZE:
+            result->width = rule->arg[0];
+            result->height = rule->arg[1];
+            break;
+        case RULE_TYPE_POSITION:
+            result->has_position = 1;
+            result->x = rule->arg[0];
+            result->y = rule->arg[1];
+            break;
+        default:
+            break;
+    }
+}
+
+static int apply_chain(const WindowRules *wr, const char *class_name, const char *instance_name,
+                       const char *key_instance, RuleResult *result, int *best) {
+    int i, matched = 0;
+    
+    for (i = wr->hash[rule_hash(class_name, key_instance)]; i != RULE_NONE; i = wr->rules[i].next) {
+        const WindowRule *rule = &wr->rules[i];
         
-        // Check class name match
-        if (strcmp(rule->class_name, "*") != 0 && 
-            strcmp(rule->class_name, class_name) != 0) {
+        if (strcmp(rule->class_name, class_name) != 0 ||
+            !pattern_match(&rule->instance_pat, instance_name)) {
             continue;
         }
-        
-        // Check instance name match
-        if (strcmp(rule->instance_name, "*") != 0 && 
-            instance_name && strcmp(rule->instance_name, instance_name) != 0) {
+        // Same key only on a hash collision of a different instance rule
+        if ((rule->instance_pat.kind == PATTERN_ANY) != (strcmp(key_instance, "*") == 0)) {
             continue;
         }
+        resolve(rule, result, best);
+        matched++;
+    }
+    return matched;
+}
+
+static const char *or_empty(const char *s) {
+    return s ? s : "";
+}
+
+static unsigned int memo_key(const WindowProps *props) {
+    unsigned int h = 2166136261u;
+    const char *parts[3], *p;
+    int i;
+    
+    parts[0] = or_empty(props->class_name);
+    parts[1] = or_empty(props->instance_name);
+    parts[2] = or_empty(props->window_type);
+    for (i = 0; i < 3; i++) {
+        for (p = parts[i]; *p; p++) {
+            h = (h ^ (unsigned char)*p) * 16777619u;
+        }
+        h = (h ^ 0) * 16777619u;
+    }
+    return h ? h : 1;  // 0 marks an empty slot
+}
+
+/* Resolve everything but title patterns once per (class, instance, type); title
+ * rules that passed their other conditions are listed for the caller to check */
+static RuleMemo *memo_lookup(WindowRules *wr, const WindowProps *props) {
+    const char *class_name = or_empty(props->class_name);
+    const char *instance_name = or_empty(props->instance_name);
+    const char *window_type = or_empty(props->window_type);
+    unsigned int key = memo_key(props);
+    RuleMemo *m = &wr->memo[key & (RULE_MEMO_SIZE - 1)];
+    int i;
+    
+    if (m->key == key && strcmp(m->class_name, class_name) == 0 &&
+        strcmp(m->instance_name, instance_name) == 0 && strcmp(m->window_type, window_type) == 0) {
+        wr->memo_hits++;
+        return m;
+    }
+    
+    // Direct-mapped: a miss simply replaces whatever was in the slot
+    wr->memo_misses++;
+    memset(m, 0, sizeof(RuleMemo));
+    m->base.floating = -1;
+    m->base.workspace = -1;
+    for (i = 0; i < RULE_TYPE_COUNT; i++) {
+        m->best[i] = -1;
+    }
+    if (strlen(class_name) >= RULE_NAME_MAX || strlen(instance_name) >= RULE_NAME_MAX ||
+        strlen(window_type) >= RULE_NAME_MAX) {
+        m->key = 0;  // Not cacheable; resolved fresh each time
+    } else {
+        m->key = key;
+        strcpy(m->class_name, class_name);
+        strcpy(m->instance_name, instance_name);
+        strcpy(m->window_type, window_type);
+    }
+    
+    m->matched += apply_chain(wr, class_name, instance_name, instance_name, &m->base, m->best);
+    if (strcmp(instance_name, "*") != 0) {
+        m->matched += apply_chain(wr, class_name, instance_name, "*", &m->base, m->best);
+    }
+    
+    for (i = 0; i < wr->num_patterns; i++) {
+        const WindowRule *rule = &wr->rules[wr->patterns[i]];
         
-        // This rule matches, check if it has higher priority
-        if (rule->priority > best_priority) {
-            best_rule = rule;
-            best_priority = rule->priority;
+        if (!pattern_match(&rule->class_pat, class_name) ||
+            !pattern_match(&rule->instance_pat, instance_name)) {
+            continue;
         }
+        if (rule->window_type[0] && strcasecmp(rule->window_type, window_type) != 0) {
+            continue;
+        }
+        if (rule->title_pat.kind != PATTERN_ANY) {
+            m->title_rules[m->num_title_rules++] = wr->patterns[i];
+            continue;
+        }
+        resolve(rule, &m->base, m->best);
+        m->matched++;
     }
+    return m;
+}
+
+int window_rules_apply(WindowRules *wr, const WindowProps *props, RuleResult *result) {
+    int best[RULE_TYPE_COUNT];
+    const RuleMemo *m;
+    int i, matched;
+    
+    memset(result, 0, sizeof(RuleResult));
+    result->floating = -1;
+    result->workspace = -1;
     
-    // Apply best matching rule
-    if (best_rule) {
-        // Rule application would be handled by window manager
-        // This function identifies the rule to apply
+    if (!wr || !props || !props->class_name) {
+        return 0;
     }
+    
+    m = memo_lookup(wr, props);
+    *result = m->base;
+    matched = m->matched;
+    if (m->num_title_rules == 0) {
+        return matched;
+    }
+    
+    memcpy(best, m->best, sizeof(best));
+    for (i = 0; i < m->num_title_rules; i++) {
+        const WindowRule *rule = &wr->rules[m->title_rules[i]];
+        
+        if (pattern_match(&rule->title_pat, props->title)) {
+            resolve(rule, result, best);
+            matched++;
+        }
+    }
+    return matched;
 }
 
-void window_rules_cleanup(WindowRules *wr) {
-    if (wr) {
-        wr->num_rules = 0;
+int window_rules_title_sensitive(WindowRules *wr, const WindowProps *props) {
+    if (!wr || !props || !props->class_name || !(wr->depends & RULE_DEPENDS_TITLE)) {
+        return 0;
     }
+    return memo_lookup(wr, props)->num_title_rules > 0;
 }
 
+void window_rules_cleanup(WindowRules *wr) {
+    int i;
+    
+    if (!wr) {
+        return;
+    }
+    for (i = 0; i < wr->num_rules; i++) {
+        pattern_free(&wr->rules[i].class_pat);
+        pattern_free(&wr->rules[i].instance_pat);
+        pattern_free(&wr->rules[i].title_pat);
+    }
+    window_rules_init(wr);
+}
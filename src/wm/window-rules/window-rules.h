@@ -1,51 +1,132 @@
 /*
  * VaultWM Window Rules System
- * Automatic window behavior based on rules
+ * Automatic window behavior based on rules; compiled at load time into a
+ * hash on exact class/instance plus precompiled glob/regex matchers, with
+ * resolutions memoized per (class, instance, window type)
  */
 
 #ifndef VAULTWM_WINDOW_RULES_H
 #define VAULTWM_WINDOW_RULES_H
 
+#include <X11/Xlib.h>
+#include <regex.h>
+
 #define MAX_RULES 64
 #define RULE_NAME_MAX 64
 #define RULE_VALUE_MAX 128
+#define RULE_HASH_SIZE 128           // (class, instance) -> rule chain, power of two
+#define RULE_GLOB_SEGMENTS 8         // '*'-separated pieces of one glob
+#define RULE_NONE (-1)
+#define RULE_MEMO_SIZE 64            // Direct-mapped, power of two
+
+/* Window properties some rule looks at; a change to any other one needs no re-evaluation */
+#define RULE_DEPENDS_CLASS (1 << 0)  // WM_CLASS
+#define RULE_DEPENDS_TITLE (1 << 1)  // WM_NAME / _NET_WM_NAME
+#define RULE_DEPENDS_TYPE  (1 << 2)  // _NET_WM_WINDOW_TYPE
 
 typedef enum {
     RULE_TYPE_FLOAT = 1,
     RULE_TYPE_WORKSPACE = 2,
     RULE_TYPE_LAYOUT = 3,
     RULE_TYPE_SIZE = 4,
-    RULE_TYPE_POSITION = 5
+    RULE_TYPE_POSITION = 5,
+    RULE_TYPE_COUNT
 } RuleType;
 
+typedef enum {
+    PATTERN_ANY,                     // "*" or empty
+    PATTERN_EXACT,
+    PATTERN_GLOB,                    // '*' and '?'
+    PATTERN_REGEX                    // /extended regex/
+} PatternKind;
+
+/* A class, instance or title matcher, compiled once when the rule is added */
+typedef struct {
+    PatternKind kind;
+    char text[RULE_VALUE_MAX];       // Literal, or the glob source segments point into
+    int num_segments;
+    short seg_start[RULE_GLOB_SEGMENTS], seg_len[RULE_GLOB_SEGMENTS];
+    int anchored_start, anchored_end;  // No '*' before the first / after the last segment
+    regex_t regex;
+} RulePattern;
+
 typedef struct {
     char class_name[RULE_NAME_MAX];
     char instance_name[RULE_NAME_MAX];
+    char title[RULE_VALUE_MAX];      // Empty = any
+    char window_type[RULE_NAME_MAX]; // _NET_WM_WINDOW_TYPE suffix, e.g. "dialog"; empty = any
     RuleType type;
     char value[RULE_VALUE_MAX];
     int priority;
+    int arg[2];                      // Parsed value: flag, workspace, WxH or X,Y
+    RulePattern class_pat, instance_pat, title_pat;
+    int next;                        // Hash chain, RULE_NONE at the end
 } WindowRule;
 
+/* What the window is matched on; NULL or "" for unknown */
+typedef struct {
+    const char *class_name;
+    const char *instance_name;
+    const char *title;
+    const char *window_type;
+} WindowProps;
+
+/* Resolved values; the highest priority rule of each type wins */
+typedef struct {
+    int floating;                    // -1 = no rule, else 0/1
+    int workspace;                   // -1 = no rule, else 0-based
+    char layout[RULE_VALUE_MAX];     // "" = no rule, else a layout name for the workspace; a copy,
+                                     // since clients keep their result across rule reloads
+    int width, height;               // 0 = no rule
+    int has_position;
+    int x, y;
+} RuleResult;
+
+/* Everything that does not depend on the title, for one (class, instance, type).
+ * Title rules whose other conditions matched are kept to be checked per window. */
+typedef struct {
+    unsigned int key;                // 0 = empty
+    char class_name[RULE_NAME_MAX];
+    char instance_name[RULE_NAME_MAX];
+    char window_type[RULE_NAME_MAX];
+    RuleResult base;
+    int best[RULE_TYPE_COUNT];       // Priority behind each base value
+    int matched;
+    short title_rules[MAX_RULES];
+    int num_title_rules;
+} RuleMemo;
+
 typedef struct {
     WindowRule rules[MAX_RULES];
     int num_rules;
+    short hash[RULE_HASH_SIZE];      // Rules with exact class and exact or "*" instance
+    short patterns[MAX_RULES];       // Everything else, checked in order
+    int num_patterns;
+    int depends;                     // RULE_DEPENDS_* of all rules together
+    RuleMemo memo[RULE_MEMO_SIZE];   // Emptied whenever the rule set changes
+    unsigned long memo_hits, memo_misses;
 } WindowRules;
 
 /* Initialize window rules */
 int window_rules_init(WindowRules *wr);
 
-/* Load rules from file */
+/* Load rules from file; replaces the current set */
 int window_rules_load(const char *config_path, WindowRules *wr);
 
-/* Apply rules to window */
-void window_rules_apply(WindowRules *wr, Window win, const char *class_name, const char *instance_name);
+/* Resolve every rule matching props into result; returns the number of rules that matched.
+ * Only title rules are evaluated per call; the rest comes from the memo table. */
+int window_rules_apply(WindowRules *wr, const WindowProps *props, RuleResult *result);
 
-/* Add rule programmatically */
-int window_rules_add(WindowRules *wr, const char *class_name, const char *instance_name, 
-                     RuleType type, const char *value);
+/* Non-zero if some rule for props' class, instance and type looks at the title,
+ * i.e. a title change has to be re-evaluated. props->title is not read. */
+int window_rules_title_sensitive(WindowRules *wr, const WindowProps *props);
+
+/* Add rule programmatically; title and window_type may be NULL. Returns 0 if the
+ * value does not parse for its type or a pattern does not compile */
+int window_rules_add(WindowRules *wr, const char *class_name, const char *instance_name,
+                     const char *title, const char *window_type, RuleType type, const char *value);
 
 /* Cleanup rules */
 void window_rules_cleanup(WindowRules *wr);
 
 #endif /* VAULTWM_WINDOW_RULES_H */
-
@@ -0,0 +1,331 @@
+/*
+ * VaultWM IPC / X event scheduling benchmark
+ *
+ * Drives the real IPC socket endpoint (ipc.c + libvaultwm-ipc) at a
+ * configurable rate while a synthetic X event stream flows through the
+ * same event loop the WM uses, then reports throughput and p50/p99
+ * latency for both paths. Run with -X 0 -I 0 to see the unbudgeted
+ * behaviour where one flood starves the other path.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include "../../src/wm/config/config.h"
+#include "../../src/wm/config/runtime-config/ipc.h"
+#include "../../src/wm/eventloop/event-loop.h"
+#include "../../src/wm/vaultwmctl/vaultwm-ipc.h"
+
+#define MAX_SAMPLES (2 * 1024 * 1024)
+#define IPC_WINDOW 1024        // Requests in flight in flood mode
+#define SEND_RING 65536
+#define X_BATCH_MAX 1024
+
+typedef struct {
+    uint64_t *values;
+    size_t count;
+    unsigned long total;
+} Samples;
+
+static struct {
+    double x_rate;             // Synthetic X events/s, 0 = flood
+    double ipc_rate;           // IPC commands/s, 0 = flood
+    int x_cost_us;             // Simulated handle_event() cost
+    int ipc_cost_us;           // Simulated command handler cost
+    int x_budget;
+    int ipc_budget;
+    double duration;
+    int csv;
+} opt = { 20000, 20000, 5, 5, X_EVENT_BUDGET, IPC_COMMAND_BUDGET, 3.0, 0 };
+
+static volatile int stop_producers = 0;
+static volatile int client_done = 0;
+static int x_pipe[2];
+static char socket_path[IPC_SOCKET_PATH_MAX];
+static Samples x_lat, ipc_lat;
+static uint64_t send_times[SEND_RING];
+static volatile unsigned long ipc_sent = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void spin_us(int us) {
+    uint64_t end = now_ns() + (uint64_t)us * 1000ull;
+    while (us > 0 && now_ns() < end) {
+        // Busy work stands in for X round trips / layout
+    }
+}
+
+static void sample_add(Samples *s, uint64_t value) {
+    s->total++;
+    if (s->count < MAX_SAMPLES) {
+        s->values[s->count++] = value;
+    }
+}
+
+/* Wait for the next slot of a fixed-rate schedule; returns 0 when stopping */
+static int pace(uint64_t start, unsigned long n, double rate) {
+    uint64_t due;
+    if (rate <= 0) {
+        return !stop_producers;
+    }
+    due = start + (uint64_t)((double)n * 1e9 / rate);
+    while (!stop_producers) {
+        uint64_t now = now_ns();
+        if (now >= due) {
+            return 1;
+        }
+        if (due - now > 200000) {
+            usleep(100);
+        }
+    }
+    return 0;
+}
+
+/* Synthetic X server: timestamps written into a pipe the loop polls */
+static void* x_producer(void *arg) {
+    uint64_t start = now_ns();
+    unsigned long n = 0;
+    (void)arg;
+    
+    while (pace(start, n, opt.x_rate)) {
+        uint64_t ts = now_ns();
+        ssize_t w = write(x_pipe[1], &ts, sizeof(ts));
+        if (w < 0 && errno == EAGAIN) {
+            usleep(50);  // Pipe full: the loop is behind
+            continue;
+        }
+        n++;
+    }
+    return NULL;
+}
+
+static int x_dispatch(void *data, int budget) {
+    uint64_t batch[X_BATCH_MAX];
+    size_t want = (budget > 0 && budget < X_BATCH_MAX) ? (size_t)budget : X_BATCH_MAX;
+    ssize_t r = read(x_pipe[0], batch, want * sizeof(uint64_t));
+    int i, n;
+    (void)data;
+    
+    if (r <= 0) {
+        return 0;
+    }
+    n = (int)(r / (ssize_t)sizeof(uint64_t));
+    for (i = 0; i < n; i++) {
+        spin_us(opt.x_cost_us);
+        sample_add(&x_lat, now_ns() - batch[i]);
+    }
+    return n;
+}
+
+static int ipc_source_dispatch(void *data, int budget) {
+    (void)data;
+    return ipc_dispatch(budget);
+}
+
+static int ipc_source_pending(void *data) {
+    (void)data;
+    return ipc_pending();
+}
+
+static int bench_handler(const char *cmd, const char *args, char *reply, size_t reply_size) {
+    (void)cmd;
+    (void)args;
+    spin_us(opt.ipc_cost_us);
+    snprintf(reply, reply_size, "workspace=1");
+    return 1;
+}
+
+/* Reply reader: replies come back in request order. It reads the socket
+ * directly because a VaultWMIPC handle is not shared between threads. */
+static void* ipc_receiver(void *arg) {
+    int fd = vaultwm_ipc_fd((VaultWMIPC *)arg);
+    char buf[8192];
+    unsigned long seq = 0;
+    
+    while (!(stop_producers && seq >= ipc_sent)) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        ssize_t r, i;
+        
+        if (poll(&pfd, 1, 10) <= 0) {
+            continue;
+        }
+        r = read(fd, buf, sizeof(buf));
+        if (r <= 0) {
+            break;
+        }
+        for (i = 0; i < r; i++) {
+            if (buf[i] == '\n') {
+                sample_add(&ipc_lat, now_ns() - send_times[seq % SEND_RING]);
+                seq++;
+            }
+        }
+    }
+    client_done = 1;
+    return NULL;
+}
+
+/* Open-loop sender: rate-paced, bounded only by the in-flight window */
+static void* ipc_client(void *arg) {
+    VaultWMIPC *ipc;
+    pthread_t receiver;
+    uint64_t start;
+    unsigned long n = 0;
+    (void)arg;
+    
+    ipc = vaultwm_ipc_connect(socket_path);
+    if (!ipc) {
+        fprintf(stderr, "bench-ipc: cannot connect to %s\n", socket_path);
+        client_done = 1;
+        return NULL;
+    }
+    pthread_create(&receiver, NULL, ipc_receiver, ipc);
+    
+    start = now_ns();
+    while (pace(start, n, opt.ipc_rate)) {
+        if (n - ipc_lat.total >= IPC_WINDOW) {
+            usleep(10);
+            continue;
+        }
+        // Each request is its own write so we measure per-command cost
+        send_times[n % SEND_RING] = now_ns();
+        __atomic_store_n(&ipc_sent, n + 1, __ATOMIC_RELEASE);
+        if (!vaultwm_ipc_send(ipc, "get_status") || !vaultwm_ipc_flush(ipc)) {
+            break;
+        }
+        n++;
+    }
+    
+    pthread_join(receiver, NULL);
+    vaultwm_ipc_disconnect(ipc);
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(Samples *s, double p) {
+    size_t idx;
+    if (s->count == 0) {
+        return 0.0;
+    }
+    idx = (size_t)(p * (double)(s->count - 1));
+    return (double)s->values[idx] / 1000.0;
+}
+
+static void report(const char *path, Samples *s, double target, double elapsed) {
+    qsort(s->values, s->count, sizeof(uint64_t), cmp_u64);
+    if (opt.csv) {
+        printf("%s,%.0f,%.0f,%.1f,%.1f,%.1f,%lu\n", path, target, (double)s->total / elapsed,
+               percentile_us(s, 0.50), percentile_us(s, 0.99), percentile_us(s, 1.0), s->total);
+    } else {
+        printf("%-5s %12.0f %12.0f %10.1f %10.1f %10.1f %10lu\n", path, target,
+               (double)s->total / elapsed, percentile_us(s, 0.50), percentile_us(s, 0.99),
+               percentile_us(s, 1.0), s->total);
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [-x x_rate] [-i ipc_rate] [-w x_cost_us] [-c ipc_cost_us]\n"
+        "          [-X x_budget] [-I ipc_budget] [-d seconds] [-m]\n"
+        "  rates are per second, 0 = flood; budgets 0 = unlimited; -m prints CSV\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    EventLoop loop;
+    pthread_t xt, it;
+    uint64_t start, deadline;
+    unsigned long iterations = 0;
+    double elapsed;
+    int c;
+    
+    while ((c = getopt(argc, argv, "x:i:w:c:X:I:d:mh")) != -1) {
+        switch (c) {
+            case 'x': opt.x_rate = atof(optarg); break;
+            case 'i': opt.ipc_rate = atof(optarg); break;
+            case 'w': opt.x_cost_us = atoi(optarg); break;
+            case 'c': opt.ipc_cost_us = atoi(optarg); break;
+            case 'X': opt.x_budget = atoi(optarg); break;
+            case 'I': opt.ipc_budget = atoi(optarg); break;
+            case 'd': opt.duration = atof(optarg); break;
+            case 'm': opt.csv = 1; break;
+            default: usage(argv[0]); return c == 'h' ? 0 : 2;
+        }
+    }
+    
+    x_lat.values = malloc(MAX_SAMPLES * sizeof(uint64_t));
+    ipc_lat.values = malloc(MAX_SAMPLES * sizeof(uint64_t));
+    if (!x_lat.values || !ipc_lat.values || pipe2(x_pipe, O_NONBLOCK | O_CLOEXEC) < 0) {
+        perror("bench-ipc");
+        return 1;
+    }
+    
+    snprintf(socket_path, sizeof(socket_path), "/tmp/vaultwm-bench-%d.sock", (int)getpid());
+    setenv(IPC_SOCKET_ENV, socket_path, 1);
+    if (!ipc_init()) {
+        fprintf(stderr, "bench-ipc: IPC init failed\n");
+        return 1;
+    }
+    ipc_set_command_handler(bench_handler);
+    
+    event_loop_init(&loop);
+    event_loop_add_source(&loop, "x11", x_pipe[0], opt.x_budget, x_dispatch, NULL, NULL);
+    event_loop_add_source(&loop, "ipc", ipc_get_fd(), opt.ipc_budget,
+                          ipc_source_dispatch, ipc_source_pending, NULL);
+    
+    pthread_create(&xt, NULL, x_producer, NULL);
+    pthread_create(&it, NULL, ipc_client, NULL);
+    
+    start = now_ns();
+    deadline = start + (uint64_t)(opt.duration * 1e9);
+    while (now_ns() < deadline) {
+        event_loop_iterate(&loop, 10);
+        iterations++;
+    }
+    elapsed = (double)(now_ns() - start) / 1e9;
+    
+    // Let the client collect replies already owed, then shut down
+    stop_producers = 1;
+    deadline = now_ns() + 2000000000ull;
+    while (!client_done && now_ns() < deadline) {
+        event_loop_iterate(&loop, 10);
+    }
+    pthread_join(xt, NULL);
+    if (client_done) {
+        pthread_join(it, NULL);
+    }
+    
+    if (opt.csv) {
+        printf("path,target_per_s,achieved_per_s,p50_us,p99_us,max_us,samples\n");
+    } else {
+        printf("VaultWM IPC/X scheduling benchmark (%.1fs, budgets x=%d ipc=%d, cost x=%dus ipc=%dus)\n\n",
+               elapsed, opt.x_budget, opt.ipc_budget, opt.x_cost_us, opt.ipc_cost_us);
+        printf("%-5s %12s %12s %10s %10s %10s %10s\n",
+               "path", "target/s", "achieved/s", "p50(us)", "p99(us)", "max(us)", "samples");
+    }
+    report("x11", &x_lat, opt.x_rate, elapsed);
+    report("ipc", &ipc_lat, opt.ipc_rate, elapsed);
+    if (!opt.csv) {
+        printf("\niterations=%lu x_budget_hits=%lu ipc_budget_hits=%lu\n", iterations,
+               loop.sources[0].exhausted, loop.sources[1].exhausted);
+    }
+    
+    ipc_cleanup();
+    free(x_lat.values);
+    free(ipc_lat.values);
+    return 0;
+}
@@ -0,0 +1,245 @@
+/*
+ * VaultWM layout micro-benchmark
+ *
+ * Runs every layout routine on synthetic LayoutClient arrays from 1 to
+ * 10,000 clients with a mix of floating windows and reports ns/client,
+ * heap allocations per call and the stack depth of one call (a proxy
+ * for recursion depth). Use -m for CSV that can be diffed across commits.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include "../../src/wm/layouts/layouts.h"
+#include "../../src/wm/layouts/bsp.h"
+
+#define STACK_SIZE (16 * 1024 * 1024)
+#define STACK_FILL 0xA5
+#define TARGET_NS 50000000ull     // Time budget per case
+#define AREA_W 3440
+#define AREA_H 1410
+#define GAP 5
+
+typedef void (*LayoutFunc)(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap);
+
+typedef struct {
+    const char *name;
+    LayoutFunc func;
+    int max_clients;              // 0 = no limit
+} LayoutCase;
+
+static void bsp_dwindle_insert(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap);
+
+static const LayoutCase cases[] = {
+    { "tiling", layout_tiling, 0 },
+    { "monocle", layout_monocle, 0 },
+    { "grid", layout_grid, 0 },
+    { "fibonacci", layout_fibonacci, 0 },
+    { "dwindle", layout_dwindle, 0 },
+    { "bsp-insert", bsp_dwindle_insert, BSP_MAX_NODES / 2 },
+};
+
+static const int sizes[] = { 1, 10, 100, 1000, 10000 };
+
+/* Heap calls made by the code under test, counted through -Wl,--wrap */
+static volatile unsigned long alloc_count = 0;
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    alloc_count++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+    alloc_count++;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    alloc_count++;
+    return __real_realloc(ptr, size);
+}
+
+static struct {
+    int floating_every;           // Every Nth client floats, 0 = none
+    int csv;
+} opt = { 7, 0 };
+
+typedef struct {
+    const LayoutCase *lc;
+    int n;
+    LayoutClient *clients;
+    double ns_per_client;
+    double allocs_per_call;
+    size_t stack_bytes;
+    unsigned long iterations;
+    uintptr_t stack_top;          // Address of a local just above the measured call
+} Result;
+
+static BSPTree bench_tree;
+
+/* Incremental BSP cost: one window inserted into a tree of n-1, then relaid out */
+static void bsp_dwindle_insert(LayoutClient *clients, int num_clients, int x, int y, int width, int height, int gap) {
+    Window w = clients[num_clients - 1].win;
+    bsp_insert(&bench_tree, w);
+    bsp_layout(&bench_tree, LAYOUT_DWINDLE, x, y, width, height, gap);
+    bsp_geometry(&bench_tree, w, &clients[num_clients - 1]);
+    bsp_remove(&bench_tree, w);
+    bsp_layout(&bench_tree, LAYOUT_DWINDLE, x, y, width, height, gap);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void make_clients(LayoutClient *clients, int n) {
+    int i;
+    memset(clients, 0, (size_t)n * sizeof(LayoutClient));
+    for (i = 0; i < n; i++) {
+        clients[i].win = (Window)(0x400000 + i);
+        clients[i].is_floating = (opt.floating_every > 0 && i % opt.floating_every == opt.floating_every - 1);
+    }
+}
+
+static void prepare_case(Result *r) {
+    int i;
+    
+    if (r->lc->func == bsp_dwindle_insert) {
+        bsp_init(&bench_tree);
+        for (i = 0; i < r->n - 1; i++) {
+            bsp_insert(&bench_tree, r->clients[i].win);
+        }
+        bsp_layout(&bench_tree, LAYOUT_DWINDLE, 0, 0, AREA_W, AREA_H, GAP);
+    }
+}
+
+/* One call on a freshly painted private stack; only the layout runs below marker */
+static void* probe_stack(void *arg) {
+    Result *r = (Result *)arg;
+    volatile int marker = 0;
+    
+    r->stack_top = (uintptr_t)&marker;
+    r->lc->func(r->clients, r->n, 0, 0, AREA_W, AREA_H, GAP);
+    return NULL;
+}
+
+static int measure_stack(Result *r, unsigned char *stack) {
+    pthread_attr_t attr;
+    pthread_t thread;
+    size_t untouched = 0;
+    
+    memset(stack, STACK_FILL, STACK_SIZE);
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, STACK_SIZE);
+    if (pthread_create(&thread, &attr, probe_stack, r) != 0) {
+        pthread_attr_destroy(&attr);
+        return 0;
+    }
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+    
+    // Stacks grow down: the lowest painted byte that changed is the high-water mark
+    while (untouched < STACK_SIZE && stack[untouched] == STACK_FILL) {
+        untouched++;
+    }
+    r->stack_bytes = (r->stack_top > (uintptr_t)(stack + untouched)) ?
+        r->stack_top - (uintptr_t)(stack + untouched) : 0;
+    return 1;
+}
+
+static void time_case(Result *r) {
+    unsigned long iters = 0, allocs;
+    uint64_t start, elapsed;
+    
+    allocs = alloc_count;
+    start = now_ns();
+    do {
+        r->lc->func(r->clients, r->n, 0, 0, AREA_W, AREA_H, GAP);
+        iters++;
+        elapsed = now_ns() - start;
+    } while (elapsed < TARGET_NS);
+    
+    r->iterations = iters;
+    r->allocs_per_call = (double)(alloc_count - allocs) / (double)iters;
+    r->ns_per_client = (double)elapsed / (double)iters / (double)r->n;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [-f floating_every] [-m]\n"
+        "  -f N  every Nth client floats (default 7, 0 = none)\n"
+        "  -m    print CSV\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned char *stack;
+    LayoutClient *clients;
+    size_t c, s;
+    int opt_c;
+    
+    while ((opt_c = getopt(argc, argv, "f:mh")) != -1) {
+        switch (opt_c) {
+            case 'f': opt.floating_every = atoi(optarg); break;
+            case 'm': opt.csv = 1; break;
+            default: usage(argv[0]); return opt_c == 'h' ? 0 : 2;
+        }
+    }
+    
+    stack = malloc(STACK_SIZE);
+    clients = malloc(10000 * sizeof(LayoutClient));
+    if (!stack || !clients) {
+        perror("bench-layouts");
+        return 1;
+    }
+    
+    if (opt.csv) {
+        printf("layout,clients,ns_per_client,allocs_per_call,stack_bytes,iterations\n");
+    } else {
+        printf("VaultWM layout benchmark (%dx%d, every %d%s client floating)\n\n",
+               AREA_W, AREA_H, opt.floating_every, opt.floating_every == 1 ? "st" : "th");
+        printf("%-11s %8s %14s %12s %12s %12s\n",
+               "layout", "clients", "ns/client", "allocs/call", "stack(B)", "iterations");
+    }
+    
+    for (c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            Result r;
+            
+            if (cases[c].max_clients > 0 && sizes[s] > cases[c].max_clients) {
+                continue;
+            }
+            memset(&r, 0, sizeof(r));
+            r.lc = &cases[c];
+            r.n = sizes[s];
+            r.clients = clients;
+            make_clients(clients, r.n);
+            prepare_case(&r);
+            if (!measure_stack(&r, stack)) {
+                fprintf(stderr, "bench-layouts: cannot start worker thread\n");
+                return 1;
+            }
+            time_case(&r);
+            
+            if (opt.csv) {
+                printf("%s,%d,%.2f,%.2f,%zu,%lu\n", r.lc->name, r.n, r.ns_per_client,
+                       r.allocs_per_call, r.stack_bytes, r.iterations);
+            } else {
+                printf("%-11s %8d %14.2f %12.2f %12zu %12lu\n", r.lc->name, r.n, r.ns_per_client,
+                       r.allocs_per_call, r.stack_bytes, r.iterations);
+            }
+        }
+    }
+    
+    free(clients);
+    free(stack);
+    return 0;
+}
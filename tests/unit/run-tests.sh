@@ -63,6 +63,13 @@ if [ -f "../src/utils/config-manager/vaultos-config-tui.sh" ]; then
     echo ""
 fi
 
+# Test window manager modules (tests/unit/test-*.c)
+if command -v make > /dev/null && command -v gcc > /dev/null; then
+    echo "Testing window manager modules:"
+    run_test "C unit tests pass" "make -s -C $(dirname "$0") check"
+    echo ""
+fi
+
 # Summary
 echo "Test Summary"
 echo "============"
@@ -0,0 +1,183 @@
+/*
+ * Unit tests for VaultWM layout animation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/wm/animation/animation.h"
+
+#define MS 1000000ull
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+/* Stands in for layout_commit: records what would go to the server */
+static LayoutClient screen[16];
+static int commits = 0;
+
+static int fake_commit(void *data, const LayoutClient *target, LayoutClient *shown, int num_clients) {
+    int i, changed = 0;
+    (void)data;
+    
+    commits++;
+    for (i = 0; i < num_clients; i++) {
+        if (!layout_rect_changed(&target[i], &shown[i])) continue;
+        shown[i] = target[i];
+        screen[target[i].win - 1] = target[i];
+        changed++;
+    }
+    return changed;
+}
+
+static void make_pair(LayoutClient *applied, LayoutClient *target, int n) {
+    int i;
+    memset(applied, 0, n * sizeof(LayoutClient));
+    memset(target, 0, n * sizeof(LayoutClient));
+    for (i = 0; i < n; i++) {
+        applied[i].win = target[i].win = (Window)(i + 1);
+        applied[i].width = applied[i].height = 100;
+        target[i].x = 1000;
+        target[i].width = target[i].height = 100;
+        screen[i] = applied[i];
+    }
+    commits = 0;
+}
+
+void test_slide() {
+    Animator anim;
+    LayoutClient applied[4], target[4];
+    int moving;
+    
+    printf("Testing animated transition...\n");
+    
+    animation_init(&anim, 60000, 100, 8, fake_commit, NULL);
+    make_pair(applied, target, 4);
+    moving = animation_transition(&anim, target, applied, 4, 0, 0);
+    
+    if (moving == 4 && commits == 0 && applied[0].x == 1000 && animation_active(&anim)) {
+        test_pass("Transition is deferred to frames");
+    } else {
+        test_fail("Transition is deferred to frames", "expected 4 tracks and no commit");
+    }
+    
+    animation_frame(&anim, 50 * MS, 1);
+    if (screen[0].x > 0 && screen[0].x < 1000) {
+        test_pass("Midway frame is between old and new geometry");
+    } else {
+        test_fail("Midway frame is between old and new geometry", "window not in between");
+    }
+    
+    animation_frame(&anim, 100 * MS, 1);
+    if (screen[3].x == 1000 && !animation_active(&anim)) {
+        test_pass("Last frame lands on the target");
+    } else {
+        test_fail("Last frame lands on the target", "window did not reach its target");
+    }
+    
+    animation_cleanup(&anim);
+}
+
+void test_skip() {
+    Animator anim;
+    LayoutClient applied[4], target[4];
+    
+    printf("Testing animation fallbacks...\n");
+    
+    animation_init(&anim, 60000, 100, 2, fake_commit, NULL);
+    make_pair(applied, target, 4);
+    if (animation_transition(&anim, target, applied, 4, 0, 0) == 0 &&
+        screen[0].x == 1000 && anim.skipped == 1) {
+        test_pass("Too many windows jump at once");
+    } else {
+        test_fail("Too many windows jump at once", "transition was animated");
+    }
+    
+    make_pair(applied, target, 2);
+    if (animation_transition(&anim, target, applied, 2, 0, 1) == 0 && screen[1].x == 1000) {
+        test_pass("Backlogged event loop jumps at once");
+    } else {
+        test_fail("Backlogged event loop jumps at once", "transition was animated");
+    }
+    
+    make_pair(applied, target, 2);
+    animation_set_enabled(&anim, 0);
+    if (animation_transition(&anim, target, applied, 2, 0, 0) == 0 && screen[0].x == 1000) {
+        test_pass("Disabled animation jumps at once");
+    } else {
+        test_fail("Disabled animation jumps at once", "transition was animated");
+    }
+    
+    animation_cleanup(&anim);
+}
+
+void test_pacing() {
+    Animator anim;
+    LayoutClient applied[2], target[2];
+    int mid;
+    
+    printf("Testing frame pacing...\n");
+    
+    animation_init(&anim, 144000, 100, 8, fake_commit, NULL);
+    if (anim.frame_ns > 6900000 && anim.frame_ns < 7000000) {
+        test_pass("Frame period follows the refresh rate");
+    } else {
+        test_fail("Frame period follows the refresh rate", "wrong period for 144 Hz");
+    }
+    
+    make_pair(applied, target, 2);
+    animation_transition(&anim, target, applied, 2, 0, 0);
+    animation_frame(&anim, 40 * MS, 4);
+    if (anim.dropped == 3 && anim.frames == 1) {
+        test_pass("Late ticks are dropped, not replayed");
+    } else {
+        test_fail("Late ticks are dropped, not replayed", "wrong frame/drop counts");
+    }
+    
+    // A new target mid-flight starts from where the window is now
+    mid = screen[0].x;
+    target[0].x = 0;
+    target[0].y = 500;
+    animation_transition(&anim, target, applied, 2, 40 * MS, 0);
+    if (anim.tracks[0].from.x == mid && anim.tracks[0].to.y == 500 && applied[0].y == 500) {
+        test_pass("Retarget continues from the shown frame");
+    } else {
+        test_fail("Retarget continues from the shown frame", "track restarted from the old target");
+    }
+    
+    animation_forget(&anim, (Window)1);
+    animation_finish(&anim);
+    if (!animation_active(&anim) && screen[1].x == 1000 && screen[0].y != 500) {
+        test_pass("Finish jumps remaining windows, forgotten ones untouched");
+    } else {
+        test_fail("Finish jumps remaining windows, forgotten ones untouched", "wrong final geometry");
+    }
+    
+    animation_cleanup(&anim);
+}
+
+int main() {
+    printf("VaultWM Animation Unit Tests\n");
+    printf("============================\n\n");
+    
+    test_slide();
+    test_skip();
+    test_pacing();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
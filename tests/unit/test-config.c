@@ -0,0 +1,192 @@
+/*
+ * Unit tests for VaultWM runtime configuration
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../src/wm/config/runtime-config/config-parser.h"
+#include "../src/wm/config/runtime-config/config-watch.h"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+static void write_file(const char *path, const char *text) {
+    FILE *f = fopen(path, "w");
+    if (!f) return;
+    fputs(text, f);
+    fclose(f);
+}
+
+void test_parse() {
+    VaultWMConfig config;
+    
+    printf("Testing config parsing...\n");
+    
+    get_default_config(&config);
+    if (config.border_width == 2 && config.gap_size == 5 && config.status_bar_height == 30 &&
+        strcmp(config.keys[CONFIG_KEY_TERMINAL], "Return") == 0 &&
+        strcmp(config.default_layout, "tiling") == 0) {
+        test_pass("Defaults come from config.h");
+    } else {
+        test_fail("Defaults come from config.h", "wrong default");
+    }
+    
+    parse_config_line("border_color_focused=0xFFBF00\n", &config);
+    parse_config_line("color_unfocused = \"#102030\"\n", &config);
+    parse_config_line("window_gap = 8\n", &config);
+    parse_config_line("terminal = \"kitty\"\n", &config);
+    if (config.border_color_focused == 0xFFBF00 && config.border_color_unfocused == 0x102030 &&
+        config.gap_size == 8 && strcmp(config.terminal_cmd, "kitty") == 0) {
+        test_pass("Hex colours, quotes and older key names");
+    } else {
+        test_fail("Hex colours, quotes and older key names", "value not parsed");
+    }
+    
+    parse_config_line("close_key=x\n", &config);
+    parse_config_line("launcher_key=\n", &config);
+    parse_config_line("status_bar_height=-4\n", &config);
+    parse_config_line("workspace_2=Web\n", &config);
+    if (strcmp(config.keys[CONFIG_KEY_CLOSE], "x") == 0 &&
+        strcmp(config.keys[CONFIG_KEY_LAUNCHER], "d") == 0 && config.status_bar_height == 30 &&
+        strcmp(config.workspace_names[1], "Web") == 0) {
+        test_pass("Key bindings, names, invalid values ignored");
+    } else {
+        test_fail("Key bindings, names, invalid values ignored", "wrong value");
+    }
+}
+
+void test_errors() {
+    const char text[] =
+        "# header\r\n"
+        "gap_size = 7\r\n"
+        "gapsize=3\n"
+        "  border_width = wide\n"
+        "just some words\n"
+        "border_color_focused=#12345678\n"
+        "workspace_9=\n"
+        "move_key=g";
+    VaultWMConfig config;
+    ConfigErrors errors;
+    
+    printf("Testing config errors...\n");
+    
+    get_default_config(&config);
+    errors.count = 0;
+    if (config_parse_buffer(text, strlen(text), &config, &errors) == 3 && config.gap_size == 7 &&
+        config.workspace_names[8][0] == '\0' && strcmp(config.keys[CONFIG_KEY_MOVE], "g") == 0) {
+        test_pass("CRLF, empty values, no trailing newline");
+    } else {
+        test_fail("CRLF, empty values, no trailing newline", "wrong values set");
+    }
+    
+    if (errors.count == 4 &&
+        errors.errors[0].line == 3 && errors.errors[0].column == 1 &&
+        strcmp(errors.errors[0].message, "unknown key") == 0 &&
+        errors.errors[1].line == 4 && errors.errors[1].column == 18 &&
+        errors.errors[2].line == 5 && errors.errors[2].column == 1 &&
+        errors.errors[3].line == 6 && errors.errors[3].column == 22 &&
+        config.border_width == 2) {
+        test_pass("Errors carry line and column");
+    } else {
+        test_fail("Errors carry line and column", "wrong diagnostics");
+    }
+}
+
+void test_diff() {
+    VaultWMConfig a, b;
+    
+    printf("Testing config diff...\n");
+    
+    get_default_config(&a);
+    b = a;
+    if (config_diff(&a, &b) == 0) {
+        test_pass("Identical configs do not differ");
+    } else {
+        test_fail("Identical configs do not differ", "spurious change");
+    }
+    
+    parse_config_line("gap_size=10", &b);
+    parse_config_line("border_color_urgent=#00FF00", &b);
+    if (config_diff(&a, &b) == (CONFIG_CHANGED_GAPS | CONFIG_CHANGED_COLORS)) {
+        test_pass("Only changed subsystems are reported");
+    } else {
+        test_fail("Only changed subsystems are reported", "wrong change mask");
+    }
+    
+    b = a;
+    parse_config_line("move_key=g", &b);
+    parse_config_line("status_bar_height=24", &b);
+    parse_config_line("launcher_cmd=bemenu-run", &b);
+    if (config_diff(&a, &b) == (CONFIG_CHANGED_KEYS | CONFIG_CHANGED_BAR | CONFIG_CHANGED_BEHAVIOUR)) {
+        test_pass("Keys, bar and commands");
+    } else {
+        test_fail("Keys, bar and commands", "wrong change mask");
+    }
+}
+
+void test_watch() {
+    char dir[] = "/tmp/vaultwm-config-XXXXXX";
+    char path[128], tmp[128];
+    VaultWMConfig config;
+    
+    printf("Testing config watch...\n");
+    
+    if (!mkdtemp(dir) || !config_watch_init(dir)) {
+        test_fail("Watch config directory", "cannot watch temp dir");
+        return;
+    }
+    
+    snprintf(path, sizeof(path), "%s/config", dir);
+    write_file(path, "gap_size=12\n");
+    if (config_watch_read() == CONFIG_WATCH_CONFIG && load_config(path, &config) && config.gap_size == 12) {
+        test_pass("Saving the config is noticed");
+    } else {
+        test_fail("Saving the config is noticed", "no event");
+    }
+    
+    // Editors that save by renaming a temp file over the original
+    snprintf(tmp, sizeof(tmp), "%s/.config.swp", dir);
+    write_file(tmp, "gap_size=3\n");
+    rename(tmp, path);
+    snprintf(tmp, sizeof(tmp), "%s/rules", dir);
+    write_file(tmp, "mpv:float=true\n");
+    if (config_watch_read() == (CONFIG_WATCH_CONFIG | CONFIG_WATCH_RULES) && config_watch_read() == 0) {
+        test_pass("Renames and rules, one bit per file");
+    } else {
+        test_fail("Renames and rules, one bit per file", "wrong event bits");
+    }
+    
+    config_watch_cleanup();
+    unlink(path);
+    unlink(tmp);
+    rmdir(dir);
+}
+
+int main(void) {
+    printf("VaultWM Config Unit Tests\n");
+    printf("=========================\n\n");
+    
+    test_parse();
+    test_errors();
+    test_diff();
+    test_watch();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
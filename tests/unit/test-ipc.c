@@ -10,6 +10,7 @@
 #include <sys/stat.h>
 #include <assert.h>
 #include "../src/wm/config/runtime-config/ipc.h"
+#include "../src/wm/vaultwmctl/vaultwm-ipc.h"
 
 #define TEST_FIFO_PATH "/tmp/test-vaultwm-ipc"
 
@@ -103,6 +104,170 @@ void test_ipc_command_validation() {
     test_pass("Command validation (tested through integration)");
 }
 
+static int handled_commands = 0;
+
+static int test_handler(const char *cmd, const char *args, char *reply, size_t reply_size) {
+    handled_commands++;
+    if (strcmp(cmd, IPC_CMD_GET_STATUS) == 0) {
+        snprintf(reply, reply_size, "workspace=1");
+    } else if (strcmp(cmd, IPC_CMD_CLOSE_WINDOW) == 0) {
+        ipc_broadcast_event(IPC_EVENT_FOCUS, "focus 0x2");  // As unmanaging does
+    } else if (strcmp(cmd, IPC_CMD_WORKSPACE) == 0 && atoi(args) == 0) {
+        snprintf(reply, reply_size, "Bad workspace");
+        return 0;
+    }
+    return 1;
+}
+
+void test_ipc_socket_pipelining() {
+    printf("Testing IPC socket pipelining...\n");
+    
+    char socket_path[IPC_SOCKET_PATH_MAX];
+    char reply[VAULTWM_IPC_LINE_MAX];
+    int i, ok = 1;
+    
+    snprintf(socket_path, sizeof(socket_path), "/tmp/test-vaultwm-ipc-%d.sock", (int)getpid());
+    setenv(IPC_SOCKET_ENV, socket_path, 1);
+    
+    if (ipc_init() != 1) {
+        test_fail("IPC socket initialization", "Failed to initialize");
+        return;
+    }
+    ipc_set_command_handler(test_handler);
+    
+    VaultWMIPC *ipc = vaultwm_ipc_connect(socket_path);
+    if (!ipc) {
+        test_fail("Client connect", "Cannot connect to socket");
+        ipc_cleanup();
+        return;
+    }
+    test_pass("Client connect");
+    ipc_process_commands();  // Accept
+    
+    // Queue many requests on one connection before reading any reply
+    handled_commands = 0;
+    for (i = 0; i < 50; i++) {
+        vaultwm_ipc_send(ipc, "focus_next");
+    }
+    vaultwm_ipc_send(ipc, "get_status");
+    vaultwm_ipc_send(ipc, "workspace x");
+    vaultwm_ipc_send(ipc, "not_a_command");
+    vaultwm_ipc_flush(ipc);
+    ipc_process_commands();
+    
+    if (handled_commands == 52) {
+        test_pass("Pipelined requests executed");
+    } else {
+        test_fail("Pipelined requests executed", "Wrong command count");
+    }
+    
+    for (i = 0; i < 50; i++) {
+        if (vaultwm_ipc_read_reply(ipc, reply, sizeof(reply)) != VAULTWM_IPC_OK) {
+            ok = 0;
+        }
+    }
+    if (ok && vaultwm_ipc_read_reply(ipc, reply, sizeof(reply)) == VAULTWM_IPC_OK &&
+        strcmp(reply, "OK workspace=1") == 0) {
+        test_pass("Replies arrive in request order");
+    } else {
+        test_fail("Replies arrive in request order", "Unexpected reply");
+    }
+    if (vaultwm_ipc_read_reply(ipc, reply, sizeof(reply)) == VAULTWM_IPC_ERROR &&
+        vaultwm_ipc_read_reply(ipc, reply, sizeof(reply)) == VAULTWM_IPC_ERROR &&
+        vaultwm_ipc_pending(ipc) == 0) {
+        test_pass("Errors reported per request");
+    } else {
+        test_fail("Errors reported per request", "Expected two errors");
+    }
+    
+    // Subscribed clients receive events between replies
+    vaultwm_ipc_send(ipc, "subscribe focus");
+    vaultwm_ipc_flush(ipc);
+    ipc_process_commands();
+    if (vaultwm_ipc_read_reply(ipc, reply, sizeof(reply)) == VAULTWM_IPC_OK) {
+        ipc_broadcast_event(IPC_EVENT_WORKSPACE, "workspace 2");
+        ipc_broadcast_event(IPC_EVENT_FOCUS, "focus 0x1");
+        if (vaultwm_ipc_read_event(ipc, reply, sizeof(reply)) && strcmp(reply, "focus 0x1") == 0) {
+            test_pass("Subscription filters events");
+        } else {
+            test_fail("Subscription filters events", "Unexpected event");
+        }
+    } else {
+        test_fail("Subscribe", "Subscribe rejected");
+    }
+    
+    vaultwm_ipc_disconnect(ipc);
+    ipc_cleanup();
+    
+    struct stat st;
+    if (stat(socket_path, &st) != 0) {
+        test_pass("IPC socket removed on cleanup");
+    } else {
+        test_fail("IPC socket removed on cleanup", "Socket still exists");
+    }
+    unsetenv(IPC_SOCKET_ENV);
+}
+
+/* Clients that hang up before reading must cost the WM nothing but the client */
+void test_ipc_client_gone() {
+    printf("Testing IPC clients that go away...\n");
+    
+    char socket_path[IPC_SOCKET_PATH_MAX];
+    char reply[VAULTWM_IPC_LINE_MAX];
+    VaultWMIPC *ipc, *other;
+    
+    snprintf(socket_path, sizeof(socket_path), "/tmp/test-vaultwm-ipc-%d.sock", (int)getpid());
+    setenv(IPC_SOCKET_ENV, socket_path, 1);
+    if (ipc_init() != 1) {
+        test_fail("IPC socket initialization", "Failed to initialize");
+        return;
+    }
+    ipc_set_command_handler(test_handler);
+    
+    // Reply to a closed socket: EPIPE, not SIGPIPE
+    ipc = vaultwm_ipc_connect(socket_path);
+    ipc_process_commands();
+    vaultwm_ipc_send(ipc, "get_status");
+    vaultwm_ipc_flush(ipc);
+    vaultwm_ipc_disconnect(ipc);
+    ipc_process_commands();
+    test_pass("Reply to a departed client");
+    
+    // The departed client is also subscribed and its own request broadcasts
+    ipc = vaultwm_ipc_connect(socket_path);
+    other = vaultwm_ipc_connect(socket_path);
+    ipc_process_commands();
+    vaultwm_ipc_send(ipc, "subscribe focus");
+    vaultwm_ipc_flush(ipc);
+    ipc_process_commands();
+    vaultwm_ipc_read_reply(ipc, reply, sizeof(reply));
+    vaultwm_ipc_send(ipc, "close_window");
+    vaultwm_ipc_send(ipc, "close_window");
+    vaultwm_ipc_flush(ipc);
+    vaultwm_ipc_disconnect(ipc);
+    handled_commands = 0;
+    ipc_process_commands();
+    if (handled_commands == 1) {
+        test_pass("Broadcast to the requesting client stops its requests");
+    } else {
+        test_fail("Broadcast to the requesting client stops its requests", "Kept executing");
+    }
+    
+    vaultwm_ipc_send(other, "get_status");
+    vaultwm_ipc_flush(other);
+    ipc_process_commands();
+    if (vaultwm_ipc_read_reply(other, reply, sizeof(reply)) == VAULTWM_IPC_OK &&
+        strcmp(reply, "OK workspace=1") == 0) {
+        test_pass("Other clients unaffected");
+    } else {
+        test_fail("Other clients unaffected", "No reply");
+    }
+    
+    vaultwm_ipc_disconnect(other);
+    ipc_cleanup();
+    unsetenv(IPC_SOCKET_ENV);
+}
+
 int main(void) {
     printf("VaultWM IPC Unit Tests\n");
     printf("======================\n\n");
@@ -110,6 +275,8 @@ int main(void) {
     test_ipc_init();
     test_ipc_command_parsing();
     test_ipc_command_validation();
+    test_ipc_socket_pipelining();
+    test_ipc_client_gone();
     
     printf("\nTest Summary\n");
     printf("============\n");
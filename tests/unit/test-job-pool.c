@@ -0,0 +1,161 @@
+/*
+ * Unit tests for the VaultWM job pool
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include "../src/wm/jobs/job-pool.h"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+static int ran = 0;           // Updated by workers
+static int completed = 0;     // Event thread only
+static int completed_a = 0;
+static int off_thread = 0;
+static int done_on_worker = 0;
+static pthread_t event_thread;
+static int owner_a, owner_b;
+
+static void count_run(void *arg) {
+    (void)arg;
+    if (!pthread_equal(pthread_self(), event_thread)) __atomic_add_fetch(&off_thread, 1, __ATOMIC_RELAXED);
+    usleep(1000);
+    __atomic_add_fetch(&ran, 1, __ATOMIC_RELAXED);
+}
+
+static void count_done(void *arg) {
+    if (arg == &owner_a) completed_a++;
+    if (!pthread_equal(pthread_self(), event_thread)) done_on_worker++;
+    completed++;
+}
+
+/* Fans out from inside a worker: the children land on that worker's queue
+ * and the idle workers have to steal them */
+static void spawn_run(void *arg) {
+    int i;
+    
+    for (i = 0; i < 8; i++) {
+        job_submit(count_run, count_done, NULL, arg);
+    }
+}
+
+/* Drain completions through the eventfd, as the event loop does */
+static void wait_for(int want) {
+    struct pollfd pfd = { job_pool_get_fd(), POLLIN, 0 };
+    int tries;
+    
+    for (tries = 0; completed < want && tries < 500; tries++) {
+        if (job_pool_pending() || poll(&pfd, 1, 10) > 0) job_pool_dispatch(4);
+    }
+}
+
+void test_completions(void) {
+    int i;
+    
+    printf("Testing job completions...\n");
+    
+    event_thread = pthread_self();
+    if (job_pool_init(3) && job_pool_get_fd() >= 0) {
+        test_pass("Pool starts with a completion fd");
+    } else {
+        test_fail("Pool starts with a completion fd", "init failed");
+        return;
+    }
+    
+    for (i = 0; i < 40; i++) {
+        job_submit(count_run, count_done, NULL, &owner_a);
+    }
+    wait_for(40);
+    if (completed == 40 && ran == 40 && off_thread == 40) {
+        test_pass("Jobs run on workers and complete through the fd");
+    } else {
+        test_fail("Jobs run on workers and complete through the fd", "jobs lost");
+    }
+    if (done_on_worker == 0) {
+        test_pass("Completions run on the event thread");
+    } else {
+        test_fail("Completions run on the event thread", "ran on a worker");
+    }
+    
+    job_submit(spawn_run, count_done, &owner_a, &owner_a);
+    wait_for(49);
+    if (completed == 49 && ran == 48) {
+        test_pass("Jobs submitted by a worker are run");
+    } else {
+        test_fail("Jobs submitted by a worker are run", "jobs lost");
+    }
+}
+
+void test_flush(void) {
+    int i;
+    
+    printf("Testing job flush...\n");
+    
+    completed = 0;
+    for (i = 0; i < 20; i++) {
+        void *owner = i % 2 ? &owner_a : &owner_b;
+        job_submit(count_run, count_done, owner, owner);
+    }
+    completed_a = 0;
+    job_pool_flush(&owner_a);
+    if (completed_a == 10) {
+        test_pass("Flush finishes an owner's jobs and completions");
+    } else {
+        test_fail("Flush finishes an owner's jobs and completions", "still queued");
+    }
+    
+    for (i = 0; i < 10; i++) {
+        job_submit(i % 2 ? spawn_run : count_run, count_done, NULL, &owner_b);
+    }
+    job_pool_drain();
+    if (completed == 70 && !job_pool_pending() && job_pool_get_fd() >= 0) {
+        test_pass("Drain finishes all jobs and keeps the pool");
+    } else {
+        test_fail("Drain finishes all jobs and keeps the pool", "jobs left");
+    }
+    
+    job_pool_cleanup();
+    if (completed == 70 && job_pool_get_fd() < 0) {
+        test_pass("Cleanup drains the queues before stopping");
+    } else {
+        test_fail("Cleanup drains the queues before stopping", "jobs lost");
+    }
+    
+    off_thread = 0;
+    job_submit(count_run, count_done, NULL, NULL);
+    if (completed == 71 && off_thread == 0) {
+        test_pass("Without a pool, jobs run inline");
+    } else {
+        test_fail("Without a pool, jobs run inline", "not run");
+    }
+}
+
+int main(void) {
+    printf("VaultWM Job Pool Unit Tests\n");
+    printf("===========================\n\n");
+    
+    test_completions();
+    test_flush();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,270 @@
+/*
+ * Unit tests for VaultWM layout engine
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/wm/layouts/layout-engine.h"
+
+#define AREA_X 0
+#define AREA_Y 30
+#define AREA_W 1920
+#define AREA_H 1050
+#define GAP 5
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+static void make_clients(LayoutClient *clients, int n) {
+    int i;
+    memset(clients, 0, n * sizeof(LayoutClient));
+    for (i = 0; i < n; i++) {
+        clients[i].win = (Window)(0x100 + i);
+    }
+}
+
+static int count_changed(const LayoutClient *a, const LayoutClient *b, int n) {
+    int i, changed = 0;
+    for (i = 0; i < n; i++) {
+        changed += layout_rect_changed(&a[i], &b[i]);
+    }
+    return changed;
+}
+
+void test_layout_modes() {
+    LayoutClient clients[8];
+    int mode, i;
+    
+    printf("Testing layout modes...\n");
+    
+    for (mode = 0; mode < LAYOUT_COUNT; mode++) {
+        int inside = 1;
+        
+        if (mode == LAYOUT_FLOATING) continue;
+        
+        make_clients(clients, 5);
+        layout_arrange(mode, NULL, clients, 5, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+        for (i = 0; i < 5; i++) {
+            if (clients[i].width <= 0 || clients[i].height <= 0 ||
+                clients[i].x < AREA_X || clients[i].y < AREA_Y ||
+                clients[i].x + clients[i].width > AREA_X + AREA_W ||
+                clients[i].y + clients[i].height > AREA_Y + AREA_H) {
+                inside = 0;
+            }
+        }
+        if (inside) {
+            test_pass("Mode places every client inside the area");
+        } else {
+            test_fail("Mode places every client inside the area", "client outside area");
+        }
+    }
+    
+    make_clients(clients, 3);
+    clients[1].is_floating = 1;
+    clients[1].x = 77;
+    layout_arrange(LAYOUT_GRID, NULL, clients, 3, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    if (clients[1].x == 77 && clients[2].x > clients[0].x && clients[2].y == clients[0].y) {
+        test_pass("Floating clients keep geometry and leave no hole");
+    } else {
+        test_fail("Floating clients keep geometry and leave no hole", "grid cell skipped");
+    }
+}
+
+void test_layout_diff() {
+    LayoutClient applied[32], target[32];
+    
+    printf("Testing layout diffing...\n");
+    
+    // 26 and 27 windows share a 6x5 grid: only the new window needs configuring
+    make_clients(applied, 27);
+    layout_arrange(LAYOUT_GRID, NULL, applied, 26, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    memcpy(target, applied, sizeof(target));
+    layout_arrange(LAYOUT_GRID, NULL, target, 27, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    if (count_changed(target, applied, 27) == 1) {
+        test_pass("Adding a grid window changes one rectangle");
+    } else {
+        test_fail("Adding a grid window changes one rectangle", "other windows moved");
+    }
+    
+    memcpy(applied, target, sizeof(target));
+    layout_arrange(LAYOUT_GRID, NULL, target, 27, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    if (count_changed(target, applied, 27) == 0) {
+        test_pass("Relayout without changes is a no-op");
+    } else {
+        test_fail("Relayout without changes is a no-op", "geometry drifted");
+    }
+}
+
+void test_bsp_tree() {
+    static BSPTree tree;
+    LayoutClient a, b, sa, sb;
+    int i, recomputed;
+    
+    printf("Testing BSP tree...\n");
+    
+    bsp_init(&tree);
+    for (i = 0; i < 30; i++) {
+        bsp_insert(&tree, (Window)(0x100 + i));
+    }
+    bsp_layout(&tree, LAYOUT_DWINDLE, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    
+    bsp_insert(&tree, (Window)0x200);
+    recomputed = bsp_layout(&tree, LAYOUT_DWINDLE, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    if (recomputed <= 3) {
+        test_pass("Insert recomputes only the split subtree");
+    } else {
+        test_fail("Insert recomputes only the split subtree", "walked the whole tree");
+    }
+    
+    if (bsp_layout(&tree, LAYOUT_DWINDLE, AREA_X, AREA_Y, AREA_W, AREA_H, GAP) == 0) {
+        test_pass("Clean relayout walks nothing");
+    } else {
+        test_fail("Clean relayout walks nothing", "nodes recomputed");
+    }
+    
+    bsp_geometry(&tree, (Window)0x100, &a);
+    bsp_adjust_ratio(&tree, (Window)0x100, 0.2);
+    bsp_layout(&tree, LAYOUT_DWINDLE, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    bsp_remove(&tree, (Window)0x200);
+    bsp_insert(&tree, (Window)0x201);
+    bsp_layout(&tree, LAYOUT_DWINDLE, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    bsp_geometry(&tree, (Window)0x100, &b);
+    if (b.width > a.width && b.height == a.height) {
+        test_pass("Manual ratio survives insert and remove");
+    } else {
+        test_fail("Manual ratio survives insert and remove", "ratio lost");
+    }
+    
+    bsp_geometry(&tree, (Window)0x101, &a);
+    bsp_geometry(&tree, (Window)0x105, &b);
+    bsp_swap(&tree, (Window)0x101, (Window)0x105);
+    bsp_layout(&tree, LAYOUT_DWINDLE, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    bsp_geometry(&tree, (Window)0x101, &sa);
+    bsp_geometry(&tree, (Window)0x105, &sb);
+    if (!layout_rect_changed(&sa, &b) && !layout_rect_changed(&sb, &a)) {
+        test_pass("Swap exchanges leaf geometry");
+    } else {
+        test_fail("Swap exchanges leaf geometry", "windows kept their places");
+    }
+    
+    for (i = 0; i < 30; i++) {
+        bsp_remove(&tree, (Window)(0x100 + i));
+    }
+    bsp_layout(&tree, LAYOUT_FIBONACCI, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    if (bsp_geometry(&tree, (Window)0x201, &a) && a.x == AREA_X + GAP && a.width == AREA_W - 2 * GAP &&
+        !bsp_contains(&tree, (Window)0x100)) {
+        test_pass("Last window takes the whole area");
+    } else {
+        test_fail("Last window takes the whole area", "stale geometry");
+    }
+}
+
+void test_bsp_sync() {
+    static BSPTree tree;
+    LayoutClient clients[6];
+    
+    printf("Testing BSP sync...\n");
+    
+    bsp_init(&tree);
+    make_clients(clients, 6);
+    bsp_sync(&tree, clients, 6);
+    bsp_sync(&tree, clients, 6);
+    if (tree.num_leaves == 6) {
+        test_pass("Sync inserts each tiled client once");
+    } else {
+        test_fail("Sync inserts each tiled client once", "wrong leaf count");
+    }
+    
+    clients[2].is_floating = 1;
+    bsp_sync(&tree, clients, 5);
+    if (tree.num_leaves == 4 && !bsp_contains(&tree, clients[2].win) &&
+        !bsp_contains(&tree, clients[5].win) && bsp_contains(&tree, clients[4].win)) {
+        test_pass("Sync drops floated and missing clients");
+    } else {
+        test_fail("Sync drops floated and missing clients", "stale leaves kept");
+    }
+}
+
+void test_dwindle_reentrant() {
+    LayoutClient first[6], second[6];
+    
+    printf("Testing dwindle determinism...\n");
+    
+    make_clients(first, 6);
+    make_clients(second, 6);
+    layout_dwindle(first, 6, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    layout_dwindle(second, 6, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    if (count_changed(first, second, 6) == 0) {
+        test_pass("Repeated dwindle calls agree");
+    } else {
+        test_fail("Repeated dwindle calls agree", "result depends on call history");
+    }
+}
+
+void test_size_hints() {
+    LayoutClient clients[3];
+    
+    printf("Testing size hint constraints...\n");
+    
+    // A terminal with 9x18 cells and 2px padding, next to an unhinted window
+    make_clients(clients, 2);
+    clients[0].hints.base_width = clients[0].hints.min_width = 4;
+    clients[0].hints.base_height = clients[0].hints.min_height = 4;
+    clients[0].hints.inc_width = 9;
+    clients[0].hints.inc_height = 18;
+    layout_arrange(LAYOUT_TILING, NULL, clients, 2, AREA_X, AREA_Y, AREA_W, AREA_H, GAP);
+    if ((clients[0].width - 4) % 9 == 0 && (clients[0].height - 4) % 18 == 0 &&
+        clients[0].width <= AREA_W && clients[1].width == AREA_W - 2 * GAP) {
+        test_pass("Layout output snaps to whole cells");
+    } else {
+        test_fail("Layout output snaps to whole cells", "fractional cell size");
+    }
+    
+    make_clients(clients, 3);
+    clients[0].x = clients[1].x = clients[2].x = 10;
+    clients[0].width = clients[1].width = clients[2].width = 800;
+    clients[0].height = clients[1].height = clients[2].height = 400;
+    clients[0].hints.max_width = 500;
+    clients[0].hints.min_height = 600;
+    clients[1].hints.max_aspect_x = clients[1].hints.min_aspect_x = 1;
+    clients[1].hints.max_aspect_y = clients[1].hints.min_aspect_y = 1;
+    clients[2].is_floating = 1;
+    clients[2].hints.max_width = 100;
+    layout_constrain(clients, 3);
+    if (clients[0].width == 500 && clients[0].height == 600 && clients[0].x == 10 &&
+        clients[1].width == 400 && clients[1].height == 400 && clients[2].width == 800) {
+        test_pass("Min/max and aspect applied, floating untouched");
+    } else {
+        test_fail("Min/max and aspect applied, floating untouched", "wrong constrained size");
+    }
+}
+
+int main(void) {
+    printf("VaultWM Layout Unit Tests\n");
+    printf("=========================\n\n");
+    
+    test_layout_modes();
+    test_layout_diff();
+    test_bsp_tree();
+    test_bsp_sync();
+    test_dwindle_reentrant();
+    test_size_hints();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+/*
+ * Unit tests for VaultWM metrics endpoint
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <X11/X.h>
+#include "../src/wm/metrics/metrics.h"
+
+#define TEST_METRICS_SOCKET "/tmp/test-vaultwm-metrics.sock"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+static int collector_calls = 0;
+
+static void test_collector(void) {
+    collector_calls++;
+    metrics_set(METRIC_CLIENTS, 3);
+}
+
+void test_metrics_render() {
+    char buf[16384];
+    size_t len;
+    
+    printf("Testing metrics rendering...\n");
+    
+    metrics_inc(METRIC_LAYOUT_PASSES);
+    metrics_inc(METRIC_LAYOUT_PASSES);
+    metrics_count_event(MapRequest);
+    metrics_count_event(200);
+    
+    len = metrics_render(buf, sizeof(buf));
+    if (len > 0 && strstr(buf, "# TYPE vaultwm_layout_passes_total counter\nvaultwm_layout_passes_total 2\n")) {
+        test_pass("Counter with HELP/TYPE");
+    } else {
+        test_fail("Counter with HELP/TYPE", buf);
+    }
+    
+    if (strstr(buf, "vaultwm_x_events_total{type=\"MapRequest\"} 1\n") &&
+        strstr(buf, "vaultwm_x_events_total{type=\"other\"} 1\n") &&
+        !strstr(buf, "type=\"KeyPress\"")) {
+        test_pass("Per-type event counters");
+    } else {
+        test_fail("Per-type event counters", "unexpected event lines");
+    }
+    
+    if (metrics_render(buf, 64) == 0) {
+        test_pass("Overflow reported");
+    } else {
+        test_fail("Overflow reported", "short buffer accepted");
+    }
+}
+
+// Send request (may be NULL for EOF-only), pump the endpoint and collect the reply
+static int scrape(const char *request, char *reply, size_t reply_size) {
+    struct sockaddr_un addr;
+    size_t len = 0;
+    int fd, i;
+    
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", TEST_METRICS_SOCKET);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        return 0;
+    }
+    if (request) {
+        (void)write(fd, request, strlen(request));
+    } else {
+        shutdown(fd, SHUT_WR);
+    }
+    
+    for (i = 0; i < 200; i++) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        metrics_dispatch(0);
+        if (poll(&pfd, 1, 5) > 0) {
+            ssize_t n = read(fd, reply + len, reply_size - len - 1);
+            if (n <= 0) {
+                break;
+            }
+            len += (size_t)n;
+        }
+    }
+    reply[len] = '\0';
+    close(fd);
+    return len > 0;
+}
+
+void test_metrics_socket() {
+    char reply[16384];
+    
+    printf("Testing metrics socket...\n");
+    
+    setenv(METRICS_SOCKET_ENV, TEST_METRICS_SOCKET, 1);
+    metrics_set_collector(test_collector);
+    if (!metrics_init()) {
+        test_fail("Metrics init", "metrics_init failed");
+        return;
+    }
+    test_pass("Metrics init");
+    
+    if (scrape(NULL, reply, sizeof(reply)) && strncmp(reply, "# HELP", 6) == 0 &&
+        strstr(reply, "vaultwm_clients 3\n") && collector_calls == 1) {
+        test_pass("Plain scrape runs collector");
+    } else {
+        test_fail("Plain scrape runs collector", reply);
+    }
+    
+    if (scrape("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n", reply, sizeof(reply)) &&
+        strncmp(reply, "HTTP/1.0 200 OK\r\n", 17) == 0 &&
+        strstr(reply, "\r\n\r\n# HELP") && strstr(reply, "vaultwm_metrics_scrapes_total 2\n")) {
+        test_pass("HTTP scrape");
+    } else {
+        test_fail("HTTP scrape", reply);
+    }
+    
+    metrics_cleanup();
+    if (access(TEST_METRICS_SOCKET, F_OK) != 0) {
+        test_pass("Socket removed on cleanup");
+    } else {
+        test_fail("Socket removed on cleanup", "socket still exists");
+    }
+}
+
+int main(void) {
+    printf("VaultWM Metrics Unit Tests\n");
+    printf("==========================\n\n");
+    
+    test_metrics_render();
+    test_metrics_socket();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
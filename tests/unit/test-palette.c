@@ -0,0 +1,147 @@
+/*
+ * Unit tests for VaultWM palette loading
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../src/wm/theme/palette.h"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+static void write_file(const char *path, const char *text) {
+    FILE *f = fopen(path, "w");
+    if (!f) return;
+    fputs(text, f);
+    fclose(f);
+}
+
+void test_load() {
+    char path[] = "/tmp/vaultwm-palette-XXXXXX";
+    Palette palette, before;
+    int fd = mkstemp(path);
+    
+    printf("Testing palette loading...\n");
+    
+    if (fd < 0) {
+        test_fail("Create colors file", "mkstemp failed");
+        return;
+    }
+    close(fd);
+    
+    palette_default(&palette);
+    write_file(path,
+        "# Vault-Tec\n"
+        "GTK_BG=\"#1E3A8A\"\n"
+        "WM_BORDER_FOCUSED=\"#FFD700\"\n"
+        "GTK_BORDER=\"#123456\"\n"
+        "export WM_BORDER_UNFOCUSED='#0F1F4A'\n"
+        "WM_BORDER_URGENT=\"#GG0000\"\n");
+    if (palette_load(path, &palette) &&
+        palette.colors[PALETTE_BAR_BACKGROUND] == 0x1E3A8A &&
+        palette.colors[PALETTE_BORDER_FOCUSED] == 0xFFD700 &&
+        palette.colors[PALETTE_BORDER_UNFOCUSED] == 0x0F1F4A) {
+        test_pass("WM_* keys win over GTK_* ones");
+    } else {
+        test_fail("WM_* keys win over GTK_* ones", "wrong colour");
+    }
+    
+    if (palette.colors[PALETTE_BORDER_URGENT] == 0xFF0000 &&
+        palette.colors[PALETTE_BAR_FOREGROUND] == 0x00FF41) {
+        test_pass("Missing and bad values keep the old colour");
+    } else {
+        test_fail("Missing and bad values keep the old colour", "colour changed");
+    }
+    
+    before = palette;
+    unlink(path);
+    if (!palette_load(path, &palette) && palette_diff(&before, &palette) == 0) {
+        test_pass("Unreadable file leaves the palette alone");
+    } else {
+        test_fail("Unreadable file leaves the palette alone", "palette changed");
+    }
+}
+
+void test_find_diff() {
+    char home[] = "/tmp/vaultwm-home-XXXXXX";
+    char dir[256], path[512];
+    Palette a, b;
+    
+    printf("Testing palette lookup...\n");
+    
+    if (!mkdtemp(home)) {
+        test_fail("Create home", "mkdtemp failed");
+        return;
+    }
+    setenv("HOME", home, 1);
+    snprintf(dir, sizeof(dir), "%s/.local", home);
+    mkdir(dir, 0700);
+    snprintf(dir, sizeof(dir), "%s/.local/share", home);
+    mkdir(dir, 0700);
+    snprintf(dir, sizeof(dir), "%s/.local/share/vaultos", home);
+    mkdir(dir, 0700);
+    snprintf(dir, sizeof(dir), "%s/" PALETTE_USER_DIR, home);
+    mkdir(dir, 0700);
+    snprintf(path, sizeof(path), "%s/vaulttec.colors", dir);
+    write_file(path, "GTK_FG=\"#FFD700\"\n");
+    
+    char found[512];
+    if (palette_find("Vault-Tec", found, sizeof(found)) && strcmp(found, path) == 0) {
+        test_pass("Theme names are normalised and found in the user directory");
+    } else {
+        test_fail("Theme names are normalised and found in the user directory", "not found");
+    }
+    
+    if (!palette_find("../vaulttec", found, sizeof(found)) && !palette_find("", found, sizeof(found))) {
+        test_pass("Paths and empty names are refused");
+    } else {
+        test_fail("Paths and empty names are refused", "accepted");
+    }
+    
+    palette_default(&a);
+    b = a;
+    palette_load(path, &b);
+    if (palette_diff(&a, &b) == PALETTE_BIT(PALETTE_BAR_FOREGROUND)) {
+        test_pass("Diff reports only the colours that changed");
+    } else {
+        test_fail("Diff reports only the colours that changed", "wrong mask");
+    }
+    
+    unlink(path);
+    rmdir(dir);
+    snprintf(dir, sizeof(dir), "%s/.local/share/vaultos", home);
+    rmdir(dir);
+    snprintf(dir, sizeof(dir), "%s/.local/share", home);
+    rmdir(dir);
+    snprintf(dir, sizeof(dir), "%s/.local", home);
+    rmdir(dir);
+    rmdir(home);
+}
+
+int main(void) {
+    printf("VaultWM Palette Unit Tests\n");
+    printf("==========================\n\n");
+    
+    test_load();
+    test_find_diff();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/*
+ * Unit tests for the VaultWM plugin manifest cache
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../src/wm/plugins/plugin-manifest.h"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+static PluginManifest manifest;
+
+static void write_file(const char *path, const char *text) {
+    FILE *f = fopen(path, "w");
+    if (!f) return;
+    fputs(text, f);
+    fclose(f);
+}
+
+void test_round_trip(const char *dir) {
+    char plugin[PLUGIN_PATH_MAX], other[PLUGIN_PATH_MAX], cache[PLUGIN_PATH_MAX];
+    struct stat st;
+    PluginManifestEntry *e;
+    
+    printf("Testing manifest round trip...\n");
+    
+    snprintf(plugin, sizeof(plugin), "%s/clock.so", dir);
+    snprintf(other, sizeof(other), "%s/old plugin.so", dir);
+    snprintf(cache, sizeof(cache), "%s/plugins.manifest", dir);
+    write_file(plugin, "build 1");
+    write_file(other, "build 1");
+    
+    plugin_manifest_load(&manifest, cache);
+    stat(plugin, &st);
+    plugin_manifest_update(&manifest, plugin, &st, "clock", 1, 5, 0x12);
+    stat(other, &st);
+    plugin_manifest_update(&manifest, other, &st, "old", 2, 0, 0);
+    if (!plugin_manifest_update(&manifest, other, &st, "bad\tname", 2, 0, 0)) {
+        test_pass("Names that would break the format are not cached");
+    } else {
+        test_fail("Names that would break the format are not cached", "stored");
+    }
+    
+    if (plugin_manifest_save(&manifest, cache) && plugin_manifest_load(&manifest, cache) == 2) {
+        test_pass("Saved entries load back");
+    } else {
+        test_fail("Saved entries load back", "wrong count");
+    }
+    
+    stat(plugin, &st);
+    e = plugin_manifest_lookup(&manifest, plugin, &st);
+    if (e && strcmp(e->name, "clock") == 0 && e->type == 1 && e->caps == 5 && e->hooks == 0x12 && e->seen) {
+        test_pass("An unchanged file is found without opening it");
+    } else {
+        test_fail("An unchanged file is found without opening it", "not found");
+    }
+    
+    // Only clock.so was seen by this "scan", so old plugin.so counts as uninstalled
+    plugin_manifest_save(&manifest, cache);
+    plugin_manifest_load(&manifest, cache);
+    if (manifest.count == 1 && strcmp(manifest.entries[0].path, plugin) == 0) {
+        test_pass("Unseen plugins are dropped on save");
+    } else {
+        test_fail("Unseen plugins are dropped on save", "still there");
+    }
+    
+    unlink(other);
+}
+
+void test_invalidation(const char *dir) {
+    char plugin[PLUGIN_PATH_MAX], copy[PLUGIN_PATH_MAX], cache[PLUGIN_PATH_MAX];
+    struct stat st;
+    
+    printf("Testing manifest invalidation...\n");
+    
+    snprintf(plugin, sizeof(plugin), "%s/clock.so", dir);
+    snprintf(copy, sizeof(copy), "%s/.clock.so.new", dir);
+    snprintf(cache, sizeof(cache), "%s/plugins.manifest", dir);
+    
+    // Same bytes installed under a new inode
+    write_file(copy, "build 1");
+    rename(copy, plugin);
+    plugin_manifest_load(&manifest, cache);
+    stat(plugin, &st);
+    if (plugin_manifest_lookup(&manifest, plugin, &st) && manifest.dirty) {
+        test_pass("A reinstalled identical build is still known");
+    } else {
+        test_fail("A reinstalled identical build is still known", "miss");
+    }
+    
+    write_file(copy, "build 2");
+    rename(copy, plugin);
+    stat(plugin, &st);
+    if (!plugin_manifest_lookup(&manifest, plugin, &st)) {
+        test_pass("A rebuilt plugin has to be opened again");
+    } else {
+        test_fail("A rebuilt plugin has to be opened again", "stale entry used");
+    }
+    
+    write_file(cache, "# vaultwm plugin manifest 99\nbogus\n");
+    if (plugin_manifest_load(&manifest, cache) == 0 && manifest.dirty) {
+        test_pass("A manifest from another version is ignored");
+    } else {
+        test_fail("A manifest from another version is ignored", "entries loaded");
+    }
+    
+    unlink(plugin);
+    unlink(cache);
+}
+
+int main(void) {
+    char dir[] = "/tmp/vaultwm-manifest-XXXXXX";
+    
+    printf("VaultWM Plugin Manifest Unit Tests\n");
+    printf("==================================\n\n");
+    
+    if (!mkdtemp(dir)) {
+        printf("Cannot create a test directory\n");
+        return 1;
+    }
+    
+    test_round_trip(dir);
+    test_invalidation(dir);
+    
+    rmdir(dir);
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
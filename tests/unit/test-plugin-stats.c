@@ -0,0 +1,145 @@
+/*
+ * Unit tests for the VaultWM plugin call accounting and time budget
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/wm/plugins/plugin-stats.h"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+/* A call that began ms milliseconds ago */
+static void call(PluginStats *stats, unsigned int ms) {
+    uint64_t start;
+    
+    if (plugin_stats_begin(stats, &start)) {
+        plugin_stats_end(stats, "test", start - (uint64_t)ms * 1000000ULL);
+    }
+}
+
+void test_histogram(void) {
+    PluginStats stats;
+    char line[256];
+    int i;
+    
+    printf("Testing latency histogram...\n");
+    
+    plugin_stats_set_budget(0, 0);
+    plugin_stats_reset(&stats);
+    for (i = 0; i < 99; i++) {
+        call(&stats, 0);
+    }
+    call(&stats, 3);
+    
+    if (stats.calls == 100 && stats.max_ns >= 3000000ULL && stats.health == PLUGIN_HEALTH_OK) {
+        test_pass("Calls are counted without a budget");
+    } else {
+        test_fail("Calls are counted without a budget", "wrong totals");
+    }
+    
+    if (plugin_stats_percentile_us(&stats, 50) <= 1024 && plugin_stats_percentile_us(&stats, 100) >= 2048) {
+        test_pass("Percentiles come from the histogram");
+    } else {
+        test_fail("Percentiles come from the histogram", "wrong bucket");
+    }
+    
+    plugin_stats_format(&stats, line, sizeof(line));
+    if (strncmp(line, "ok calls=100 ", 13) == 0 && strstr(line, " hist=")) {
+        test_pass("Accounting formats as one line");
+    } else {
+        test_fail("Accounting formats as one line", line);
+    }
+}
+
+void test_budget(void) {
+    PluginStats stats;
+    uint64_t start;
+    
+    printf("Testing time budget...\n");
+    
+    plugin_stats_set_budget(5, 5);
+    plugin_stats_reset(&stats);
+    
+    call(&stats, 10);
+    if (stats.health == PLUGIN_HEALTH_WARNED && stats.overruns == 1) {
+        test_pass("A slow call warns");
+    } else {
+        test_fail("A slow call warns", plugin_health_name(stats.health));
+    }
+    
+    call(&stats, 10);
+    call(&stats, 10);
+    if (stats.health == PLUGIN_HEALTH_THROTTLED && !plugin_stats_begin(&stats, &start) && stats.skipped == 1) {
+        test_pass("Repeated slow calls are throttled");
+    } else {
+        test_fail("Repeated slow calls are throttled", plugin_health_name(stats.health));
+    }
+    
+    // Let the next rationed call through at once
+    stats.next_call_ns = 0;
+    call(&stats, 10);
+    stats.next_call_ns = 0;
+    call(&stats, 10);
+    if (stats.health == PLUGIN_HEALTH_DISABLED && !plugin_stats_begin(&stats, &start)) {
+        test_pass("A plugin that keeps overrunning is disabled");
+    } else {
+        test_fail("A plugin that keeps overrunning is disabled", plugin_health_name(stats.health));
+    }
+    
+    plugin_stats_reset(&stats);
+    if (stats.health == PLUGIN_HEALTH_OK && plugin_stats_begin(&stats, &start)) {
+        test_pass("Reset re-enables a plugin");
+    } else {
+        test_fail("Reset re-enables a plugin", "still skipped");
+    }
+}
+
+void test_forgiveness(void) {
+    PluginStats stats;
+    int i;
+    
+    printf("Testing strike reset...\n");
+    
+    plugin_stats_set_budget(5, 0);
+    plugin_stats_reset(&stats);
+    for (i = 0; i < 3; i++) {
+        call(&stats, 10);
+    }
+    for (i = 0; i < PLUGIN_STRIKE_RESET; i++) {
+        stats.next_call_ns = 0;
+        call(&stats, 0);
+    }
+    if (stats.health == PLUGIN_HEALTH_WARNED && stats.strikes == 0 && stats.overruns == 3) {
+        test_pass("A clean run lifts the throttle");
+    } else {
+        test_fail("A clean run lifts the throttle", plugin_health_name(stats.health));
+    }
+}
+
+int main(void) {
+    printf("VaultWM Plugin Stats Unit Tests\n");
+    printf("===============================\n\n");
+    
+    test_histogram();
+    test_budget();
+    test_forgiveness();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
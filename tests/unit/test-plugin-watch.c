@@ -0,0 +1,142 @@
+/*
+ * Unit tests for the VaultWM plugin watcher
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../src/wm/plugins/plugin-watch.h"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+typedef struct {
+    int count;
+    char names[8][64];
+} Reported;
+
+static void record(const char *path, void *data) {
+    Reported *r = data;
+    const char *slash = strrchr(path, '/');
+    if (r->count < 8) {
+        snprintf(r->names[r->count++], sizeof(r->names[0]), "%s", slash ? slash + 1 : path);
+    }
+}
+
+static void write_file(const char *dir, const char *name, const char *text) {
+    char path[PLUGIN_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "w");
+    if (!f) return;
+    fputs(text, f);
+    fclose(f);
+}
+
+static void remove_file(const char *dir, const char *name) {
+    char path[PLUGIN_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    unlink(path);
+}
+
+void test_watch(const char *dir) {
+    char from[PLUGIN_PATH_MAX], to[PLUGIN_PATH_MAX];
+    Reported r = { 0 };
+    
+    printf("Testing directory watch...\n");
+    
+    if (plugin_watch_add_dir(dir) && plugin_watch_get_fd() >= 0 &&
+        !plugin_watch_add_dir("/nonexistent/vaultwm-plugins")) {
+        test_pass("Existing directories are watched, missing ones skipped");
+    } else {
+        test_fail("Existing directories are watched, missing ones skipped", "wrong result");
+    }
+    
+    // One plugin written twice, one installed by rename, one gone before the read
+    write_file(dir, "tall.so", "v1");
+    write_file(dir, "tall.so", "v2");
+    write_file(dir, ".wide.so.tmp", "v1");
+    snprintf(from, sizeof(from), "%s/.wide.so.tmp", dir);
+    snprintf(to, sizeof(to), "%s/wide.so", dir);
+    rename(from, to);
+    write_file(dir, "gone.so", "v1");
+    remove_file(dir, "gone.so");
+    write_file(dir, "README", "not a plugin");
+    
+    int reported = plugin_watch_read(record, &r);
+    if (reported == 2 && r.count == 2 && strcmp(r.names[0], "tall.so") == 0 &&
+        strcmp(r.names[1], "wide.so") == 0) {
+        test_pass("Each new or replaced .so is reported once");
+    } else {
+        test_fail("Each new or replaced .so is reported once", "wrong files");
+    }
+    
+    r.count = 0;
+    if (plugin_watch_read(record, &r) == 0 && r.count == 0) {
+        test_pass("Nothing is reported twice");
+    } else {
+        test_fail("Nothing is reported twice", "events left over");
+    }
+    
+    remove_file(dir, "tall.so");
+    remove_file(dir, "wide.so");
+    remove_file(dir, "README");
+}
+
+void test_dlopen(const char *dir) {
+    char path[PLUGIN_PATH_MAX];
+    int fd = 0;
+    
+    printf("Testing plugin loading...\n");
+    
+    write_file(dir, "broken.so", "not an ELF file");
+    snprintf(path, sizeof(path), "%s/broken.so", dir);
+    if (!plugin_dlopen(path, &fd) && fd == -1) {
+        test_pass("A file that is not a library is refused");
+    } else {
+        test_fail("A file that is not a library is refused", "loaded");
+    }
+    remove_file(dir, "broken.so");
+    
+    if (!plugin_dlopen(path, &fd) && fd < 0) {
+        test_pass("A missing file is refused");
+    } else {
+        test_fail("A missing file is refused", "loaded");
+    }
+}
+
+int main(void) {
+    char dir[] = "/tmp/vaultwm-plugins-XXXXXX";
+    
+    printf("VaultWM Plugin Watch Unit Tests\n");
+    printf("===============================\n\n");
+    
+    if (!mkdtemp(dir)) {
+        printf("Cannot create a test directory\n");
+        return 1;
+    }
+    
+    test_watch(dir);
+    test_dlopen(dir);
+    
+    plugin_watch_cleanup();
+    rmdir(dir);
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+/*
+ * Unit tests for VaultWM restart state handoff
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "../src/wm/restart/restart.h"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+void test_encoding() {
+    StateBuffer sb;
+    char name[8];
+    
+    printf("Testing state encoding...\n");
+    
+    state_init(&sb);
+    state_put_uint(&sb, 5);
+    state_put_uint(&sb, 300);
+    state_put_uint(&sb, 0xFFFFFFFFu);
+    state_put_int(&sb, -1);
+    state_put_int(&sb, -1920);
+    state_put_int(&sb, 2147483647);
+    if (sb.len == 1 + 2 + 5 + 1 + 2 + 5 && sb.data[3] == 0xFF && sb.data[8] == 0x01) {
+        test_pass("Varints: small values take one byte");
+    } else {
+        test_fail("Varints: small values take one byte", "unexpected length");
+    }
+    
+    if (state_get_uint(&sb) == 5 && state_get_uint(&sb) == 300 && state_get_uint(&sb) == 0xFFFFFFFFu &&
+        state_get_int(&sb) == -1 && state_get_int(&sb) == -1920 && state_get_int(&sb) == 2147483647 &&
+        !sb.error) {
+        test_pass("Unsigned and zigzag round trip");
+    } else {
+        test_fail("Unsigned and zigzag round trip", "value changed");
+    }
+    
+    state_put_str(&sb, "web");
+    state_put_str(&sb, "Fibonacci");
+    state_get_str(&sb, name, sizeof(name));
+    int first = strcmp(name, "web") == 0;
+    state_get_str(&sb, name, sizeof(name));
+    if (first && strcmp(name, "Fibonac") == 0 && sb.pos == sb.len && !sb.error) {
+        test_pass("Strings, truncated to the caller's buffer");
+    } else {
+        test_fail("Strings, truncated to the caller's buffer", "wrong string");
+    }
+    
+    if (state_get_uint(&sb) == 0 && sb.error) {
+        test_pass("Reading past the end sets error");
+    } else {
+        test_fail("Reading past the end sets error", "no error");
+    }
+    state_free(&sb);
+}
+
+void test_handoff() {
+    StateBuffer out, in;
+    char name[16];
+    char byte;
+    
+    printf("Testing state handoff...\n");
+    
+    state_init(&out);
+    state_init(&in);
+    state_put_uint(&out, 3);
+    state_put_str(&out, "Monocle");
+    state_put_int(&out, -40);
+    int fd = restart_handoff(&out);
+    int received = fd >= 0 && getenv(RESTART_FD_ENV) && restart_receive(&in);
+    if (received) {
+        uint32_t workspace = state_get_uint(&in);
+        state_get_str(&in, name, sizeof(name));
+        int x = state_get_int(&in);
+        received = workspace == 3 && strcmp(name, "Monocle") == 0 && x == -40 && !in.error;
+    }
+    if (received && !getenv(RESTART_FD_ENV) && fcntl(fd, F_GETFD) < 0) {
+        test_pass("Round trip through the memfd; fd closed, variable cleared");
+    } else {
+        test_fail("Round trip through the memfd; fd closed, variable cleared", "state lost");
+    }
+    state_free(&in);
+    
+    if (!restart_receive(&in)) {
+        test_pass("No state without a handoff");
+    } else {
+        test_fail("No state without a handoff", "stale state");
+    }
+    
+    // A flipped payload byte must fail the checksum
+    fd = restart_handoff(&out);
+    if (fd >= 0 && pread(fd, &byte, 1, 16) == 1) {
+        byte ^= 0x40;
+        if (pwrite(fd, &byte, 1, 16) != 1) fd = -1;
+    }
+    if (fd >= 0 && !restart_receive(&in) && in.data == NULL) {
+        test_pass("Corrupted state is rejected");
+    } else {
+        test_fail("Corrupted state is rejected", "accepted");
+    }
+    
+    setenv(RESTART_FD_ENV, "12abc", 1);
+    if (!restart_receive(&in) && !getenv(RESTART_FD_ENV)) {
+        test_pass("Malformed variable is ignored");
+    } else {
+        test_fail("Malformed variable is ignored", "accepted");
+    }
+    state_free(&out);
+}
+
+int main(void) {
+    printf("VaultWM Restart Unit Tests\n");
+    printf("==========================\n\n");
+    
+    test_encoding();
+    test_handoff();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
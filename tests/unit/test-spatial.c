@@ -0,0 +1,242 @@
+/*
+ * Unit tests for VaultWM spatial index
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "../src/wm/spatial/spatial.h"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+typedef struct {
+    Window win;
+    int x, y, width, height;
+} Rect;
+
+/* Same scoring as spatial_neighbor(), by checking every window. Ties go to the
+ * window met first walking outward: nearest centre, then window id order. */
+static Window brute_neighbor(const Rect *rects, int n, int from, Direction dir) {
+    const Rect *f = &rects[from];
+    int horizontal = (dir == DIR_LEFT || dir == DIR_RIGHT);
+    int forward = (dir == DIR_RIGHT || dir == DIR_DOWN);
+    long fc = horizontal ? 2L * f->x + f->width : 2L * f->y + f->height;
+    long fp = horizontal ? 2L * f->y + f->height : 2L * f->x + f->width;
+    long best_score = LONG_MAX, best_primary = LONG_MAX;
+    Window best = None;
+    int i;
+    
+    for (i = 0; i < n; i++) {
+        const Rect *c = &rects[i];
+        long cc = horizontal ? 2L * c->x + c->width : 2L * c->y + c->height;
+        long cp = horizontal ? 2L * c->y + c->height : 2L * c->x + c->width;
+        long primary, score;
+        
+        if (i == from || (forward ? cc <= fc : cc >= fc)) continue;
+        
+        primary = labs(cc - fc);
+        score = primary + SPATIAL_PERPENDICULAR_WEIGHT * labs(cp - fp);
+        
+        if (score < best_score || (score == best_score && (primary < best_primary ||
+            (primary == best_primary && (forward ? c->win < best : c->win > best))))) {
+            best_score = score;
+            best_primary = primary;
+            best = c->win;
+        }
+    }
+    return best;
+}
+
+void test_grid() {
+    static SpatialIndex idx;
+    int row, col;
+    
+    printf("Testing directional lookup...\n");
+    
+    // 3x3 grid of 100x100 windows, ids 1..9 row by row
+    spatial_init(&idx);
+    for (row = 0; row < 3; row++) {
+        for (col = 0; col < 3; col++) {
+            spatial_update(&idx, (Window)(row * 3 + col + 1), col * 100, row * 100, 100, 100);
+        }
+    }
+    
+    if (spatial_neighbor(&idx, 5, DIR_LEFT) == 4 && spatial_neighbor(&idx, 5, DIR_RIGHT) == 6 &&
+        spatial_neighbor(&idx, 5, DIR_UP) == 2 && spatial_neighbor(&idx, 5, DIR_DOWN) == 8) {
+        test_pass("Centre window finds all four neighbours");
+    } else {
+        test_fail("Centre window finds all four neighbours", "wrong neighbour");
+    }
+    
+    if (spatial_neighbor(&idx, 1, DIR_LEFT) == None && spatial_neighbor(&idx, 9, DIR_DOWN) == None) {
+        test_pass("Edges have no neighbour");
+    } else {
+        test_fail("Edges have no neighbour", "wrapped around");
+    }
+    
+    // Right column gone, window 6 on a second monitor at the same height: still neighbours
+    spatial_remove(&idx, 3);
+    spatial_remove(&idx, 9);
+    spatial_update(&idx, 6, 1920 + 200, 100, 800, 100);
+    if (spatial_neighbor(&idx, 5, DIR_RIGHT) == 6 && spatial_neighbor(&idx, 6, DIR_LEFT) == 5) {
+        test_pass("Neighbours cross monitors");
+    } else {
+        test_fail("Neighbours cross monitors", "moved window not found");
+    }
+    
+    spatial_remove(&idx, 8);
+    if (spatial_neighbor(&idx, 5, DIR_DOWN) == 7) {
+        test_pass("Removed window is skipped");
+    } else {
+        test_fail("Removed window is skipped", "stale entry");
+    }
+    
+    if (!spatial_contains(&idx, 8) && spatial_direction("up") == DIR_UP && spatial_direction("north") == -1) {
+        test_pass("Membership and direction names");
+    } else {
+        test_fail("Membership and direction names", "unexpected result");
+    }
+}
+
+void test_random() {
+    static SpatialIndex idx;
+    static Rect rects[SPATIAL_MAX];
+    int i, round, mismatches = 0;
+    
+    printf("Testing against brute force...\n");
+    
+    srand(42);
+    spatial_init(&idx);
+    for (i = 0; i < SPATIAL_MAX; i++) {
+        rects[i].win = (Window)(i + 1);
+    }
+    
+    // Floating windows scattered over two monitors, moved around between rounds
+    for (round = 0; round < 20; round++) {
+        for (i = 0; i < SPATIAL_MAX; i++) {
+            if (round > 0 && rand() % 4 != 0) continue;
+            rects[i].x = rand() % 3840;
+            rects[i].y = rand() % 1080;
+            rects[i].width = 50 + rand() % 600;
+            rects[i].height = 50 + rand() % 400;
+            spatial_update(&idx, rects[i].win, rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+        }
+        for (i = 0; i < SPATIAL_MAX; i += 7) {
+            int d;
+            for (d = 0; d < DIR_COUNT; d++) {
+                if (spatial_neighbor(&idx, rects[i].win, (Direction)d) !=
+                    brute_neighbor(rects, SPATIAL_MAX, i, (Direction)d)) {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    
+    if (mismatches == 0) {
+        test_pass("Index agrees with a full scan after incremental updates");
+    } else {
+        char reason[64];
+        snprintf(reason, sizeof(reason), "%d mismatches", mismatches);
+        test_fail("Index agrees with a full scan after incremental updates", reason);
+    }
+    
+    if (spatial_update(&idx, (Window)(SPATIAL_MAX + 1), 0, 0, 10, 10) == 0 && idx.count == SPATIAL_MAX) {
+        test_pass("Full index rejects new windows");
+    } else {
+        test_fail("Full index rejects new windows", "overflowed");
+    }
+}
+
+void test_snap() {
+    static SpatialIndex idx;
+    static EdgeIndex screen;
+    int x, y, w, h, i;
+    
+    printf("Testing edge snapping...\n");
+    
+    // Two 1920x1080 monitors side by side, 20px status bar, one window at (100, 100)
+    edge_index_init(&screen);
+    edge_index_add(&screen, 1, 0, 0, 1080);
+    edge_index_add(&screen, 1, 1920, 0, 1080);
+    edge_index_add(&screen, 1, 3840, 0, 1080);
+    edge_index_add(&screen, 0, 20, 0, 3840);
+    spatial_init(&idx);
+    spatial_update(&idx, 1, 100, 100, 400, 300);
+    spatial_update(&idx, 2, 1000, 500, 200, 200);
+    
+    x = 508; y = 150; w = 200; h = 100;
+    if (spatial_snap(&idx, &screen, 2, &x, &y, &w, &h, 12, 0) && x == 500 && y == 150) {
+        test_pass("Left side snaps to a neighbour's right side");
+    } else {
+        test_fail("Left side snaps to a neighbour's right side", "position not snapped");
+    }
+    
+    x = 1715; y = 26; w = 200; h = 100;
+    if (spatial_snap(&idx, &screen, 2, &x, &y, &w, &h, 12, 0) && x == 1720 && y == 20) {
+        test_pass("Snaps to the monitor seam and the status bar");
+    } else {
+        test_fail("Snaps to the monitor seam and the status bar", "position not snapped");
+    }
+    
+    // Beside the window vertically but not overlapping it: no snap
+    x = 508; y = 600; w = 200; h = 100;
+    if (!spatial_snap(&idx, &screen, 2, &x, &y, &w, &h, 12, 0) && x == 508) {
+        test_pass("Edges that do not overlap are ignored");
+    } else {
+        test_fail("Edges that do not overlap are ignored", "snapped to a distant window");
+    }
+    
+    x = 600; y = 200; w = 1315; h = 100;
+    if (spatial_snap(&idx, &screen, 2, &x, &y, &w, &h, 12, 1) && x == 600 && w == 1320) {
+        test_pass("Resize snaps the far side only");
+    } else {
+        test_fail("Resize snaps the far side only", "wrong geometry");
+    }
+    
+    // Moving window 1 keeps its edges current; its own edges never attract it
+    for (i = 0; i < 50; i++) {
+        spatial_update(&idx, 1, 100 + i * 10, 100, 400, 300);
+    }
+    x = 100 + 49 * 10 + 3; y = 100; w = 400; h = 300;
+    if (idx.edges.vertical.count == 4 && spatial_snap(&idx, NULL, 1, &x, &y, &w, &h, 12, 0) == 0) {
+        test_pass("Edge lists follow window moves");
+    } else {
+        test_fail("Edge lists follow window moves", "stale or self edges");
+    }
+    
+    spatial_remove(&idx, 1);
+    x = 508; y = 150; w = 200; h = 100;
+    if (idx.edges.horizontal.count == 2 && !spatial_snap(&idx, &screen, 2, &x, &y, &w, &h, 12, 0)) {
+        test_pass("Removed window no longer attracts");
+    } else {
+        test_fail("Removed window no longer attracts", "stale edge");
+    }
+}
+
+int main(void) {
+    printf("VaultWM Spatial Index Unit Tests\n");
+    printf("================================\n\n");
+    
+    test_grid();
+    test_random();
+    test_snap();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/*
+ * Unit tests for VaultWM window tags
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/wm/tags/window-tags.h"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+static int is_set(const uint64_t *bits, int slot) {
+    return (bits[slot / 64] >> (slot % 64)) & 1;
+}
+
+void test_names() {
+    TagManager tm;
+    
+    printf("Testing tag names...\n");
+    
+    tag_manager_init(&tm);
+    tag_create(&tm, "1");
+    tag_create(&tm, "web");
+    tag_create(&tm, "chat");
+    
+    if (tag_parse_mask(&tm, "web") == 2 && tag_parse_mask(&tm, "1,chat") == 5 &&
+        tag_parse_mask(&tm, "all") == TAG_ALL && tag_parse_mask(&tm, "web,nope") == 0) {
+        test_pass("Names and lists map to masks");
+    } else {
+        test_fail("Names and lists map to masks", "wrong mask");
+    }
+    
+    if (!tag_create(&tm, "web")) {
+        test_pass("Duplicate tag rejected");
+    } else {
+        test_fail("Duplicate tag rejected", "created twice");
+    }
+}
+
+void test_views() {
+    static TagTable tt;
+    uint64_t visible[TAG_WORDS];
+    int i, ok;
+    
+    printf("Testing tag views...\n");
+    
+    // 200 clients: tag 0 on even slots, tag 1 on multiples of 3
+    tag_table_init(&tt);
+    for (i = 0; i < 200; i++) {
+        tag_table_set(&tt, i, (i % 2 == 0 ? 1u : 0) | (i % 3 == 0 ? 2u : 0) | 4u);
+    }
+    
+    tag_table_view(&tt, 3, visible);
+    ok = 1;
+    for (i = 0; i < TAG_SLOTS; i++) {
+        if (is_set(visible, i) != (i < 200 && (i % 2 == 0 || i % 3 == 0))) ok = 0;
+    }
+    if (ok) {
+        test_pass("View is the union of its tags");
+    } else {
+        test_fail("View is the union of its tags", "wrong visible set");
+    }
+    
+    // Drop slot 70 (word boundary crossing for everything above it)
+    tag_table_remove(&tt, 70);
+    tag_table_view(&tt, 1, visible);
+    ok = (tt.count == 199);
+    for (i = 0; i < 199; i++) {
+        int orig = i < 70 ? i : i + 1;
+        unsigned int mask = (orig % 2 == 0 ? 1u : 0) | (orig % 3 == 0 ? 2u : 0) | 4u;
+        if (is_set(visible, i) != (orig % 2 == 0) || tt.masks[i] != mask) ok = 0;
+    }
+    if (ok && !is_set(visible, 199)) {
+        test_pass("Removing a slot shifts bitsets like the client array");
+    } else {
+        test_fail("Removing a slot shifts bitsets like the client array", "bitsets out of step");
+    }
+    
+    tag_table_set(&tt, 5, 8);
+    tag_table_view(&tt, 8, visible);
+    if (is_set(visible, 5) && visible[0] == (1ull << 5) && visible[1] == 0 && tt.masks[5] == 8) {
+        test_pass("Retagging updates membership");
+    } else {
+        test_fail("Retagging updates membership", "stale membership");
+    }
+    
+    if (!tag_table_set(&tt, 250, 1) && tt.count == 199) {
+        test_pass("Slots past the end are rejected");
+    } else {
+        test_fail("Slots past the end are rejected", "gap in table");
+    }
+}
+
+int main(void) {
+    printf("VaultWM Tag Unit Tests\n");
+    printf("======================\n\n");
+    
+    test_names();
+    test_views();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+/*
+ * Unit tests for VaultWM window rules
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../src/wm/window-rules/window-rules.h"
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_pass(const char *test_name) {
+    printf("  ✓ %s\n", test_name);
+    tests_passed++;
+}
+
+void test_fail(const char *test_name, const char *reason) {
+    printf("  ✗ %s: %s\n", test_name, reason);
+    tests_failed++;
+}
+
+static int apply(WindowRules *wr, const char *class_name, const char *instance_name,
+                 const char *title, const char *window_type, RuleResult *result) {
+    WindowProps props = { class_name, instance_name, title, window_type };
+    return window_rules_apply(wr, &props, result);
+}
+
+void test_exact() {
+    static WindowRules wr;
+    RuleResult r;
+    
+    printf("Testing exact rules...\n");
+    
+    window_rules_init(&wr);
+    window_rules_add(&wr, "Firefox", "Navigator", NULL, NULL, RULE_TYPE_WORKSPACE, "5");
+    window_rules_add(&wr, "Firefox", "*", NULL, NULL, RULE_TYPE_FLOAT, "false");
+    window_rules_add(&wr, "Dialog", "Dialog", NULL, NULL, RULE_TYPE_SIZE, "800x600");
+    window_rules_add(&wr, "Dialog", "Dialog", NULL, NULL, RULE_TYPE_POSITION, "100,-20");
+    
+    if (wr.num_patterns == 0 && apply(&wr, "Firefox", "Navigator", NULL, NULL, &r) == 2 &&
+        r.workspace == 4 && r.floating == 0 && r.width == 0) {
+        test_pass("Class/instance and class-wide rules both apply");
+    } else {
+        test_fail("Class/instance and class-wide rules both apply", "wrong resolved values");
+    }
+    
+    if (apply(&wr, "Firefox", "Toolkit", NULL, NULL, &r) == 1 && r.workspace == -1 && r.floating == 0) {
+        test_pass("Instance rule skips other instances");
+    } else {
+        test_fail("Instance rule skips other instances", "instance ignored");
+    }
+    
+    if (apply(&wr, "Dialog", "Dialog", NULL, NULL, &r) == 2 && r.width == 800 && r.height == 600 &&
+        r.has_position && r.x == 100 && r.y == -20) {
+        test_pass("Size and position values are parsed");
+    } else {
+        test_fail("Size and position values are parsed", "wrong geometry");
+    }
+    
+    if (!window_rules_add(&wr, "X", "*", NULL, NULL, RULE_TYPE_SIZE, "big") &&
+        !window_rules_add(&wr, "X", "*", NULL, NULL, RULE_TYPE_WORKSPACE, "0") &&
+        !window_rules_add(&wr, "/(/", "*", NULL, NULL, RULE_TYPE_FLOAT, "true")) {
+        test_pass("Invalid values and patterns are rejected");
+    } else {
+        test_fail("Invalid values and patterns are rejected", "bad rule accepted");
+    }
+    
+    window_rules_cleanup(&wr);
+}
+
+void test_patterns() {
+    static WindowRules wr;
+    RuleResult r;
+    
+    printf("Testing pattern rules...\n");
+    
+    window_rules_init(&wr);
+    window_rules_add(&wr, "*Gimp*", "*", NULL, NULL, RULE_TYPE_FLOAT, "true");
+    window_rules_add(&wr, "jetbrains-*", "*", NULL, NULL, RULE_TYPE_WORKSPACE, "3");
+    window_rules_add(&wr, "*", "*", "/^Picture.in.[Pp]icture$/", NULL, RULE_TYPE_FLOAT, "true");
+    window_rules_add(&wr, "*", "*", NULL, "dialog", RULE_TYPE_FLOAT, "true");
+    window_rules_add(&wr, "jetbrains-idea", "*", NULL, "dialog", RULE_TYPE_FLOAT, "false");
+    
+    if (apply(&wr, "Gimp-2.10", "gimp", NULL, NULL, &r) == 1 && r.floating == 1 &&
+        apply(&wr, "jetbrains-idea", "idea", NULL, NULL, &r) == 1 && r.workspace == 2 &&
+        apply(&wr, "jetbrains", "x", NULL, NULL, &r) == 0) {
+        test_pass("Globs match anywhere or anchored");
+    } else {
+        test_fail("Globs match anywhere or anchored", "wrong glob result");
+    }
+    
+    if (apply(&wr, "firefox", "firefox", "Picture-in-Picture", NULL, &r) == 1 && r.floating == 1 &&
+        apply(&wr, "firefox", "firefox", "Picture-in-Picture - Mozilla", NULL, &r) == 0) {
+        test_pass("Title regex");
+    } else {
+        test_fail("Title regex", "wrong regex result");
+    }
+    
+    // The later, more specific rule wins over the generic dialog rule
+    if (apply(&wr, "jetbrains-idea", "idea", NULL, "dialog", &r) == 3 && r.floating == 0 &&
+        apply(&wr, "xterm", "xterm", NULL, "DIALOG", &r) == 1 && r.floating == 1) {
+        test_pass("Window type and priority");
+    } else {
+        test_fail("Window type and priority", "wrong winner");
+    }
+    
+    window_rules_cleanup(&wr);
+}
+
+void test_load() {
+    static WindowRules wr;
+    char path[] = "/tmp/vaultwm-rules-XXXXXX";
+    RuleResult r;
+    FILE *f;
+    int fd;
+    
+    printf("Testing rules file...\n");
+    
+    fd = mkstemp(path);
+    f = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (!f) {
+        test_fail("Rules file loads", "cannot create temp file");
+        return;
+    }
+    fprintf(f, "# comment\n\n");
+    fprintf(f, "Alacritty:Alacritty:workspace=2\n");
+    fprintf(f, "mpv:float=true\n");
+    fprintf(f, "*:*:title=*YouTube*:window_type=normal:layout=monocle\n");
+    fprintf(f, "*:*:title=/^[0-9]+:[0-9]+ /:float=true\n");
+    fprintf(f, "Broken:size=huge\n");
+    fprintf(f, "no-action-here\n");
+    fclose(f);
+    
+    window_rules_init(&wr);
+    if (window_rules_load(path, &wr) && wr.num_rules == 4 &&
+        apply(&wr, "Alacritty", "Alacritty", NULL, NULL, &r) == 1 && r.workspace == 1 &&
+        apply(&wr, "mpv", "gl", NULL, NULL, &r) == 1 && r.floating == 1 &&
+        apply(&wr, "xclock", "xclock", "12:30 lunch", NULL, &r) == 1 && r.floating == 1 &&
+        apply(&wr, "chromium", "chromium", "Music - YouTube", "normal", &r) == 1 &&
+        strcmp(r.layout, "monocle") == 0) {
+        test_pass("Rules file loads, bad lines skipped");
+    } else {
+        test_fail("Rules file loads, bad lines skipped", "wrong rules loaded");
+    }
+    
+    // Clients keep their result across reloads, which refill the rules in place
+    f = fopen(path, "w");
+    if (f) {
+        fprintf(f, "*:*:title=*YouTube*:window_type=normal:layout=grid\n");
+        fclose(f);
+    }
+    if (window_rules_load(path, &wr) && strcmp(r.layout, "monocle") == 0) {
+        test_pass("Result outlives a rules reload");
+    } else {
+        test_fail("Result outlives a rules reload", "layout changed under the result");
+    }
+    
+    unlink(path);
+    window_rules_cleanup(&wr);
+}
+
+void test_memo() {
+    static WindowRules wr;
+    RuleResult r;
+    WindowProps props = { "Spotify", "spotify", NULL, "" };
+    unsigned long misses;
+    int i;
+    
+    printf("Testing memoized resolution...\n");
+    
+    window_rules_init(&wr);
+    window_rules_add(&wr, "Spotify", "*", NULL, NULL, RULE_TYPE_WORKSPACE, "9");
+    window_rules_add(&wr, "*", "*", "*Picture*", NULL, RULE_TYPE_FLOAT, "true");
+    window_rules_add(&wr, "xterm", "*", NULL, NULL, RULE_TYPE_FLOAT, "false");
+    
+    // A terminal retitling itself hits the memo and checks one title pattern
+    for (i = 0; i < 100; i++) {
+        apply(&wr, "xterm", "xterm", i % 2 ? "vim" : "bash", "", &r);
+    }
+    if (wr.memo_misses == 1 && wr.memo_hits == 99 && r.floating == 0) {
+        test_pass("Repeated resolution hits the memo");
+    } else {
+        test_fail("Repeated resolution hits the memo", "memo not used");
+    }
+    
+    if (apply(&wr, "feh", "feh", "Picture viewer", "", &r) == 1 && r.floating == 1 &&
+        apply(&wr, "feh", "feh", "image.png", "", &r) == 0) {
+        test_pass("Title rules are still checked per window");
+    } else {
+        test_fail("Title rules are still checked per window", "memoized title result");
+    }
+    
+    // Mapped without WM_CLASS, labelled later
+    if (apply(&wr, "", "", NULL, "", &r) == 0 && r.workspace == -1 &&
+        apply(&wr, "Spotify", "spotify", NULL, "", &r) == 1 && r.workspace == 8) {
+        test_pass("Late WM_CLASS resolves to its rules");
+    } else {
+        test_fail("Late WM_CLASS resolves to its rules", "wrong late resolution");
+    }
+    
+    if ((wr.depends & RULE_DEPENDS_TITLE) && (wr.depends & RULE_DEPENDS_CLASS) &&
+        !(wr.depends & RULE_DEPENDS_TYPE) && window_rules_title_sensitive(&wr, &props)) {
+        test_pass("Property dependencies are tracked");
+    } else {
+        test_fail("Property dependencies are tracked", "wrong dependency mask");
+    }
+    
+    misses = wr.memo_misses;
+    window_rules_add(&wr, "Spotify", "*", NULL, NULL, RULE_TYPE_WORKSPACE, "4");
+    if (apply(&wr, "Spotify", "spotify", NULL, "", &r) == 2 && r.workspace == 3 &&
+        wr.memo_misses == misses + 1) {
+        test_pass("Changing the rules invalidates the memo");
+    } else {
+        test_fail("Changing the rules invalidates the memo", "stale memo entry");
+    }
+    
+    window_rules_cleanup(&wr);
+}
+
+int main(void) {
+    printf("VaultWM Window Rules Unit Tests\n");
+    printf("===============================\n\n");
+    
+    test_exact();
+    test_patterns();
+    test_load();
+    test_memo();
+    
+    printf("\nTest Summary\n");
+    printf("============\n");
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    
+    return (tests_failed == 0) ? 0 : 1;
+}